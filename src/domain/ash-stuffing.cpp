@@ -0,0 +1,199 @@
+/**
+ * @file ash-stuffing.cpp
+ *
+ * @brief Scanning for ASH reserved bytes, and byte stuffing
+ */
+
+#include <cstring>
+
+#include "ash-stuffing.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ASH_STUFFING_X86
+#include <immintrin.h>
+#endif
+
+#define ASH_ESCAPE_BYTE 0x7D
+
+namespace {
+
+/**
+ * @brief Classification of all byte values, non-zero for reserved bytes
+ */
+struct SAshReservedTable {
+    uint8_t reserved[256];
+
+    SAshReservedTable() : reserved() {
+        for (unsigned int i = 0; i < 256; i++) {
+            reserved[i] = CAshStuffing::isReserved(static_cast<uint8_t>(i)) ? 1 : 0;
+        }
+    }
+};
+
+const SAshReservedTable& reservedTable() {
+    static const SAshReservedTable table;
+    return table;
+}
+
+typedef size_t (*FFindReserved)(const uint8_t* i_data, size_t i_len);
+
+/**
+ * @brief Select the fastest scanner supported by the CPU we are running on
+ */
+FFindReserved selectFindReserved() {
+    if (CAshStuffing::hasAvx2()) {
+        return &CAshStuffing::findReservedAvx2;
+    }
+    if (CAshStuffing::hasSse2()) {
+        return &CAshStuffing::findReservedSse2;
+    }
+    return &CAshStuffing::findReservedScalar;
+}
+
+FFindReserved findReservedImpl() {
+    static const FFindReserved impl = selectFindReserved();
+    return impl;
+}
+
+} // namespace
+
+size_t CAshStuffing::findReserved(const uint8_t* i_data, size_t i_len)
+{
+    return findReservedImpl()(i_data, i_len);
+}
+
+size_t CAshStuffing::stuff(const uint8_t* i_data, size_t i_len, uint8_t* o_out)
+{
+    FFindReserved l_find = findReservedImpl();
+    uint8_t *l_out = o_out;
+    size_t l_pos = 0;
+
+    while (l_pos < i_len) {
+        // copy the clean run in bulk, then escape the reserved byte that ends it
+        size_t l_run = l_find(i_data + l_pos, i_len - l_pos);
+        std::memcpy(l_out, i_data + l_pos, l_run);
+        l_out += l_run;
+        l_pos += l_run;
+        if (l_pos < i_len) {
+            *l_out++ = ASH_ESCAPE_BYTE;
+            *l_out++ = static_cast<uint8_t>(i_data[l_pos++] ^ 0x20);
+        }
+    }
+    return static_cast<size_t>(l_out - o_out);
+}
+
+const char* CAshStuffing::getImplementationName()
+{
+    FFindReserved l_find = findReservedImpl();
+
+    if (l_find == &CAshStuffing::findReservedAvx2) {
+        return "avx2";
+    }
+    if (l_find == &CAshStuffing::findReservedSse2) {
+        return "sse2";
+    }
+    return "scalar";
+}
+
+size_t CAshStuffing::findReservedScalar(const uint8_t* i_data, size_t i_len)
+{
+    const uint8_t *l_table = reservedTable().reserved;
+
+    for (size_t cnt = 0; cnt < i_len; cnt++) {
+        if (l_table[i_data[cnt]]) {
+            return cnt;
+        }
+    }
+    return i_len;
+}
+
+#ifdef ASH_STUFFING_X86
+
+__attribute__((target("sse2")))
+size_t CAshStuffing::findReservedSse2(const uint8_t* i_data, size_t i_len)
+{
+    const __m128i l_flag = _mm_set1_epi8(0x7E);
+    const __m128i l_escape = _mm_set1_epi8(0x7D);
+    const __m128i l_xon = _mm_set1_epi8(0x11);
+    const __m128i l_xoff = _mm_set1_epi8(0x13);
+    const __m128i l_substitute = _mm_set1_epi8(0x18);
+    const __m128i l_cancel = _mm_set1_epi8(0x1A);
+    size_t cnt = 0;
+
+    for (; cnt + 16 <= i_len; cnt += 16) {
+        __m128i l_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(i_data + cnt));
+        __m128i l_match = _mm_or_si128(
+                              _mm_or_si128(_mm_cmpeq_epi8(l_block, l_flag), _mm_cmpeq_epi8(l_block, l_escape)),
+                              _mm_or_si128(
+                                  _mm_or_si128(_mm_cmpeq_epi8(l_block, l_xon), _mm_cmpeq_epi8(l_block, l_xoff)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(l_block, l_substitute), _mm_cmpeq_epi8(l_block, l_cancel))));
+        int l_mask = _mm_movemask_epi8(l_match);
+        if (0 != l_mask) {
+            return cnt + static_cast<size_t>(__builtin_ctz(static_cast<unsigned int>(l_mask)));
+        }
+    }
+    return cnt + findReservedScalar(i_data + cnt, i_len - cnt);
+}
+
+__attribute__((target("avx2")))
+size_t CAshStuffing::findReservedAvx2(const uint8_t* i_data, size_t i_len)
+{
+    const __m256i l_flag = _mm256_set1_epi8(0x7E);
+    const __m256i l_escape = _mm256_set1_epi8(0x7D);
+    const __m256i l_xon = _mm256_set1_epi8(0x11);
+    const __m256i l_xoff = _mm256_set1_epi8(0x13);
+    const __m256i l_substitute = _mm256_set1_epi8(0x18);
+    const __m256i l_cancel = _mm256_set1_epi8(0x1A);
+    size_t cnt = 0;
+
+    for (; cnt + 32 <= i_len; cnt += 32) {
+        __m256i l_block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(i_data + cnt));
+        __m256i l_match = _mm256_or_si256(
+                              _mm256_or_si256(_mm256_cmpeq_epi8(l_block, l_flag), _mm256_cmpeq_epi8(l_block, l_escape)),
+                              _mm256_or_si256(
+                                  _mm256_or_si256(_mm256_cmpeq_epi8(l_block, l_xon), _mm256_cmpeq_epi8(l_block, l_xoff)),
+                                  _mm256_or_si256(_mm256_cmpeq_epi8(l_block, l_substitute), _mm256_cmpeq_epi8(l_block, l_cancel))));
+        unsigned int l_mask = static_cast<unsigned int>(_mm256_movemask_epi8(l_match));
+        if (0 != l_mask) {
+            _mm256_zeroupper();
+            return cnt + static_cast<size_t>(__builtin_ctz(l_mask));
+        }
+    }
+    /* Avoid AVX to SSE transition penalties (not all optimisation levels insert this automatically) */
+    _mm256_zeroupper();
+    return cnt + findReservedSse2(i_data + cnt, i_len - cnt);
+}
+
+bool CAshStuffing::hasSse2()
+{
+    return __builtin_cpu_supports("sse2");
+}
+
+bool CAshStuffing::hasAvx2()
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+#else // ASH_STUFFING_X86
+
+size_t CAshStuffing::findReservedSse2(const uint8_t* i_data, size_t i_len)
+{
+    return findReservedScalar(i_data, i_len);
+}
+
+size_t CAshStuffing::findReservedAvx2(const uint8_t* i_data, size_t i_len)
+{
+    return findReservedScalar(i_data, i_len);
+}
+
+bool CAshStuffing::hasSse2()
+{
+    return false;
+}
+
+bool CAshStuffing::hasAvx2()
+{
+    return false;
+}
+
+#endif // ASH_STUFFING_X86
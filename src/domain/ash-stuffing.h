@@ -0,0 +1,89 @@
+/**
+ * @file ash-stuffing.h
+ *
+ * @brief Scanning for ASH reserved bytes, and byte stuffing
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>	// For size_t
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief Fast detection of ASH reserved bytes (0x7E, 0x7D, 0x11, 0x13, 0x18 and 0x1A)
+ *
+ * Reserved bytes are rare in payloads, so the scanners look for the first one in a whole block (16 bytes using SSE2, 32 bytes using AVX2) and the clean runs before it are copied in bulk.
+ * The fastest scanner supported by the CPU is selected at runtime, the scalar fallback uses a 256-entry classification table
+ */
+class CAshStuffing
+{
+public:
+    /**
+     * @brief Is a byte reserved (and thus needs to be stuffed)?
+     */
+    static constexpr bool isReserved(uint8_t i_byte) {
+        return (0x7E == i_byte) || (0x7D == i_byte) || (0x11 == i_byte) || (0x13 == i_byte) || (0x18 == i_byte) || (0x1A == i_byte);
+    }
+
+    /**
+     * @brief Find the first reserved byte in a buffer
+     *
+     * @param i_data A pointer to the first byte
+     * @param i_len The number of bytes to scan
+     *
+     * @return The index of the first reserved byte, or i_len if there is none
+     */
+    static size_t findReserved(const uint8_t* i_data, size_t i_len);
+
+    /**
+     * @brief Stuff a buffer
+     *
+     * Every reserved byte is replaced by an escape byte (0x7D) followed by the reserved byte with bit 5 inverted
+     *
+     * @param i_data A pointer to the first byte to stuff
+     * @param i_len The number of bytes to stuff
+     * @param[out] o_out The buffer receiving the stuffed bytes, it must be able to hold 2*i_len bytes
+     *
+     * @return The number of bytes written to o_out
+     */
+    static size_t stuff(const uint8_t* i_data, size_t i_len, uint8_t* o_out);
+
+    /**
+     * @brief Name of the scanner selected at runtime ("avx2", "sse2" or "scalar")
+     */
+    static const char* getImplementationName();
+
+    /**
+     * @brief Scanner using a 256-entry classification table, available everywhere
+     */
+    static size_t findReservedScalar(const uint8_t* i_data, size_t i_len);
+
+    /**
+     * @brief Scanner processing 16-byte blocks, only to be invoked if hasSse2() is true
+     */
+    static size_t findReservedSse2(const uint8_t* i_data, size_t i_len);
+
+    /**
+     * @brief Scanner processing 32-byte blocks, only to be invoked if hasAvx2() is true
+     */
+    static size_t findReservedAvx2(const uint8_t* i_data, size_t i_len);
+
+    /**
+     * @brief Can findReservedSse2() be used on this CPU?
+     */
+    static bool hasSse2();
+
+    /**
+     * @brief Can findReservedAvx2() be used on this CPU?
+     */
+    static bool hasAvx2();
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
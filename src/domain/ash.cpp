@@ -4,12 +4,22 @@
 
 #include <iostream>
 #include <list>
-#include <map>
+#include <algorithm>
+#include <cstring>
 
 #include "ash.h"
+#include "crc-ccitt.h"
+#include "ash-stuffing.h"
+#include "enum-name-table.h"
 
 #include "../spi/GenericLogger.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 using namespace std;
 
 /**
@@ -21,21 +31,90 @@ using namespace std;
 
 #define ASH_CANCEL_BYTE     0x1A
 #define ASH_FLAG_BYTE       0x7E
+#define ASH_ESCAPE_BYTE     0x7D
 #define ASH_SUBSTITUTE_BYTE 0x18
 #define ASH_XON_BYTE        0x11
 #define ASH_OFF_BYTE        0x13
 #define ASH_TIMEOUT         -1
 
-#define ASH_MAX_LENGTH 131
+#define ASH_RST_CONTROL_BYTE 0xC0
+#define ASH_ACK_CONTROL_BYTE 0x80
+#define ASH_RETX_FLAG        0x08
+
+/**
+ * CRCs of the fixed-content frames, computed at compile time
+ */
+static constexpr uint16_t ASH_RST_CRC = CCrcCcitt::constUpdate(CCrcCcitt::INITIAL_VALUE, ASH_RST_CONTROL_BYTE);
+static constexpr uint16_t ASH_ACK_CRC[8] = {
+    CCrcCcitt::constUpdate(CCrcCcitt::INITIAL_VALUE, ASH_ACK_CONTROL_BYTE+0),
+    CCrcCcitt::constUpdate(CCrcCcitt::INITIAL_VALUE, ASH_ACK_CONTROL_BYTE+1),
+    CCrcCcitt::constUpdate(CCrcCcitt::INITIAL_VALUE, ASH_ACK_CONTROL_BYTE+2),
+    CCrcCcitt::constUpdate(CCrcCcitt::INITIAL_VALUE, ASH_ACK_CONTROL_BYTE+3),
+    CCrcCcitt::constUpdate(CCrcCcitt::INITIAL_VALUE, ASH_ACK_CONTROL_BYTE+4),
+    CCrcCcitt::constUpdate(CCrcCcitt::INITIAL_VALUE, ASH_ACK_CONTROL_BYTE+5),
+    CCrcCcitt::constUpdate(CCrcCcitt::INITIAL_VALUE, ASH_ACK_CONTROL_BYTE+6),
+    CCrcCcitt::constUpdate(CCrcCcitt::INITIAL_VALUE, ASH_ACK_CONTROL_BYTE+7),
+};
+static_assert(ASH_RST_CRC == 0x38BC, "Unexpected CRC for the RST frame");
+
+/**
+ * Number of pseudo-random bytes precomputed: enough for the data field and CRC of the longest frame (the CRC is randomised on reception)
+ */
+#define ASH_LFSR_TABLE_SIZE (ASH_MAX_LENGTH-1)
+
+namespace {
+
+/**
+ * @brief Pseudo-random sequence XORed with the data field of DATA frames (LFSR seeded with 0x42, feedback 0xB8)
+ */
+struct SAshLfsrTable {
+    alignas(16) uint8_t seq[ASH_LFSR_TABLE_SIZE];
+
+    SAshLfsrTable() : seq() {
+        uint8_t rand = 0x42;
+        for (size_t cnt = 0; cnt < ASH_LFSR_TABLE_SIZE; cnt++) {
+            seq[cnt] = rand;
+            rand = nextLfsr(rand);
+        }
+    }
+
+    static uint8_t nextLfsr(uint8_t rand) {
+        if ((rand & 0x01) == 0) {
+            return static_cast<uint8_t>(rand >> 1);
+        } else {
+            return static_cast<uint8_t>((rand >> 1) ^ 0xb8);
+        }
+    }
+};
+
+const SAshLfsrTable& lfsrTable() {
+    static const SAshLfsrTable table;
+    return table;
+}
+
+} // namespace
 
 CAsh::CAsh(CAshCallback *ipCb, ITimerFactory &i_timer_factory) :
 	ackNum(0),
 	frmNum(0),
+	unackedFrmNum(0),
+	txWindow(1),
+	txFrames(),
+	txFramesLen(),
+	txFramesTime(),
+	txFramesReTx(),
+	ackTimeout(T_RX_ACK_INIT),
+	timeoutCount(0),
+	rxUnackedCount(0),
+	ackSentCount(0),
+	ackSavedCount(0),
 	seq_num(0),
 	stateConnected(false),
 	timer(i_timer_factory.create()),
 	pCb(ipCb),
-	in_msg()
+	in_buf(),
+	in_len(0),
+	in_error(false)
 {
 }
 
@@ -48,28 +127,45 @@ void CAsh::Timeout(void)
             pCb->ashCbInfo(ASH_RESET_FAILED);
         }
     }
+    else if( 0 != getOutstandingFrameCount() )
+    {
+        timeoutCount++;
+        if( timeoutCount > ASH_MAX_TIMEOUTS )
+        {
+            clogE << "CAsh::Timeout no ACK from NCP after " << static_cast<unsigned int>(ASH_MAX_TIMEOUTS) << " retransmissions" << std::endl;
+            stateConnected = false;
+            if( nullptr != pCb ) { pCb->ashCbInfo(ASH_STATE_CHANGE); }
+            return;
+        }
+
+        // back off
+        ackTimeout = static_cast<uint16_t>(std::min(2*ackTimeout, T_RX_ACK_MAX));
+        clogD << "CAsh::Timeout retransmitting " << static_cast<unsigned int>(getOutstandingFrameCount()) << " frame(s), next timeout " << ackTimeout << "ms" << std::endl;
+
+        retransmitFrames();
+        startAckTimer();
+    }
 }
 
-vector<uint8_t> CAsh::resetNCPFrame(void)
+CFrameBuffer CAsh::resetNCPFrame(void)
 {
     ackNum = 0;
     frmNum = 0;
+    unackedFrmNum = 0;
+    std::fill(txFramesLen, txFramesLen + 8, 0);
+    ackTimeout = T_RX_ACK_INIT;
+    timeoutCount = 0;
+    rxUnackedCount = 0;
     seq_num = 0;
     stateConnected = false;
-    vector<uint8_t> lo_msg;
+    const uint8_t l_rst[] = { ASH_RST_CONTROL_BYTE, static_cast<uint8_t>(ASH_RST_CRC>>8), static_cast<uint8_t>(ASH_RST_CRC&0xFF) };
 
     timer->stop();
     if( nullptr != pCb ){ pCb->ashCbInfo(ASH_STATE_CHANGE); }
 
-    lo_msg.push_back(0xC0);
-
-    uint16_t crc = computeCRC(lo_msg);
-    lo_msg.push_back(static_cast<uint8_t>(crc>>8));
-    lo_msg.push_back(static_cast<uint8_t>(crc&0xFF));
+    CFrameBuffer lo_msg = stuffedOutputData(l_rst, sizeof(l_rst));
 
-    lo_msg = stuffedOutputData(lo_msg);
-
-    lo_msg.insert( lo_msg.begin(), ASH_CANCEL_BYTE );
+    lo_msg.push_front( ASH_CANCEL_BYTE );
 
     // start timer
     timer->start( T_RX_ACK_INIT, [&](ITimer *ipTimer){this->Timeout();} );
@@ -79,210 +175,163 @@ vector<uint8_t> CAsh::resetNCPFrame(void)
 
 std::string CAsh::EAshInfoToString( EAshInfo in )
 {
-    const std::map<EAshInfo,std::string> MyEnumStrings {
+    static const CEnumNameTable::SEntry entries[] = {
         { ASH_RESET_FAILED, "ASH_RESET_FAILED" },
         { ASH_ACK, "ASH_ACK" },
         { ASH_NACK, "ASH_NACK" },
         { ASH_STATE_CHANGE, "ASH_STATE_CHANGE" },
     };
-    auto   it  = MyEnumStrings.find(in);
-    return it == MyEnumStrings.end() ? "OUT_OF_RANGE" : it->second;      
+    static const CEnumNameTable names(entries);
+    const char* name = names.find(in);
+    return (name != nullptr) ? name : "OUT_OF_RANGE";
 }
 
-std::vector<uint8_t> CAsh::AckFrame(void)
+CFrameBuffer CAsh::AckFrame(void)
 {
-  std::vector<uint8_t> lo_msg;
-
-  lo_msg.push_back(static_cast<uint8_t>(0x80+ackNum));
+  const uint8_t l_ack[] = { static_cast<uint8_t>(ASH_ACK_CONTROL_BYTE+ackNum), static_cast<uint8_t>(ASH_ACK_CRC[ackNum]>>8), static_cast<uint8_t>(ASH_ACK_CRC[ackNum]&0xFF) };
 
-  uint16_t crc = computeCRC(lo_msg);
-  lo_msg.push_back(static_cast<uint8_t>(crc>>8));
-  lo_msg.push_back(static_cast<uint8_t>(crc&0xFF));
+  CFrameBuffer lo_msg = stuffedOutputData(l_ack, sizeof(l_ack));
 
-  lo_msg = stuffedOutputData(lo_msg);
+  // one ACK frame acknowledges all DATA frames received so far
+  ackSentCount++;
+  if( rxUnackedCount > 1 )
+  {
+    ackSavedCount += rxUnackedCount - 1U;
+  }
+  rxUnackedCount = 0;
 
-  // start timer
-  timer->start( T_RX_ACK_INIT, [&](ITimer *ipTimer){this->Timeout();} );
+  // no timer here: ACK frames are not acknowledged by the NCP
 
   return lo_msg;
 }
 
 std::vector<uint8_t> CAsh::DataFrame(std::vector<uint8_t> i_data)
 {
-  std::vector<uint8_t> lo_msg;
+  uint8_t l_frame[ASH_MAX_FRAME_SIZE];
 
-  lo_msg.push_back(static_cast<uint8_t>((frmNum << 4) + ackNum) );
-  frmNum = (frmNum + 1) & 0x07;
+  size_t l_len = DataFrame(i_data.data(), i_data.size(), l_frame, sizeof(l_frame));
+
+  return std::vector<uint8_t>(l_frame, l_frame + l_len);
+}
 
-  if( 0 != i_data.at(0) )
+size_t CAsh::DataFrame(const uint8_t* i_data, size_t i_len, uint8_t* o_frame, size_t i_frame_size)
+{
+  // WARNING for all frames except "VersionRequest" frame, add exteded header
+  size_t l_header_len = (0 != i_data[0]) ? 4 : 2;
+  size_t l_ezsp_len = l_header_len + i_len;
+
+  if( (0 == i_len) || (l_ezsp_len > ASH_MAX_DATA_LENGTH) || (i_frame_size < 2*(l_ezsp_len+3)+1) )
   {
-    // WARNING for all frames except "VersionRequest" frame, add exteded header
-    i_data.insert(i_data.begin(),0);
-    i_data.insert(i_data.begin(),0xFF);
+    clogE << "CAsh::DataFrame cannot encode a " << i_len << " bytes command" << std::endl;
+    return 0;
   }
 
-  // insert frm control
-  i_data.insert(i_data.begin(),0);
-  // insert seq number
-  i_data.insert(i_data.begin(),seq_num++);
+  // build the EZSP frame directly in the retransmit buffer, where it is kept until it gets acknowledged by the NCP
+  uint8_t l_frm_num = frmNum;
+  uint8_t *l_ezsp = txFrames[l_frm_num];
+  l_ezsp[0] = seq_num++;
+  l_ezsp[1] = 0;  // frm control
+  l_ezsp[2] = 0xFF;
+  l_ezsp[3] = 0x00;
+  std::copy(i_data, i_data + i_len, l_ezsp + l_header_len);
+  txFramesLen[l_frm_num] = l_ezsp_len;
+  txFramesTime[l_frm_num] = std::chrono::steady_clock::now();
+  txFramesReTx[l_frm_num] = false;
+  frmNum = (frmNum + 1) & 0x07;
+
+  size_t lo_len = encodeDataFrame(static_cast<uint8_t>((l_frm_num << 4) + ackNum), l_ezsp, l_ezsp_len, o_frame);
 
+  // start timer, if not already running for a previous frame
+  if( !timer->isRunning() )
+  {
+    startAckTimer();
+  }
 
-  i_data = dataRandomise(i_data,0);
-  for (auto &val : i_data)
+  return lo_len;
+}
+
+void CAsh::setTxWindow(uint8_t i_window)
+{
+  if( i_window < 1 )
   {
-      lo_msg.push_back(val);
+    i_window = 1;
   }
+  if( i_window > ASH_MAX_TX_WINDOW )
+  {
+    i_window = ASH_MAX_TX_WINDOW;
+  }
+  txWindow = i_window;
+}
 
-  uint16_t crc = computeCRC(lo_msg);
-  lo_msg.push_back(static_cast<uint8_t>(crc>>8));
-  lo_msg.push_back(static_cast<uint8_t>(crc&0xFF));
+uint8_t CAsh::getOutstandingFrameCount(void) const
+{
+  return static_cast<uint8_t>((frmNum - unackedFrmNum) & 0x07);
+}
 
-  lo_msg = stuffedOutputData(lo_msg);
+std::vector<uint8_t> CAsh::decode(std::vector<uint8_t> &i_data)
+{
+  size_t l_used = 0;
+  std::vector<uint8_t> lo_msg = decode(i_data.data(), i_data.size(), l_used).toVector();
 
-  // start timer
-  timer->start( T_RX_ACK_INIT, [&](ITimer *ipTimer){this->Timeout();} );
+  i_data.erase(i_data.begin(), i_data.begin()+static_cast<std::ptrdiff_t>(l_used));
 
   return lo_msg;
 }
 
-std::vector<uint8_t> CAsh::decode(std::vector<uint8_t> &i_data)
+CByteSpan CAsh::decode(const uint8_t* i_data, size_t i_len, size_t& o_used)
 {
-  bool inputError = false;
-  //std::list<uint8_t> li_data;
-  std::vector<uint8_t> lo_msg;
-  uint8_t val;
+  CByteSpan lo_msg;
+  size_t l_pos = 0;
 
-  while( !i_data.empty() && lo_msg.empty() )
+  while( (l_pos < i_len) && lo_msg.empty() )
   {
-    val = i_data.front();
-    i_data.erase(i_data.begin());
+    // bytes up to the next reserved byte are plain frame content, copy them in bulk
+    size_t l_run = CAshStuffing::findReserved(i_data + l_pos, i_len - l_pos);
+    if( l_run > 0 )
+    {
+      if( !in_error )
+      {
+        if( in_len + l_run > sizeof(in_buf) )
+        {
+          // a stuffed frame can never be that long, drop everything until next flag
+          in_len = 0;
+          in_error = true;
+        }
+        else
+        {
+          std::copy(i_data + l_pos, i_data + l_pos + l_run, in_buf + in_len);
+          in_len += l_run;
+        }
+      }
+      l_pos += l_run;
+      continue;
+    }
+
+    uint8_t val = i_data[l_pos++];
     switch( val )
     {
       case ASH_CANCEL_BYTE:
           // Cancel Byte: Terminates a frame in progress. A Cancel Byte causes all data received since the
           // previous Flag Byte to be ignored. Note that as a special case, RST and RSTACK frames are preceded
           // by Cancel Bytes to ignore any link startup noise.
-          in_msg.clear();
-          inputError = false;
+          in_len = 0;
+          in_error = false;
           break;
       case ASH_FLAG_BYTE:
-            //-- clogD << "CAsh::decode ASH_FLAG_BYTE" << std::endl;
           // Flag Byte: Marks the end of a frame.When a Flag Byte is received, the data received since the
           // last Flag Byte or Cancel Byte is tested to see whether it is a valid frame.
-          //LOGGER(logTRACE) << "<-- RX ASH frame: VIEW ASH_FLAG_BYTE";
-          if (!inputError && !in_msg.empty()) {
-            if( in_msg.size() >= 3 )
-            {
-              // Remove byte stuffing
-              bool escape = false;
-              for (auto &data : in_msg) {
-                  if (escape) {
-                      escape = false;
-                      if ((data & 0x20) == 0) {
-                          data = static_cast<uint8_t>(data + 0x20);
-                      } else {
-                          data = static_cast<uint8_t>(data & 0xDF);
-                      }
-                  } else if (data == 0x7D) {
-                      escape = true;
-                      continue;
-                  }
-                  lo_msg.push_back(data);
-              }
-
-              // Check CRC
-              if (computeCRC(lo_msg) != 0) {
-                  lo_msg.clear();
-                  clogD << "CAsh::decode Wrong CRC" << std::endl;
-              }
-              else
-              {
-                if ((lo_msg.at(0) & 0x80) == 0) {
-                  // DATA;
-                  //-- clogD << "CAsh::decode DATA" << std::endl;
-
-                  // update ack number, use incoming frm number
-                  ackNum = ((lo_msg.at(0)>>4&0x07) + 1) & 0x07;
-
-
-                  lo_msg = dataRandomise(lo_msg,1);
-
-                  if( 0xFF == lo_msg.at(2) )
-                  {
-                    // WARNING for all frames except "VersionRequest" frame, add exteded header
-                    lo_msg.erase(lo_msg.begin()+2);
-                    lo_msg.erase(lo_msg.begin()+2);
-                  }
-
-                }
-                else if ((lo_msg.at(0) & 0x60) == 0x00) {
-                  // ACK;
-                  //-- clogD << "CAsh::decode ACK" << std::endl;
-                  //LOGGER(logTRACE) << "<-- RX ASH ACK Frame !! ";
-                  lo_msg.clear();
-                  timer->stop();
-
-                  if( nullptr != pCb ) { pCb->ashCbInfo(ASH_ACK); }
-                }
-                else if ((lo_msg.at(0) & 0x60) == 0x20) {
-                  // NAK;
-                  frmNum = lo_msg.at(0) & 0x07;
-
-                  clogD << "CAsh::decode NACK" << std::endl;
-
-                  //LOGGER(logTRACE) << "<-- RX ASH NACK Frame !! : 0x" << QString::number(lo_msg.at(0),16).toUpper().rightJustified(2,'0');
-                  lo_msg.clear();
-                  timer->stop();
-
-                  if( nullptr != pCb ) { pCb->ashCbInfo(ASH_NACK); }
-                }
-                else if (lo_msg.at(0) == 0xC0) {
-                  // RST;
-                  lo_msg.clear();
-                  //LOGGER(logTRACE) << "<-- RX ASH RST Frame !! ";
-                  clogD << "CAsh::decode RST" << std::endl;
-                }
-                else if (lo_msg.at(0) == 0xC1) {
-                  // RSTACK;
-                  //LOGGER(logTRACE) << "<-- RX ASH RSTACK Frame !! ";
-                  clogD << "CAsh::decode RSTACK" << std::endl;
-
-                  lo_msg.clear();
-                  if( !stateConnected )
-                  {
-                    /** \todo : add some test to verify it is a software reset and ash protocol version is 2 */
-                    timer->stop();
-                    stateConnected = true;
-                    if( nullptr != pCb ){ pCb->ashCbInfo(ASH_STATE_CHANGE); }
-                  }
-                }
-                else if (lo_msg.at(0) == 0xC2) {
-                  // ERROR;
-                  //LOGGER(logTRACE) << "<-- RX ASH ERROR Frame !! ";
-                  clogD << "CAsh::decode ERROR" << std::endl;
-                  lo_msg.clear();
-                }
-                else
-                {
-                  //LOGGER(logTRACE) << "<-- RX ASH Unknown !! ";
-                  clogD << "CAsh::decode UNKNOWN" << std::endl;
-                  lo_msg.clear();
-                }
-              }
-            }
-            else
-            {
-              //LOGGER(logTRACE) << "<-- RX ASH too short !! ";
-            }
+          if( !in_error && (in_len > 0) )
+          {
+            lo_msg = decodeFrame();
           }
-          in_msg.clear();
-          inputError = false;
+          in_len = 0;
+          in_error = false;
           break;
       case ASH_SUBSTITUTE_BYTE:
           // Substitute Byte: Replaces a byte received with a low-level communication error (e.g., framing
           // error) from the UART.When a Substitute Byte is processed, the data between the previous and the
           // next Flag Bytes is ignored.
-          inputError = true;
+          in_error = true;
           break;
       case ASH_XON_BYTE:
           // XON: Resume transmissionUsed in XON/XOFF flow control. Always ignored if received by the NCP.
@@ -290,19 +339,154 @@ std::vector<uint8_t> CAsh::decode(std::vector<uint8_t> &i_data)
       case ASH_OFF_BYTE:
           // XOFF: Stop transmissionUsed in XON/XOFF flow control. Always ignored if received by the NCP.
           break;
-/*          
-      case ASH_TIMEOUT:
-          break;
-*/          
       default:
-          if (in_msg.size() >= ASH_MAX_LENGTH) {
-              in_msg.clear();
-              inputError = true;
+          // escape byte, removed when the whole frame has been received
+          if( in_error )
+          {
+            break;
+          }
+          if( in_len >= sizeof(in_buf) )
+          {
+            // a stuffed frame can never be that long, drop everything until next flag
+            in_len = 0;
+            in_error = true;
+            break;
           }
-          in_msg.push_back(val);
+          in_buf[in_len++] = val;
           break;
     }
+  }
+
+  o_used = l_pos;
+  return lo_msg;
+}
 
+CByteSpan CAsh::decodeFrame(void)
+{
+  // Remove byte stuffing in place (the write index never goes past the read index), moving the runs between escape bytes in bulk
+  size_t l_len = 0;
+  size_t l_idx = 0;
+  while( l_idx < in_len )
+  {
+    const uint8_t *l_escape = static_cast<const uint8_t*>(memchr(in_buf + l_idx, ASH_ESCAPE_BYTE, in_len - l_idx));
+    size_t l_run = (nullptr == l_escape) ? (in_len - l_idx) : static_cast<size_t>(l_escape - (in_buf + l_idx));
+    if( l_len != l_idx )
+    {
+      memmove(in_buf + l_len, in_buf + l_idx, l_run);
+    }
+    l_len += l_run;
+    l_idx += l_run;
+    if( l_idx < in_len )
+    {
+      // skip the escape byte, a trailing one is simply dropped
+      l_idx++;
+      if( l_idx < in_len )
+      {
+        in_buf[l_len++] = static_cast<uint8_t>(in_buf[l_idx++] ^ 0x20);
+      }
+    }
+  }
+
+  if( (l_len < 3) || (l_len > ASH_MAX_LENGTH) )
+  {
+    //LOGGER(logTRACE) << "<-- RX ASH too short !! ";
+    return CByteSpan();
+  }
+
+  // Check CRC
+  if( computeCRC(in_buf, l_len) != 0 )
+  {
+    clogD << "CAsh::decode Wrong CRC" << std::endl;
+    return CByteSpan();
+  }
+
+  uint8_t l_control = in_buf[0];
+  CByteSpan lo_msg;
+
+  if( (l_control & 0x80) == 0 )
+  {
+    // DATA;
+    // update ack number, use incoming frm number
+    ackNum = ((l_control>>4&0x07) + 1) & 0x07;
+    if( rxUnackedCount < 0xFF )
+    {
+      rxUnackedCount++;
+    }
+
+    // the DATA frame also acknowledges the frames we sent
+    releaseAckedFrames(l_control & 0x07);
+
+    // the EZSP frame (followed by the CRC) starts after the control byte
+    uint8_t *l_ezsp = &in_buf[1];
+    size_t l_ezsp_len = l_len - 1;
+    dataRandomise(l_ezsp, l_ezsp_len);
+
+    if( (l_ezsp_len > 2) && (0xFF == l_ezsp[2]) )
+    {
+      // WARNING for all frames except "VersionRequest" frame, remove extended header
+      // move sequence number and frame control over the 2 extended header bytes
+      l_ezsp[3] = l_ezsp[1];
+      l_ezsp[2] = l_ezsp[0];
+      l_ezsp += 2;
+      l_ezsp_len -= 2;
+    }
+    lo_msg = CByteSpan(l_ezsp, l_ezsp_len);
+  }
+  else if( (l_control & 0x60) == 0x00 )
+  {
+    // ACK;
+    if( !releaseAckedFrames(l_control & 0x07) )
+    {
+      timer->stop();
+    }
+
+    if( nullptr != pCb ) { pCb->ashCbInfo(ASH_ACK); }
+  }
+  else if( (l_control & 0x60) == 0x20 )
+  {
+    // NAK;
+    releaseAckedFrames(l_control & 0x07);
+
+    clogD << "CAsh::decode NACK" << std::endl;
+
+    // rewind to the frame rejected by the NCP and send it again, followed by the frames sent after it
+    if( 0 != getOutstandingFrameCount() )
+    {
+      timer->stop();
+      retransmitFrames();
+      startAckTimer();
+    }
+
+    timer->stop();
+
+    if( nullptr != pCb ) { pCb->ashCbInfo(ASH_NACK); }
+  }
+  else if( 0xC0 == l_control )
+  {
+    // RST;
+    clogD << "CAsh::decode RST" << std::endl;
+  }
+  else if( 0xC1 == l_control )
+  {
+    // RSTACK;
+    clogD << "CAsh::decode RSTACK" << std::endl;
+
+    if( !stateConnected )
+    {
+      /** \todo : add some test to verify it is a software reset and ash protocol version is 2 */
+      timer->stop();
+      stateConnected = true;
+      if( nullptr != pCb ){ pCb->ashCbInfo(ASH_STATE_CHANGE); }
+    }
+  }
+  else if( 0xC2 == l_control )
+  {
+    // ERROR;
+    clogD << "CAsh::decode ERROR" << std::endl;
+  }
+  else
+  {
+    clogD << "CAsh::decode UNKNOWN" << std::endl;
   }
 
   return lo_msg;
@@ -313,83 +497,124 @@ std::vector<uint8_t> CAsh::decode(std::vector<uint8_t> &i_data)
  * PRIVATE FUNCTION
  */
 
-uint16_t CAsh::computeCRC( vector<uint8_t> i_msg )
+bool CAsh::releaseAckedFrames(uint8_t i_ack_num)
 {
-  uint16_t lo_crc = 0xFFFF; // initial value
-  uint16_t polynomial = 0x1021; // 0001 0000 0010 0001 (0, 5, 12)
-
-  for (std::size_t cnt = 0; cnt < i_msg.size(); cnt++) {
-      for (auto i = 0; i < 8; i++) {
-          bool bit = ((i_msg.at(cnt) >> (7 - i) & 1) == 1);
-          bool c15 = ((lo_crc >> 15 & 1) == 1);
-          lo_crc = static_cast<uint16_t>(lo_crc << 1U);
-          if (c15 ^ bit) {
-              lo_crc ^= polynomial;
-          }
-      }
-  }
+  // ignore acknowledge numbers that are outside of the frames currently outstanding
+  uint8_t l_acked = static_cast<uint8_t>((i_ack_num - unackedFrmNum) & 0x07);
+  if( (l_acked > 0) && (l_acked <= getOutstandingFrameCount()) )
+  {
+    // measure the round trip time on the last frame acknowledged, unless it has been retransmitted (we cannot tell which copy is acknowledged)
+    uint8_t l_last = (i_ack_num - 1) & 0x07;
+    if( (0 != txFramesLen[l_last]) && !txFramesReTx[l_last] )
+    {
+      auto l_rtt = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - txFramesTime[l_last]).count();
+      // t_rx_ack = 7/8 * t_rx_ack + 1/2 * measured, as specified by ASH
+      long l_timeout = (7*static_cast<long>(ackTimeout))/8 + l_rtt/2;
+      ackTimeout = static_cast<uint16_t>(std::max(static_cast<long>(T_RX_ACK_MIN), std::min(l_timeout, static_cast<long>(T_RX_ACK_MAX))));
+    }
+    timeoutCount = 0;
 
-  lo_crc &= 0xffff;
+    while( unackedFrmNum != i_ack_num )
+    {
+      txFramesLen[unackedFrmNum] = 0;
+      unackedFrmNum = (unackedFrmNum + 1) & 0x07;
+    }
 
-  return lo_crc;
+    timer->stop();
+    if( 0 != getOutstandingFrameCount() )
+    {
+      // restart the timer for the frames still waiting to be acknowledged
+      startAckTimer();
+    }
+  }
+  return (0 != getOutstandingFrameCount());
 }
 
-vector<uint8_t> CAsh::stuffedOutputData(vector<uint8_t> i_msg)
+void CAsh::retransmitFrames(void)
 {
-  vector<uint8_t> lo_msg;
-
-  for (std::size_t cnt = 0; cnt < i_msg.size(); cnt++) {
-      switch (i_msg.at(cnt)) {
-          case 0x7E:
-              lo_msg.push_back( 0x7D );
-              lo_msg.push_back( 0x5E );
-              break;
-          case 0x7D:
-              lo_msg.push_back( 0x7D );
-              lo_msg.push_back( 0x5D );
-              break;
-          case 0x11:
-              lo_msg.push_back( 0x7D );
-              lo_msg.push_back( 0x31 );
-              break;
-          case 0x13:
-              lo_msg.push_back( 0x7D );
-              lo_msg.push_back( 0x33 );
-              break;
-          case 0x18:
-              lo_msg.push_back( 0x7D );
-              lo_msg.push_back( 0x38 );
-              break;
-          case 0x1A:
-              lo_msg.push_back( 0x7D );
-              lo_msg.push_back( 0x3A );
-              break;
-          default:
-              lo_msg.push_back( i_msg.at(cnt) );
-              break;
-      }
+  for( uint8_t l_frm = unackedFrmNum; l_frm != frmNum; l_frm = (l_frm + 1) & 0x07 )
+  {
+    if( 0 != txFramesLen[l_frm] )
+    {
+      txFramesReTx[l_frm] = true;
+      uint8_t l_frame[ASH_MAX_FRAME_SIZE];
+      size_t l_len = encodeDataFrame(static_cast<uint8_t>((l_frm << 4) | ASH_RETX_FLAG | ackNum), txFrames[l_frm], txFramesLen[l_frm], l_frame);
+      if( nullptr != pCb ) { pCb->ashCbRetransmit(std::vector<uint8_t>(l_frame, l_frame + l_len)); }
+    }
   }
-  lo_msg.push_back( 0x7E );
+}
 
+void CAsh::startAckTimer(void)
+{
+  timer->start( ackTimeout, [&](ITimer *ipTimer){this->Timeout();} );
+}
 
-  return lo_msg;
+size_t CAsh::encodeDataFrame(uint8_t i_control, const uint8_t* i_ezsp, size_t i_len, uint8_t* o_frame)
+{
+  uint8_t l_raw[ASH_MAX_LENGTH];
+
+  // the ackNum field of this DATA frame acknowledges all DATA frames received so far
+  ackSavedCount += rxUnackedCount;
+  rxUnackedCount = 0;
+
+  // randomise (i_len is at most ASH_MAX_DATA_LENGTH) and compute the CRC on the stack, then stuff in bulk
+  l_raw[0] = i_control;
+  std::copy(i_ezsp, i_ezsp + i_len, l_raw + 1);
+  dataRandomise(l_raw + 1, i_len);
+
+  uint16_t crc = computeCRC(l_raw, i_len + 1);
+  l_raw[i_len+1] = static_cast<uint8_t>(crc>>8);
+  l_raw[i_len+2] = static_cast<uint8_t>(crc&0xFF);
+
+  size_t lo_len = CAshStuffing::stuff(l_raw, i_len + 3, o_frame);
+  o_frame[lo_len++] = ASH_FLAG_BYTE;
+
+  return lo_len;
 }
 
-vector<uint8_t> CAsh::dataRandomise(vector<uint8_t> i_data, uint8_t start)
+uint16_t CAsh::computeCRC( const uint8_t* i_msg, size_t i_len )
 {
-    vector<uint8_t> lo_data;
+  return CCrcCcitt::compute(i_msg, i_len);
+}
 
-    // Randomise the data
-    uint8_t rand = 0x42;
-    for (uint8_t cnt = start; cnt < i_data.size(); cnt++) {
-        lo_data.push_back(i_data.at(cnt) ^ rand);
+CFrameBuffer CAsh::stuffedOutputData(const uint8_t* i_msg, size_t i_len)
+{
+  CFrameBuffer lo_msg;
 
-        if ((rand & 0x01) == 0) {
-            rand = static_cast<uint8_t>(rand >> 1);
-        } else {
-            rand = static_cast<uint8_t>((rand >> 1) ^ 0xb8);
-        }
+  // only used for the 3 bytes RST and ACK frames, whose stuffed form easily fits
+  lo_msg.resize(2*i_len+1);
+  size_t l_len = CAshStuffing::stuff(i_msg, i_len, lo_msg.data());
+  lo_msg[l_len++] = ASH_FLAG_BYTE;
+  lo_msg.resize(l_len);
+
+  return lo_msg;
+}
+
+void CAsh::dataRandomise(uint8_t* io_data, size_t i_len)
+{
+    const uint8_t *l_rand = lfsrTable().seq;
+    size_t l_len = std::min(i_len, static_cast<size_t>(ASH_LFSR_TABLE_SIZE));
+    size_t cnt = 0;
+
+#if defined(__SSE2__)
+    for (; cnt + 16 <= l_len; cnt += 16) {
+        __m128i l_data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(io_data + cnt));
+        __m128i l_seq = _mm_load_si128(reinterpret_cast<const __m128i*>(l_rand + cnt));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(io_data + cnt), _mm_xor_si128(l_data, l_seq));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; cnt + 16 <= l_len; cnt += 16) {
+        vst1q_u8(io_data + cnt, veorq_u8(vld1q_u8(io_data + cnt), vld1q_u8(l_rand + cnt)));
+    }
+#endif
+    for (; cnt < l_len; cnt++) {
+        io_data[cnt] ^= l_rand[cnt];
     }
 
-    return lo_data;
+    // longer than any valid frame, carry on generating the sequence
+    uint8_t rand = SAshLfsrTable::nextLfsr(l_rand[ASH_LFSR_TABLE_SIZE-1]);
+    for (; cnt < i_len; cnt++) {
+        io_data[cnt] ^= rand;
+        rand = SAshLfsrTable::nextLfsr(rand);
+    }
 }
@@ -3,8 +3,36 @@
 #include <cstdint>
 #include <vector>
 #include <memory>	// For std::unique_ptr
+#include <chrono>
 
 #include "../spi/ITimerFactory.h"
+#include "byte-span.h"
+#include "frame-buffer.h"
+
+/**
+ * Maximum length of an ASH frame (control byte, up to 128 data bytes and 2 CRC bytes), before byte stuffing
+ */
+#define ASH_MAX_LENGTH 131
+
+/**
+ * Maximum length of the data field of an ASH DATA frame
+ */
+#define ASH_MAX_DATA_LENGTH 128
+
+/**
+ * Maximum size of an encoded ASH frame (all bytes stuffed, followed by the flag byte)
+ */
+#define ASH_MAX_FRAME_SIZE (2*ASH_MAX_LENGTH+1)
+
+/**
+ * Maximum number of DATA frames that can be sent without being acknowledged (frame numbers are 3-bit)
+ */
+#define ASH_MAX_TX_WINDOW 7
+
+/**
+ * Number of consecutive ACK timeouts after which the connection to the NCP is considered lost
+ */
+#define ASH_MAX_TIMEOUTS 4
 
 
 typedef enum {
@@ -19,6 +47,13 @@ class CAshCallback
 public:
     virtual ~CAshCallback() { }
     virtual void ashCbInfo( EAshInfo info ) = 0;
+
+    /**
+     * @brief Invoked when ASH needs to send a frame on its own (retransmission of unacknowledged DATA frames)
+     *
+     * @param i_frame The encoded frame, ready to be written to the UART
+     */
+    virtual void ashCbRetransmit( const std::vector<uint8_t>& i_frame ) = 0;
 };
 
 class CAsh
@@ -35,30 +70,133 @@ public:
 
     CAsh& operator=(CAsh) = delete; /* No assignment allowed */
 
-    std::vector<uint8_t> resetNCPFrame(void);
+    CFrameBuffer resetNCPFrame(void);
 
-    std::vector<uint8_t> AckFrame(void);
+    CFrameBuffer AckFrame(void);
 
     std::vector<uint8_t> DataFrame(std::vector<uint8_t> i_data);
 
+    /**
+     * @brief Encode an EZSP command into an ASH DATA frame, without any heap allocation
+     *
+     * The EZSP header is written once into the retransmit buffer, randomisation and CRC are computed on the stack, and byte stuffing copies clean runs in bulk into o_frame
+     *
+     * @param i_data A pointer to the EZSP command (command id followed by its parameters)
+     * @param i_len The length of the EZSP command
+     * @param[out] o_frame The buffer receiving the encoded frame
+     * @param i_frame_size The size of o_frame, ASH_MAX_FRAME_SIZE is always large enough
+     *
+     * @return The length of the encoded frame written to o_frame, or 0 if the command could not be encoded
+     */
+    size_t DataFrame(const uint8_t* i_data, size_t i_len, uint8_t* o_frame, size_t i_frame_size);
+
+    /**
+     * @brief Decode incoming bytes, stopping after the first decoded DATA frame
+     *
+     * @param i_data The incoming bytes, consumed bytes are removed from the vector
+     *
+     * @return The EZSP frame decoded, or an empty vector if no DATA frame was completed
+     */
     std::vector<uint8_t> decode(std::vector<uint8_t> &i_data);
 
+    /**
+     * @brief Decode incoming bytes in place, stopping after the first decoded DATA frame
+     *
+     * Bytes are copied into a fixed internal buffer, un-stuffed and de-randomised there, no heap allocation is performed
+     *
+     * @param i_data A pointer to the incoming bytes
+     * @param i_len The number of incoming bytes
+     * @param[out] o_used The number of bytes from i_data that have been consumed
+     *
+     * @return A view on the EZSP frame decoded (empty if no DATA frame was completed), only valid until the next call to decode()
+     */
+    CByteSpan decode(const uint8_t* i_data, size_t i_len, size_t& o_used);
+
     bool isConnected(void){ return stateConnected; }
 
+    /**
+     * @brief Get the EZSP sequence number that the next DATA frame will carry
+     */
+    uint8_t getNextSeqNum(void) const { return seq_num; }
+
+    /**
+     * @brief Set the maximum number of DATA frames that can be outstanding (sent but not yet acknowledged)
+     *
+     * @param i_window The window size, between 1 (stop-and-wait) and ASH_MAX_TX_WINDOW
+     */
+    void setTxWindow(uint8_t i_window);
+
+    /**
+     * @brief Get the maximum number of DATA frames that can be outstanding
+     */
+    uint8_t getTxWindow(void) const { return txWindow; }
+
+    /**
+     * @brief Get the number of DATA frames sent but not yet acknowledged by the NCP
+     */
+    uint8_t getOutstandingFrameCount(void) const;
+
+    /**
+     * @brief Can another DATA frame be sent without waiting for an acknowledge?
+     */
+    bool isTxWindowFull(void) const { return getOutstandingFrameCount() >= txWindow; }
+
+    /**
+     * @brief Get the current ACK timeout (in ms), adapted to the measured round trip time and clamped between T_RX_ACK_MIN and T_RX_ACK_MAX
+     */
+    uint16_t getAckTimeout(void) const { return ackTimeout; }
+
+    /**
+     * @brief Number of DATA frames received from the NCP and not yet acknowledged (neither by an ACK frame nor by the ackNum of an outgoing DATA frame)
+     */
+    uint8_t getRxUnackedCount(void) const { return rxUnackedCount; }
+
+    /**
+     * @brief Number of standalone ACK frames built
+     */
+    uint32_t getAckSentCount(void) const { return ackSentCount; }
+
+    /**
+     * @brief Number of ACK frames that did not need to be sent, because the acknowledge was piggybacked in a DATA frame or coalesced into a single ACK frame
+     */
+    uint32_t getAckSavedCount(void) const { return ackSavedCount; }
+
     static std::string EAshInfoToString( EAshInfo in );
 
 private:
     uint8_t ackNum;
     uint8_t frmNum;
+    uint8_t unackedFrmNum;  /*!< Frame number of the oldest frame not yet acknowledged (equals frmNum if none) */
+    uint8_t txWindow;   /*!< Maximum number of outstanding DATA frames */
+    uint8_t txFrames[8][ASH_MAX_DATA_LENGTH];   /*!< Retransmit buffer: EZSP frames sent and not yet acknowledged, indexed by frame number */
+    size_t txFramesLen[8];  /*!< Length of each frame in txFrames, 0 if the slot is unused */
+    std::chrono::steady_clock::time_point txFramesTime[8];  /*!< When each frame in txFrames was first sent */
+    bool txFramesReTx[8];   /*!< Has each frame in txFrames been retransmitted (if so, its ACK cannot be used to measure the round trip time) */
+    uint16_t ackTimeout;    /*!< Current ACK timeout (in ms) */
+    uint8_t timeoutCount;   /*!< Number of consecutive ACK timeouts */
+    uint8_t rxUnackedCount; /*!< Number of received DATA frames not yet acknowledged */
+    uint32_t ackSentCount;  /*!< Number of standalone ACK frames built */
+    uint32_t ackSavedCount; /*!< Number of ACK frames saved by piggybacking or coalescing */
     uint8_t seq_num;
     bool stateConnected;
     std::unique_ptr<ITimer> timer;
     CAshCallback *pCb;
 
-    std::vector<uint8_t> in_msg;
+    uint8_t in_buf[2*ASH_MAX_LENGTH];  /*!< Bytes of the frame being received, worst case being all bytes stuffed */
+    size_t in_len;  /*!< Number of bytes currently in in_buf */
+    bool in_error;  /*!< Is the frame being received to be discarded */
+
+    CByteSpan decodeFrame(void);
 
-    uint16_t computeCRC( std::vector<uint8_t> i_msg );
-    std::vector<uint8_t> stuffedOutputData(std::vector<uint8_t> i_msg);
-    std::vector<uint8_t> dataRandomise(std::vector<uint8_t> i_data, uint8_t start);
+    uint16_t computeCRC( const uint8_t* i_msg, size_t i_len );
+    bool releaseAckedFrames(uint8_t i_ack_num);
+    size_t encodeDataFrame(uint8_t i_control, const uint8_t* i_ezsp, size_t i_len, uint8_t* o_frame);
+    void retransmitFrames(void);
+    void startAckTimer(void);
+    CFrameBuffer stuffedOutputData(const uint8_t* i_msg, size_t i_len);
+    /**
+     * @brief Randomise (or de-randomise) the data field of a DATA frame in place
+     */
+    void dataRandomise(uint8_t* io_data, size_t i_len);
     void Timeout(void);
 };
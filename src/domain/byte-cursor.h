@@ -0,0 +1,297 @@
+/**
+ * @file byte-cursor.h
+ *
+ * @brief Bounds-checked sequential little endian reading and writing of bytes
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>	// For size_t
+#include <algorithm>
+
+#include "byte-manip.h"
+#include "byte-span.h"
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief Cursor decoding little endian fields one after the other from a view on bytes
+ *
+ * Reading past the end never throws nor reads out of bounds: the missing bytes read as 0, and the reader is marked as overflowed (see isValid()), so that a parser can read all of its fields and check once at the end.
+ * Byte strings are returned as views on the bytes being read, no byte is copied.
+ *
+ * @code
+ * CByteReader l_reader(i_msg_receive);
+ * uint8_t l_status = l_reader.readU8();
+ * uint16_t l_options = l_reader.readU16();
+ * CByteSpan l_key = l_reader.readBytes(EMBER_KEY_DATA_BYTE_SIZE);
+ * if( !l_reader.isValid() ) { ... }
+ * @endcode
+ */
+class CByteReader
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param i_data The bytes to read (they must outlive this reader and the views it returns)
+     */
+    explicit CByteReader(const CByteSpan& i_data) : m_data(i_data), m_pos(0), m_overflow(false) {}
+
+    /**
+     * @brief Read one byte
+     */
+    uint8_t readU8()
+    {
+        if( !this->has(1) )
+        {
+            return 0;
+        }
+        return m_data[m_pos++];
+    }
+
+    /**
+     * @brief Read a 16-bit little endian value
+     */
+    uint16_t readU16()
+    {
+        if( !this->has(2) )
+        {
+            return 0;
+        }
+        uint16_t l_value = dble_u8_to_u16(m_data[m_pos + 1], m_data[m_pos]);
+        m_pos += 2;
+        return l_value;
+    }
+
+    /**
+     * @brief Read a 32-bit little endian value
+     */
+    uint32_t readU32()
+    {
+        if( !this->has(4) )
+        {
+            return 0;
+        }
+        uint32_t l_value = quad_u8_to_u32(m_data[m_pos + 3], m_data[m_pos + 2], m_data[m_pos + 1], m_data[m_pos]);
+        m_pos += 4;
+        return l_value;
+    }
+
+    /**
+     * @brief Read a 64-bit little endian value
+     */
+    uint64_t readU64()
+    {
+        uint64_t l_low = this->readU32();
+        uint64_t l_high = this->readU32();
+        return l_low | (l_high << 32);
+    }
+
+    /**
+     * @brief Read a byte string
+     *
+     * @param i_count The number of bytes to read
+     *
+     * @return A view on the bytes read, empty if less than i_count bytes are left
+     */
+    CByteSpan readBytes(size_t i_count)
+    {
+        if( !this->has(i_count) )
+        {
+            return CByteSpan();
+        }
+        CByteSpan l_bytes = m_data.subspan(m_pos, i_count);
+        m_pos += i_count;
+        return l_bytes;
+    }
+
+    /**
+     * @brief Read all the bytes left
+     *
+     * @return A view on the bytes read
+     */
+    CByteSpan readRemaining()
+    {
+        return this->readBytes(this->getRemainingSize());
+    }
+
+    /**
+     * @brief Skip bytes
+     *
+     * @param i_count The number of bytes to skip
+     */
+    void skip(size_t i_count)
+    {
+        if( this->has(i_count) )
+        {
+            m_pos += i_count;
+        }
+    }
+
+    /**
+     * @brief Get the number of bytes read so far
+     */
+    size_t getPosition() const { return m_pos; }
+
+    /**
+     * @brief Get the number of bytes left to read
+     */
+    size_t getRemainingSize() const { return m_data.size() - m_pos; }
+
+    /**
+     * @brief Have all the reads so far been within bounds
+     *
+     * @return false if any read went past the end of the bytes
+     */
+    bool isValid() const { return !m_overflow; }
+
+private:
+    /**
+     * @brief Check that enough bytes are left, and mark the reader as overflowed (having consumed all the bytes) if not
+     */
+    bool has(size_t i_count)
+    {
+        if( i_count > m_data.size() - m_pos )
+        {
+            m_pos = m_data.size();
+            m_overflow = true;
+            return false;
+        }
+        return true;
+    }
+
+    CByteSpan m_data;   /*!< The bytes to read */
+    size_t m_pos;   /*!< The offset of the next byte to read */
+    bool m_overflow;    /*!< Has a read gone past the end of the bytes */
+};
+
+/**
+ * @brief Cursor encoding little endian fields one after the other into a caller-provided buffer
+ *
+ * Writing past the end of the buffer never writes out of bounds: the bytes that do not fit are dropped, and the writer is marked as overflowed (see isValid()).
+ *
+ * @code
+ * uint8_t l_buf[EMBER_KEY_DATA_BYTE_SIZE + 4];
+ * CByteWriter l_writer(l_buf, sizeof(l_buf));
+ * l_writer.writeBytes(l_key);
+ * l_writer.writeU32(l_frame_counter);
+ * @endcode
+ */
+class CByteWriter
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param o_buf The buffer to write to
+     * @param i_size The size of o_buf
+     */
+    CByteWriter(uint8_t* o_buf, size_t i_size) : m_buf(o_buf), m_size(i_size), m_pos(0), m_overflow(false) {}
+
+    CByteWriter(const CByteWriter& other) = delete; /* No copy (pointer data members) */
+    CByteWriter& operator=(const CByteWriter& other) = delete; /* No assignment (pointer data members) */
+
+    /**
+     * @brief Write one byte
+     */
+    void writeU8(uint8_t i_value)
+    {
+        if( this->has(1) )
+        {
+            m_buf[m_pos++] = i_value;
+        }
+    }
+
+    /**
+     * @brief Write a 16-bit little endian value
+     */
+    void writeU16(uint16_t i_value)
+    {
+        if( this->has(2) )
+        {
+            m_buf[m_pos++] = u16_get_lo_u8(i_value);
+            m_buf[m_pos++] = u16_get_hi_u8(i_value);
+        }
+    }
+
+    /**
+     * @brief Write a 32-bit little endian value
+     */
+    void writeU32(uint32_t i_value)
+    {
+        if( this->has(4) )
+        {
+            this->writeU16(static_cast<uint16_t>(i_value & 0xFFFF));
+            this->writeU16(static_cast<uint16_t>(i_value >> 16));
+        }
+    }
+
+    /**
+     * @brief Write a 64-bit little endian value
+     */
+    void writeU64(uint64_t i_value)
+    {
+        if( this->has(8) )
+        {
+            this->writeU32(static_cast<uint32_t>(i_value & 0xFFFFFFFFU));
+            this->writeU32(static_cast<uint32_t>(i_value >> 32));
+        }
+    }
+
+    /**
+     * @brief Write a byte string
+     */
+    void writeBytes(const CByteSpan& i_bytes)
+    {
+        if( this->has(i_bytes.size()) )
+        {
+            std::copy(i_bytes.begin(), i_bytes.end(), m_buf + m_pos);
+            m_pos += i_bytes.size();
+        }
+    }
+
+    /**
+     * @brief Get the number of bytes written so far
+     */
+    size_t getSize() const { return m_pos; }
+
+    /**
+     * @brief Get a view on the bytes written so far
+     */
+    CByteSpan getWritten() const { return CByteSpan(m_buf, m_pos); }
+
+    /**
+     * @brief Have all the writes so far fitted in the buffer
+     *
+     * @return false if any write has been dropped
+     */
+    bool isValid() const { return !m_overflow; }
+
+private:
+    /**
+     * @brief Check that enough room is left, and mark the writer as overflowed if not
+     */
+    bool has(size_t i_count)
+    {
+        if( i_count > m_size - m_pos )
+        {
+            m_overflow = true;
+            return false;
+        }
+        return true;
+    }
+
+    uint8_t* m_buf; /*!< The buffer to write to */
+    size_t m_size;  /*!< The size of the buffer */
+    size_t m_pos;   /*!< The offset of the next byte to write */
+    bool m_overflow;    /*!< Has a write been dropped */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
@@ -0,0 +1,84 @@
+/**
+ * @file byte-span.h
+ *
+ * @brief Non-owning read-only view on a contiguous sequence of bytes
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>	// For size_t
+#include <vector>
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief Read-only view on bytes owned by somebody else
+ *
+ * A CByteSpan never allocates nor copies the bytes it refers to, thus the owner of the bytes must keep them alive (and unmodified) for as long as the view is used
+ */
+class CByteSpan
+{
+public:
+    /**
+     * @brief Default constructor, builds an empty view
+     */
+    CByteSpan() : m_data(nullptr), m_size(0) {}
+
+    /**
+     * @brief Constructor from a pointer and a length
+     *
+     * @param i_data A pointer to the first byte
+     * @param i_size The number of bytes in the view
+     */
+    CByteSpan(const uint8_t* i_data, size_t i_size) : m_data(i_data), m_size(i_size) {}
+
+    /**
+     * @brief Constructor viewing the whole content of a vector
+     *
+     * @param i_vector The vector to view (it must outlive this view)
+     */
+    CByteSpan(const std::vector<uint8_t>& i_vector) : m_data(i_vector.data()), m_size(i_vector.size()) {}
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return 0 == m_size; }
+
+    const uint8_t* begin() const { return m_data; }
+    const uint8_t* end() const { return m_data + m_size; }
+
+    /**
+     * @brief Unchecked access to a byte of the view
+     */
+    uint8_t operator[](size_t i_index) const { return m_data[i_index]; }
+
+    /**
+     * @brief Get a sub-view
+     *
+     * @param i_offset The offset of the first byte of the sub-view (clamped to the size of this view)
+     * @param i_count The maximum number of bytes in the sub-view
+     *
+     * @return The sub-view
+     */
+    CByteSpan subspan(size_t i_offset, size_t i_count = static_cast<size_t>(-1)) const {
+        if( i_offset > m_size ) { i_offset = m_size; }
+        if( i_count > m_size - i_offset ) { i_count = m_size - i_offset; }
+        return CByteSpan(m_data + i_offset, i_count);
+    }
+
+    /**
+     * @brief Copy the viewed bytes into a new vector
+     */
+    std::vector<uint8_t> toVector() const { return std::vector<uint8_t>(begin(), end()); }
+
+private:
+    const uint8_t* m_data;  /*!< The first byte of the view */
+    size_t m_size;  /*!< The number of bytes in the view */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
@@ -0,0 +1,100 @@
+/**
+ * @file crc-ccitt.cpp
+ *
+ * @brief CRC-CCITT (polynomial 0x1021, MSB first) as used by the ASH framing layer
+ */
+
+#include "crc-ccitt.h"
+
+constexpr uint16_t CCrcCcitt::INITIAL_VALUE;
+constexpr uint16_t CCrcCcitt::POLYNOMIAL;
+
+namespace {
+
+/**
+ * @brief Slice-by-8 lookup tables
+ *
+ * table[0] is the classic byte table (effect of one byte on a zero CRC register)
+ * table[k] is the effect of one byte followed by k zero bytes
+ */
+struct SCrcCcittTables {
+    uint16_t table[8][256];
+
+    SCrcCcittTables() : table() {
+        for (unsigned int i = 0; i < 256; i++) {
+            table[0][i] = CCrcCcitt::constUpdate(0, static_cast<uint8_t>(i));
+        }
+        for (unsigned int i = 0; i < 256; i++) {
+            for (unsigned int k = 1; k < 8; k++) {
+                uint16_t prev = table[k-1][i];
+                table[k][i] = static_cast<uint16_t>((prev << 8) ^ table[0][prev >> 8]);
+            }
+        }
+    }
+};
+
+const SCrcCcittTables& crcTables() {
+    static const SCrcCcittTables tables;
+    return tables;
+}
+
+inline uint16_t byteTableStep(const uint16_t (&t0)[256], uint16_t crc, uint8_t byte) {
+    return static_cast<uint16_t>((crc << 8) ^ t0[static_cast<uint8_t>((crc >> 8) ^ byte)]);
+}
+
+} // namespace
+
+void CCrcCcitt::update(uint8_t i_byte)
+{
+    crc = byteTableStep(crcTables().table[0], crc, i_byte);
+}
+
+uint16_t CCrcCcitt::computeBitwise(const uint8_t* i_data, size_t i_len, uint16_t i_crc)
+{
+    for (size_t cnt = 0; cnt < i_len; cnt++) {
+        for (unsigned int i = 0; i < 8; i++) {
+            bool bit = ((i_data[cnt] >> (7 - i)) & 1) == 1;
+            bool c15 = ((i_crc >> 15) & 1) == 1;
+            i_crc = static_cast<uint16_t>(i_crc << 1U);
+            if (c15 ^ bit) {
+                i_crc ^= POLYNOMIAL;
+            }
+        }
+    }
+    return i_crc;
+}
+
+uint16_t CCrcCcitt::computeByteTable(const uint8_t* i_data, size_t i_len, uint16_t i_crc)
+{
+    const uint16_t (&t0)[256] = crcTables().table[0];
+
+    for (size_t cnt = 0; cnt < i_len; cnt++) {
+        i_crc = byteTableStep(t0, i_crc, i_data[cnt]);
+    }
+    return i_crc;
+}
+
+uint16_t CCrcCcitt::computeSliceBy8(const uint8_t* i_data, size_t i_len, uint16_t i_crc)
+{
+    const SCrcCcittTables& tables = crcTables();
+    const uint16_t (*t)[256] = tables.table;
+
+    while (i_len >= 8) {
+        /* The 2 CRC register bytes are combined with the first 2 input bytes, each byte then only depends on how many bytes follow it in the block */
+        i_crc = static_cast<uint16_t>(
+                    t[7][static_cast<uint8_t>((i_crc >> 8) ^ i_data[0])] ^
+                    t[6][static_cast<uint8_t>((i_crc & 0xFF) ^ i_data[1])] ^
+                    t[5][i_data[2]] ^
+                    t[4][i_data[3]] ^
+                    t[3][i_data[4]] ^
+                    t[2][i_data[5]] ^
+                    t[1][i_data[6]] ^
+                    t[0][i_data[7]] );
+        i_data += 8;
+        i_len -= 8;
+    }
+    while (i_len-- > 0) {
+        i_crc = byteTableStep(t[0], i_crc, *i_data++);
+    }
+    return i_crc;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file crc-ccitt.h
+ *
+ * @brief CRC-CCITT (polynomial 0x1021, MSB first) as used by the ASH framing layer
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>	// For size_t
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief Incremental CRC-CCITT engine
+ *
+ * Bytes can be fed one at a time (while they stream in from the UART) or as whole pointer+length ranges.
+ * Single bytes are processed using a 256-entry lookup table, ranges are processed using slice-by-8 tables.
+ *
+ * The value of a CRC computed over a buffer that already ends with its own CRC (big endian) is 0
+ */
+class CCrcCcitt
+{
+public:
+    static constexpr uint16_t INITIAL_VALUE = 0xFFFF; /*!< CRC register value at the start of an ASH frame */
+    static constexpr uint16_t POLYNOMIAL = 0x1021;  /*!< x^16 + x^12 + x^5 + 1 */
+
+    /**
+     * @brief Constructor
+     *
+     * @param i_initial The initial value of the CRC register
+     */
+    explicit CCrcCcitt(uint16_t i_initial = INITIAL_VALUE) : crc(i_initial) {}
+
+    /**
+     * @brief Restart a new CRC computation
+     *
+     * @param i_initial The initial value of the CRC register
+     */
+    void reset(uint16_t i_initial = INITIAL_VALUE) { crc = i_initial; }
+
+    /**
+     * @brief Feed one byte into the CRC
+     *
+     * @param i_byte The byte to add
+     */
+    void update(uint8_t i_byte);
+
+    /**
+     * @brief Feed a range of bytes into the CRC
+     *
+     * @param i_data A pointer to the first byte
+     * @param i_len The number of bytes to process
+     */
+    void update(const uint8_t* i_data, size_t i_len) { crc = computeSliceBy8(i_data, i_len, crc); }
+
+    /**
+     * @brief Get the current value of the CRC register
+     */
+    uint16_t value() const { return crc; }
+
+    /**
+     * @brief Compute the CRC over a byte range (fastest implementation available)
+     *
+     * @param i_data A pointer to the first byte
+     * @param i_len The number of bytes to process
+     * @param i_crc The initial value of the CRC register (allows chaining computations)
+     *
+     * @return The resulting CRC
+     */
+    static uint16_t compute(const uint8_t* i_data, size_t i_len, uint16_t i_crc = INITIAL_VALUE) { return computeSliceBy8(i_data, i_len, i_crc); }
+
+    /**
+     * @brief Reference bit-by-bit implementation
+     */
+    static uint16_t computeBitwise(const uint8_t* i_data, size_t i_len, uint16_t i_crc = INITIAL_VALUE);
+
+    /**
+     * @brief Byte-wise implementation using one 256-entry lookup table
+     */
+    static uint16_t computeByteTable(const uint8_t* i_data, size_t i_len, uint16_t i_crc = INITIAL_VALUE);
+
+    /**
+     * @brief Implementation processing 8 bytes per iteration using eight 256-entry lookup tables
+     */
+    static uint16_t computeSliceBy8(const uint8_t* i_data, size_t i_len, uint16_t i_crc = INITIAL_VALUE);
+
+    /**
+     * @brief Compile-time evaluable CRC update for one byte
+     *
+     * Allows frames with a fixed content (RST, ACK...) to get their CRC computed by the compiler
+     *
+     * @param i_crc The current value of the CRC register
+     * @param i_byte The byte to add
+     *
+     * @return The new value of the CRC register
+     */
+    static constexpr uint16_t constUpdate(uint16_t i_crc, uint8_t i_byte) {
+        return constShift(static_cast<uint16_t>(i_crc ^ static_cast<uint16_t>(i_byte << 8)), 8);
+    }
+
+private:
+    uint16_t crc;   /*!< The current value of the CRC register */
+
+    static constexpr uint16_t constShift(uint16_t i_crc, unsigned int i_bits) {
+        return (0 == i_bits) ? i_crc :
+            constShift( static_cast<uint16_t>((i_crc & 0x8000U) ? ((i_crc << 1) ^ POLYNOMIAL) : (i_crc << 1)), i_bits - 1 );
+    }
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
@@ -0,0 +1,80 @@
+/**
+ * @file enum-name-table.h
+ *
+ * @brief Constant-time lookup of the names of 8-bit enum values
+ */
+
+#pragma once
+
+#include <cstddef>	// For size_t
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief Table of names indexed by enum value
+ *
+ * The table is filled once from a list of (value, name) pairs, typically as a function-local static so that it is built at first use.
+ * Looking up a name is then a mere array access, without any allocation. Names are not copied, they must be string literals.
+ *
+ * @code
+ * static const CEnumNameTable::SEntry entries[] = { { EMBER_SUCCESS, "EMBER_SUCCESS" }, ... };
+ * static const CEnumNameTable names(entries);
+ * const char* name = names.find(status);	// nullptr if unknown
+ * @endcode
+ */
+class CEnumNameTable
+{
+public:
+    /**
+     * @brief Number of values the table can hold (values above are reported as unknown)
+     */
+    static const size_t SIZE = 256;
+
+    /**
+     * @brief A value and its name
+     */
+    struct SEntry
+    {
+        unsigned int value; /*!< The enum value */
+        const char* name;   /*!< The name of the value */
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param entries The (value, name) pairs. If a value is listed several times, the first name listed is used
+     */
+    template <size_t N>
+    explicit CEnumNameTable(const SEntry (&entries)[N]) : names()
+    {
+        for (size_t i = N; i > 0; i--)
+        {
+            if (entries[i - 1].value < SIZE)
+            {
+                names[entries[i - 1].value] = entries[i - 1].name;
+            }
+        }
+    }
+
+    /**
+     * @brief Get the name of a value
+     *
+     * @param value The value
+     *
+     * @return The name of @p value, or nullptr if it is unknown
+     */
+    const char* find(unsigned int value) const
+    {
+        return (value < SIZE) ? names[value] : nullptr;
+    }
+
+private:
+    const char* names[SIZE];    /*!< The name of each value, nullptr if unknown */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
@@ -0,0 +1,152 @@
+/**
+ * @file ezsp-cmd-scheduler.cpp
+ *
+ * @brief Scheduling of the EZSP commands waiting to be sent to the NCP
+ */
+
+#include "ezsp-cmd-scheduler.h"
+
+/**
+ * Number of slots of a command ring when it first gets used
+ */
+#define EZSP_CMD_RING_INITIAL_SIZE 8
+
+void CEzspCmdRing::push_back(SMsg&& i_msg)
+{
+    if( count == slots.size() )
+    {
+        // full, move the commands (oldest first) to a larger ring
+        std::vector<SMsg> l_slots((0 == slots.size()) ? EZSP_CMD_RING_INITIAL_SIZE : 2 * slots.size());
+        for( size_t l_idx = 0; l_idx < count; l_idx++ )
+        {
+            l_slots[l_idx] = std::move(slots[(head + l_idx) % slots.size()]);
+        }
+        slots.swap(l_slots);
+        head = 0;
+    }
+    slots[(head + count) % slots.size()] = std::move(i_msg);
+    count++;
+}
+
+void CEzspCmdRing::pop_front()
+{
+    // release the completion handler (and whatever it captured) now rather than when the slot gets reused
+    slots[head].rsp_handler = nullptr;
+    head = (head + 1) % slots.size();
+    count--;
+}
+
+CEzspCmdScheduler::CEzspCmdScheduler() :
+    queues(),
+    aging(),
+    metrics()
+{
+    aging[EZSP_PRIO_REALTIME] = 0;
+    aging[EZSP_PRIO_INTERACTIVE] = EZSP_DEFAULT_INTERACTIVE_AGING;
+    aging[EZSP_PRIO_BULK] = EZSP_DEFAULT_BULK_AGING;
+}
+
+void CEzspCmdScheduler::push(SMsg i_msg)
+{
+    if( i_msg.priority >= EZSP_PRIO_COUNT )
+    {
+        i_msg.priority = EZSP_PRIO_INTERACTIVE;
+    }
+    i_msg.queued = std::chrono::steady_clock::now();
+
+    CEzspCmdRing& l_queue = queues[i_msg.priority];
+    SEzspCmdQueueMetrics& l_metrics = metrics[i_msg.priority];
+    l_queue.push_back(std::move(i_msg));
+    l_metrics.queued++;
+    l_metrics.depth = l_queue.size();
+    if( l_metrics.depth > l_metrics.max_depth )
+    {
+        l_metrics.max_depth = l_metrics.depth;
+    }
+}
+
+SMsg CEzspCmdScheduler::pop()
+{
+    std::chrono::steady_clock::time_point l_now = std::chrono::steady_clock::now();
+    int l_selected = -1;
+    bool l_aged = false;
+
+    // the command that waited the longest beyond the aging threshold of its class goes first
+    for( int l_prio = 0; l_prio < EZSP_PRIO_COUNT; l_prio++ )
+    {
+        if( !queues[l_prio].empty() && (0 != aging[l_prio]) &&
+            (l_now - queues[l_prio].front().queued >= std::chrono::milliseconds(aging[l_prio])) &&
+            ((l_selected < 0) || (queues[l_prio].front().queued < queues[l_selected].front().queued)) )
+        {
+            l_selected = l_prio;
+        }
+    }
+
+    // otherwise, the most urgent class
+    for( int l_prio = 0; (l_selected < 0) && (l_prio < EZSP_PRIO_COUNT); l_prio++ )
+    {
+        if( !queues[l_prio].empty() )
+        {
+            l_selected = l_prio;
+        }
+    }
+    for( int l_prio = 0; l_prio < l_selected; l_prio++ )
+    {
+        if( !queues[l_prio].empty() )
+        {
+            // served before commands of a more urgent class
+            l_aged = true;
+        }
+    }
+
+    SMsg lo_msg = std::move(queues[l_selected].front());
+    queues[l_selected].pop_front();
+
+    SEzspCmdQueueMetrics& l_metrics = metrics[l_selected];
+    l_metrics.served++;
+    l_metrics.depth = queues[l_selected].size();
+    if( l_aged )
+    {
+        l_metrics.aged++;
+    }
+    uint32_t l_wait = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(l_now - lo_msg.queued).count());
+    if( l_wait > l_metrics.max_wait )
+    {
+        l_metrics.max_wait = l_wait;
+    }
+
+    return lo_msg;
+}
+
+bool CEzspCmdScheduler::empty() const
+{
+    return (0 == size());
+}
+
+size_t CEzspCmdScheduler::size() const
+{
+    size_t lo_size = 0;
+
+    for( int l_prio = 0; l_prio < EZSP_PRIO_COUNT; l_prio++ )
+    {
+        lo_size += queues[l_prio].size();
+    }
+    return lo_size;
+}
+
+void CEzspCmdScheduler::setAging(EEzspCmdPriority i_priority, uint16_t i_aging)
+{
+    if( i_priority < EZSP_PRIO_COUNT )
+    {
+        aging[i_priority] = i_aging;
+    }
+}
+
+SEzspCmdQueueMetrics CEzspCmdScheduler::getMetrics(EEzspCmdPriority i_priority) const
+{
+    if( i_priority < EZSP_PRIO_COUNT )
+    {
+        return metrics[i_priority];
+    }
+    return SEzspCmdQueueMetrics();
+}
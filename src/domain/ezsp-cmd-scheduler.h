@@ -0,0 +1,176 @@
+/**
+ * @file ezsp-cmd-scheduler.h
+ *
+ * @brief Scheduling of the EZSP commands waiting to be sent to the NCP
+ */
+
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <functional>
+
+#include "ezsp-protocol/ezsp-enum.h"
+#include "byte-span.h"
+#include "frame-buffer.h"
+
+/**
+ * Default time (in ms) after which an interactive command waiting to be sent is served before realtime commands
+ */
+#define EZSP_DEFAULT_INTERACTIVE_AGING 500
+
+/**
+ * Default time (in ms) after which a bulk command waiting to be sent is served before realtime and interactive commands
+ */
+#define EZSP_DEFAULT_BULK_AGING 2000
+
+/**
+ * @brief Outcome of a command sent with a completion handler
+ */
+typedef enum {
+  EZSP_RSP_SUCCESS, /*!< The response has been received */
+  EZSP_RSP_TIMEOUT, /*!< No response received in time */
+  EZSP_RSP_ABORTED  /*!< The connection to the NCP has been lost before the response was received */
+}EEzspRspStatus;
+
+/**
+ * @brief Completion handler of a command
+ *
+ * @param i_status The outcome of the command
+ * @param i_cmd The EZSP command
+ * @param i_response A read-only view on the parameters of the response (empty unless i_status is EZSP_RSP_SUCCESS), only valid during the invocation
+ */
+typedef std::function<void (EEzspRspStatus i_status, EEzspCmd i_cmd, CByteSpan i_response)> FEzspRspHandler;
+
+/**
+ * @brief Priority classes of EZSP commands, the first one being the most urgent
+ */
+typedef enum {
+  EZSP_PRIO_REALTIME,   /*!< Commands with a deadline on the Zigbee side (eg: answering a GPD during its receive window) */
+  EZSP_PRIO_INTERACTIVE,    /*!< Regular commands (default) */
+  EZSP_PRIO_BULK,   /*!< Long sequences that can be delayed (stack configuration, table sweeps) */
+  EZSP_PRIO_COUNT   /*!< Number of priority classes, not a priority */
+}EEzspCmdPriority;
+
+extern "C" {	/* Avoid compiler warning on member initialization for structs (in -Weffc++ mode) */
+    typedef struct sMsg
+    {
+        EEzspCmd i_cmd;
+        CFrameBuffer payload;   /*!< Parameters of the command, stored inline */
+        FEzspRspHandler rsp_handler; /*!< Invoked on completion, may be empty */
+        uint16_t rsp_timeout;   /*!< Time (in ms) to wait for the response, 0 to wait forever */
+        std::chrono::steady_clock::time_point rsp_deadline; /*!< When the response times out, set once the command is sent */
+        EEzspCmdPriority priority;  /*!< Priority class of the command */
+        std::chrono::steady_clock::time_point queued;   /*!< When the command has been queued */
+    }SMsg;
+
+    /**
+     * @brief Statistics on the queue of a priority class
+     */
+    typedef struct sEzspCmdQueueMetrics
+    {
+        size_t depth;   /*!< Number of commands currently waiting */
+        size_t max_depth;   /*!< Highest number of commands that have been waiting simultaneously */
+        uint32_t queued;    /*!< Total number of commands queued */
+        uint32_t served;    /*!< Total number of commands taken out of the queue */
+        uint32_t aged;  /*!< Number of commands served before more urgent ones because they waited too long */
+        uint32_t max_wait;  /*!< Longest time (in ms) a command has been waiting */
+    }SEzspCmdQueueMetrics;
+}
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief FIFO of commands, stored in a ring buffer
+ *
+ * The ring only grows (doubling its size) when full, and never shrinks: unlike a std::deque, which allocates a block every few items
+ * (every item, for an item as large as SMsg), queuing and serving commands does not touch the heap once the ring has reached the usual depth of the queue.
+ */
+class CEzspCmdRing
+{
+public:
+    CEzspCmdRing() : slots(), head(0), count(0) {}
+
+    bool empty() const { return 0 == count; }
+    size_t size() const { return count; }
+
+    /**
+     * @brief Get the oldest command. Must not be invoked if empty() is true
+     */
+    SMsg& front() { return slots[head]; }
+    const SMsg& front() const { return slots[head]; }
+
+    /**
+     * @brief Queue a command
+     */
+    void push_back(SMsg&& i_msg);
+
+    /**
+     * @brief Remove the oldest command. Must not be invoked if empty() is true
+     */
+    void pop_front();
+
+private:
+    std::vector<SMsg> slots;    /*!< Storage, the slots in use start at head and wrap around */
+    size_t head;    /*!< Slot of the oldest command */
+    size_t count;   /*!< Number of commands queued */
+};
+
+/**
+ * @brief Priority queues for EZSP commands
+ *
+ * Commands are served from the most urgent non-empty class, first in first out within a class.
+ * To avoid starvation, a command that has been waiting longer than the aging threshold of its class is served first, whatever the class.
+ */
+class CEzspCmdScheduler
+{
+public:
+    CEzspCmdScheduler();
+
+    /**
+     * @brief Queue a command, in the class given by i_msg.priority
+     */
+    void push(SMsg i_msg);
+
+    /**
+     * @brief Take the next command to send out of the queues
+     *
+     * Must not be invoked if empty() is true
+     */
+    SMsg pop();
+
+    /**
+     * @brief Are all queues empty?
+     */
+    bool empty() const;
+
+    /**
+     * @brief Total number of commands waiting
+     */
+    size_t size() const;
+
+    /**
+     * @brief Set the time after which a command of class i_priority gets served first
+     *
+     * @param i_priority The priority class
+     * @param i_aging The time (in ms), 0 to disable aging for this class
+     */
+    void setAging(EEzspCmdPriority i_priority, uint16_t i_aging);
+
+    /**
+     * @brief Get statistics on the queue of a priority class
+     */
+    SEzspCmdQueueMetrics getMetrics(EEzspCmdPriority i_priority) const;
+
+private:
+    CEzspCmdRing queues[EZSP_PRIO_COUNT];   /*!< Commands waiting, per priority class */
+    uint16_t aging[EZSP_PRIO_COUNT];    /*!< Aging threshold (in ms) per priority class, 0 if disabled */
+    SEzspCmdQueueMetrics metrics[EZSP_PRIO_COUNT];  /*!< Statistics per priority class */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
@@ -6,8 +6,8 @@
 
 #pragma once
 
-#include <vector>
 #include "ezsp-protocol/ezsp-enum.h"
+#include "frame-buffer.h"
 
 class CEzspDongleObserver {
 public:
@@ -25,7 +25,7 @@ public:
      * @brief Method that will be invoked on incoming EZSP messages
      *
      * @param i_cmd The EZSP command
-     * @param i_msg_receive The payload of the message
+     * @param i_msg_receive The payload of the message, shared by all observers and only valid during the invocation
      */
-    virtual void handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_receive ) = 0;
+    virtual void handleEzspRxMessage( EEzspCmd i_cmd, const CFrameBuffer& i_msg_receive ) = 0;
 };
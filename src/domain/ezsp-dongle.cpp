@@ -2,18 +2,39 @@
  * @file ezsp-dongle.cpp
  */
 
+#include <algorithm>
+
 #include "ezsp-dongle.h"
 #include "../spi/GenericLogger.h"
 
+/**
+ * Bits of the EZSP frame control byte, for frames sent by the NCP
+ */
+#define EZSP_FC_RESPONSE_MASK       0x80   /*!< Set on all frames from the NCP */
+#define EZSP_FC_CALLBACK_TYPE_MASK  0x18   /*!< Non-zero for callbacks (synchronous 0x08 or asynchronous 0x10), zero for responses to commands */
+
 CEzspDongle::CEzspDongle( ITimerFactory &i_timer_factory, CEzspDongleObserver* ip_observer ) :
 	timer_factory(i_timer_factory),
 	pUart(nullptr),
 	ash(new CAsh(static_cast<CAshCallback*>(this), timer_factory)),
 	uartIncomingDataHandler(),
 	sendingMsgQueue(),
-	wait_rsp(false),
+	pendingRsp(),
+	delayedAck(false),
+	ackDeadline(DONGLE_DEFAULT_ACK_DEADLINE),
+	ackTimer(timer_factory.create()),
+	rspTimer(timer_factory.create()),
+	rxDispatch(),
+	lastSubscription(0),
+	dispatching(false),
+	dispatchCleanup(false),
+	dongleMutex(),
+	rxExecutor([this](CByteSpan i_frame) { this->deliverEzspFrame(i_frame); }),
 	observers()
 {
+    // the ASH window bounds the number of commands waiting for their response, so the table never reallocates
+    pendingRsp.reserve(ASH_MAX_TX_WINDOW);
+
     if( nullptr != ip_observer )
     {
         registerObserver(ip_observer);
@@ -22,6 +43,9 @@ CEzspDongle::CEzspDongle( ITimerFactory &i_timer_factory, CEzspDongleObserver* i
 
 CEzspDongle::~CEzspDongle()
 {
+    rxExecutor.stop();
+    ackTimer->stop();
+    rspTimer->stop();
     pUart = nullptr;
     delete ash;
 }
@@ -29,7 +53,7 @@ CEzspDongle::~CEzspDongle()
 bool CEzspDongle::open(IUartDriver *ipUart)
 {
     bool lo_success = true;
-    std::vector<uint8_t> l_buffer;
+    CFrameBuffer l_buffer;
     size_t l_size;
 
     if( nullptr == ipUart )
@@ -82,73 +106,178 @@ void CEzspDongle::ashCbInfo( EAshInfo info )
         }
         else
         {
+            abortPendingRsp();
             notifyObserversOfDongleState( DONGLE_REMOVE );
         }
     }
+    else if( ASH_ACK == info )
+    {
+        // acknowledged frames free some room in the ASH window
+        sendNextMsg();
+    }
 }
 
-void CEzspDongle::handleInputData(const unsigned char* dataIn, const size_t dataLen)
- {
-    std::vector<uint8_t> li_data;
-    std::vector<uint8_t> lo_msg;
+void CEzspDongle::ashCbRetransmit( const std::vector<uint8_t>& i_frame )
+{
+    size_t l_size;
 
-    li_data.clear();
-    for( size_t loop=0; loop< dataLen; loop++ )
+    if( nullptr != pUart )
     {
-        li_data.push_back(dataIn[loop]);
+        pUart->write(l_size, i_frame.data(), i_frame.size());
     }
+}
+
+void CEzspDongle::handleInputData(const unsigned char* dataIn, const size_t dataLen)
+ {
+    size_t l_offset = 0;
 
-    while( !li_data.empty())
+    while( l_offset < dataLen )
     {
-        lo_msg = ash->decode(li_data);
+        size_t l_used = 0;
+        CByteSpan lo_msg;
 
-        // send incomming mesage to application
-        if( !lo_msg.empty() )
         {
-            size_t l_size;
+            std::lock_guard<std::recursive_mutex> l_lock(dongleMutex);
 
-            //clogD << "CEzspDongle::handleInputData ash message decoded" << std::endl;
+            lo_msg = ash->decode(dataIn + l_offset, dataLen - l_offset, l_used);
+            l_offset += l_used;
 
             // send ack
-            std::vector<uint8_t> l_msg = ash->AckFrame();
-            pUart->write(l_size, l_msg.data(), l_msg.size());
+            if( (lo_msg.size() > 2) && !delayedAck )
+            {
+                sendAck();
+            }
+        }
 
-            // call handler
+        // send incomming mesage to application
+        if( lo_msg.size() > 2 )
+        {
+            //clogD << "CEzspDongle::handleInputData ash message decoded" << std::endl;
 
-            // ezsp
-            // extract ezsp command
-            EEzspCmd l_cmd = static_cast<EEzspCmd>(lo_msg.at(2));
-            // keep only payload
-            lo_msg.erase(lo_msg.begin(),lo_msg.begin()+3);    
+            // not locked, handlers may send commands from the dispatch thread meanwhile (the view stays valid, only this thread decodes)
+            rxExecutor.dispatch( lo_msg );
 
-            // notify observers
-            notifyObserversOfEzspRxMessage( l_cmd, lo_msg );
+            std::lock_guard<std::recursive_mutex> l_lock(dongleMutex);
+            handleEzspFrame( lo_msg );
+        }
+    }
 
+    std::lock_guard<std::recursive_mutex> l_lock(dongleMutex);
 
-            // response to a sending command
-            if( !sendingMsgQueue.empty() )
+    // acknowledge frames that could not be piggybacked in a DATA frame
+    if( delayedAck && (ash->getRxUnackedCount() > 0) )
+    {
+        if( ash->getRxUnackedCount() >= DONGLE_MAX_DELAYED_ACKS )
+        {
+            // the NCP will soon stop sending, do not wait any longer
+            ackTimer->stop();
+            sendAck();
+        }
+        else if( !ackTimer->isRunning() )
+        {
+            ackTimer->start( ackDeadline, [&](ITimer *ipTimer){ this->ackTimeout(); } );
+        }
+    }
+}
+
+void CEzspDongle::setDelayedAck(bool i_enable, uint16_t i_deadline)
+{
+    std::lock_guard<std::recursive_mutex> l_lock(dongleMutex);
+    delayedAck = i_enable;
+    ackDeadline = i_deadline;
+    if( !delayedAck )
+    {
+        ackTimer->stop();
+        ackTimeout();
+    }
+}
+
+void CEzspDongle::handleEzspFrame( CByteSpan i_frame )
+{
+    uint8_t l_seq = i_frame[0];
+    uint8_t l_fc = i_frame[1];
+    // extract ezsp command
+    EEzspCmd l_cmd = static_cast<EEzspCmd>(i_frame[2]);
+
+
+    // response to a sending command (callbacks may share the command id of a pending command, but never complete it)
+    if( (0 != (l_fc & EZSP_FC_RESPONSE_MASK)) && (0 == (l_fc & EZSP_FC_CALLBACK_TYPE_MASK)) )
+    {
+        std::vector< std::pair<uint8_t, SMsg> >::iterator l_it = findPendingRsp(l_seq);
+        if( l_it == pendingRsp.end() )
+        {
+            clogW << "CEzspDongle::handleEzspFrame unexpected response " << CEzspEnum::EEzspCmdToString(l_cmd) << " with sequence number " << static_cast<unsigned int>(l_seq) << std::endl;
+        }
+        else
+        {
+            if( l_it->second.i_cmd != l_cmd )
             {
-				sMsg l_msgQ = sendingMsgQueue.front();
-				if( l_msgQ.i_cmd == l_cmd ) // Bug
-				{
-					// remove waiting message and send next
-					sendingMsgQueue.pop();
-					wait_rsp = false;
-					sendNextMsg();
-				}
+                clogW << "CEzspDongle::handleEzspFrame response " << CEzspEnum::EEzspCmdToString(l_cmd) << " to command " << CEzspEnum::EEzspCmdToString(l_it->second.i_cmd) << std::endl;
             }
+            // remove waiting message and send next
+            FEzspRspHandler l_handler = std::move(l_it->second.rsp_handler);
+            pendingRsp.erase(l_it);
+            if( l_handler )
+            {
+                // parameters only, without the trailing CRC
+                CByteSpan l_params = i_frame.subspan(3, (i_frame.size() >= 5) ? (i_frame.size() - 5) : 0);
+                l_handler(EZSP_RSP_SUCCESS, l_cmd, l_params);
+                armRspTimer();
+            }
+            sendNextMsg();
         }
-    }    
+    }
+}
+
+void CEzspDongle::deliverEzspFrame( CByteSpan i_frame )
+{
+    // extract ezsp command
+    EEzspCmd l_cmd = static_cast<EEzspCmd>(i_frame[2]);
+
+    // notify observers, keeping only payload (copied once into a buffer on the stack, shared by all observers)
+    if( !observers.empty() )
+    {
+        notifyObserversOfEzspRxMessage( l_cmd, CFrameBuffer(i_frame.subspan(3)) );
+    }
+    // subscribers of this command only get the parameters, without the trailing CRC
+    dispatchEzspRxMessage( l_cmd, i_frame.subspan(3, (i_frame.size() >= 5) ? (i_frame.size() - 5) : 0) );
+}
+
+void CEzspDongle::setTxWindow(uint8_t i_window)
+{
+    std::lock_guard<std::recursive_mutex> l_lock(dongleMutex);
+
+    ash->setTxWindow(i_window);
+    sendNextMsg();
 }
 
-void CEzspDongle::sendCommand(EEzspCmd i_cmd, std::vector<uint8_t> i_cmd_payload )
+void CEzspDongle::sendCommand(EEzspCmd i_cmd, const CFrameBuffer& i_cmd_payload, EEzspCmdPriority i_priority )
 {
+    std::lock_guard<std::recursive_mutex> l_lock(dongleMutex);
     sMsg l_msg;
 
     l_msg.i_cmd = i_cmd;
     l_msg.payload = i_cmd_payload;
+    l_msg.rsp_timeout = 0;
+    l_msg.priority = i_priority;
     
-    sendingMsgQueue.push(l_msg);
+    sendingMsgQueue.push(std::move(l_msg));
+
+    sendNextMsg();
+}
+
+void CEzspDongle::sendCommand(EEzspCmd i_cmd, const CFrameBuffer& i_cmd_payload, FEzspRspHandler i_handler, uint16_t i_timeout, EEzspCmdPriority i_priority )
+{
+    std::lock_guard<std::recursive_mutex> l_lock(dongleMutex);
+    sMsg l_msg;
+
+    l_msg.i_cmd = i_cmd;
+    l_msg.payload = i_cmd_payload;
+    l_msg.rsp_handler = std::move(i_handler);
+    l_msg.rsp_timeout = i_timeout;
+    l_msg.priority = i_priority;
+
+    sendingMsgQueue.push(std::move(l_msg));
 
     sendNextMsg();
 }
@@ -160,36 +289,142 @@ void CEzspDongle::sendCommand(EEzspCmd i_cmd, std::vector<uint8_t> i_cmd_payload
  * 
  */
 
+void CEzspDongle::sendAck( void )
+{
+    size_t l_size;
+
+    CFrameBuffer l_msg = ash->AckFrame();
+    if( nullptr != pUart )
+    {
+        pUart->write(l_size, l_msg.data(), l_msg.size());
+    }
+}
+
+void CEzspDongle::ackTimeout( void )
+{
+    // nothing to do if the acknowledge was piggybacked in a DATA frame in the meantime
+    if( ash->getRxUnackedCount() > 0 )
+    {
+        sendAck();
+    }
+}
+
 void CEzspDongle::sendNextMsg( void )
 {
-    if( (!wait_rsp) && (!sendingMsgQueue.empty()) )
+    // send as many commands as the ASH window allows
+    while( (nullptr != pUart) && (!sendingMsgQueue.empty()) &&
+           (pendingRsp.size() < ash->getTxWindow()) && (!ash->isTxWindowFull()) )
     {
-        sMsg l_msg = sendingMsgQueue.front();
+        sMsg l_msg = sendingMsgQueue.pop();
 
         // encode command using ash and write to uart
-        std::vector<uint8_t> li_data;
-        std::vector<uint8_t> l_enc_data;
+        uint8_t li_data[ASH_MAX_DATA_LENGTH];
+        uint8_t l_enc_data[ASH_MAX_FRAME_SIZE];
         size_t l_size;
+        size_t l_enc_len = 0;
 
-        li_data.clear();
-        li_data.push_back(static_cast<uint8_t>(l_msg.i_cmd));
-        for( size_t loop=0; loop< l_msg.payload.size(); loop++ )
+        //-- clogD << "CEzspDongle::sendCommand ash->DataFrame" << std::endl;
+        uint8_t l_seq = ash->getNextSeqNum();
+        if( l_msg.payload.size() < sizeof(li_data) )
         {
-            li_data.push_back(l_msg.payload.at(loop));
+            li_data[0] = static_cast<uint8_t>(l_msg.i_cmd);
+            std::copy(l_msg.payload.begin(), l_msg.payload.end(), li_data + 1);
+            l_enc_len = ash->DataFrame(li_data, 1 + l_msg.payload.size(), l_enc_data, sizeof(l_enc_data));
         }
 
-        //-- clogD << "CEzspDongle::sendCommand ash->DataFrame" << std::endl;
-        l_enc_data = ash->DataFrame(li_data);
-        if( nullptr != pUart )
+        if( 0 == l_enc_len )
         {
-            //-- clogD << "CEzspDongle::sendCommand pUart->write" << std::endl;
-            pUart->write(l_size, l_enc_data.data(), l_enc_data.size());
+            clogE << "CEzspDongle::sendNextMsg dropping command " << CEzspEnum::EEzspCmdToString(l_msg.i_cmd) << std::endl;
+            continue;
+        }
 
-            wait_rsp = true;
+        //-- clogD << "CEzspDongle::sendCommand pUart->write" << std::endl;
+        pUart->write(l_size, l_enc_data, l_enc_len);
+
+        l_msg.rsp_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(l_msg.rsp_timeout);
+        bool l_timed = (l_msg.rsp_handler && (0 != l_msg.rsp_timeout));
+        pendingRsp.push_back(std::make_pair(l_seq, std::move(l_msg)));
+        if( l_timed && !rspTimer->isRunning() )
+        {
+            armRspTimer();
         }
     }
 }
 
+void CEzspDongle::armRspTimer( void )
+{
+    bool l_found = false;
+    std::chrono::steady_clock::time_point l_earliest;
+
+    for( std::vector< std::pair<uint8_t, SMsg> >::const_iterator l_it = pendingRsp.begin(); l_it != pendingRsp.end(); ++l_it )
+    {
+        if( l_it->second.rsp_handler && (0 != l_it->second.rsp_timeout) && (!l_found || (l_it->second.rsp_deadline < l_earliest)) )
+        {
+            l_earliest = l_it->second.rsp_deadline;
+            l_found = true;
+        }
+    }
+
+    rspTimer->stop();
+    if( l_found )
+    {
+        auto l_delay = std::chrono::duration_cast<std::chrono::milliseconds>(l_earliest - std::chrono::steady_clock::now()).count();
+        l_delay = std::max(static_cast<decltype(l_delay)>(1), std::min(l_delay, static_cast<decltype(l_delay)>(UINT16_MAX)));
+        rspTimer->start( static_cast<uint16_t>(l_delay), [&](ITimer *ipTimer){ this->rspTimeout(); } );
+    }
+}
+
+void CEzspDongle::rspTimeout( void )
+{
+    std::chrono::steady_clock::time_point l_now = std::chrono::steady_clock::now();
+    std::vector<SMsg> l_expired;
+
+    std::vector< std::pair<uint8_t, SMsg> >::iterator l_it = pendingRsp.begin();
+    while( l_it != pendingRsp.end() )
+    {
+        if( l_it->second.rsp_handler && (0 != l_it->second.rsp_timeout) && (l_it->second.rsp_deadline <= l_now) )
+        {
+            clogW << "CEzspDongle::rspTimeout no response to " << CEzspEnum::EEzspCmdToString(l_it->second.i_cmd) << std::endl;
+            l_expired.push_back(std::move(l_it->second));
+            l_it = pendingRsp.erase(l_it);
+        }
+        else
+        {
+            ++l_it;
+        }
+    }
+
+    for( const SMsg& l_msg : l_expired )
+    {
+        l_msg.rsp_handler(EZSP_RSP_TIMEOUT, l_msg.i_cmd, CByteSpan());
+    }
+
+    armRspTimer();
+    sendNextMsg();
+}
+
+void CEzspDongle::abortPendingRsp( void )
+{
+    std::vector< std::pair<uint8_t, SMsg> > l_pending;
+
+    l_pending.swap(pendingRsp);
+    pendingRsp.reserve(ASH_MAX_TX_WINDOW);
+    rspTimer->stop();
+    for( std::vector< std::pair<uint8_t, SMsg> >::const_iterator l_it = l_pending.begin(); l_it != l_pending.end(); ++l_it )
+    {
+        if( l_it->second.rsp_handler )
+        {
+            l_it->second.rsp_handler(EZSP_RSP_ABORTED, l_it->second.i_cmd, CByteSpan());
+        }
+    }
+}
+
+std::vector< std::pair<uint8_t, SMsg> >::iterator CEzspDongle::findPendingRsp( uint8_t i_seq )
+{
+    return std::find_if(pendingRsp.begin(), pendingRsp.end(),
+                        [i_seq](const std::pair<uint8_t, SMsg>& i_pending) { return i_pending.first == i_seq; });
+}
+
 
 /**
  * Managing Observer of this class
@@ -210,8 +445,80 @@ void CEzspDongle::notifyObserversOfDongleState( EDongleState i_state ) {
 	}
 }
 
-void CEzspDongle::notifyObserversOfEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_message ) {
+void CEzspDongle::notifyObserversOfEzspRxMessage( EEzspCmd i_cmd, const CFrameBuffer& i_message ) {
 	for(auto observer : this->observers) {
 		observer->handleEzspRxMessage(i_cmd, i_message);
 	}
 }
+
+unsigned int CEzspDongle::subscribe(EEzspCmd i_cmd, FEzspRxHandler i_handler)
+{
+    if( !i_handler )
+    {
+        return 0;
+    }
+    lastSubscription++;
+    if( 0 == lastSubscription )
+    {
+        // 0 is never a valid identifier
+        lastSubscription++;
+    }
+    rxDispatch[static_cast<uint8_t>(i_cmd)].push_back(std::make_pair(lastSubscription, i_handler));
+    return lastSubscription;
+}
+
+bool CEzspDongle::unsubscribe(unsigned int i_subscription)
+{
+    for( auto& l_slot : rxDispatch )
+    {
+        for( auto l_it = l_slot.begin(); l_it != l_slot.end(); ++l_it )
+        {
+            if( (0 != i_subscription) && (l_it->first == i_subscription) )
+            {
+                if( dispatching )
+                {
+                    // the slot may be being walked through, only disable the subscription, it will be removed once dispatching is over
+                    l_it->first = 0;
+                    l_it->second = nullptr;
+                    dispatchCleanup = true;
+                }
+                else
+                {
+                    l_slot.erase(l_it);
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void CEzspDongle::dispatchEzspRxMessage( EEzspCmd i_cmd, CByteSpan i_message ) {
+    std::vector< std::pair<unsigned int, FEzspRxHandler> >& l_slot = rxDispatch[static_cast<uint8_t>(i_cmd)];
+    bool l_nested = dispatching;
+
+    dispatching = true;
+    // subscriptions added by a handler are part of the walk, by index as the slot may grow
+    for( size_t l_idx = 0; l_idx < l_slot.size(); l_idx++ )
+    {
+        if( 0 != l_slot[l_idx].first )
+        {
+            FEzspRxHandler l_handler = l_slot[l_idx].second;
+            l_handler(i_cmd, i_message);
+        }
+    }
+    if( !l_nested )
+    {
+        dispatching = false;
+        if( dispatchCleanup )
+        {
+            dispatchCleanup = false;
+            for( auto& l_cleaned_slot : rxDispatch )
+            {
+                l_cleaned_slot.erase(std::remove_if(l_cleaned_slot.begin(), l_cleaned_slot.end(),
+                                                    [](const std::pair<unsigned int, FEzspRxHandler>& i_entry) { return 0 == i_entry.first; }),
+                                     l_cleaned_slot.end());
+            }
+        }
+    }
+}
@@ -3,21 +3,41 @@
 #include <string>
 #include <iostream>
 #include <vector>
-#include <queue>
+#include <map>
+#include <chrono>
+#include <functional>
+#include <mutex>
 
 #include "ezsp-protocol/ezsp-enum.h"
 #include "../spi/IUartDriver.h"
 #include "ash.h"
 #include "ezsp-dongle-observer.h"
+#include "ezsp-cmd-scheduler.h"
+#include "ezsp-rx-executor.h"
 #include "../spi/ITimerFactory.h"
 
-extern "C" {	/* Avoid compiler warning on member initialization for structs (in -Weffc++ mode) */
-    typedef struct sMsg
-    {
-        EEzspCmd i_cmd;
-        std::vector<uint8_t> payload;
-    }SMsg;
-}
+/**
+ * Default time (in ms) to wait for an outgoing DATA frame to carry the acknowledge, when delayed ACKs are enabled
+ */
+#define DONGLE_DEFAULT_ACK_DEADLINE 20
+
+/**
+ * Number of DATA frames received without acknowledge after which an ACK frame is sent immediately, when delayed ACKs are enabled
+ */
+#define DONGLE_MAX_DELAYED_ACKS 3
+
+/**
+ * Default time (in ms) to wait for the response to a command sent with a completion handler
+ */
+#define DONGLE_DEFAULT_RSP_TIMEOUT 5000
+
+/**
+ * @brief Handler of incoming EZSP messages for a given command
+ *
+ * @param i_cmd The EZSP command
+ * @param i_msg_receive A read-only view on the parameters of the message, only valid during the invocation
+ */
+typedef std::function<void (EEzspCmd i_cmd, CByteSpan i_msg_receive)> FEzspRxHandler;
 
 #ifdef USE_RARITAN
 /**** Start of the official API; no includes below this point! ***************/
@@ -42,10 +62,93 @@ public:
 
     /**
      * @brief Send Ezsp Command
+     *
+     * @param i_cmd The EZSP command
+     * @param i_cmd_payload The parameters of the command (copied into the queue)
+     * @param i_priority How urgently the command must be sent, compared to other commands waiting to be sent
      */
-    void sendCommand(EEzspCmd i_cmd, std::vector<uint8_t> i_cmd_payload = std::vector<uint8_t>() );
+    void sendCommand(EEzspCmd i_cmd, const CFrameBuffer& i_cmd_payload = CFrameBuffer(), EEzspCmdPriority i_priority = EZSP_PRIO_INTERACTIVE );
+
+    /**
+     * @brief Send Ezsp Command, and get notified of its response
+     *
+     * The response is still notified to all observers, but i_handler is the only one that is guaranteed to get the response to this specific command
+     *
+     * @param i_cmd The EZSP command
+     * @param i_cmd_payload The parameters of the command (copied into the queue)
+     * @param i_handler The function to invoke once the response has been received, or on timeout
+     * @param i_timeout The time (in ms) to wait for the response (counted from the moment the command is sent to the NCP), 0 to wait forever
+     * @param i_priority How urgently the command must be sent, compared to other commands waiting to be sent
+     */
+    void sendCommand(EEzspCmd i_cmd, const CFrameBuffer& i_cmd_payload, FEzspRspHandler i_handler, uint16_t i_timeout = DONGLE_DEFAULT_RSP_TIMEOUT, EEzspCmdPriority i_priority = EZSP_PRIO_INTERACTIVE );
+
+    /**
+     * @brief Set the time after which a command waiting to be sent is served before more urgent commands
+     *
+     * @param i_priority The priority class
+     * @param i_aging The time (in ms), 0 to disable aging for this class
+     */
+    void setCommandAging(EEzspCmdPriority i_priority, uint16_t i_aging) { sendingMsgQueue.setAging(i_priority, i_aging); }
+
+    /**
+     * @brief Get statistics on the commands waiting to be sent, for one priority class
+     */
+    SEzspCmdQueueMetrics getCommandQueueMetrics(EEzspCmdPriority i_priority) const { return sendingMsgQueue.getMetrics(i_priority); }
+
 
 
+    /**
+     * @brief Set the number of EZSP commands that can be sent to the NCP before getting their response
+     *
+     * @param i_window The window size, between 1 (default, one command at a time) and ASH_MAX_TX_WINDOW
+     */
+    void setTxWindow(uint8_t i_window);
+
+    /**
+     * @brief Enable or disable delayed ACKs
+     *
+     * When enabled, DATA frames received from the NCP are not acknowledged immediately: the acknowledge is piggybacked in the next DATA frame we send, or a single ACK frame is sent after i_deadline
+     * (or as soon as DONGLE_MAX_DELAYED_ACKS frames are waiting for their acknowledge). Disabled by default, every DATA frame is then acknowledged by its own ACK frame
+     *
+     * @param i_enable true to enable delayed ACKs
+     * @param i_deadline The maximum time (in ms) an acknowledge can be delayed
+     */
+    void setDelayedAck(bool i_enable, uint16_t i_deadline = DONGLE_DEFAULT_ACK_DEADLINE);
+
+    /**
+     * @brief Dispatch incoming messages to observers and subscribers from a dedicated thread
+     *
+     * By default, observers and subscribers are invoked from the UART read thread, so a slow handler delays the processing of the next frames (and the NCP may overflow).
+     * Once enabled, decoded frames are handed off to a dispatch thread through a bounded queue, and the UART read thread only takes care of ASH and of completing commands
+     * (handlers given to sendCommand() are thus still invoked from the UART read thread).
+     * Observers and subscribers should be registered before enabling this.
+     *
+     * @param i_capacity The number of frames that can wait to be dispatched
+     * @param i_policy What to do when a frame arrives while the queue is full
+     *
+     * @return false if already enabled
+     */
+    bool setAsyncDispatch(size_t i_capacity = EZSP_RX_DEFAULT_QUEUE_CAPACITY, EEzspRxOverflowPolicy i_policy = EZSP_RX_OVERFLOW_DROP) { return rxExecutor.start(i_capacity, i_policy); }
+
+    /**
+     * @brief Dispatch incoming messages from the UART read thread again (default), once the frames waiting in the queue have been dispatched
+     */
+    void setSyncDispatch(void) { rxExecutor.stop(); }
+
+    /**
+     * @brief Get statistics on the frames handed off to the dispatch thread
+     */
+    SEzspRxMetrics getRxDispatchMetrics(void) const { return rxExecutor.getMetrics(); }
+
+    /**
+     * @brief Number of ACK frames sent to the NCP
+     */
+    uint32_t getAckSentCount(void) const { return ash->getAckSentCount(); }
+
+    /**
+     * @brief Number of ACK frames saved thanks to piggybacking and coalescing
+     */
+    uint32_t getAckSavedCount(void) const { return ash->getAckSavedCount(); }
 
     /**
      * @brief Callback invoked on UART received bytes
@@ -57,28 +160,73 @@ public:
      */
     void ashCbInfo( EAshInfo info );
 
+    /**
+     * @brief Callback invoked when ASH retransmits a frame
+     */
+    void ashCbRetransmit( const std::vector<uint8_t>& i_frame );
+
     /**
      * Managing Observer of this class
      */
 	bool registerObserver(CEzspDongleObserver* observer);
 	bool unregisterObserver(CEzspDongleObserver* observer);
 
+    /**
+     * @brief Get notified of the incoming EZSP messages (responses and callbacks) of a single command
+     *
+     * Unlike observers, which get a copy of every message, a subscriber is only invoked for the command it subscribed to, and gets a view on the received bytes
+     *
+     * @param i_cmd The EZSP command
+     * @param i_handler The function to invoke on each message for i_cmd
+     *
+     * @return An identifier to give to unsubscribe()
+     */
+    unsigned int subscribe(EEzspCmd i_cmd, FEzspRxHandler i_handler);
+
+    /**
+     * @brief Stop a subscription (this can be done from within a handler)
+     *
+     * @param i_subscription The identifier returned by subscribe()
+     *
+     * @return false if no such subscription exists
+     */
+    bool unsubscribe(unsigned int i_subscription);
+
 private:
     ITimerFactory &timer_factory;
     IUartDriver *pUart;
     CAsh *ash;
     GenericAsyncDataInputObservable uartIncomingDataHandler;
-    std::queue<SMsg> sendingMsgQueue;
-    bool wait_rsp;
+    CEzspCmdScheduler sendingMsgQueue;  /*!< Commands waiting to be sent */
+    std::vector< std::pair<uint8_t, SMsg> > pendingRsp;    /*!< Commands sent and waiting for their response, with their EZSP sequence number (at most ASH_MAX_TX_WINDOW, room is reserved upfront) */
+    bool delayedAck;    /*!< Are acknowledges delayed to be piggybacked or coalesced */
+    uint16_t ackDeadline;   /*!< Maximum delay (in ms) of an acknowledge */
+    std::unique_ptr<ITimer> ackTimer;   /*!< Timer sending the delayed acknowledge */
+    std::unique_ptr<ITimer> rspTimer;   /*!< Timer expiring the oldest command waiting for its response */
+    std::vector< std::pair<unsigned int, FEzspRxHandler> > rxDispatch[256];  /*!< Subscriptions (identifier and handler), indexed by EZSP command */
+    unsigned int lastSubscription;  /*!< Identifier given to the latest subscription */
+    bool dispatching;   /*!< Are subscription handlers being invoked */
+    bool dispatchCleanup;   /*!< Have subscriptions been stopped while dispatching */
+    std::recursive_mutex dongleMutex;   /*!< Serializes ASH and command queue accesses from the UART read thread, the dispatch thread and the application */
+    CEzspRxExecutor rxExecutor; /*!< Hands incoming frames to observers and subscribers */
 
     void sendNextMsg( void );
+    void sendAck( void );
+    void ackTimeout( void );
+    void handleEzspFrame( CByteSpan i_frame );
+    void deliverEzspFrame( CByteSpan i_frame );
+    void armRspTimer( void );
+    void rspTimeout( void );
+    void abortPendingRsp( void );
+    std::vector< std::pair<uint8_t, SMsg> >::iterator findPendingRsp( uint8_t i_seq );
 
     /**
      * Notify Observer of this class
      */
     std::set<CEzspDongleObserver*> observers;
     void notifyObserversOfDongleState( EDongleState i_state );
-    void notifyObserversOfEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_message );
+    void notifyObserversOfEzspRxMessage( EEzspCmd i_cmd, const CFrameBuffer& i_message );
+    void dispatchEzspRxMessage( EEzspCmd i_cmd, CByteSpan i_message );
 };
 
 #ifdef USE_RARITAN
@@ -0,0 +1,333 @@
+/**
+ * @file ezsp-codec.h
+ *
+ * @brief Compile-time description of the parameters of EZSP commands, and allocation-free encoding/decoding of these parameters
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>	// For size_t
+#include <algorithm>
+#include <array>
+
+#include "ezsp-enum.h"
+#include "../ash.h"
+#include "../byte-span.h"
+#include "../frame-buffer.h"
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * Maximum size of the parameters of an EZSP command: an ASH DATA frame holds the EZSP extended header (4 bytes) and the frame ID (1 byte) before them
+ */
+#define EZSP_MAX_PARAMETERS_LENGTH (ASH_MAX_DATA_LENGTH - 5)
+
+/**
+ * @brief Codec of a one byte parameter
+ *
+ * A field codec describes how one parameter is laid out in an EZSP frame:
+ * - value_type is the C++ type of the parameter
+ * - MAX_SIZE is the largest number of bytes the parameter can occupy
+ * - encode() writes the parameter and returns the number of bytes written (at most MAX_SIZE)
+ * - decode() reads the parameter and moves the span past it, or returns false if the span is too short
+ *
+ * @tparam T The type of the parameter (an integer, bool or enum type)
+ */
+template <typename T = uint8_t>
+struct CEzspU8Field
+{
+    typedef T value_type;
+    static const size_t MAX_SIZE = 1;
+
+    static size_t encode(uint8_t* o_buf, const value_type& i_value)
+    {
+        o_buf[0] = static_cast<uint8_t>(i_value);
+        return MAX_SIZE;
+    }
+
+    static bool decode(CByteSpan& io_span, value_type& o_value)
+    {
+        if( io_span.size() < MAX_SIZE )
+        {
+            return false;
+        }
+        o_value = static_cast<value_type>(io_span[0]);
+        io_span = io_span.subspan(MAX_SIZE);
+        return true;
+    }
+};
+
+/**
+ * @brief Codec of a 16-bit little endian parameter
+ */
+struct CEzspU16Field
+{
+    typedef uint16_t value_type;
+    static const size_t MAX_SIZE = 2;
+
+    static size_t encode(uint8_t* o_buf, const value_type& i_value)
+    {
+        o_buf[0] = static_cast<uint8_t>(i_value & 0xFF);
+        o_buf[1] = static_cast<uint8_t>((i_value >> 8) & 0xFF);
+        return MAX_SIZE;
+    }
+
+    static bool decode(CByteSpan& io_span, value_type& o_value)
+    {
+        if( io_span.size() < MAX_SIZE )
+        {
+            return false;
+        }
+        o_value = static_cast<value_type>(io_span[0] | (io_span[1] << 8));
+        io_span = io_span.subspan(MAX_SIZE);
+        return true;
+    }
+};
+
+/**
+ * @brief Codec of a 32-bit little endian parameter
+ */
+struct CEzspU32Field
+{
+    typedef uint32_t value_type;
+    static const size_t MAX_SIZE = 4;
+
+    static size_t encode(uint8_t* o_buf, const value_type& i_value)
+    {
+        for( size_t loop = 0; loop < MAX_SIZE; loop++ )
+        {
+            o_buf[loop] = static_cast<uint8_t>((i_value >> (8 * loop)) & 0xFF);
+        }
+        return MAX_SIZE;
+    }
+
+    static bool decode(CByteSpan& io_span, value_type& o_value)
+    {
+        if( io_span.size() < MAX_SIZE )
+        {
+            return false;
+        }
+        o_value = 0;
+        for( size_t loop = 0; loop < MAX_SIZE; loop++ )
+        {
+            o_value |= static_cast<value_type>(io_span[loop]) << (8 * loop);
+        }
+        io_span = io_span.subspan(MAX_SIZE);
+        return true;
+    }
+};
+
+/**
+ * @brief Codec of a fixed-size list of 16-bit little endian parameters (eg: a cluster list, whose count is another parameter)
+ *
+ * @tparam N The number of items in the list
+ */
+template <size_t N>
+struct CEzspU16ArrayField
+{
+    typedef std::array<uint16_t, N> value_type;
+    static const size_t MAX_SIZE = 2 * N;
+
+    static size_t encode(uint8_t* o_buf, const value_type& i_value)
+    {
+        for( size_t loop = 0; loop < N; loop++ )
+        {
+            CEzspU16Field::encode(o_buf + 2 * loop, i_value[loop]);
+        }
+        return MAX_SIZE;
+    }
+
+    static bool decode(CByteSpan& io_span, value_type& o_value)
+    {
+        for( size_t loop = 0; loop < N; loop++ )
+        {
+            if( !CEzspU16Field::decode(io_span, o_value[loop]) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Codec of a byte string preceded by its length on one byte (eg: the content of a message)
+ *
+ * Encoded strings longer than MAX_LENGTH are truncated, callers that care must check the length beforehand.
+ * Decoded strings are views on the frame being decoded, no byte is copied.
+ *
+ * @tparam MAX_LENGTH The maximum length of the string
+ */
+template <size_t MAX_LENGTH>
+struct CEzspVarBytesField
+{
+    static_assert(MAX_LENGTH <= 0xFF, "The length of the string must fit in one byte");
+
+    typedef CByteSpan value_type;
+    static const size_t MAX_SIZE = 1 + MAX_LENGTH;
+
+    static size_t encode(uint8_t* o_buf, const value_type& i_value)
+    {
+        size_t l_length = (i_value.size() > MAX_LENGTH) ? MAX_LENGTH : i_value.size();
+
+        o_buf[0] = static_cast<uint8_t>(l_length);
+        std::copy(i_value.begin(), i_value.begin() + l_length, o_buf + 1);
+        return 1 + l_length;
+    }
+
+    static bool decode(CByteSpan& io_span, value_type& o_value)
+    {
+        if( io_span.empty() || (io_span.size() < 1U + io_span[0]) )
+        {
+            return false;
+        }
+        o_value = io_span.subspan(1, io_span[0]);
+        io_span = io_span.subspan(1U + io_span[0]);
+        return true;
+    }
+};
+
+/**
+ * @brief Ordered list of parameters of an EZSP command or response
+ *
+ * The size of the largest possible encoding is known at compile time, so parameters are encoded in a buffer on the stack.
+ *
+ * @tparam Fields The codec of each parameter, in the order they appear in the frame
+ */
+template <typename... Fields>
+struct CEzspParameters;
+
+/**
+ * @brief Empty list of parameters, ends the recursion over the parameters
+ */
+template <>
+struct CEzspParameters<>
+{
+    static const size_t MAX_SIZE = 0;
+
+    static size_t encode(uint8_t* /* o_buf */)
+    {
+        return 0;
+    }
+
+    static bool decode(CByteSpan& /* io_span */)
+    {
+        return true;
+    }
+};
+
+template <typename First, typename... Others>
+struct CEzspParameters<First, Others...>
+{
+    static const size_t MAX_SIZE = First::MAX_SIZE + CEzspParameters<Others...>::MAX_SIZE;
+
+    /**
+     * @brief Encode the parameters
+     *
+     * @param o_buf The buffer to write to, at least MAX_SIZE bytes long
+     * @param i_first, i_others The value of each parameter
+     *
+     * @return The number of bytes written
+     */
+    static size_t encode(uint8_t* o_buf, const typename First::value_type& i_first, const typename Others::value_type&... i_others)
+    {
+        size_t l_len = First::encode(o_buf, i_first);
+        return l_len + CEzspParameters<Others...>::encode(o_buf + l_len, i_others...);
+    }
+
+    /**
+     * @brief Decode the parameters
+     *
+     * @param io_span The bytes to decode, moved past the parameters decoded
+     * @param o_first, o_others The value of each parameter
+     *
+     * @return false if the bytes are too short to hold all the parameters
+     */
+    static bool decode(CByteSpan& io_span, typename First::value_type& o_first, typename Others::value_type&... o_others)
+    {
+        return First::decode(io_span, o_first) && CEzspParameters<Others...>::decode(io_span, o_others...);
+    }
+};
+
+/**
+ * @brief Codec of an EZSP command, declaring the layout of its parameters and of the parameters of its response
+ *
+ * @code
+ * typedef CEzspCommandCodec<EZSP_SET_POLICY, CEzspParameters<CEzspU8Field<>, CEzspU8Field<> >, CEzspParameters<CEzspU8Field<EEmberStatus> > > CEzspSetPolicy;
+ *
+ * dongle.sendCommand(CEzspSetPolicy::ID, CEzspSetPolicy::requestPayload(EZSP_TRUST_CENTER_POLICY, 0x01));
+ * ...
+ * EEmberStatus l_status;
+ * if( CEzspSetPolicy::decodeResponse(i_msg_receive, l_status) ) ...
+ * @endcode
+ *
+ * @tparam CMD The EZSP command
+ * @tparam Request The parameters of the command
+ * @tparam Response The parameters of its response
+ */
+template <EEzspCmd CMD, typename Request, typename Response = CEzspParameters<> >
+struct CEzspCommandCodec
+{
+    static_assert(Request::MAX_SIZE <= EZSP_MAX_PARAMETERS_LENGTH, "The parameters of this EZSP command may not fit in an ASH DATA frame");
+
+    static const EEzspCmd ID = CMD;
+
+    /**
+     * @brief A buffer large enough to hold any encoding of the parameters of the command
+     */
+    typedef std::array<uint8_t, Request::MAX_SIZE> CRequestBuffer;
+
+    /**
+     * @brief Encode the parameters of the command
+     *
+     * @param o_buf The buffer to write to
+     * @param i_args The value of each parameter (there must be exactly one per parameter, convertible to its type)
+     *
+     * @return The number of bytes written
+     */
+    template <typename... Args>
+    static size_t encodeRequest(CRequestBuffer& o_buf, const Args&... i_args)
+    {
+        return Request::encode(o_buf.data(), i_args...);
+    }
+
+    /**
+     * @brief Encode the parameters of the command into a payload for CEzspDongle::sendCommand()
+     *
+     * The parameters are encoded on the stack, then copied into a frame buffer, without any heap allocation.
+     *
+     * @param i_args The value of each parameter (there must be exactly one per parameter, convertible to its type)
+     *
+     * @return The encoded parameters
+     */
+    template <typename... Args>
+    static CFrameBuffer requestPayload(const Args&... i_args)
+    {
+        CRequestBuffer l_buf;
+        size_t l_len = encodeRequest(l_buf, i_args...);
+
+        return CFrameBuffer(CByteSpan(l_buf.data(), l_len));
+    }
+
+    /**
+     * @brief Decode the parameters of the response (trailing bytes, if any, are ignored)
+     *
+     * @param i_rsp The parameters of the response, as received from the NCP
+     * @param o_args The value of each parameter (there must be exactly one per parameter, of its type)
+     *
+     * @return false if the response is too short to hold all the parameters
+     */
+    template <typename... Args>
+    static bool decodeResponse(CByteSpan i_rsp, Args&... o_args)
+    {
+        return Response::decode(i_rsp, o_args...);
+    }
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
@@ -0,0 +1,157 @@
+/**
+ * @file ezsp-commands.h
+ *
+ * @brief Layout of the parameters of the EZSP commands sent by the library, and of their responses
+ */
+
+#pragma once
+
+#include "ezsp-codec.h"
+#include "struct/ember-gp-address-struct.h"
+#include "../zbmessage/aps.h"
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief Codec of an EmberApsFrame parameter
+ */
+struct CEzspApsFrameField
+{
+    typedef CAPSFrame value_type;
+    static const size_t MAX_SIZE = 11;
+
+    static size_t encode(uint8_t* o_buf, const value_type& i_value)
+    {
+        size_t l_len = 0;
+
+        l_len += CEzspU16Field::encode(o_buf + l_len, i_value.profile_id);
+        l_len += CEzspU16Field::encode(o_buf + l_len, i_value.cluster_id);
+        l_len += CEzspU8Field<>::encode(o_buf + l_len, i_value.src_ep);
+        l_len += CEzspU8Field<>::encode(o_buf + l_len, i_value.dest_ep);
+        l_len += CEzspU16Field::encode(o_buf + l_len, i_value.option.GetEmberApsOption());
+        l_len += CEzspU16Field::encode(o_buf + l_len, i_value.group_id);
+        l_len += CEzspU8Field<>::encode(o_buf + l_len, i_value.sequence);
+        return l_len;
+    }
+
+    static bool decode(CByteSpan& io_span, value_type& o_value)
+    {
+        uint16_t l_option = 0;
+
+        if( !CEzspParameters<CEzspU16Field, CEzspU16Field, CEzspU8Field<>, CEzspU8Field<>, CEzspU16Field, CEzspU16Field, CEzspU8Field<> >::decode(io_span,
+                o_value.profile_id, o_value.cluster_id, o_value.src_ep, o_value.dest_ep, l_option, o_value.group_id, o_value.sequence) )
+        {
+            return false;
+        }
+        o_value.option.SetEmberApsOption(l_option);
+        return true;
+    }
+};
+
+/**
+ * @brief Codec of an EmberGpAddress parameter
+ */
+struct CEzspGpAddressField
+{
+    typedef CEmberGpAddressStruct value_type;
+    static const size_t MAX_SIZE = EMBER_GP_ADDRESS_BYTE_SIZE;
+
+    static size_t encode(uint8_t* o_buf, const value_type& i_value)
+    {
+        const EmberEUI64& l_ieee = i_value.getGpdIeeeAddress();
+
+        o_buf[0] = i_value.getApplicationId();
+        for( size_t loop = 0; loop < EMBER_EUI64_BYTE_SIZE; loop++ )
+        {
+            o_buf[1 + loop] = (loop < l_ieee.size()) ? l_ieee[loop] : 0;
+        }
+        o_buf[1 + EMBER_EUI64_BYTE_SIZE] = i_value.getEndpoint();
+        return MAX_SIZE;
+    }
+
+    static bool decode(CByteSpan& io_span, value_type& o_value)
+    {
+        if( io_span.size() < MAX_SIZE )
+        {
+            return false;
+        }
+        o_value = CEmberGpAddressStruct(io_span.subspan(0, MAX_SIZE));
+        io_span = io_span.subspan(MAX_SIZE);
+        return true;
+    }
+};
+
+/**
+ * @brief EZSP_SET_CONFIGURATION_VALUE (configId, value) -> (status)
+ */
+typedef CEzspCommandCodec<EZSP_SET_CONFIGURATION_VALUE,
+        CEzspParameters<CEzspU8Field<>, CEzspU16Field>,
+        CEzspParameters<CEzspU8Field<> > > CEzspSetConfigurationValue;
+
+/**
+ * @brief EZSP_SET_POLICY (policyId, decisionId) -> (status)
+ */
+typedef CEzspCommandCodec<EZSP_SET_POLICY,
+        CEzspParameters<CEzspU8Field<>, CEzspU8Field<> >,
+        CEzspParameters<CEzspU8Field<> > > CEzspSetPolicy;
+
+/**
+ * @brief EZSP_ADD_ENDPOINT (endpoint, profileId, deviceId, appFlags, inputClusterCount, outputClusterCount, inputClusterList, outputClusterList) -> (status)
+ *
+ * @tparam IN The number of input clusters
+ * @tparam OUT The number of output clusters
+ */
+template <size_t IN, size_t OUT>
+using CEzspAddEndpoint = CEzspCommandCodec<EZSP_ADD_ENDPOINT,
+        CEzspParameters<CEzspU8Field<>, CEzspU16Field, CEzspU16Field, CEzspU8Field<>, CEzspU8Field<>, CEzspU8Field<>, CEzspU16ArrayField<IN>, CEzspU16ArrayField<OUT> >,
+        CEzspParameters<CEzspU8Field<> > >;
+
+/**
+ * Maximum length of the content of a message sent with EZSP_SEND_UNICAST
+ */
+#define EZSP_SEND_UNICAST_MAX_MESSAGE_LENGTH (EZSP_MAX_PARAMETERS_LENGTH - 16)
+
+/**
+ * @brief EZSP_SEND_UNICAST (type, indexOrDestination, apsFrame, messageTag, messageLength, messageContents) -> (status, sequence)
+ */
+typedef CEzspCommandCodec<EZSP_SEND_UNICAST,
+        CEzspParameters<CEzspU8Field<>, CEzspU16Field, CEzspApsFrameField, CEzspU8Field<>, CEzspVarBytesField<EZSP_SEND_UNICAST_MAX_MESSAGE_LENGTH> >,
+        CEzspParameters<CEzspU8Field<EEmberStatus>, CEzspU8Field<> > > CEzspSendUnicast;
+
+/**
+ * Maximum length of the content of a message sent with EZSP_SEND_BROADCAST
+ */
+#define EZSP_SEND_BROADCAST_MAX_MESSAGE_LENGTH (EZSP_MAX_PARAMETERS_LENGTH - 16)
+
+/**
+ * @brief EZSP_SEND_BROADCAST (destination, apsFrame, radius, messageTag, messageLength, messageContents) -> (status, sequence)
+ */
+typedef CEzspCommandCodec<EZSP_SEND_BROADCAST,
+        CEzspParameters<CEzspU16Field, CEzspApsFrameField, CEzspU8Field<>, CEzspU8Field<>, CEzspVarBytesField<EZSP_SEND_BROADCAST_MAX_MESSAGE_LENGTH> >,
+        CEzspParameters<CEzspU8Field<EEmberStatus>, CEzspU8Field<> > > CEzspSendBroadcast;
+
+/**
+ * Maximum length of the GPD command payload sent with EZSP_D_GP_SEND
+ */
+#define EZSP_D_GP_SEND_MAX_GPD_ASDU_LENGTH (EZSP_MAX_PARAMETERS_LENGTH - 17)
+
+/**
+ * @brief EZSP_D_GP_SEND (action, useCca, addr, gpdCommandId, gpdAsduLength, gpdAsdu, gpepHandle, gpTxQueueEntryLifetimeMs) -> (status)
+ */
+typedef CEzspCommandCodec<EZSP_D_GP_SEND,
+        CEzspParameters<CEzspU8Field<bool>, CEzspU8Field<bool>, CEzspGpAddressField, CEzspU8Field<>, CEzspVarBytesField<EZSP_D_GP_SEND_MAX_GPD_ASDU_LENGTH>, CEzspU8Field<>, CEzspU16Field>,
+        CEzspParameters<CEzspU8Field<EEmberStatus> > > CEzspDGpSend;
+
+/**
+ * @brief EZSP_D_GP_SENT_HANDLER callback () -> (status, gpepHandle)
+ */
+typedef CEzspCommandCodec<EZSP_D_GP_SENT_HANDLER,
+        CEzspParameters<>,
+        CEzspParameters<CEzspU8Field<EEmberStatus>, CEzspU8Field<> > > CEzspDGpSentHandler;
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
@@ -1,26 +1,29 @@
 /**
  * 
  */
-#include <map>
+#include <string>
+
+#include "../enum-name-table.h"
 
 #include "ezsp-enum.h"
 
 std::string CEzspEnum::EmberNodeTypeToString( EmberNodeType in )
 {
-    const std::map<EmberNodeType,std::string> MyEnumStrings {
+    static const CEnumNameTable::SEntry entries[] = {
         { EMBER_UNKNOWN_DEVICE, "EMBER_UNKNOWN_DEVICE" },
         { EMBER_COORDINATOR, "EMBER_COORDINATOR" },
         { EMBER_ROUTER, "EMBER_ROUTER" },
         { EMBER_END_DEVICE, "EMBER_END_DEVICE" },
         { EMBER_SLEEPY_END_DEVICE, "EMBER_SLEEPY_END_DEVICE" },
     };
-    auto   it  = MyEnumStrings.find(in);
-    return it == MyEnumStrings.end() ? "OUT_OF_RANGE" : it->second;   
+    static const CEnumNameTable names(entries);
+    const char* name = names.find(in);
+    return (name != nullptr) ? name : "OUT_OF_RANGE";
 }
 
 std::string CEzspEnum::EEmberStatusToString( EEmberStatus in )
 {
-    const std::map<EEmberStatus,std::string> MyEnumStrings {
+    static const CEnumNameTable::SEntry entries[] = {
         { EMBER_SUCCESS, "EMBER_SUCCESS" },
         { EMBER_ERR_FATAL, "EMBER_ERR_FATAL" },
         { EMBER_NO_BUFFERS, "EMBER_NO_BUFFERS" },
@@ -42,25 +45,27 @@ std::string CEzspEnum::EEmberStatusToString( EEmberStatus in )
         { EMBER_RECEIVED_KEY_IN_THE_CLEAR, "EMBER_RECEIVED_KEY_IN_THE_CLEAR" },
         { EMBER_NO_NETWORK_KEY_RECEIVED, "EMBER_NO_NETWORK_KEY_RECEIVED" }
     };
-    auto   it  = MyEnumStrings.find(in);
-    return it == MyEnumStrings.end() ? "OUT_OF_RANGE : " + std::to_string(in) : it->second;      
+    static const CEnumNameTable names(entries);
+    const char* name = names.find(in);
+    return (name != nullptr) ? std::string(name) : "OUT_OF_RANGE : " + std::to_string(in);
 }
 
 std::string CEzspEnum::EmberJoinMethodToString( EmberJoinMethod in )
 {
-    const std::map<EmberJoinMethod,std::string> MyEnumStrings {
+    static const CEnumNameTable::SEntry entries[] = {
         { EMBER_USE_MAC_ASSOCIATION, "EMBER_USE_MAC_ASSOCIATION" },
         { EMBER_USE_NWK_REJOIN, "EMBER_USE_NWK_REJOIN" },
         { EMBER_USE_NWK_REJOIN_HAVE_NWK_KEY, "EMBER_USE_NWK_REJOIN_HAVE_NWK_KEY" },
         { EMBER_USE_NWK_COMMISSIONING, "EMBER_USE_NWK_COMMISSIONING" }
     };
-    auto   it  = MyEnumStrings.find(in);
-    return it == MyEnumStrings.end() ? "OUT_OF_RANGE" : it->second;    
+    static const CEnumNameTable names(entries);
+    const char* name = names.find(in);
+    return (name != nullptr) ? name : "OUT_OF_RANGE";
 }
 
 std::string CEzspEnum::EEzspCmdToString( EEzspCmd in )
 {
-    const std::map<EEzspCmd,std::string> MyEnumStrings {
+    static const CEnumNameTable::SEntry entries[] = {
         /* Configuration Frames */
         { EZSP_VERSION, "EZSP_VERSION" },
         { EZSP_GET_CONFIGURATION_VALUE, "EZSP_GET_CONFIGURATION_VALUE" },
@@ -281,26 +286,28 @@ std::string CEzspEnum::EEzspCmdToString( EEzspCmd in )
         /* Secure EZSP */
         /* --- */
     };
-    auto   it  = MyEnumStrings.find(in);
-    return it == MyEnumStrings.end() ? "OUT_OF_RANGE" : it->second;    
+    static const CEnumNameTable names(entries);
+    const char* name = names.find(in);
+    return (name != nullptr) ? name : "OUT_OF_RANGE";
 }
 
 std::string CEzspEnum::EmberKeyTypeToString( EmberKeyType in )
 {
-    const std::map<EmberKeyType,std::string> MyEnumStrings {
+    static const CEnumNameTable::SEntry entries[] = {
         { EMBER_TRUST_CENTER_LINK_KEY, "EMBER_TRUST_CENTER_LINK_KEY" },
         { EMBER_CURRENT_NETWORK_KEY, "EMBER_CURRENT_NETWORK_KEY" },
         { EMBER_NEXT_NETWORK_KEY, "EMBER_NEXT_NETWORK_KEY" },
         { EMBER_APPLICATION_LINK_KEY, "EMBER_APPLICATION_LINK_KEY" }
     };
-    auto   it  = MyEnumStrings.find(in);
-    return it == MyEnumStrings.end() ? "OUT_OF_RANGE" : it->second;    
+    static const CEnumNameTable names(entries);
+    const char* name = names.find(in);
+    return (name != nullptr) ? name : "OUT_OF_RANGE";
 }
 
 
 std::string CEzspEnum::EmberIncomingMessageTypeToString( EmberIncomingMessageType in )
 {
-    const std::map<EmberIncomingMessageType,std::string> MyEnumStrings {
+    static const CEnumNameTable::SEntry entries[] = {
         { EMBER_INCOMING_UNICAST, "EMBER_INCOMING_UNICAST" },
         { EMBER_INCOMING_UNICAST_REPLY, "EMBER_INCOMING_UNICAST_REPLY" },
         { EMBER_INCOMING_MULTICAST, "EMBER_INCOMING_MULTICAST" },
@@ -309,6 +316,7 @@ std::string CEzspEnum::EmberIncomingMessageTypeToString( EmberIncomingMessageTyp
         { EMBER_INCOMING_BROADCAST_LOOPBACK, "EMBER_INCOMING_BROADCAST_LOOPBACK" },
         { EMBER_INCOMING_MANY_TO_ONE_ROUTE_REQUEST, "EMBER_INCOMING_MANY_TO_ONE_ROUTE_REQUEST" }
     };
-    auto   it  = MyEnumStrings.find(in);
-    return it == MyEnumStrings.end() ? "OUT_OF_RANGE" : it->second;      
+    static const CEnumNameTable names(entries);
+    const char* name = names.find(in);
+    return (name != nullptr) ? name : "OUT_OF_RANGE";
 }
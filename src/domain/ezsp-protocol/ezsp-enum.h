@@ -1029,6 +1029,8 @@ typedef std::vector<uint8_t> EmberKeyData;
 #define EMBER_EUI64_BYTE_SIZE  8
 typedef std::vector<uint8_t> EmberEUI64;
 
+#define EMBER_GP_ADDRESS_BYTE_SIZE  (EMBER_EUI64_BYTE_SIZE+2) // application id, source id or IEEE address, endpoint
+
 typedef enum
 {
     DONGLE_READY,
@@ -7,13 +7,21 @@
 #include <sstream>
 
 #include "get-network-parameters-response.h"
+#include "../byte-cursor.h"
 
-CGetNetworkParamtersResponse::CGetNetworkParamtersResponse(const std::vector<uint8_t>& raw_message) :
-	status(static_cast<EEmberStatus>(raw_message.at(0))),
-	node_type(static_cast<EmberNodeType>(raw_message.at(1))),
+CGetNetworkParamtersResponse::CGetNetworkParamtersResponse(const CByteSpan& raw_message) :
+	status(EMBER_ERR_FATAL),
+	node_type(),
 	parameters(raw_message,2)
-
 {
+    CByteReader l_reader(raw_message);
+
+    status = static_cast<EEmberStatus>(l_reader.readU8());
+    node_type = static_cast<EmberNodeType>(l_reader.readU8());
+    if( !l_reader.isValid() )
+    {
+        status = EMBER_ERR_FATAL;
+    }
 }
 
 std::string CGetNetworkParamtersResponse::String() const
@@ -30,7 +30,7 @@ class CGetNetworkParamtersResponse
          *
          * @param raw_message The buffer to construct from
          */
-        CGetNetworkParamtersResponse(const std::vector<uint8_t>& raw_message);
+        CGetNetworkParamtersResponse(const CByteSpan& raw_message);
 
         /**
          * @brief Copy constructor
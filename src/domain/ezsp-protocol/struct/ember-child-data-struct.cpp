@@ -9,24 +9,29 @@
 
 #include "ember-child-data-struct.h"
 
-#include "../../byte-manip.h"
+#include "../../byte-cursor.h"
 
-CEmberChildDataStruct::CEmberChildDataStruct(const std::vector<uint8_t>& raw_message) :
+CEmberChildDataStruct::CEmberChildDataStruct(const CByteSpan& raw_message) :
 	eui64(),
-	type(static_cast<EmberNodeType>(raw_message.at(EMBER_EUI64_BYTE_SIZE))),
-	id(static_cast<EmberNodeId>(dble_u8_to_u16(raw_message.at(EMBER_EUI64_BYTE_SIZE+2), raw_message.at(EMBER_EUI64_BYTE_SIZE+1)))),
-	phy(raw_message.at(EMBER_EUI64_BYTE_SIZE+3)),
-	power(raw_message.at(EMBER_EUI64_BYTE_SIZE+4)),
-	timeout(raw_message.at(EMBER_EUI64_BYTE_SIZE+5)),
+	type(),
+	id(),
+	phy(),
+	power(),
+	timeout(),
 	gpdIeeeAddress(),	/* FIXME */
 	sourceId(),	/* FIXME */
 	applicationId(), /* FIXME */
 	endpoint() /* FIXME */
 {
-    for(uint8_t loop=0; loop<EMBER_EUI64_BYTE_SIZE; loop++)
-    {
-        eui64.push_back(raw_message.at(loop));
-    }
+    CByteReader l_reader(raw_message);
+
+    CByteSpan l_eui64 = l_reader.readBytes(EMBER_EUI64_BYTE_SIZE);
+    eui64.assign(l_eui64.begin(), l_eui64.end());
+    type = static_cast<EmberNodeType>(l_reader.readU8());
+    id = static_cast<EmberNodeId>(l_reader.readU16());
+    phy = l_reader.readU8();
+    power = l_reader.readU8();
+    timeout = l_reader.readU8();
     //    if( raw_message.size() > 17 ) // todo associate to node type
     //    {
     //        gpdIeeeAddress.clear();
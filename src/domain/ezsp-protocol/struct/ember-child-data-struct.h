@@ -7,6 +7,7 @@
 #pragma once
 
 #include "../ezsp-enum.h"
+#include "../../byte-span.h"
 
 class CEmberChildDataStruct
 {
@@ -23,7 +24,7 @@ class CEmberChildDataStruct
          *
          * @param raw_message The buffer to construct from
          */
-        CEmberChildDataStruct(const std::vector<uint8_t>& raw_message);
+        CEmberChildDataStruct(const CByteSpan& raw_message);
 
         /**
          * @brief Assignment operator
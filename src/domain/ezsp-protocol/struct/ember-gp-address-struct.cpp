@@ -7,6 +7,7 @@
 #include <iomanip>
 
 #include "ember-gp-address-struct.h"
+#include "../../byte-cursor.h"
 
 CEmberGpAddressStruct::CEmberGpAddressStruct():
 	gpdIeeeAddress({0,0,0,0,0,0,0,0}),
@@ -22,11 +23,18 @@ CEmberGpAddressStruct::CEmberGpAddressStruct(const CEmberGpAddressStruct& other)
 {
 }
 
-CEmberGpAddressStruct::CEmberGpAddressStruct(const std::vector<uint8_t>& raw_message):
-	gpdIeeeAddress(raw_message.begin()+1,raw_message.begin()+1+EMBER_EUI64_BYTE_SIZE),
-	applicationId(raw_message.at(0)),
-	endpoint(raw_message.at(EMBER_EUI64_BYTE_SIZE+1))
+CEmberGpAddressStruct::CEmberGpAddressStruct(const CByteSpan& raw_message):
+	gpdIeeeAddress(),
+	applicationId(),
+	endpoint()
 {
+    CByteReader l_reader(raw_message);
+
+    applicationId = l_reader.readU8();
+    CByteSpan l_ieee = l_reader.readBytes(EMBER_EUI64_BYTE_SIZE);
+    gpdIeeeAddress.assign(l_ieee.begin(), l_ieee.end());
+    gpdIeeeAddress.resize(EMBER_EUI64_BYTE_SIZE, 0);
+    endpoint = l_reader.readU8();
 }
 
 /**
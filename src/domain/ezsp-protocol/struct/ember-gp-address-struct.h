@@ -7,6 +7,7 @@
 
 #include "../ezsp-enum.h"
 #include "../../byte-manip.h"
+#include "../../byte-span.h"
 
 class CEmberGpAddressStruct
 {
@@ -28,7 +29,7 @@ class CEmberGpAddressStruct
          *
          * @param raw_message The buffer to construct from
          */
-        CEmberGpAddressStruct(const std::vector<uint8_t>& raw_message);
+        CEmberGpAddressStruct(const CByteSpan& raw_message);
 
         /**
          * @brief Construct from sourceId
@@ -59,7 +60,7 @@ class CEmberGpAddressStruct
         /**
          * @brief The GPD's EUI64.
          */
-        EmberEUI64 getGpdIeeeAddress() const { return gpdIeeeAddress; }
+        const EmberEUI64& getGpdIeeeAddress() const { return gpdIeeeAddress; }
 
         /**
          * @brief The GPD's source ID. not mention in ezsp specification but ieee and sourceId is an union
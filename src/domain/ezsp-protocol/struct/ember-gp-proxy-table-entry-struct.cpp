@@ -9,21 +9,33 @@
 
 #include "ember-gp-proxy-table-entry-struct.h"
 
-#include "../../byte-manip.h"
+#include "../../byte-cursor.h"
 
 /** \todo Verify value !!! */
-CEmberGpProxyTableEntryStruct::CEmberGpProxyTableEntryStruct(const std::vector<uint8_t>& raw_message) :
+CEmberGpProxyTableEntryStruct::CEmberGpProxyTableEntryStruct(const CByteSpan& raw_message) :
         /*security_link_key(raw_message.begin(),raw_message.begin()+EMBER_KEY_DATA_BYTE_SIZE),*/
-        status(raw_message.at(0)),
-        options(quad_u8_to_u32(raw_message.at(4),raw_message.at(3),raw_message.at(2),raw_message.at(1))),
-        gpd(std::vector<uint8_t>(raw_message.begin()+5,raw_message.end())),
-        assigned_alias(dble_u8_to_u16(raw_message.at(16),raw_message.at(15))),
-        security_options(raw_message.at(17)),
-        gpdSecurityFrameCounter(static_cast<EmberGpSecurityFrameCounter>(quad_u8_to_u32(raw_message.at(21),raw_message.at(20),raw_message.at(19),raw_message.at(18)))),
-        gpd_key(raw_message.begin()+22,raw_message.begin()+22+EMBER_KEY_DATA_BYTE_SIZE),
+        status(),
+        options(),
+        gpd(),
+        assigned_alias(),
+        security_options(),
+        gpdSecurityFrameCounter(),
+        gpd_key(),
         sink_list(),
-        groupcast_radius(raw_message.at(60)),
-        search_counter(raw_message.at(61))
+        groupcast_radius(),
+        search_counter()
 {
+    CByteReader l_reader(raw_message);
 
+    status = l_reader.readU8();
+    options = l_reader.readU32();
+    gpd = CEmberGpAddressStruct(l_reader.readBytes(EMBER_GP_ADDRESS_BYTE_SIZE));
+    assigned_alias = l_reader.readU16();
+    security_options = l_reader.readU8();
+    gpdSecurityFrameCounter = static_cast<EmberGpSecurityFrameCounter>(l_reader.readU32());
+    CByteSpan l_key = l_reader.readBytes(EMBER_KEY_DATA_BYTE_SIZE);
+    gpd_key.assign(l_key.begin(), l_key.end());
+    l_reader.skip(GP_SINK_LIST_ENTRIES * EMBER_GP_SINK_LIST_ENTRY_SIZE);    // sink list, not decoded
+    groupcast_radius = l_reader.readU8();
+    search_counter = l_reader.readU8();
 }
\ No newline at end of file
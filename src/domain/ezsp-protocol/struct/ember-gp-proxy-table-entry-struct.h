@@ -30,7 +30,7 @@ class CEmberGpProxyTableEntryStruct
          *
          * @param raw_message The buffer to construct from
          */
-        CEmberGpProxyTableEntryStruct(const std::vector<uint8_t>& raw_message);
+        CEmberGpProxyTableEntryStruct(const CByteSpan& raw_message);
 
         /**
          * @brief Copy constructor
@@ -10,6 +10,7 @@
 #include "ember-gp-sink-table-entry-struct.h"
 
 #include "../../byte-manip.h"
+#include "../../byte-cursor.h"
 
 CEmberGpSinkTableEntryStruct::CEmberGpSinkTableEntryStruct():
         status(0xFF),
@@ -27,18 +28,32 @@ CEmberGpSinkTableEntryStruct::CEmberGpSinkTableEntryStruct():
     sink_list[1].push_back(0xFF);
 }
 
-CEmberGpSinkTableEntryStruct::CEmberGpSinkTableEntryStruct(const std::vector<uint8_t>& raw_message):
-        status(raw_message.at(0)),
-        options(dble_u8_to_u16(raw_message.at(2),raw_message.at(1))),
-        gpd(std::vector<uint8_t>(raw_message.begin()+3,raw_message.end())),
-        device_id(raw_message.at(13)),
+CEmberGpSinkTableEntryStruct::CEmberGpSinkTableEntryStruct(const CByteSpan& raw_message):
+        status(),
+        options(),
+        gpd(),
+        device_id(),
         sink_list(),
-        assigned_alias(dble_u8_to_u16(raw_message.at(37),raw_message.at(36))),
-        groupcast_radius(raw_message.at(38)),
-        security_options(raw_message.at(39)),
-        gpdSecurity_frame_counter(static_cast<EmberGpSecurityFrameCounter>(quad_u8_to_u32(raw_message.at(43),raw_message.at(42),raw_message.at(41),raw_message.at(40)))),
-        gpd_key(raw_message.begin()+44,raw_message.begin()+60)
+        assigned_alias(),
+        groupcast_radius(),
+        security_options(),
+        gpdSecurity_frame_counter(),
+        gpd_key()
 {
+    CByteReader l_reader(raw_message);
+
+    status = l_reader.readU8();
+    options = CEmberGpSinkTableOption(l_reader.readU16());
+    gpd = CEmberGpAddressStruct(l_reader.readBytes(EMBER_GP_ADDRESS_BYTE_SIZE));
+    device_id = l_reader.readU8();
+    l_reader.skip(GP_SINK_LIST_ENTRIES * EMBER_GP_SINK_LIST_ENTRY_SIZE);    // sink list, not decoded
+    assigned_alias = l_reader.readU16();
+    groupcast_radius = l_reader.readU8();
+    security_options = l_reader.readU8();
+    gpdSecurity_frame_counter = static_cast<EmberGpSecurityFrameCounter>(l_reader.readU32());
+    CByteSpan l_key = l_reader.readBytes(EMBER_KEY_DATA_BYTE_SIZE);
+    gpd_key.assign(l_key.begin(), l_key.end());
+
     sink_list[0].push_back(0xFF);
     sink_list[1].push_back(0xFF);
 }
@@ -118,10 +133,12 @@ std::vector<uint8_t> CEmberGpSinkTableEntryStruct::getRaw() const
     l_struct.insert(l_struct.end(), l_addr.begin(), l_addr.end());
     // The device id for the GPD.
     l_struct.push_back(device_id);
-    // The list of sinks (hardcoded to 2 which is the spec minimum).
+    // The list of sinks (hardcoded to 2 which is the spec minimum), each entry taking EMBER_GP_SINK_LIST_ENTRY_SIZE bytes (padded with 0xFF, like unused entries).
     for( int loop=0; loop<GP_SINK_LIST_ENTRIES; loop++ )
     {
-        l_struct.insert(l_struct.end(), sink_list[loop].begin(), sink_list[loop].end());
+        EmberGpSinkListEntry l_sink = sink_list[loop];
+        l_sink.resize(EMBER_GP_SINK_LIST_ENTRY_SIZE, 0xFF);
+        l_struct.insert(l_struct.end(), l_sink.begin(), l_sink.end());
     }
     // The assigned alias for the GPD.
     l_struct.push_back(u16_get_lo_u8(assigned_alias));
@@ -136,8 +153,10 @@ std::vector<uint8_t> CEmberGpSinkTableEntryStruct::getRaw() const
     l_struct.push_back(static_cast<uint8_t>((gpdSecurity_frame_counter>>16)&0xFF));
     l_struct.push_back(static_cast<uint8_t>((gpdSecurity_frame_counter>>24)&0xFF));
 
-    // The key to use for GPD.
-    l_struct.insert(l_struct.end(), gpd_key.begin(), gpd_key.end());
+    // The key to use for GPD (all 0 if not set).
+    EmberKeyData l_key = gpd_key;
+    l_key.resize(EMBER_KEY_DATA_BYTE_SIZE, 0);
+    l_struct.insert(l_struct.end(), l_key.begin(), l_key.end());
 
     return l_struct;
 }
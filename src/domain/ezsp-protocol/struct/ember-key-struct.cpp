@@ -9,33 +9,28 @@
 
 #include "ember-key-struct.h"
 
-#include "../../byte-manip.h"
+#include "../../byte-cursor.h"
 
-CEmberKeyStruct::CEmberKeyStruct(const std::vector<uint8_t>& raw_message) :
-	bitmask(static_cast<EmberKeyStructBitmask>(dble_u8_to_u16(raw_message.at(1), raw_message.at(0)))),
-	type(static_cast<EmberKeyType>(raw_message.at(2))),
+CEmberKeyStruct::CEmberKeyStruct(const CByteSpan& raw_message) :
+	bitmask(),
+	type(),
 	key(),
-	outgoingFrameCounter(
-		static_cast<uint32_t>(raw_message.at(19)) |
-		static_cast<uint32_t>(raw_message.at(20))<<8 |
-		static_cast<uint32_t>(raw_message.at(21))<<16 |
-		static_cast<uint32_t>(raw_message.at(22))<<24),
-	incomingFrameCounter(
-		static_cast<uint32_t>(raw_message.at(23)) |
-		static_cast<uint32_t>(raw_message.at(24))<<8 |
-		static_cast<uint32_t>(raw_message.at(25))<<16 |
-		static_cast<uint32_t>(raw_message.at(26))<<24),
-	sequenceNumber(static_cast<EmberKeyType>(raw_message.at(27))),
+	outgoingFrameCounter(),
+	incomingFrameCounter(),
+	sequenceNumber(),
 	partnerEUI64()
 {
-    for(uint8_t loop=0; loop<EMBER_KEY_DATA_BYTE_SIZE; loop++)
-    {
-        key.push_back( raw_message.at(3U+loop) );
-    }
-    for(uint8_t loop=0; loop<EMBER_EUI64_BYTE_SIZE; loop++)
-    {
-        partnerEUI64.push_back(raw_message.at(28U+loop));
-    }
+    CByteReader l_reader(raw_message);
+
+    bitmask = static_cast<EmberKeyStructBitmask>(l_reader.readU16());
+    type = static_cast<EmberKeyType>(l_reader.readU8());
+    CByteSpan l_key = l_reader.readBytes(EMBER_KEY_DATA_BYTE_SIZE);
+    key.assign(l_key.begin(), l_key.end());
+    outgoingFrameCounter = l_reader.readU32();
+    incomingFrameCounter = l_reader.readU32();
+    sequenceNumber = static_cast<EmberKeyType>(l_reader.readU8());
+    CByteSpan l_partner = l_reader.readBytes(EMBER_EUI64_BYTE_SIZE);
+    partnerEUI64.assign(l_partner.begin(), l_partner.end());
 }
 
 std::string CEmberKeyStruct::String() const
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "../ezsp-enum.h"
+#include "../../byte-span.h"
 
 #ifdef USE_RARITAN
 /**** Start of the official API; no includes below this point! ***************/
@@ -28,7 +29,7 @@ class CEmberKeyStruct
          *
          * @param raw_message The buffer to construct from
          */
-        CEmberKeyStruct(const std::vector<uint8_t>& raw_message);
+        CEmberKeyStruct(const CByteSpan& raw_message);
 
         /**
          * @brief Copy constructor
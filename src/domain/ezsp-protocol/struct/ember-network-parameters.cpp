@@ -7,6 +7,7 @@
 #include "ember-network-parameters.h"
 
 #include "../../byte-manip.h"
+#include "../../byte-cursor.h"
 
 CEmberNetworkParameters::CEmberNetworkParameters() :
 	extend_pan_id(0),
@@ -32,28 +33,26 @@ CEmberNetworkParameters::CEmberNetworkParameters(const CEmberNetworkParameters&
 {
 }
 
-CEmberNetworkParameters::CEmberNetworkParameters(const std::vector<uint8_t>& raw_message, const std::string::size_type skip) :
-	extend_pan_id(
-		static_cast<uint64_t>(raw_message.at(0+skip)) |
-		static_cast<uint64_t>(raw_message.at(1+skip))<<8 |
-		static_cast<uint64_t>(raw_message.at(2+skip))<<16 |
-		static_cast<uint64_t>(raw_message.at(3+skip))<<24 |
-		static_cast<uint64_t>(raw_message.at(4+skip))<<32 |
-		static_cast<uint64_t>(raw_message.at(5+skip))<<40 |
-		static_cast<uint64_t>(raw_message.at(6+skip))<<48 |
-		static_cast<uint64_t>(raw_message.at(7+skip))<<56),
-	pan_id(dble_u8_to_u16(raw_message.at(9+skip), raw_message.at(8+skip))),
-	radio_tx_power(raw_message.at(10+skip)),
-	radio_channel(raw_message.at(11+skip)),
-	join_method(static_cast<EmberJoinMethod>(raw_message.at(12+skip))),
-	nwk_manager_id(static_cast<EmberNodeId>(dble_u8_to_u16(raw_message.at(14+skip), raw_message.at(13+skip)))),
-	nwk_update_id(raw_message.at(15+skip)),
-	channels(
-		static_cast<uint32_t>(raw_message.at(16)) |
-		static_cast<uint32_t>(raw_message.at(17))<<8 |
-		static_cast<uint32_t>(raw_message.at(18))<<16 |
-		static_cast<uint32_t>(raw_message.at(19))<<24)
+CEmberNetworkParameters::CEmberNetworkParameters(const CByteSpan& raw_message, const std::string::size_type skip) :
+	extend_pan_id(0),
+	pan_id(0),
+	radio_tx_power(0),
+	radio_channel(0),
+	join_method(EMBER_USE_MAC_ASSOCIATION),
+	nwk_manager_id(0),
+	nwk_update_id(0),
+	channels(0)
 {
+    CByteReader l_reader(raw_message.subspan(skip));
+
+    extend_pan_id = l_reader.readU64();
+    pan_id = l_reader.readU16();
+    radio_tx_power = l_reader.readU8();
+    radio_channel = l_reader.readU8();
+    join_method = static_cast<EmberJoinMethod>(l_reader.readU8());
+    nwk_manager_id = static_cast<EmberNodeId>(l_reader.readU16());
+    nwk_update_id = l_reader.readU8();
+    channels = l_reader.readU32();
 }
 
 std::vector<uint8_t> CEmberNetworkParameters::getRaw() const
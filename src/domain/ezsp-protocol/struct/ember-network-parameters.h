@@ -4,6 +4,7 @@
 #pragma once
 
 #include "../ezsp-enum.h"
+#include "../../byte-span.h"
 #include <vector>
 #include <string>
 
@@ -26,7 +27,7 @@ class CEmberNetworkParameters
          * @param raw_message The buffer to construct from
          * @param skip The number of leading bytes to skip in buffer @p raw_message
          */
-        CEmberNetworkParameters(const std::vector<uint8_t>& raw_message, const std::string::size_type skip = 0);
+        CEmberNetworkParameters(const CByteSpan& raw_message, const std::string::size_type skip = 0);
 
         /**
          * @brief Copy constructor
@@ -0,0 +1,194 @@
+/**
+ * @file ezsp-rx-executor.cpp
+ *
+ * @brief Hand-off of incoming EZSP frames from the UART read thread to the application
+ */
+
+#include <cstring>
+
+#include "ezsp-rx-executor.h"
+#include "../spi/GenericLogger.h"
+
+CEzspRxExecutor::CEzspRxExecutor(FEzspRxDispatch i_dispatch) :
+    dispatchFct(i_dispatch),
+    mode_m(),
+    queue(nullptr),
+    policy(EZSP_RX_OVERFLOW_DROP),
+    worker(),
+    wake_m(),
+    wake(),
+    stopping(false),
+    producerWaiting(false),
+    maxDepth(0),
+    queued(0),
+    dispatched(0),
+    dropped(0),
+    blocked(0),
+    maxLatency(0),
+    totalLatency(0)
+{
+}
+
+CEzspRxExecutor::~CEzspRxExecutor()
+{
+    stop();
+}
+
+bool CEzspRxExecutor::start(size_t i_capacity, EEzspRxOverflowPolicy i_policy)
+{
+    std::lock_guard<std::recursive_mutex> l_mode_lock(mode_m);
+
+    if( nullptr != queue )
+    {
+        return false;
+    }
+    policy = i_policy;
+    stopping = false;
+    queue = new CSpscQueue<SEzspRxItem>(i_capacity);
+    worker = std::thread(&CEzspRxExecutor::run, this);
+    return true;
+}
+
+void CEzspRxExecutor::stop()
+{
+    std::lock_guard<std::recursive_mutex> l_mode_lock(mode_m);
+
+    if( nullptr == queue )
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> l_lock(wake_m);
+        stopping = true;
+    }
+    wake.notify_all();
+    // the dispatch thread only terminates once the queue has been drained
+    worker.join();
+    delete queue;
+    queue = nullptr;
+}
+
+bool CEzspRxExecutor::isAsync() const
+{
+    std::lock_guard<std::recursive_mutex> l_mode_lock(mode_m);
+
+    return nullptr != queue;
+}
+
+bool CEzspRxExecutor::dispatch(CByteSpan i_frame)
+{
+    std::lock_guard<std::recursive_mutex> l_mode_lock(mode_m);
+
+    if( nullptr == queue )
+    {
+        // synchronous mode
+        dispatchFct(i_frame);
+        dispatched++;
+        return true;
+    }
+
+    if( i_frame.size() > EZSP_RX_MAX_FRAME_SIZE )
+    {
+        clogE << "CEzspRxExecutor::dispatch dropping oversized frame of " << i_frame.size() << " bytes" << std::endl;
+        dropped++;
+        return false;
+    }
+
+    SEzspRxItem* l_slot = queue->back();
+    if( nullptr == l_slot )
+    {
+        if( EZSP_RX_OVERFLOW_DROP == policy )
+        {
+            dropped++;
+            return false;
+        }
+
+        // wait for the dispatch thread to make room (it wakes us up after each frame while we are waiting, the timeout only guards against a missed notification)
+        blocked++;
+        std::unique_lock<std::mutex> l_lock(wake_m);
+        producerWaiting = true;
+        while( nullptr == (l_slot = queue->back()) )
+        {
+            wake.wait_for(l_lock, std::chrono::milliseconds(1));
+        }
+        producerWaiting = false;
+    }
+
+    std::memcpy(l_slot->data, i_frame.data(), i_frame.size());
+    l_slot->len = i_frame.size();
+    l_slot->queued = std::chrono::steady_clock::now();
+    queue->push();
+    queued++;
+
+    size_t l_depth = queue->size();
+    if( l_depth > maxDepth )
+    {
+        maxDepth = l_depth;
+    }
+
+    {
+        std::lock_guard<std::mutex> l_lock(wake_m);
+    }
+    wake.notify_all();
+    return true;
+}
+
+SEzspRxMetrics CEzspRxExecutor::getMetrics() const
+{
+    SEzspRxMetrics lo_metrics;
+
+    {
+        std::lock_guard<std::recursive_mutex> l_mode_lock(mode_m);
+        lo_metrics.depth = (nullptr != queue) ? queue->size() : 0;
+    }
+    lo_metrics.max_depth = maxDepth;
+    lo_metrics.queued = queued;
+    lo_metrics.dispatched = dispatched;
+    lo_metrics.dropped = dropped;
+    lo_metrics.blocked = blocked;
+    lo_metrics.max_latency = maxLatency;
+    lo_metrics.total_latency = totalLatency;
+    return lo_metrics;
+}
+
+void CEzspRxExecutor::run()
+{
+    for( ;; )
+    {
+        SEzspRxItem* l_item = queue->front();
+
+        if( nullptr == l_item )
+        {
+            std::unique_lock<std::mutex> l_lock(wake_m);
+            wake.wait(l_lock, [this]{ return stopping || !queue->empty(); });
+            if( queue->empty() )
+            {
+                // stopping, and nothing left to dispatch
+                return;
+            }
+            continue;
+        }
+
+        // free the slot before dispatching, so that the frame being dispatched does not count in the capacity
+        SEzspRxItem l_frame = *l_item;
+        queue->pop();
+
+        uint64_t l_latency = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - l_frame.queued).count());
+        totalLatency += l_latency;
+        if( l_latency > maxLatency )
+        {
+            maxLatency = static_cast<uint32_t>(l_latency);
+        }
+
+        if( producerWaiting )
+        {
+            {
+                std::lock_guard<std::mutex> l_lock(wake_m);
+            }
+            wake.notify_all();
+        }
+
+        dispatchFct(CByteSpan(l_frame.data, l_frame.len));
+        dispatched++;
+    }
+}
@@ -0,0 +1,155 @@
+/**
+ * @file ezsp-rx-executor.h
+ *
+ * @brief Hand-off of incoming EZSP frames from the UART read thread to the application
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "ash.h"
+#include "byte-span.h"
+#include "spsc-queue.h"
+
+/**
+ * Default number of frames that can wait to be dispatched to the application
+ */
+#define EZSP_RX_DEFAULT_QUEUE_CAPACITY 32
+
+/**
+ * Largest frame that can be handed off (EZSP frame and its 2 bytes of CRC)
+ */
+#define EZSP_RX_MAX_FRAME_SIZE (ASH_MAX_DATA_LENGTH + 2)
+
+/**
+ * @brief What to do with an incoming frame when the hand-off queue is full
+ */
+typedef enum {
+  EZSP_RX_OVERFLOW_DROP,    /*!< Discard the incoming frame, the UART is never blocked by the application */
+  EZSP_RX_OVERFLOW_BLOCK    /*!< Wait for the application to make room, no frame is lost but the UART read thread is stalled */
+}EEzspRxOverflowPolicy;
+
+/**
+ * @brief Statistics on the hand-off queue
+ */
+typedef struct {
+  size_t depth;   /*!< Number of frames currently waiting */
+  size_t max_depth;   /*!< Highest number of frames that have been waiting simultaneously */
+  uint32_t queued;    /*!< Total number of frames handed off */
+  uint32_t dispatched;    /*!< Total number of frames dispatched to the application */
+  uint32_t dropped;   /*!< Number of frames discarded because the queue was full (or the frame too large) */
+  uint32_t blocked;   /*!< Number of times the producer had to wait for room in the queue */
+  uint32_t max_latency;   /*!< Longest time (in us) a frame waited in the queue */
+  uint64_t total_latency; /*!< Sum of the time (in us) all dispatched frames waited in the queue */
+}SEzspRxMetrics;
+
+/**
+ * @brief A frame waiting in the hand-off queue
+ */
+struct SEzspRxItem
+{
+    SEzspRxItem() : data(), len(0), queued() {}
+
+    uint8_t data[EZSP_RX_MAX_FRAME_SIZE];
+    size_t len;
+    std::chrono::steady_clock::time_point queued;   /*!< When the frame has been handed off */
+};
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief Executor dispatching incoming EZSP frames to the application
+ *
+ * By default (synchronous mode), frames are dispatched from the thread that calls dispatch(), ie the UART read thread.
+ * Once start() has been invoked, frames are copied into a bounded single-producer single-consumer queue and dispatched from a dedicated thread, so that slow
+ * application handlers cannot delay the UART and ASH processing anymore.
+ * dispatch() must always be invoked from the same thread, start() and stop() can be invoked from any thread but the dispatch thread.
+ */
+class CEzspRxExecutor
+{
+public:
+    /**
+     * @brief Function invoked for each frame, the view is only valid during the invocation
+     */
+    typedef std::function<void (CByteSpan i_frame)> FEzspRxDispatch;
+
+    /**
+     * @brief Constructor
+     *
+     * @param i_dispatch The function dispatching a frame to the application
+     */
+    explicit CEzspRxExecutor(FEzspRxDispatch i_dispatch);
+
+    CEzspRxExecutor(const CEzspRxExecutor&) = delete;
+    CEzspRxExecutor& operator=(const CEzspRxExecutor&) = delete;
+
+    ~CEzspRxExecutor();
+
+    /**
+     * @brief Switch to asynchronous mode, starting the dispatch thread
+     *
+     * @param i_capacity The number of frames that can wait to be dispatched
+     * @param i_policy What to do when a frame arrives while i_capacity frames are already waiting
+     *
+     * @return false if already started
+     */
+    bool start(size_t i_capacity = EZSP_RX_DEFAULT_QUEUE_CAPACITY, EEzspRxOverflowPolicy i_policy = EZSP_RX_OVERFLOW_DROP);
+
+    /**
+     * @brief Switch back to synchronous mode, once all the frames waiting have been dispatched
+     */
+    void stop();
+
+    /**
+     * @brief Is the dispatch thread running?
+     */
+    bool isAsync() const;
+
+    /**
+     * @brief Dispatch a frame (immediately in synchronous mode, later from the dispatch thread in asynchronous mode)
+     *
+     * @param i_frame The frame, it is copied in asynchronous mode
+     *
+     * @return false if the frame has been discarded
+     */
+    bool dispatch(CByteSpan i_frame);
+
+    /**
+     * @brief Get statistics on the hand-off queue
+     */
+    SEzspRxMetrics getMetrics() const;
+
+private:
+    void run();
+
+    FEzspRxDispatch dispatchFct;
+    mutable std::recursive_mutex mode_m;  /*!< Held while dispatching or switching mode, never contended on the data path */
+    CSpscQueue<SEzspRxItem>* queue; /*!< Hand-off queue, only allocated in asynchronous mode */
+    EEzspRxOverflowPolicy policy;
+    std::thread worker; /*!< The dispatch thread */
+    std::mutex wake_m;  /*!< Only used to sleep when there is nothing to do (for the consumer) or no room (for the producer) */
+    std::condition_variable wake;
+    std::atomic<bool> stopping;
+    std::atomic<bool> producerWaiting;
+    std::atomic<size_t> maxDepth;
+    std::atomic<uint32_t> queued;
+    std::atomic<uint32_t> dispatched;
+    std::atomic<uint32_t> dropped;
+    std::atomic<uint32_t> blocked;
+    std::atomic<uint32_t> maxLatency;
+    std::atomic<uint64_t> totalLatency;
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
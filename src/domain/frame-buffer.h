@@ -0,0 +1,207 @@
+/**
+ * @file frame-buffer.h
+ *
+ * @brief Byte container with inline storage, large enough for any frame exchanged with the NCP
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>	// For size_t
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+
+#include "byte-span.h"
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * Capacity of a CFrameBuffer: an ASH frame carries at most ASH_MAX_LENGTH (131) bytes, the extra room covers messages built on top of it (eg: a ZCL header and its payload)
+ */
+#define FRAME_BUFFER_CAPACITY 256
+
+/**
+ * @brief Vector-like container of bytes, whose storage is part of the object
+ *
+ * Creating, copying and filling a frame buffer never touches the heap, so frames can be built, queued and handed over to observers on the hot paths.
+ * Bytes that do not fit in FRAME_BUFFER_CAPACITY are dropped, and the buffer is marked as truncated (see isTruncated()).
+ *
+ * @code
+ * CFrameBuffer l_frame;
+ * l_frame.push_back(EMBER_OUTGOING_DIRECT);
+ * l_frame.append(l_aps.GetEmberAPS());
+ * dongle.sendCommand(EZSP_SEND_UNICAST, l_frame);
+ * @endcode
+ */
+class CFrameBuffer
+{
+public:
+    typedef uint8_t value_type;
+    typedef uint8_t* iterator;
+    typedef const uint8_t* const_iterator;
+
+    /**
+     * @brief Default constructor, for an empty buffer
+     */
+    CFrameBuffer() : m_data(), m_size(0), m_truncated(false) {}
+
+    /**
+     * @brief Construct a buffer holding a copy of some bytes
+     *
+     * @param i_bytes The bytes to copy
+     */
+    CFrameBuffer(const CByteSpan& i_bytes) : m_data(), m_size(0), m_truncated(false) { this->append(i_bytes); }
+
+    /**
+     * @brief Construct a buffer holding a copy of the content of a vector
+     *
+     * @param i_vector The vector to copy
+     */
+    CFrameBuffer(const std::vector<uint8_t>& i_vector) : m_data(), m_size(0), m_truncated(false) { this->append(CByteSpan(i_vector)); }
+
+    /**
+     * @brief Construct a buffer from a list of bytes
+     *
+     * @param i_bytes The bytes
+     */
+    CFrameBuffer(std::initializer_list<uint8_t> i_bytes) : m_data(), m_size(0), m_truncated(false) { this->append(CByteSpan(i_bytes.begin(), i_bytes.size())); }
+
+    /**
+     * @brief Get a view on the content of the buffer (only valid as long as the buffer is neither modified nor destroyed)
+     */
+    operator CByteSpan() const { return CByteSpan(m_data, m_size); }
+
+    const uint8_t* data() const { return m_data; }
+    uint8_t* data() { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return 0 == m_size; }
+    static size_t capacity() { return FRAME_BUFFER_CAPACITY; }
+
+    const_iterator begin() const { return m_data; }
+    const_iterator end() const { return m_data + m_size; }
+    iterator begin() { return m_data; }
+    iterator end() { return m_data + m_size; }
+
+    const uint8_t& operator[](size_t i_idx) const { return m_data[i_idx]; }
+    uint8_t& operator[](size_t i_idx) { return m_data[i_idx]; }
+
+    /**
+     * @brief Get a byte, with bounds checking
+     *
+     * @param i_idx The offset of the byte
+     *
+     * @return The byte, or 0 if i_idx is past the end of the content (like reads past the end with CByteReader)
+     */
+    uint8_t at(size_t i_idx) const { return (i_idx < m_size) ? m_data[i_idx] : 0; }
+
+    /**
+     * @brief Add a byte at the end
+     */
+    void push_back(uint8_t i_byte)
+    {
+        if( m_size < FRAME_BUFFER_CAPACITY )
+        {
+            m_data[m_size++] = i_byte;
+        }
+        else
+        {
+            m_truncated = true;
+        }
+    }
+
+    /**
+     * @brief Add bytes at the end
+     */
+    void append(const CByteSpan& i_bytes)
+    {
+        size_t l_count = std::min(i_bytes.size(), FRAME_BUFFER_CAPACITY - m_size);
+
+        std::copy(i_bytes.begin(), i_bytes.begin() + l_count, m_data + m_size);
+        m_size += l_count;
+        if( l_count < i_bytes.size() )
+        {
+            m_truncated = true;
+        }
+    }
+
+    /**
+     * @brief Insert a byte at the beginning
+     */
+    void push_front(uint8_t i_byte)
+    {
+        if( m_size < FRAME_BUFFER_CAPACITY )
+        {
+            std::copy_backward(m_data, m_data + m_size, m_data + m_size + 1);
+            m_data[0] = i_byte;
+            m_size++;
+        }
+        else
+        {
+            m_truncated = true;
+        }
+    }
+
+    /**
+     * @brief Change the size of the content, new bytes being set to 0
+     *
+     * @param i_size The new size, capped to FRAME_BUFFER_CAPACITY
+     */
+    void resize(size_t i_size)
+    {
+        if( i_size > FRAME_BUFFER_CAPACITY )
+        {
+            i_size = FRAME_BUFFER_CAPACITY;
+            m_truncated = true;
+        }
+        if( i_size > m_size )
+        {
+            std::fill(m_data + m_size, m_data + i_size, 0);
+        }
+        m_size = i_size;
+    }
+
+    /**
+     * @brief Empty the buffer
+     */
+    void clear()
+    {
+        m_size = 0;
+        m_truncated = false;
+    }
+
+    /**
+     * @brief Have bytes been dropped because they did not fit in the buffer
+     */
+    bool isTruncated() const { return m_truncated; }
+
+    /**
+     * @brief Copy the content into a vector (this allocates)
+     */
+    std::vector<uint8_t> toVector() const { return std::vector<uint8_t>(begin(), end()); }
+
+private:
+    uint8_t m_data[FRAME_BUFFER_CAPACITY];  /*!< The content, followed by unused room */
+    size_t m_size;  /*!< Number of bytes of content */
+    bool m_truncated;   /*!< Have bytes been dropped */
+};
+
+/**
+ * @brief Compare the content of two buffers
+ */
+inline bool operator==(const CFrameBuffer& i_lhs, const CFrameBuffer& i_rhs)
+{
+    return (i_lhs.size() == i_rhs.size()) && std::equal(i_lhs.begin(), i_lhs.end(), i_rhs.begin());
+}
+
+inline bool operator!=(const CFrameBuffer& i_lhs, const CFrameBuffer& i_rhs)
+{
+    return !(i_lhs == i_rhs);
+}
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
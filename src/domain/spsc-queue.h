@@ -0,0 +1,128 @@
+/**
+ * @file spsc-queue.h
+ *
+ * @brief Bounded lock-free queue with a single producer and a single consumer
+ */
+
+#pragma once
+
+#include <cstddef>	// For size_t
+#include <atomic>
+#include <vector>
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief Bounded FIFO ring buffer, safe without locks as long as there is exactly one producer thread and one consumer thread
+ *
+ * All slots are allocated at construction, items are then filled in place by the producer (see back()) and read in place by the consumer (see front()), so nothing is allocated nor copied twice on the data path.
+ *
+ * @tparam T The type of the items, it must be default-constructible and copy-assignable
+ */
+template <typename T>
+class CSpscQueue
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param i_capacity The maximum number of items in the queue (at least 1)
+     */
+    explicit CSpscQueue(size_t i_capacity) :
+        slots((0 == i_capacity) ? 2 : (i_capacity + 1)),
+        head(0),
+        tail(0)
+    {
+    }
+
+    CSpscQueue(const CSpscQueue&) = delete;
+    CSpscQueue& operator=(const CSpscQueue&) = delete;
+
+    /**
+     * @brief Maximum number of items in the queue
+     */
+    size_t capacity() const { return slots.size() - 1; }
+
+    /**
+     * @brief Number of items in the queue (only a snapshot if invoked from another thread than the producer or consumer)
+     */
+    size_t size() const {
+        size_t l_head = head.load(std::memory_order_acquire);
+        size_t l_tail = tail.load(std::memory_order_acquire);
+        return (l_tail >= l_head) ? (l_tail - l_head) : (l_tail + slots.size() - l_head);
+    }
+
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Producer side: get the slot to fill in place
+     *
+     * @return The free slot, or nullptr if the queue is full. The item becomes visible to the consumer on push()
+     */
+    T* back() {
+        size_t l_tail = tail.load(std::memory_order_relaxed);
+        if( next(l_tail) == head.load(std::memory_order_acquire) )
+        {
+            return nullptr;
+        }
+        return &slots[l_tail];
+    }
+
+    /**
+     * @brief Producer side: publish the slot obtained from back()
+     */
+    void push() {
+        tail.store(next(tail.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    /**
+     * @brief Producer side: copy an item into the queue
+     *
+     * @return false if the queue is full
+     */
+    bool push(const T& i_item) {
+        T* l_slot = back();
+        if( nullptr == l_slot )
+        {
+            return false;
+        }
+        *l_slot = i_item;
+        push();
+        return true;
+    }
+
+    /**
+     * @brief Consumer side: get the oldest item, in place
+     *
+     * @return The oldest item, or nullptr if the queue is empty. The item stays valid until pop()
+     */
+    T* front() {
+        size_t l_head = head.load(std::memory_order_relaxed);
+        if( l_head == tail.load(std::memory_order_acquire) )
+        {
+            return nullptr;
+        }
+        return &slots[l_head];
+    }
+
+    /**
+     * @brief Consumer side: release the item obtained from front()
+     */
+    void pop() {
+        head.store(next(head.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+private:
+    size_t next(size_t i_index) const { return (i_index + 1 == slots.size()) ? 0 : (i_index + 1); }
+
+    std::vector<T> slots;   /*!< Storage, one slot is always kept free to tell a full queue from an empty one */
+    std::atomic<size_t> head;   /*!< Next slot to read, only written by the consumer */
+    std::atomic<size_t> tail;   /*!< Next slot to write, only written by the producer */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
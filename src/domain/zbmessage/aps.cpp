@@ -6,6 +6,7 @@
 
 #include "aps.h"
 #include "../byte-manip.h"
+#include "../byte-cursor.h"
 
 CAPSFrame::CAPSFrame() : cluster_id(0), dest_ep(0), group_id(0), option(), profile_id(0), sequence(0), src_ep(0)
 {
@@ -40,9 +41,9 @@ void CAPSFrame::SetDefaultAPS( uint16_t i_profile_id, uint16_t i_cluster_id, uin
 
 }
 
-std::vector<uint8_t> CAPSFrame::GetEmberAPS(void)
+CFrameBuffer CAPSFrame::GetEmberAPS(void)
 {
-  std::vector<uint8_t> lo_aps;
+  CFrameBuffer lo_aps;
   uint16_t l_option;
 
   lo_aps.push_back( u16_get_lo_u8(profile_id) );
@@ -67,31 +68,17 @@ std::vector<uint8_t> CAPSFrame::GetEmberAPS(void)
   return lo_aps;
 }
 
-void CAPSFrame::SetEmberAPS(std::vector<uint8_t> i_data )
+void CAPSFrame::SetEmberAPS( const CByteSpan& i_data )
 {
-  uint8_t l_idx = 0;
-
-  profile_id = dble_u8_to_u16(i_data.at(l_idx+1U), i_data.at(l_idx));
-  l_idx++;
-  l_idx++;
-
-  cluster_id = dble_u8_to_u16(i_data.at(l_idx+1U), i_data.at(l_idx));
-  l_idx++;
-  l_idx++;
-
-  src_ep = i_data.at(l_idx++);
-
-  dest_ep = i_data.at(l_idx++);
-
-  option.SetEmberApsOption( dble_u8_to_u16(i_data.at(l_idx+1U), i_data.at(l_idx)) );
-  l_idx++;
-  l_idx++;
-
-  group_id = dble_u8_to_u16(i_data.at(l_idx+1U), i_data.at(l_idx));
-  l_idx++;
-  l_idx++;
-
-  sequence = i_data.at(l_idx++);
+  CByteReader l_reader(i_data);
+
+  profile_id = l_reader.readU16();
+  cluster_id = l_reader.readU16();
+  src_ep = l_reader.readU8();
+  dest_ep = l_reader.readU8();
+  option.SetEmberApsOption( l_reader.readU16() );
+  group_id = l_reader.readU16();
+  sequence = l_reader.readU8();
 }
 
 /**
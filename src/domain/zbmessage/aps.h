@@ -11,6 +11,8 @@
 #include <vector>
 
 #include "apsoption.h"
+#include "../byte-span.h"
+#include "../frame-buffer.h"
 
 #ifdef USE_RARITAN
 /**** Start of the official API; no includes below this point! ***************/
@@ -62,8 +64,8 @@ public:
   void SetDefaultAPS( uint16_t i_profile_id, uint16_t i_cluster_id, uint8_t i_dest_ep, uint16_t i_grp_id = 0 );
 
   // concatenate
-  std::vector<uint8_t> GetEmberAPS(void);
-  void SetEmberAPS( std::vector<uint8_t> i_data );
+  CFrameBuffer GetEmberAPS(void);
+  void SetEmberAPS( const CByteSpan& i_data );
 
   // usefull
   /**
@@ -9,12 +9,13 @@
 #include <cstring>
 
 #include "../byte-manip.h"
+#include "../byte-cursor.h"
 #include "../custom-aes.h"
 #include "gpd-commissioning-command-payload.h"
 
-CGpdCommissioningPayload::CGpdCommissioningPayload(const std::vector<uint8_t>& raw_message, uint32_t i_src_id):
-        device_id(raw_message.at(0)),
-        options(raw_message.at(1)),
+CGpdCommissioningPayload::CGpdCommissioningPayload(const CByteSpan& raw_message, uint32_t i_src_id):
+        device_id(),
+        options(),
         extended_options(0),
         key(),
         key_mic(),
@@ -25,27 +26,29 @@ CGpdCommissioningPayload::CGpdCommissioningPayload(const std::vector<uint8_t>& r
         gpd_command_list(),
         gpd_cluster_list()
 {
+    CByteReader l_reader(raw_message);
+
     // only device_id and option are mandatory, other field depend of option value
-    unsigned int l_idx = 2;
+    device_id = l_reader.readU8();
+    options = l_reader.readU8();
 
     // extended option
     if( options & (1<<COM_OPTION_EXTENDED_OPTION_FIELD_BIT) )
     {
-        extended_options = raw_message.at(l_idx);
-        l_idx++;
+        extended_options = l_reader.readU8();
     }
 
     // gpd key
     if( extended_options & (1<<COM_EXT_OPTION_GPD_KEY_PRESENT_BIT) )
     {
-        key.insert(key.begin(),raw_message.begin()+static_cast<int>(l_idx),raw_message.begin()+static_cast<int>(l_idx)+EMBER_KEY_DATA_BYTE_SIZE);
-        l_idx += EMBER_KEY_DATA_BYTE_SIZE;
+        CByteSpan l_key = l_reader.readBytes(EMBER_KEY_DATA_BYTE_SIZE);
+        key.assign(l_key.begin(), l_key.end());
+        key.resize(EMBER_KEY_DATA_BYTE_SIZE, 0);
         // gpd key MIC and encryption
         if( extended_options & (1<<COM_EXT_OPTION_GPD_KEY_ENCRYPTION_BIT) )
         {
             // MIC
-            key_mic = quad_u8_to_u32(raw_message.at(l_idx+3),raw_message.at(l_idx+2),raw_message.at(l_idx+1),raw_message.at(l_idx));
-            l_idx += 4;
+            key_mic = l_reader.readU32();
             // uncrypt key using default TC-LK (A.3.3.3.3 gpLinkKey:‘ZigBeeAlliance09’) with method A.3.7.1.2.3 Over- the-air protection of GPD key with TC-LK
             uint8_t TC_LK[16] = {0x5A, 0x69, 0x67, 0x42, 0x65, 0x65, 0x41, 0x6C, 0x6C, 0x69, 0x61, 0x6E, 0x63, 0x65, 0x30, 0x39};
             uint8_t nonce[16];
@@ -73,8 +76,7 @@ CGpdCommissioningPayload::CGpdCommissioningPayload(const std::vector<uint8_t>& r
             aes.xor_block(out_key, in_key);
 
             // fill key with uncrypt value
-            key.clear();
-            for(int loop=0; loop<16; loop++){ key.push_back(out_key[loop]);}
+            key.assign(out_key, out_key + 16);
 
             // verify MIC
             // \todo
@@ -84,47 +86,40 @@ CGpdCommissioningPayload::CGpdCommissioningPayload(const std::vector<uint8_t>& r
     // gpd outgoing counter
     if( extended_options & (1<<COM_EXT_OPTION_GPD_OUT_COUNTER_PRESENT_BIT) )
     {
-        out_frame_counter = quad_u8_to_u32(raw_message.at(l_idx+3),raw_message.at(l_idx+2),raw_message.at(l_idx+1),raw_message.at(l_idx));
-            l_idx += 4;
+        out_frame_counter = l_reader.readU32();
     }
 
     // application information
     if( options & (1<<COM_OPTION_APPLICATION_INFORMATION_BIT) )
     {
-        app_information = raw_message.at(l_idx);
-        l_idx++;
+        app_information = l_reader.readU8();
     }
 
     // manufacturer id
     if( app_information & (1<<COM_APP_INFO_MANUFACTURER_ID_PRESENT_BIT) )
     {
-        manufacturer_id = dble_u8_to_u16(raw_message.at(l_idx+1),raw_message.at(l_idx));
-        l_idx += 2;
+        manufacturer_id = l_reader.readU16();
     }
 
     // model id
     if( app_information & (1<<COM_APP_INFO_MODEL_ID_PRESENT_BIT) )
     {
-        model_id = dble_u8_to_u16(raw_message.at(l_idx+1),raw_message.at(l_idx));
-        l_idx += 2;
+        model_id = l_reader.readU16();
     }
 
     // gpd commands
     if( app_information & (1<<COM_APP_INFO_GPD_COMMANDS_PRESENT_BIT) )
     {
-        uint8_t l_number = raw_message.at(l_idx);
-        l_idx++;
-        for( int loop=0; loop<l_number; loop++)
-        {
-            gpd_command_list.push_back(raw_message.at(l_idx));
-            l_idx++;
-        }
+        uint8_t l_number = l_reader.readU8();
+        CByteSpan l_commands = l_reader.readBytes(l_number);
+        gpd_command_list.assign(l_commands.begin(), l_commands.end());
     }
 
     // gpd cluster list
     if( app_information & (1<<COM_APP_INFO_CLUSTER_LIST_PRESENT_BIT) )
     {
-        gpd_cluster_list.insert(gpd_cluster_list.begin(),raw_message.begin()+static_cast<int>(l_idx),raw_message.end());
+        CByteSpan l_clusters = l_reader.readRemaining();
+        gpd_cluster_list.assign(l_clusters.begin(), l_clusters.end());
     }
 }
 
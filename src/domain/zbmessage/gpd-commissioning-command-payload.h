@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "../ezsp-protocol/ezsp-enum.h"
+#include "../byte-span.h"
 
 // option bitfield
 #define COM_OPTION_MAC_SEQ_CAPABILITY_BIT       0
@@ -56,7 +57,7 @@ class CGpdCommissioningPayload
          * @param raw_message The buffer to construct from
          * @param i_src_id source id of gpd frame, used to decrypt key
          */
-        CGpdCommissioningPayload(const std::vector<uint8_t>& raw_message, uint32_t i_src_id);
+        CGpdCommissioningPayload(const CByteSpan& raw_message, uint32_t i_src_id);
 
         /**
          * @brief Getter for the enclosed encryption/authentication key
@@ -6,11 +6,12 @@
 
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
-#include "../byte-manip.h"
+#include "../byte-cursor.h"
 #include "green-power-frame.h"
 
-#include "../ezsp-protocol/struct/ember-gp-address-struct.h"
+#include "../ezsp-protocol/ezsp-enum.h"
 
 CGpFrame::CGpFrame():
     link_value(0),
@@ -24,11 +25,12 @@ CGpFrame::CGpFrame():
     command_id(0xFF),
     mic(0),
     proxy_table_entry(0xFF),
+    payload_length(0),
     payload()
 {
 }
 
-CGpFrame::CGpFrame(const std::vector<uint8_t>& raw_message):
+CGpFrame::CGpFrame(const CByteSpan& raw_message):
     link_value(0),
     sequence_number(0),
     source_id(0),
@@ -40,29 +42,33 @@ CGpFrame::CGpFrame(const std::vector<uint8_t>& raw_message):
     command_id(0xFF),
     mic(0),
     proxy_table_entry(0xFF),
+    payload_length(0),
     payload()
 {
-    std::vector<uint8_t> l_gp_addr(raw_message.begin()+3,raw_message.end());
+    CByteReader l_reader(raw_message);
+
+    l_reader.skip(1);   // status
+    uint8_t l_link_value = l_reader.readU8();
+    uint8_t l_sequence_number = l_reader.readU8();
 
-    CEmberGpAddressStruct gp_address = CEmberGpAddressStruct(l_gp_addr);
     /* only sourceId addressing mode is supported */
-    if( 0 == gp_address.getApplicationId() )
+    if( 0 == l_reader.readU8() )
     {
-        link_value = raw_message.at(1);
-        sequence_number = raw_message.at(2);
-        source_id = gp_address.getSourceId();
-        security = static_cast<EGpSecurityLevel>(raw_message.at(13));
-        key_type = static_cast<EGpSecurityKeyType>(raw_message.at(14));
-        auto_commissioning = raw_message.at(15);
-        rx_after_tx = raw_message.at(16);
-        security_frame_counter = quad_u8_to_u32(raw_message.at(20), raw_message.at(19), raw_message.at(18), raw_message.at(17));
-        command_id = raw_message.at(21);
-        mic = quad_u8_to_u32(raw_message.at(25), raw_message.at(24), raw_message.at(23), raw_message.at(22));
-        proxy_table_entry = raw_message.at(26);
-        for( unsigned int loop=0; loop<raw_message.at(27); loop++ )
-        {
-            payload.push_back(raw_message.at(28+loop));
-        }
+        link_value = l_link_value;
+        sequence_number = l_sequence_number;
+        source_id = l_reader.readU32();
+        l_reader.skip(EMBER_GP_ADDRESS_BYTE_SIZE - 5);  // rest of the IEEE address field, endpoint
+        security = static_cast<EGpSecurityLevel>(l_reader.readU8());
+        key_type = static_cast<EGpSecurityKeyType>(l_reader.readU8());
+        auto_commissioning = l_reader.readU8();
+        rx_after_tx = l_reader.readU8();
+        security_frame_counter = l_reader.readU32();
+        command_id = l_reader.readU8();
+        mic = l_reader.readU32();
+        proxy_table_entry = l_reader.readU8();
+        CByteSpan l_payload = l_reader.readBytes(l_reader.readU8());
+        payload_length = static_cast<uint8_t>(std::min(l_payload.size(), sizeof(payload)));
+        std::copy(l_payload.begin(), l_payload.begin() + payload_length, payload);
     }
 }
 
@@ -83,7 +89,7 @@ std::string CGpFrame::String() const
     buf << "[mic : "<< std::hex << std::setw(8) << std::setfill('0') << static_cast<unsigned int>(mic) << "]";
     buf << "[proxy_table_entry : "<< std::hex << std::setw(2) << std::setfill('0') << static_cast<unsigned int>(proxy_table_entry) << "]";
     buf << "[payload :";
-    for(uint8_t loop=0; loop<payload.size(); loop++){ buf << " " << std::hex << std::setw(2) << std::setfill('0') << static_cast<unsigned int>(payload[loop]); }
+    for(uint8_t loop=0; loop<payload_length; loop++){ buf << " " << std::hex << std::setw(2) << std::setfill('0') << static_cast<unsigned int>(payload[loop]); }
     buf << "]";
     buf << " }";
 
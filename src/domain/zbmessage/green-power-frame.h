@@ -7,6 +7,14 @@
 
 #include <cstdint>
 #include <vector>
+#include <string>
+
+#include "../byte-span.h"
+
+/**
+ * Maximum size of the GPD command payload held by a CGpFrame (the whole EZSP frame carrying it is at most 128 bytes)
+ */
+#define GP_FRAME_MAX_PAYLOAD_SIZE 128
 
 typedef enum
 {
@@ -47,7 +55,7 @@ class CGpFrame
          *
          * @param raw_message The buffer to construct from
          */
-        CGpFrame(const std::vector<uint8_t>& raw_message);
+        CGpFrame(const CByteSpan& raw_message);
 
         /**
          * @brief Dump this instance as a string
@@ -78,7 +86,12 @@ class CGpFrame
         uint8_t getCommandId() const {return command_id;}
         uint32_t getMic() const {return mic;}
         uint8_t getProxyTableEntry() const {return proxy_table_entry;}
-        std::vector<uint8_t> getPayload() const {return payload;}
+        /**
+         * @brief Get the GPD command payload
+         *
+         * @return A view on the payload, valid as long as this frame is alive and unmodified
+         */
+        CByteSpan getPayload() const {return CByteSpan(payload, payload_length);}
 
     private:
         uint8_t link_value;
@@ -92,5 +105,6 @@ class CGpFrame
         uint8_t command_id;
         uint32_t mic;
         uint8_t proxy_table_entry;
-        std::vector<uint8_t> payload;
+        uint8_t payload_length;
+        uint8_t payload[GP_FRAME_MAX_PAYLOAD_SIZE];    /*!< Stored inline, so that decoding a frame does not allocate */
 };
\ No newline at end of file
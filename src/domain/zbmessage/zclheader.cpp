@@ -7,6 +7,7 @@
 #include "zclheader.h"
 
 #include "../byte-manip.h"
+#include "../byte-cursor.h"
 
 CZCLHeader::CZCLHeader() :
 	frm_ctrl(),
@@ -25,20 +26,24 @@ CZCLHeader::CZCLHeader() :
  *
  * Total of bytes expected: 5 (if manufacturer code is present) or 3 otherwise
  */
-CZCLHeader::CZCLHeader(const std::vector<uint8_t>& i_data, uint8_t& o_idx) :
-	frm_ctrl(i_data.at(0)),
-	manufacturer_code(frm_ctrl.IsManufacturerCodePresent()?dble_u8_to_u16(i_data.at(2), i_data.at(1)):0),
-	transaction_number(frm_ctrl.IsManufacturerCodePresent()?i_data.at(3):i_data.at(1)),
-	cmd_id(frm_ctrl.IsManufacturerCodePresent()?i_data.at(4):i_data.at(2))
+CZCLHeader::CZCLHeader(const CByteSpan& i_data, uint8_t& o_idx) :
+	frm_ctrl(),
+	manufacturer_code(0),
+	transaction_number(0),
+	cmd_id(0)
 {
+  CByteReader l_reader(i_data);
+
+  frm_ctrl = CZCLFrameControl(l_reader.readU8());
   if( frm_ctrl.IsManufacturerCodePresent() )
   {
-    o_idx=5;	/* When manufacturer code is present, the header is 5-bytes long */
-  }
-  else
-  {
-    o_idx=3;	/* otherwise, it is 3-bytes long */
+    manufacturer_code = l_reader.readU16();
   }
+  transaction_number = l_reader.readU8();
+  cmd_id = l_reader.readU8();
+
+  /* 5 bytes when manufacturer code is present, 3 otherwise (unless the buffer is shorter) */
+  o_idx = static_cast<uint8_t>(l_reader.getPosition());
 }
 
 CZCLHeader::CZCLHeader(const CZCLHeader& other) :
@@ -115,9 +120,9 @@ void CZCLHeader::SetPublicGeneral( const uint16_t i_manufacturer_id, const uint8
   manufacturer_code = i_manufacturer_id;
 }
 
-std::vector<uint8_t> CZCLHeader::GetZCLHeader(void) const
+CFrameBuffer CZCLHeader::GetZCLHeader(void) const
 {
-  std::vector<uint8_t> lo_data;
+  CFrameBuffer lo_data;
 
   lo_data.push_back(frm_ctrl.GetFrmCtrlByte());
   if( frm_ctrl.IsManufacturerCodePresent() )
@@ -1,13 +1,15 @@
 /**
  * 
  */
-#include <map>
+#include <string>
+
+#include "../enum-name-table.h"
 
 #include "zdp-enum.h"
 
 std::string CZdpEnum::ToString( EZdpLowByte in )
 {
-    const std::map<EZdpLowByte,std::string> MyEnumStrings {
+    static const CEnumNameTable::SEntry entries[] = {
         { ZDP_MGMT_BIND, "ZDP_MGMT_BIND" },
         { ZDP_MGMT_RTG, "ZDP_MGMT_RTG" },
         { ZDP_MGMT_LQI, "ZDP_MGMT_LQI" },
@@ -24,6 +26,7 @@ std::string CZdpEnum::ToString( EZdpLowByte in )
         { ZDP_IEEE_ADDR, "ZDP_IEEE_ADDR" },
         { ZDP_NWK_ADDR, "ZDP_NWK_ADDR" }
     };
-    auto   it  = MyEnumStrings.find(in);
-    return it == MyEnumStrings.end() ? "OUT_OF_RANGE" : it->second;    
+    static const CEnumNameTable names(entries);
+    const char* name = names.find(in);
+    return (name != nullptr) ? name : "OUT_OF_RANGE";
 }
@@ -60,10 +60,10 @@ void CZigBeeMsg::SetZdo(const uint16_t i_cmd_id, const std::vector<uint8_t>& i_p
   use_zcl_header = false;
 
   payload = i_payload;
-  payload.insert( payload.begin(), i_transaction_number );
+  payload.push_front( i_transaction_number );
 }
 
-void CZigBeeMsg::Set(const std::vector<uint8_t>& i_aps, const std::vector<uint8_t>& i_msg )
+void CZigBeeMsg::Set(const CByteSpan& i_aps, const CByteSpan& i_msg )
 {
   uint8_t l_idx = 0;
 
@@ -83,23 +83,19 @@ void CZigBeeMsg::Set(const std::vector<uint8_t>& i_aps, const std::vector<uint8_
 
 
   // payload
-  for(uint16_t loop=l_idx; loop<i_msg.size(); loop++)
-  {
-      payload.push_back(i_msg.at(loop));
-  }  
+  payload.append(i_msg.subspan(l_idx));
 }
 
-std::vector<uint8_t> CZigBeeMsg::Get( void ) const
+CFrameBuffer CZigBeeMsg::Get( void ) const
 {
-  std::vector<uint8_t> lo_msg;
+  CFrameBuffer lo_msg;
 
   if( use_zcl_header )
   {
-    std::vector<uint8_t> v_tmp = zcl_header.GetZCLHeader();
-    lo_msg.insert(lo_msg.end(), v_tmp.begin(), v_tmp.end());
+    lo_msg = zcl_header.GetZCLHeader();
   }
 
-  lo_msg.insert(lo_msg.end(), payload.begin(), payload.end());
+  lo_msg.append(payload);
 
   return lo_msg;
 }
@@ -175,27 +175,27 @@ public:
    *
    * @return The enclosed payload
    */
-  std::vector<uint8_t> GetPayload() const { return payload; }
+  const CFrameBuffer& GetPayload() const { return payload; }
 
   /**
    * @brief Parse an incomming raw EZSP message
    * @param i_aps : aps data
    * @param i_msg : message data included header (ZCL and/or MSP)
    */
-  void Set( const std::vector<uint8_t>& i_aps, const std::vector<uint8_t>& i_msg );
+  void Set( const CByteSpan& i_aps, const CByteSpan& i_msg );
 
   /**
    * @brief Get : format zigbee message frame with header
    * @return Zigbee message with header
    */
-  std::vector<uint8_t> Get() const;
+  CFrameBuffer Get() const;
 
   /* FIXME: make the atribute below private as create getter/setter methods */
   CAPSFrame aps;        /*!< Enclosed APS frame */
 private:
   CZCLHeader zcl_header;        /*!< Enclosed ZCL header */
   bool use_zcl_header;  /*!< Do we have a valid content in attribute zcl_header? */
-  std::vector<uint8_t> payload; /*!< Enclosed payload */
+  CFrameBuffer payload; /*!< Enclosed payload */
 };
 
 #ifdef USE_RARITAN
@@ -1,105 +1,117 @@
 /**
  * @file green-power-sink-table.cpp
  *
- * @brief A green power sink table
+ * @brief Host mirror of the green power sink table of the NCP
  */
 
-#include <sstream>
-#include <iomanip>
-
 #include "green-power-sink-table.h"
 
 #include "../../spi/GenericLogger.h"
 #include "../../spi/ILogger.h"
 
 CGpSinkTable::CGpSinkTable() :
-    gpds()
+    loaded(false),
+    entries(),
+    index_by_source_id()
+{
+}
+
+void CGpSinkTable::reset()
 {
+    loaded = false;
+    entries.clear();
+    index_by_source_id.clear();
+}
 
+void CGpSinkTable::setLoaded()
+{
+    loaded = true;
 }
 
-uint8_t CGpSinkTable::addEntry( CGpSinkTableEntry i_entry )
+void CGpSinkTable::setEntry( uint8_t i_index, const CEmberGpSinkTableEntryStruct& i_entry )
 {
-    uint8_t lo_index = GP_SINK_INVALID_ENTRY;
-
-/*
-    std::stringstream buf;
-    buf << "[source_id : "<< std::hex << std::setw(8) << std::setfill('0') << unsigned(i_entry.getSourceId()) << "]";
-    clogI << "CGpSinkTable::addEntry : " << buf.str() << std::endl;
-*/
-    // loop on table to search if gpd is already register
-    lo_index = getEntryIndexForSourceId( i_entry.getSourceId() );
-    if( GP_SINK_INVALID_ENTRY == lo_index )
+    if( GP_SINK_INVALID_ENTRY == i_index )
     {
-        // limit number of entry !
-        if( gpds.size() < GP_SINK_INVALID_ENTRY )
-        {
-            if (gpds.size()>255)
-            {
-                clogW << "gpd table size overflow\n";
-            }
-            else
-            {
-                lo_index = static_cast<uint8_t>(gpds.size());
-                gpds.push_back(i_entry);
-            }
-        }
+        clogW << "CGpSinkTable::setEntry invalid index\n";
+        return;
+    }
+    if( i_index >= entries.size() )
+    {
+        entries.resize(i_index + 1U);
     }
 
-//    clogI << "CGpSinkTable::addEntry at index : " << unsigned(lo_index) << std::endl;
+    unmapEntry(i_index);
+    entries[i_index] = i_entry;
+    if( i_entry.isActive() && (0 == i_entry.getGpdAddr().getApplicationId()) )
+    {
+        uint32_t l_source_id = i_entry.getGpdAddr().getSourceId();
 
-    return lo_index;
+        // a gpd has a single entry, drop any stale one
+        uint8_t l_previous = getEntryIndexForSourceId(l_source_id);
+        if( GP_SINK_INVALID_ENTRY != l_previous )
+        {
+            entries[l_previous].setEntryActive(false);
+        }
+        index_by_source_id[l_source_id] = i_index;
+    }
 }
 
-uint8_t CGpSinkTable::removeEntry(const uint32_t i_source_id )
+void CGpSinkTable::removeEntry( uint8_t i_index )
 {
-    uint8_t lo_index = GP_SINK_INVALID_ENTRY;
-
-/*
-    std::stringstream buf;
-    buf << "[source_id : "<< std::hex << std::setw(8) << std::setfill('0') << unsigned(i_source_id) << "]";
-    clogI << "CGpSinkTable::removeEntry : " << buf.str() << std::endl;
-*/
-    // loop on table to search if gpd is already register
-    lo_index = getEntryIndexForSourceId( i_source_id );
-//    clogI << "CGpSinkTable::removeEntry at index : " << unsigned(lo_index) << std::endl;
-    if( GP_SINK_INVALID_ENTRY != lo_index )
+    if( i_index < entries.size() )
     {
-        const auto it = gpds.begin() + lo_index;
-        gpds.erase(it);
-        return 0;
+        unmapEntry(i_index);
+        entries[i_index].setEntryActive(false);
     }
+}
 
-    return lo_index;
+void CGpSinkTable::removeAllEntries()
+{
+    for( CEmberGpSinkTableEntryStruct& l_entry : entries )
+    {
+        l_entry.setEntryActive(false);
+    }
+    index_by_source_id.clear();
 }
 
-uint8_t CGpSinkTable::getEntryIndexForSourceId(uint32_t i_source_id)
+uint8_t CGpSinkTable::getEntryIndexForSourceId( uint32_t i_source_id ) const
 {
-    uint8_t lo_index = GP_SINK_INVALID_ENTRY;
+    std::unordered_map<uint32_t, uint8_t>::const_iterator it = index_by_source_id.find(i_source_id);
 
-/*
-    std::stringstream buf;
-    buf << "[source_id : "<< std::hex << std::setw(8) << std::setfill('0') << unsigned(i_source_id) << "]";
-    clogI << "CGpSinkTable::getEntryIndexForSourceId : " << buf.str() << std::endl;
-*/
+    return (it == index_by_source_id.end()) ? static_cast<uint8_t>(GP_SINK_INVALID_ENTRY) : it->second;
+}
 
-    for( unsigned int loop=0; loop<gpds.size(); loop++ )
+uint8_t CGpSinkTable::getFreeEntryIndex() const
+{
+    for( size_t loop = 0; loop < entries.size() && loop < GP_SINK_INVALID_ENTRY; loop++ )
     {
-        if( i_source_id == gpds.at(loop).getSourceId() )
+        if( !entries[loop].isActive() )
         {
-            if (loop>255)
-            {
-                clogW << "gpd table index overflow\n";
-            }
-            else
-            {
-                lo_index = static_cast<uint8_t>(loop);
-                break;
-            }
+            return static_cast<uint8_t>(loop);
         }
     }
+    return GP_SINK_INVALID_ENTRY;
+}
 
-//    clogI << "CGpSinkTable::getEntryIndexForSourceId at index : " << unsigned(lo_index) << std::endl;
+CEmberGpSinkTableEntryStruct CGpSinkTable::getEntry( uint8_t i_index ) const
+{
+    if( i_index < entries.size() )
+    {
+        return entries[i_index];
+    }
+    return CEmberGpSinkTableEntryStruct();
+}
+
+void CGpSinkTable::unmapEntry( uint8_t i_index )
+{
+    const CEmberGpSinkTableEntryStruct& l_entry = entries[i_index];
 
-    return lo_index;
+    if( l_entry.isActive() && (0 == l_entry.getGpdAddr().getApplicationId()) )
+    {
+        std::unordered_map<uint32_t, uint8_t>::iterator it = index_by_source_id.find(l_entry.getGpdAddr().getSourceId());
+        if( (it != index_by_source_id.end()) && (it->second == i_index) )
+        {
+            index_by_source_id.erase(it);
+        }
+    }
 }
@@ -1,13 +1,16 @@
 /**
  * @file green-power-sink-table.h
  *
- * @brief A green power sink table
+ * @brief Host mirror of the green power sink table of the NCP
  */
 #pragma once
 
 #include <cstdint>
+#include <cstddef>	// For size_t
 #include <vector>
-#include "../zbmessage/green-power-sink-table-entry.h"
+#include <unordered_map>
+
+#include "../ezsp-protocol/struct/ember-gp-sink-table-entry-struct.h"
 
 #ifdef USE_RARITAN
 /**** Start of the official API; no includes below this point! ***************/
@@ -17,28 +20,56 @@
 
 #define GP_SINK_INVALID_ENTRY 0xFF
 
+/**
+ * @brief Copy of the GP sink table of the NCP, indexed by GPD source ID
+ *
+ * The table is read once from the NCP (see CGpSink::init()), then kept coherent by applying each change acknowledged by the NCP (write-through).
+ * It thus answers lookups and free entry allocations locally, instead of EZSP_GP_SINK_TABLE_LOOKUP, EZSP_GP_SINK_TABLE_FIND_OR_ALLOCATE_ENTRY and EZSP_GP_SINK_TABLE_GET_ENTRY round trips.
+ *
+ * Only entries of GPDs addressed by source ID (application ID 0) can be looked up.
+ */
 class CGpSinkTable
 {
 public:
     CGpSinkTable(const CGpSinkTable&) = delete; /* No copy construction allowed */
+    CGpSinkTable& operator=(const CGpSinkTable&) = delete; /* No assignment allowed */
 
     CGpSinkTable();
 
     /**
-     * @brief add a green power sink table entry
-     *
-     * @return index of entry in sink table, or GP_SINK_INVALID_ENTRY if table is full
+     * @brief Forget all entries, the table has to be loaded again from the NCP
+     */
+    void reset();
+
+    /**
+     * @brief Mark the table as loaded, once all the entries of the NCP have been given to setEntry()
      */
-    uint8_t addEntry( CGpSinkTableEntry i_entry );
+    void setLoaded();
 
     /**
-     * @brief remove a green power sink table entry
+     * @brief Is the table a complete copy of the table of the NCP
+     */
+    bool isLoaded() const { return loaded; }
+
+    /**
+     * @brief Record the content of an entry, as read from or written to the NCP
      *
-     * @param i_source_id source id of gpd
+     * @param i_index index of the entry in the table of the NCP
+     * @param i_entry content of the entry (an inactive entry is a free one)
+     */
+    void setEntry( uint8_t i_index, const CEmberGpSinkTableEntryStruct& i_entry );
+
+    /**
+     * @brief Record that an entry has been removed from the NCP
      *
-     * @return 0 or GP_SINK_INVALID_ENTRY if table entry not found
+     * @param i_index index of the entry in the table of the NCP
+     */
+    void removeEntry( uint8_t i_index );
+
+    /**
+     * @brief Record that all entries have been removed from the NCP (the table stays loaded)
      */
-    uint8_t removeEntry(const uint32_t i_source_id );
+    void removeAllEntries();
 
     /**
      * @brief obtain entry index according to a gpd source id
@@ -47,11 +78,43 @@ public:
      *
      * @return index of sink table entry, GP_SINK_INVALID_ENTRY if not found
      */
-    uint8_t getEntryIndexForSourceId(uint32_t i_source_id);
+    uint8_t getEntryIndexForSourceId( uint32_t i_source_id ) const;
+
+    /**
+     * @brief obtain the index of a free entry, the lowest one like the NCP does
+     *
+     * @return index of a free sink table entry, GP_SINK_INVALID_ENTRY if the table is full
+     */
+    uint8_t getFreeEntryIndex() const;
+
+    /**
+     * @brief Get the content of an entry
+     *
+     * @param i_index index of the entry
+     *
+     * @return The entry, or an inactive entry if i_index is out of the table
+     */
+    CEmberGpSinkTableEntryStruct getEntry( uint8_t i_index ) const;
+
+    /**
+     * @brief Get the number of entries of the table of the NCP
+     */
+    size_t getSize() const { return entries.size(); }
+
+    /**
+     * @brief Get the number of active entries
+     */
+    size_t getActiveEntryCount() const { return index_by_source_id.size(); }
 
 private:
-    std::vector<CGpSinkTableEntry> gpds;
+    /**
+     * @brief Forget the source id mapped to an entry, if any
+     */
+    void unmapEntry( uint8_t i_index );
 
+    bool loaded;    /*!< Have all entries been read from the NCP */
+    std::vector<CEmberGpSinkTableEntryStruct> entries;  /*!< Content of each entry of the NCP, by index */
+    std::unordered_map<uint32_t, uint8_t> index_by_source_id;   /*!< Index of the active entries, by GPD source id */
 };
 
 #ifdef USE_RARITAN
@@ -12,10 +12,12 @@
 #include <string>
 
 #include "green-power-sink.h"
+#include "../ezsp-protocol/ezsp-commands.h"
 #include "../ezsp-protocol/struct/ember-gp-address-struct.h"
 #include "../ezsp-protocol/struct/ember-gp-proxy-table-entry-struct.h"
 
 #include "../byte-manip.h"
+#include "../byte-cursor.h"
 
 #include "../../domain/zbmessage/zigbee-message.h"
 #include "../../domain/zbmessage/gpd-commissioning-command-payload.h"
@@ -79,8 +81,9 @@ CGpSink::CGpSink( CEzspDongle &i_dongle, CZigbeeMessaging &i_zb_messaging ) :
     sink_state(SINK_NOT_INIT),
     nwk_parameters(),
     authorizeGpfChannelRqst(false),
-    gpf_comm_frame(),
     sink_table_index(0xFF),
+    sink_table_load_index(0),
+    sink_table(),
     gpds_to_register(),
     sink_table_entry(),
     proxy_table_index(),
@@ -88,7 +91,27 @@ CGpSink::CGpSink( CEzspDongle &i_dongle, CZigbeeMessaging &i_zb_messaging ) :
     gpd_send_list(),
     observers()
 {
-    dongle.registerObserver(this);
+    // only get the messages handled by handleEzspRxMessage()
+    const EEzspCmd l_handled_cmds[] = {
+        EZSP_GP_PROXY_TABLE_GET_ENTRY,
+        EZSP_GET_NETWORK_PARAMETERS,
+        EZSP_GP_SINK_TABLE_INIT,
+        EZSP_GPEP_INCOMING_MESSAGE_HANDLER,
+        EZSP_GP_PROXY_TABLE_LOOKUP,
+        EZSP_GP_SINK_TABLE_GET_ENTRY,
+        EZSP_GP_SINK_TABLE_SET_ENTRY,
+        EZSP_GP_SINK_TABLE_REMOVE_ENTRY,
+        EZSP_GP_SINK_TABLE_CLEAR_ALL,
+        EZSP_GP_PROXY_TABLE_PROCESS_GP_PAIRING,
+        EZSP_D_GP_SEND,
+        EZSP_D_GP_SENT_HANDLER,
+        EZSP_SEND_RAW_MESSAGE,
+        EZSP_RAW_TRANSMIT_COMPLETE_HANDLER
+    };
+    for( EEzspCmd l_cmd : l_handled_cmds )
+    {
+        dongle.subscribe(l_cmd, [this](EEzspCmd i_cmd, CByteSpan i_msg_receive) { this->handleEzspRxMessage(i_cmd, CFrameBuffer(i_msg_receive)); });
+    }
 }
 
 void CGpSink::init()
@@ -100,6 +123,11 @@ void CGpSink::init()
     // retieve network information
     dongle.sendCommand(EZSP_GET_NETWORK_PARAMETERS);
 
+    // read the whole sink table once, the mirror is then updated on each change acknowledged by the NCP
+    sink_table.reset();
+    sink_table_load_index = 0;
+    gpSinkGetEntry(sink_table_load_index);
+
     // set state
     setSinkState(SINK_READY);
 }
@@ -115,7 +143,7 @@ bool CGpSink::gpClearAllTables()
 
         // proxy table
         proxy_table_index = 0;
-        dongle.sendCommand(EZSP_GP_PROXY_TABLE_GET_ENTRY,{proxy_table_index});
+        dongle.sendCommand(EZSP_GP_PROXY_TABLE_GET_ENTRY,{proxy_table_index},EZSP_PRIO_BULK);
 
         // set state
         setSinkState(SINK_CLEAR_ALL);
@@ -146,31 +174,45 @@ void CGpSink::registerGpds( const std::vector<CGpDevice> &gpd )
 {
     // save offline information
     gpds_to_register = gpd;
-
-    // request sink table entry
-    gpSinkTableFindOrAllocateEntry( gpds_to_register.back().getSourceId() );
+    if( gpds_to_register.empty() )
+    {
+        return;
+    }
 
     // set state
     setSinkState(SINK_COM_OFFLINE_IN_PROGRESS);
+
+    // write sink table entry, or wait for the sink table to be loaded
+    if( sink_table.isLoaded() )
+    {
+        gpSinkRegisterNextGpd();
+    }
 }
 
 void CGpSink::removeGpds( const std::vector<uint32_t> &gpd )
 {
     // save offline information
     gpds_to_remove = gpd;
-
-    // request sink table entry
-    gpSinkTableLookup( gpds_to_remove.back() );
+    if( gpds_to_remove.empty() )
+    {
+        return;
+    }
 
     // set state
     setSinkState(SINK_REMOVE_IN_PROGRESS);
+
+    // remove sink table entry, or wait for the sink table to be loaded
+    if( sink_table.isLoaded() )
+    {
+        gpSinkRemoveNextGpd();
+    }
 }
 
 void CGpSink::handleDongleState( EDongleState i_state )
 {
 }
 
-void CGpSink::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_receive )
+void CGpSink::handleEzspRxMessage( EEzspCmd i_cmd, const CFrameBuffer& i_msg_receive )
 {
     switch( i_cmd )
     {
@@ -182,7 +224,7 @@ void CGpSink::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_re
                 if( EMBER_SUCCESS == l_status )
                 {
                     // do remove action
-                    CEmberGpProxyTableEntryStruct l_entry(std::vector<uint8_t>(i_msg_receive.begin()+1,i_msg_receive.end()));
+                    CEmberGpProxyTableEntryStruct l_entry(CByteSpan(i_msg_receive).subspan(1));
                     CProcessGpPairingParam l_param(l_entry.getGpdAddress().getSourceId());
                     gpProxyTableProcessGpPairing(l_param);
                 }
@@ -240,20 +282,14 @@ void CGpSink::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_re
                 {
                     if(  GPF_COMMISSIONING_CMD == gpf.getCommandId() )
                     {
-                        // find entry in sink table
-                        gpSinkTableFindOrAllocateEntry(gpf.getSourceId());
-
-                        // save incomming message
-                        gpf_comm_frame = gpf;
-
-                        // set new state
-                        setSinkState(SINK_COM_IN_PROGRESS);
+                        // write sink table entry
+                        gpSinkCommission(gpf);
                     }
                 }
                 if( authorizeGpfChannelRqst && (GPF_CHANNEL_REQUEST_CMD == gpf.getCommandId()) )
                 {
                     // response only if next attempt is on same channel as us
-                    uint8_t l_next_channel_attempt = static_cast<uint8_t>(gpf.getPayload().at(0)&0x0F);
+                    uint8_t l_next_channel_attempt = static_cast<uint8_t>(CByteReader(gpf.getPayload()).readU8()&0x0F);
                     if( l_next_channel_attempt == (nwk_parameters.getRadioChannel()-11U) )
                     {
                         // send hannel configuration with timeout of 500ms
@@ -275,15 +311,16 @@ void CGpSink::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_re
                     if( GPF_MANUFACTURER_ATTRIBUTE_REPORTING == gpf.getCommandId() )
                     {
                         // assume manufacturing 0x1021 attribute 0x5000 of cluster 0x0000 is a secure channel request
-                        uint16_t l_manufacturer_id = dble_u8_to_u16(gpf.getPayload().at(1), gpf.getPayload().at(0));
+                        CByteReader l_reader(gpf.getPayload());
+                        uint16_t l_manufacturer_id = l_reader.readU16();
                         if( 0x1021 == l_manufacturer_id )
                         {
-                            uint16_t l_cluster_id = dble_u8_to_u16(gpf.getPayload().at(3), gpf.getPayload().at(2));
-                            uint16_t l_attribute_id = dble_u8_to_u16(gpf.getPayload().at(5), gpf.getPayload().at(4));
-                            uint8_t l_type_id = gpf.getPayload().at(6);
-                            //uint8_t l_device_id = gpf.getPayload().at(7);	// Unused for now
+                            uint16_t l_cluster_id = l_reader.readU16();
+                            uint16_t l_attribute_id = l_reader.readU16();
+                            uint8_t l_type_id = l_reader.readU8();
+                            //uint8_t l_device_id = l_reader.readU8();	// Unused for now
 
-                            if( (0==l_cluster_id) && (0x5000==l_attribute_id) && (0x20==l_type_id) )
+                            if( l_reader.isValid() && (0==l_cluster_id) && (0x5000==l_attribute_id) && (0x20==l_type_id) )
                             {
                                 // verify that no message is waiting to send
                                 bool l_found = false;
@@ -315,64 +352,23 @@ void CGpSink::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_re
         }
         break;
 
-        case EZSP_GP_SINK_TABLE_FIND_OR_ALLOCATE_ENTRY:
+        case EZSP_GP_SINK_TABLE_REMOVE_ENTRY:
         {
-            if( SINK_COM_IN_PROGRESS == sink_state )
-            {
-                // save allocate index
-                sink_table_index = i_msg_receive.at(0);
-
-                // debug
-                clogD << "EZSP_GP_SINK_TABLE_FIND_OR_ALLOCATE_ENTRY response index : " << std::hex << std::setw(2) << std::setfill('0') << sink_table_index << std::endl;
-
-                // retrieve entry at selected index
-                if( 0xFF != sink_table_index )
-                {
-                    gpSinkGetEntry( sink_table_index );
-                }
-                else
-                {
-                    // no place to done pairing : FAILED
-                    clogD << "INVALID SINK TABLE ENTRY, PAIRING FAILED !!" << std::endl;
-                    setSinkState(SINK_READY);
-                }
-            }
-            else if( SINK_COM_OFFLINE_IN_PROGRESS == sink_state )
+            if ( SINK_REMOVE_IN_PROGRESS == sink_state )
             {
-                // save allocate index
-                sink_table_index = i_msg_receive.at(0);
-
-                // debug
-                clogD << "EZSP_GP_SINK_TABLE_FIND_OR_ALLOCATE_ENTRY response index : " << std::hex << std::setw(2) << std::setfill('0') << sink_table_index << std::endl;
+                // keep mirror in sync
+                sink_table.removeEntry(sink_table_index);
 
-                // retrieve entry at selected index
-                if( 0xFF != sink_table_index )
-                {
-                    gpSinkGetEntry( sink_table_index );
-                }
-                else
-                {
-                    // no place to done pairing : FAILED
-                    clogD << "INVALID SINK TABLE ENTRY, PAIRING FAILED !!" << std::endl;
-                    setSinkState(SINK_READY);
-                }
+                // find proxy table entry
+                gpProxyTableLookup(gpds_to_remove.back());
             }
         }
         break;
 
-        case EZSP_GP_SINK_TABLE_LOOKUP:
+        case EZSP_GP_SINK_TABLE_CLEAR_ALL:
         {
-            if ( SINK_REMOVE_IN_PROGRESS == sink_state )
-            {
-                if( 0xFF != i_msg_receive.at(0) )
-                {
-                    // remove index
-                    gpSinkTableRemoveEntry(i_msg_receive.at(0));
-                }
-
-                // find proxy table entry
-                gpProxyTableLookup(gpds_to_remove.back());
-            }
+            // keep mirror in sync
+            sink_table.removeAllEntries();
         }
         break;
 
@@ -396,7 +392,7 @@ void CGpSink::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_re
                 }
                 else
                 {
-                    gpSinkTableLookup(gpds_to_remove.back());
+                    gpSinkRemoveNextGpd();
                 }
             }
         }
@@ -404,69 +400,35 @@ void CGpSink::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_re
 
         case EZSP_GP_SINK_TABLE_GET_ENTRY:
         {
-            if( SINK_COM_IN_PROGRESS == sink_state )
+            // only read while loading the sink table
+            if( !sink_table.isLoaded() )
             {
                 EEmberStatus l_status = static_cast<EEmberStatus>(i_msg_receive.at(0));
-                CEmberGpSinkTableEntryStruct l_entry({i_msg_receive.begin()+1,i_msg_receive.end()});
-
-                // debug
-                clogD << "EZSP_GP_SINK_TABLE_GET_ENTRY Response status :" <<  CEzspEnum::EEmberStatusToString(l_status) << ", table entry : " << l_entry << std::endl;
-
-                // decode payload
-                CGpdCommissioningPayload l_payload(gpf_comm_frame.getPayload(),gpf_comm_frame.getSourceId());
-
-                // debug
-                clogD << "GPD Commissioning payload : " << l_payload << std::endl;
-
-                // update sink table entry
-                CEmberGpAddressStruct l_gpd_addr(gpf_comm_frame.getSourceId());
-                CEmberGpSinkTableOption l_options(l_gpd_addr.getApplicationId(),l_payload);
-
-                l_entry.setEntryActive(true);
-                l_entry.setOptions(l_options);
-                l_entry.setGpdAddress(l_gpd_addr);
-                l_entry.setDeviceId(l_payload.getDeviceId());
-                l_entry.setAlias(static_cast<uint16_t>(gpf_comm_frame.getSourceId()&0xFFFF));
-                l_entry.setSecurityOption(l_payload.getExtendedOption()&0x1F);
-                l_entry.setFrameCounter(l_payload.getOutFrameCounter());
-                l_entry.setKey(l_payload.getKey());
-
-                // debug
-                clogD << "Update table entry : " << l_entry << std::endl;
-
-                // call
-                gpSinkSetEntry(sink_table_index,l_entry);
-
-                // save
-                sink_table_entry = l_entry;
-            }
-            else if( SINK_COM_OFFLINE_IN_PROGRESS == sink_state )
-            {
-                EEmberStatus l_status = static_cast<EEmberStatus>(i_msg_receive.at(0));
-                CEmberGpSinkTableEntryStruct l_entry({i_msg_receive.begin()+1,i_msg_receive.end()});
-
-                // debug
-                clogD << "EZSP_GP_SINK_TABLE_GET_ENTRY Response status :" <<  CEzspEnum::EEmberStatusToString(l_status) << ", table entry : " << l_entry << std::endl;
-
-                // update sink table entry
-                CEmberGpAddressStruct l_gp_addr(gpds_to_register.back().getSourceId());
-
-                l_entry.setEntryActive(true);
-                l_entry.setOptions(gpds_to_register.back().getSinkOption());
-                l_entry.setGpdAddress(l_gp_addr);
-                l_entry.setAlias(static_cast<uint16_t>(l_gp_addr.getSourceId()&0xFFFF));
-                l_entry.setSecurityOption(gpds_to_register.back().getSinkSecurityOption());
-                l_entry.setFrameCounter(0);
-                l_entry.setKey(gpds_to_register.back().getKey());
-
-                // debug
-                clogD << "Update table entry : " << l_entry << std::endl;
+                if( EMBER_SUCCESS == l_status )
+                {
+                    sink_table.setEntry(sink_table_load_index, CEmberGpSinkTableEntryStruct(CByteSpan(i_msg_receive).subspan(1)));
+                    if( sink_table_load_index < (GP_SINK_INVALID_ENTRY-1) )
+                    {
+                        // retrieve next entry
+                        sink_table_load_index++;
+                        gpSinkGetEntry(sink_table_load_index);
+                        break;
+                    }
+                }
 
-                // call
-                gpSinkSetEntry(sink_table_index,l_entry);
+                // assume end of table
+                sink_table.setLoaded();
+                clogI << "GP sink table loaded : " << sink_table.getActiveEntryCount() << " active entries out of " << sink_table.getSize() << std::endl;
 
-                // save
-                sink_table_entry = l_entry;
+                // process requests waiting for the sink table
+                if( SINK_COM_OFFLINE_IN_PROGRESS == sink_state )
+                {
+                    gpSinkRegisterNextGpd();
+                }
+                else if( SINK_REMOVE_IN_PROGRESS == sink_state )
+                {
+                    gpSinkRemoveNextGpd();
+                }
             }
         }
         break;
@@ -488,6 +450,9 @@ void CGpSink::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_re
                 }
                 else
                 {
+                    // keep mirror in sync
+                    sink_table.setEntry(sink_table_index, sink_table_entry);
+
                     // do proxy pairing
                     // \todo replace short and long sink network address by right value, currently we use group mode not so important
                     CProcessGpPairingParam l_param( sink_table_entry, true, false, 0, {0,0,0,0,0,0,0,0} );
@@ -515,8 +480,8 @@ void CGpSink::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_re
 
                 if( gpds_to_register.size() )
                 {
-                    // request sink table entry
-                    gpSinkTableFindOrAllocateEntry( gpds_to_register.back().getSourceId() );
+                    // write next sink table entry
+                    gpSinkRegisterNextGpd();
                 }
                 else
                 {
@@ -528,7 +493,7 @@ void CGpSink::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_re
             {
                 // retrieve next entry
                 proxy_table_index++;
-                dongle.sendCommand(EZSP_GP_PROXY_TABLE_GET_ENTRY,{proxy_table_index});
+                dongle.sendCommand(EZSP_GP_PROXY_TABLE_GET_ENTRY,{proxy_table_index},EZSP_PRIO_BULK);
             }
         }
         break;
@@ -544,10 +509,16 @@ void CGpSink::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_re
 
         case EZSP_D_GP_SENT_HANDLER:
         {
-            EEmberStatus l_status = static_cast<EEmberStatus>(i_msg_receive.at(0));
+            EEmberStatus l_status = EMBER_ERR_FATAL;
+            uint8_t l_handle = 0;
 
+            if( !CEzspDGpSentHandler::decodeResponse(i_msg_receive, l_status, l_handle) )
+            {
+                clogE << "EZSP_D_GP_SENT_HANDLER truncated" << std::endl;
+                break;
+            }
             if( EMBER_SUCCESS == l_status )
-                gpd_send_list.erase(i_msg_receive.at(1));
+                gpd_send_list.erase(l_handle);
 
             // debug
             clogD << "EZSP_D_GP_SENT_HANDLER Response status :" <<  CEzspEnum::EEmberStatusToString(l_status) << std::endl;
@@ -665,7 +636,7 @@ void CGpSink::gpBrCommissioningNotification( uint32_t i_gpd_src_id, uint8_t i_se
     CAPSFrame l_aps;
     l_aps.SetDefaultAPS(GP_PROFILE_ID,GP_CLUSTER_ID,GP_ENDPOINT);
     l_aps.src_ep = GP_ENDPOINT;
-    std::vector<uint8_t> l_ember_aps = l_aps.GetEmberAPS();
+    CFrameBuffer l_ember_aps = l_aps.GetEmberAPS();
     l_proxy_br_payload.insert(l_proxy_br_payload.end(), l_ember_aps.begin(), l_ember_aps.end());
 
     // The message will be delivered to all nodes within radius hops of the sender. A radius of zero is converted to EMBER_MAX_HOPS.
@@ -773,24 +744,124 @@ void CAppDemo::gpSinkTableLookup( uint32_t i_src_id )
 }
 */
 
-void CGpSink::gpSinkTableFindOrAllocateEntry( uint32_t i_src_id )
+uint8_t CGpSink::gpSinkTableFindOrAllocateEntry( uint32_t i_src_id ) const
 {
-    // An EmberGpAddress struct containing a copy of the gpd address to be found.
-    CEmberGpAddressStruct l_gp_address(i_src_id);
+    uint8_t lo_index = sink_table.getEntryIndexForSourceId(i_src_id);
 
-    clogI << "EZSP_GP_SINK_TABLE_FIND_OR_ALLOCATE_ENTRY\n";
-    dongle.sendCommand(EZSP_GP_SINK_TABLE_FIND_OR_ALLOCATE_ENTRY,l_gp_address.getRaw());
+    if( GP_SINK_INVALID_ENTRY == lo_index )
+    {
+        lo_index = sink_table.getFreeEntryIndex();
+    }
+    return lo_index;
 }
 
-void CGpSink::gpSinkGetEntry( uint8_t i_index )
+void CGpSink::gpSinkCommission( const CGpFrame& i_gpf )
 {
-    std::vector<uint8_t> l_payload;
+    if( !sink_table.isLoaded() )
+    {
+        // the gpd repeats its commissioning frame
+        clogW << "GP sink table not loaded yet, commissioning frame ignored" << std::endl;
+        return;
+    }
 
-    // The index of the requested sink table entry.
-    l_payload.push_back(i_index);
+    // find entry in sink table
+    sink_table_index = gpSinkTableFindOrAllocateEntry(i_gpf.getSourceId());
+    if( GP_SINK_INVALID_ENTRY == sink_table_index )
+    {
+        // no place to done pairing : FAILED
+        clogD << "INVALID SINK TABLE ENTRY, PAIRING FAILED !!" << std::endl;
+        setSinkState(SINK_READY);
+        return;
+    }
+
+    // decode payload
+    CGpdCommissioningPayload l_payload(i_gpf.getPayload(),i_gpf.getSourceId());
+
+    // debug
+    clogD << "GPD Commissioning payload : " << l_payload << std::endl;
+
+    // update sink table entry
+    CEmberGpSinkTableEntryStruct l_entry = sink_table.getEntry(sink_table_index);
+    CEmberGpAddressStruct l_gpd_addr(i_gpf.getSourceId());
+    CEmberGpSinkTableOption l_options(l_gpd_addr.getApplicationId(),l_payload);
 
+    l_entry.setEntryActive(true);
+    l_entry.setOptions(l_options);
+    l_entry.setGpdAddress(l_gpd_addr);
+    l_entry.setDeviceId(l_payload.getDeviceId());
+    l_entry.setAlias(static_cast<uint16_t>(i_gpf.getSourceId()&0xFFFF));
+    l_entry.setSecurityOption(l_payload.getExtendedOption()&0x1F);
+    l_entry.setFrameCounter(l_payload.getOutFrameCounter());
+    l_entry.setKey(l_payload.getKey());
+
+    // debug
+    clogD << "Update table entry at index " << unsigned(sink_table_index) << " : " << l_entry << std::endl;
+
+    // call
+    gpSinkSetEntry(sink_table_index,l_entry);
+
+    // save
+    sink_table_entry = l_entry;
+
+    // set new state
+    setSinkState(SINK_COM_IN_PROGRESS);
+}
+
+void CGpSink::gpSinkRegisterNextGpd()
+{
+    const CGpDevice& l_gpd = gpds_to_register.back();
+
+    sink_table_index = gpSinkTableFindOrAllocateEntry(l_gpd.getSourceId());
+    if( GP_SINK_INVALID_ENTRY == sink_table_index )
+    {
+        // no place to done pairing : FAILED
+        clogD << "INVALID SINK TABLE ENTRY, PAIRING FAILED !!" << std::endl;
+        setSinkState(SINK_READY);
+        return;
+    }
+
+    // update sink table entry
+    CEmberGpSinkTableEntryStruct l_entry = sink_table.getEntry(sink_table_index);
+    CEmberGpAddressStruct l_gp_addr(l_gpd.getSourceId());
+
+    l_entry.setEntryActive(true);
+    l_entry.setOptions(l_gpd.getSinkOption());
+    l_entry.setGpdAddress(l_gp_addr);
+    l_entry.setAlias(static_cast<uint16_t>(l_gp_addr.getSourceId()&0xFFFF));
+    l_entry.setSecurityOption(l_gpd.getSinkSecurityOption());
+    l_entry.setFrameCounter(0);
+    l_entry.setKey(l_gpd.getKey());
+
+    // debug
+    clogD << "Update table entry at index " << unsigned(sink_table_index) << " : " << l_entry << std::endl;
+
+    // call
+    gpSinkSetEntry(sink_table_index,l_entry);
+
+    // save
+    sink_table_entry = l_entry;
+}
+
+void CGpSink::gpSinkRemoveNextGpd()
+{
+    sink_table_index = sink_table.getEntryIndexForSourceId(gpds_to_remove.back());
+    if( GP_SINK_INVALID_ENTRY != sink_table_index )
+    {
+        // remove index, proxy table is looked up once done
+        gpSinkTableRemoveEntry(sink_table_index);
+    }
+    else
+    {
+        // find proxy table entry
+        gpProxyTableLookup(gpds_to_remove.back());
+    }
+}
+
+void CGpSink::gpSinkGetEntry( uint8_t i_index )
+{
     clogI << "EZSP_GP_SINK_TABLE_GET_ENTRY\n";
-    dongle.sendCommand(EZSP_GP_SINK_TABLE_GET_ENTRY,l_payload);
+    // The index of the requested sink table entry, only read when loading the whole table
+    dongle.sendCommand(EZSP_GP_SINK_TABLE_GET_ENTRY,{i_index},EZSP_PRIO_BULK);
 }
 
 
@@ -819,34 +890,15 @@ void CGpSink::gpProxyTableProcessGpPairing( CProcessGpPairingParam& i_param )
 void CGpSink::gpSend(bool i_action, bool i_use_cca, CEmberGpAddressStruct i_gp_addr,
                 uint8_t i_gpd_command_id, std::vector<uint8_t> i_gpd_command_payload, uint16_t i_life_time_ms, uint8_t i_handle )
 {
-    std::vector<uint8_t> l_payload;
-
-    // The action to perform on the GP TX queue (true to add, false to remove).
-    l_payload.push_back(i_action);
-    // Whether to use ClearChannelAssessment when transmitting the GPDF.
-    l_payload.push_back(i_use_cca);
-    // The Address of the destination GPD.
-    std::vector<uint8_t> i_addr = i_gp_addr.getRaw();
-    l_payload.insert(l_payload.end(), i_addr.begin(), i_addr.end());
-    // The GPD command ID to send.
-    l_payload.push_back(i_gpd_command_id);
-    // The length of the GP command payload.
-    std::string::size_type payload_size = i_gpd_command_payload.size();
-    if (payload_size > static_cast<uint8_t>(-1)) {
-        clogE << "Payload size overflow: " << payload_size << ", truncating to a 255\n";
-        payload_size = static_cast<uint8_t>(-1);
+    if (i_gpd_command_payload.size() > EZSP_D_GP_SEND_MAX_GPD_ASDU_LENGTH) {
+        clogE << "Payload size overflow: " << i_gpd_command_payload.size() << ", truncating to " << EZSP_D_GP_SEND_MAX_GPD_ASDU_LENGTH << "\n";
     }
-    l_payload.push_back(static_cast<uint8_t>(payload_size));
-    // The GP command payload.
-    l_payload.insert(l_payload.end(), i_gpd_command_payload.begin(), i_gpd_command_payload.end());
-    // The handle to refer to the GPDF.
-    l_payload.push_back(i_handle);
-    // How long to keep the GPDF in the TX Queue.
-    l_payload.push_back(static_cast<uint8_t>(i_life_time_ms&0xFF));
-    l_payload.push_back(static_cast<uint8_t>((i_life_time_ms>>8)&0xFF));
 
     clogI << "EZSP_D_GP_SEND\n";
-    dongle.sendCommand(EZSP_D_GP_SEND,l_payload);
+    // the GPD only listens for a short time after its own transmission, do not let other commands delay this one
+    dongle.sendCommand(CEzspDGpSend::ID,
+                       CEzspDGpSend::requestPayload(i_action, i_use_cca, i_gp_addr, i_gpd_command_id, CByteSpan(i_gpd_command_payload), i_handle, i_life_time_ms),
+                       EZSP_PRIO_REALTIME);
 }
 
 void CGpSink::gpSinkTableRemoveEntry( uint8_t i_index )
@@ -862,13 +914,6 @@ void CGpSink::gpProxyTableLookup(uint32_t i_src_id)
     dongle.sendCommand(EZSP_GP_PROXY_TABLE_LOOKUP,i_addr.getRaw());
 }
 
-void CGpSink::gpSinkTableLookup(uint32_t i_src_id)
-{
-    CEmberGpAddressStruct i_addr(i_src_id);
-    clogI << "EZSP_GP_SINK_TABLE_LOOKUP\n";
-    dongle.sendCommand(EZSP_GP_SINK_TABLE_LOOKUP,i_addr.getRaw());
-}
-
 void CGpSink::setSinkState( ESinkState i_state )
 {
     sink_state = i_state;
@@ -13,6 +13,7 @@
 #include "../green-power-observer.h"
 #include "../ezsp-dongle.h"
 #include "zigbee-messaging.h"
+#include "green-power-sink-table.h"
 #include "../ezsp-protocol/struct/ember-gp-sink-table-entry-struct.h"
 #include "../ezsp-protocol/struct/ember-process-gp-pairing-parameter.h"
 #include "../ezsp-protocol/struct/ember-network-parameters.h"
@@ -47,6 +48,8 @@ public:
 
     /**
      * @brief Initialize sink, shall be done after a network init.
+     *
+     * The sink table of the NCP is read once, registrations and removals requested meanwhile are processed once it is loaded.
      */
     void init();
 
@@ -88,11 +91,18 @@ public:
      */
     void authorizeAnswerToGpfChannelRqst( bool i_authorize ){ authorizeGpfChannelRqst = i_authorize; }
 
+    /**
+     * @brief Get the host mirror of the sink table of the NCP
+     *
+     * @warning The mirror is updated from the thread handling the responses of the NCP, only read it from this thread or while no GP operation is in progress
+     */
+    const CGpSinkTable& getSinkTable() const { return sink_table; }
+
     /**
      * Observer
      */
     void handleDongleState( EDongleState i_state );
-    void handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_receive );
+    void handleEzspRxMessage( EEzspCmd i_cmd, const CFrameBuffer& i_msg_receive );
 
     /**
      * Managing Observer of this class
@@ -108,8 +118,9 @@ private:
     CEmberNetworkParameters nwk_parameters;
     bool authorizeGpfChannelRqst;
     // parameters to save for pairing/clearing
-    CGpFrame gpf_comm_frame;
     uint8_t sink_table_index;
+    uint8_t sink_table_load_index;
+    CGpSinkTable sink_table;
     std::vector<CGpDevice> gpds_to_register;
     CEmberGpSinkTableEntryStruct sink_table_entry;
     uint8_t proxy_table_index;
@@ -153,11 +164,30 @@ private:
     void gpSinkGetEntry( uint8_t i_index );
 
     /**
-     * @brief Finds or allocates a sink entry
-     * 
+     * @brief Finds or allocates a sink entry, from the mirror of the sink table
+     *
      * @param i_src_id GPD source ID address to search
+     *
+     * @return index of the entry of the gpd or of a free entry, GP_SINK_INVALID_ENTRY if the table is full
      */
-    void gpSinkTableFindOrAllocateEntry( uint32_t i_src_id );
+    uint8_t gpSinkTableFindOrAllocateEntry( uint32_t i_src_id ) const;
+
+    /**
+     * @brief Write the sink table entry of a gpd that sent a commissioning frame
+     *
+     * @param i_gpf The commissioning frame
+     */
+    void gpSinkCommission( const CGpFrame& i_gpf );
+
+    /**
+     * @brief Write the sink table entry of the last gpd of gpds_to_register
+     */
+    void gpSinkRegisterNextGpd();
+
+    /**
+     * @brief Remove the sink table entry of the last gpd of gpds_to_remove, if any, then look it up in the proxy table
+     */
+    void gpSinkRemoveNextGpd();
 
     /**
      * @brief Updates the sink table entry at the specified index.
@@ -199,11 +229,6 @@ private:
      */
     void gpProxyTableLookup(uint32_t i_src_id);
 
-    /**
-     * @brief search entry in sink table for a gpd by source id
-     * @param i_src_id : source id of gpd to found
-     */
-    void gpSinkTableLookup(uint32_t i_src_id);
 };
 
 #ifdef USE_RARITAN
@@ -5,16 +5,24 @@
  */
 
 #include "zigbee-messaging.h"
+#include "../ezsp-protocol/ezsp-commands.h"
 
 #include "../../spi/GenericLogger.h"
 
 
 CZigbeeMessaging::CZigbeeMessaging( CEzspDongle &i_dongle, ITimerFactory &i_timer_factory ): dongle(i_dongle), timer_factory(i_timer_factory)
 {
-    dongle.registerObserver(this);
+    // only get the messages handled by handleEzspRxMessage()
+    const EEzspCmd l_handled_cmds[] = {
+        EZSP_MESSAGE_SENT_HANDLER
+    };
+    for( EEzspCmd l_cmd : l_handled_cmds )
+    {
+        dongle.subscribe(l_cmd, [this](EEzspCmd i_cmd, CByteSpan i_msg_receive) { this->handleEzspRxMessage(i_cmd, CFrameBuffer(i_msg_receive)); });
+    }
 }
 
-void CZigbeeMessaging::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_receive )
+void CZigbeeMessaging::handleEzspRxMessage( EEzspCmd i_cmd, const CFrameBuffer& i_msg_receive )
 {
     switch( i_cmd )
     {
@@ -40,31 +48,15 @@ void CZigbeeMessaging::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t>
  */
 void CZigbeeMessaging::SendBroadcast( EOutBroadcastDestination i_destination, uint8_t i_radius, CZigBeeMsg i_msg)
 {
-    std::vector<uint8_t> l_payload;
-    std::vector<uint8_t> l_zb_msg = i_msg.Get();
-
-    // destination
-    l_payload.push_back( static_cast<uint8_t>(i_destination&0xFF) );
-    l_payload.push_back( static_cast<uint8_t>((i_destination>>8)&0xFF) );
-
-    // aps frame
-    std::vector<uint8_t> v_tmp = i_msg.GetAps().GetEmberAPS();
-    l_payload.insert(l_payload.end(), v_tmp.begin(), v_tmp.end());
-
-    // radius
-    l_payload.push_back( i_radius );
- 
-    // message tag : not used for this simplier demo
-    l_payload.push_back( 0 );
-
-    // message length
-    l_payload.push_back( static_cast<uint8_t>(l_zb_msg.size()) );
-
-    // message content
-    l_payload.insert(l_payload.end(), l_zb_msg.begin(), l_zb_msg.end());
+    CFrameBuffer l_zb_msg = i_msg.Get();
 
+    if( l_zb_msg.size() > EZSP_SEND_BROADCAST_MAX_MESSAGE_LENGTH )
+    {
+        clogE << "CZigbeeMessaging::SendBroadcast message too long: " << l_zb_msg.size() << ", truncating to " << EZSP_SEND_BROADCAST_MAX_MESSAGE_LENGTH << std::endl;
+    }
 
-    dongle.sendCommand(EZSP_SEND_BROADCAST, l_payload);
+    // message tag is not used for this simplier demo
+    dongle.sendCommand(CEzspSendBroadcast::ID, CEzspSendBroadcast::requestPayload(i_destination, i_msg.GetAps(), i_radius, 0, CByteSpan(l_zb_msg)));
 }
 
 /**
@@ -74,31 +66,15 @@ void CZigbeeMessaging::SendBroadcast( EOutBroadcastDestination i_destination, ui
  */
 void CZigbeeMessaging::SendUnicast( EmberNodeId i_node_id, CZigBeeMsg i_msg )
 {
-    std::vector<uint8_t> l_payload;
-    std::vector<uint8_t> l_zb_msg = i_msg.Get();
-
-    // only direct unicast is supported for now
-    l_payload.push_back( EMBER_OUTGOING_DIRECT );
-
-    // destination
-    l_payload.push_back( static_cast<uint8_t>(i_node_id&0xFF) );
-    l_payload.push_back( static_cast<uint8_t>((i_node_id>>8)&0xFF) );
-
-    // aps frame
-    std::vector<uint8_t> v_tmp = i_msg.GetAps().GetEmberAPS();
-    l_payload.insert(l_payload.end(), v_tmp.begin(), v_tmp.end());
- 
-    // message tag : not used for this simplier demo
-    l_payload.push_back( 0 );
-
-    // message length
-    l_payload.push_back( static_cast<uint8_t>(l_zb_msg.size()) );
-
-    // message content
-    l_payload.insert(l_payload.end(), l_zb_msg.begin(), l_zb_msg.end());
+    CFrameBuffer l_zb_msg = i_msg.Get();
 
+    if( l_zb_msg.size() > EZSP_SEND_UNICAST_MAX_MESSAGE_LENGTH )
+    {
+        clogE << "CZigbeeMessaging::SendUnicast message too long: " << l_zb_msg.size() << ", truncating to " << EZSP_SEND_UNICAST_MAX_MESSAGE_LENGTH << std::endl;
+    }
 
-    dongle.sendCommand(EZSP_SEND_UNICAST, l_payload);
+    // only direct unicast is supported for now, message tag is not used for this simplier demo
+    dongle.sendCommand(CEzspSendUnicast::ID, CEzspSendUnicast::requestPayload(EMBER_OUTGOING_DIRECT, i_node_id, i_msg.GetAps(), 0, CByteSpan(l_zb_msg)));
 }
 
 /**
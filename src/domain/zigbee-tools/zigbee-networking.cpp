@@ -8,6 +8,7 @@
 
 #include "zigbee-networking.h"
 
+#include "../ezsp-protocol/ezsp-commands.h"
 #include "../ezsp-protocol/get-network-parameters-response.h"
 #include "../ezsp-protocol/struct/ember-key-struct.h"
 #include "../ezsp-protocol/struct/ember-child-data-struct.h"
@@ -22,10 +23,25 @@ CZigbeeNetworking::CZigbeeNetworking( CEzspDongle &i_dongle, CZigbeeMessaging &i
     discoverCallbackFct(nullptr),
     form_channel(DEFAULT_RADIO_CHANNEL)
 {
-    dongle.registerObserver(this);
+    // only get the messages handled by handleEzspRxMessage()
+    const EEzspCmd l_handled_cmds[] = {
+        EZSP_PERMIT_JOINING,
+        EZSP_SEND_BROADCAST,
+        EZSP_GET_CHILD_DATA,
+        EZSP_SET_INITIAL_SECURITY_STATE,
+        EZSP_SET_CONFIGURATION_VALUE,
+        EZSP_ADD_ENDPOINT,
+        EZSP_NETWORK_INIT,
+        EZSP_FORM_NETWORK,
+        EZSP_LEAVE_NETWORK
+    };
+    for( EEzspCmd l_cmd : l_handled_cmds )
+    {
+        dongle.subscribe(l_cmd, [this](EEzspCmd i_cmd, CByteSpan i_msg_receive) { this->handleEzspRxMessage(i_cmd, CFrameBuffer(i_msg_receive)); });
+    }
 }
 
-void CZigbeeNetworking::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_receive )
+void CZigbeeNetworking::handleEzspRxMessage( EEzspCmd i_cmd, const CFrameBuffer& i_msg_receive )
 {
     // clogD << "CZigbeeNetworking::handleEzspRxMessage : " << CEzspEnum::EEzspCmdToString(i_cmd) << std::endl;
 
@@ -47,8 +63,7 @@ void CZigbeeNetworking::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t
             clogD << "EZSP_GET_CHILD_DATA return  at index : " << unsigned(child_idx) << ", status : " << CEzspEnum::EEmberStatusToString(static_cast<EEmberStatus>(i_msg_receive.at(0))) << std::endl;
             if( EMBER_SUCCESS == i_msg_receive.at(0) )
             {
-                i_msg_receive.erase(i_msg_receive.begin());
-                CEmberChildDataStruct l_rsp(i_msg_receive);
+                CEmberChildDataStruct l_rsp(CByteSpan(i_msg_receive).subspan(1));
                 clogD << l_rsp.String() << std::endl;
 
                 // appeler la fonction de nouveau produit
@@ -121,60 +136,27 @@ void CZigbeeNetworking::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t
 
 void CZigbeeNetworking::stackInit(const std::vector<SEzspConfig>& l_config, const std::vector<SEzspPolicy>& l_policy)
 {
-  std::vector<uint8_t> l_payload;
-
   // set config
   for(auto it : l_config)
   {
-    l_payload.clear();
-    l_payload.push_back(it.id);
-    l_payload.push_back(u16_get_lo_u8(it.value));
-    l_payload.push_back(u16_get_hi_u8(it.value));
     //clogD << "EZSP_SET_CONFIGURATION_VALUE : " << unsigned(l_config[loop].id) << std::endl;
-    dongle.sendCommand(EZSP_SET_CONFIGURATION_VALUE, l_payload);
+    dongle.sendCommand(CEzspSetConfigurationValue::ID, CEzspSetConfigurationValue::requestPayload(it.id, it.value));
   }
 
   // set policy
   for(auto it : l_policy)
   {
-    l_payload.clear();
-    l_payload.push_back(it.id);
-    l_payload.push_back(it.decision);
     //clogD << "EZSP_SET_POLICY : " << unsigned(l_policy[loop].id) << std::endl;
-    dongle.sendCommand(EZSP_SET_POLICY, l_payload);
+    dongle.sendCommand(CEzspSetPolicy::ID, CEzspSetPolicy::requestPayload(it.id, it.decision));
   }
 
-  // add endpoint 1 : gateway device
-  l_payload.clear();
-  l_payload.push_back(1); // ep number
-  l_payload.push_back(0x04U); // profile id
-  l_payload.push_back(0x01U);
-  l_payload.push_back(0x07U); // device id
-  l_payload.push_back(0x00U);
-  l_payload.push_back(0); // flags
-  l_payload.push_back(1); // in cluster count
-  l_payload.push_back(1); // out cluster count
-  l_payload.push_back(0); // in cluster
-  l_payload.push_back(0);
-  l_payload.push_back(0); // out cluster
-  l_payload.push_back(0);
-  dongle.sendCommand(EZSP_ADD_ENDPOINT, l_payload);
-
-  // add endpoint 242 : green power
-  l_payload.clear();
-  l_payload.push_back(242); // ep number
-  l_payload.push_back(0x0EU); // profile id
-  l_payload.push_back(0xA1U);
-  l_payload.push_back(0x64U); // device id
-  l_payload.push_back(0x00U);
-  l_payload.push_back(0); // flags
-  l_payload.push_back(1); // in cluster count
-  l_payload.push_back(1); // out cluster count
-  l_payload.push_back(0x21); // in cluster
-  l_payload.push_back(0);
-  l_payload.push_back(0x21); // out cluster
-  l_payload.push_back(0);
-  dongle.sendCommand(EZSP_ADD_ENDPOINT, l_payload);
+  // add endpoint 1 : gateway device (profile 0x0104, device 0x0007, basic cluster in and out)
+  dongle.sendCommand(CEzspAddEndpoint<1,1>::ID, CEzspAddEndpoint<1,1>::requestPayload(1, 0x0104U, 0x0007U, 0, 1, 1,
+                                                                                        std::array<uint16_t,1>{{0x0000U}}, std::array<uint16_t,1>{{0x0000U}}));
+
+  // add endpoint 242 : green power (profile 0xA10E, device 0x0064, green power cluster in and out)
+  dongle.sendCommand(CEzspAddEndpoint<1,1>::ID, CEzspAddEndpoint<1,1>::requestPayload(242, 0xA10EU, 0x0064U, 0, 1, 1,
+                                                                                        std::array<uint16_t,1>{{0x0021U}}, std::array<uint16_t,1>{{0x0021U}}));
 }
 
 void CZigbeeNetworking::formHaNetwork(uint8_t channel)
@@ -184,14 +166,11 @@ void CZigbeeNetworking::formHaNetwork(uint8_t channel)
     uint16_t l_security_bitmak = 0;
     std::srand(static_cast<unsigned int>(std::time(nullptr)));
 
-    payload.push_back(EZSP_TRUST_CENTER_POLICY); // EZSP_TRUST_CENTER_POLICY
-    payload.push_back(0x01); // EZSP_ALLOW_PRECONFIGURED_KEY_JOINS
-    dongle.sendCommand( EZSP_SET_POLICY, payload );
+    // EZSP_ALLOW_PRECONFIGURED_KEY_JOINS
+    dongle.sendCommand( CEzspSetPolicy::ID, CEzspSetPolicy::requestPayload(EZSP_TRUST_CENTER_POLICY, 0x01) );
 
-    payload.clear();
-    payload.push_back(EZSP_TC_KEY_REQUEST_POLICY); // EZSP_TC_KEY_REQUEST_POLICY
-    payload.push_back(0x50); // EZSP_DENY_TC_KEY_REQUESTS
-    dongle.sendCommand( EZSP_SET_POLICY, payload );
+    // EZSP_DENY_TC_KEY_REQUESTS
+    dongle.sendCommand( CEzspSetPolicy::ID, CEzspSetPolicy::requestPayload(EZSP_TC_KEY_REQUEST_POLICY, 0x50) );
 
     // set initial security state
     // EMBER_HAVE_PRECONFIGURED_KEY
@@ -77,7 +77,7 @@ void CAppDemo::handleDongleState( EDongleState i_state )
     }
 }
 
-bool CAppDemo::extractClusterReport( const std::vector<uint8_t >& payload, uint8_t& usedBytes )
+bool CAppDemo::extractClusterReport( const CByteSpan& payload, uint8_t& usedBytes )
 {
     size_t payloadSize = payload.size();
 
@@ -87,9 +87,9 @@ bool CAppDemo::extractClusterReport( const std::vector<uint8_t >& payload, uint8
         return false;
     }
 
-    uint16_t clusterId = dble_u8_to_u16(payload.at(1), payload.at(0));
-    uint16_t attributeId = dble_u8_to_u16(payload.at(3), payload.at(2));
-    uint8_t type = payload.at(4);
+    uint16_t clusterId = dble_u8_to_u16(payload[1], payload[0]);
+    uint16_t attributeId = dble_u8_to_u16(payload[3], payload[2]);
+    uint8_t type = payload[4];
 
     switch (clusterId)
     {
@@ -103,7 +103,7 @@ bool CAppDemo::extractClusterReport( const std::vector<uint8_t >& payload, uint8
                 }
                 else
                 {
-                    uint8_t value = payload.at(5);
+                    uint8_t value = payload[5];
                     std::cout << "Door is " << (value?"closed":"open") << "\n";
                     usedBytes = 6;
                     return true;
@@ -125,7 +125,7 @@ bool CAppDemo::extractClusterReport( const std::vector<uint8_t >& payload, uint8
                 }
                 else
                 {
-                    int16_t value = static_cast<int16_t>(dble_u8_to_u16(payload.at(6), payload.at(5)));
+                    int16_t value = static_cast<int16_t>(dble_u8_to_u16(payload[6], payload[5]));
                     std::cout << "Temperature: " << value/100 << "." << std::setw(2) << std::setfill('0') << value%100 << "°C\n";
                     usedBytes = 7;
                     return true;
@@ -147,7 +147,7 @@ bool CAppDemo::extractClusterReport( const std::vector<uint8_t >& payload, uint8
                 }
                 else
                 {
-                    int16_t value = static_cast<int16_t>(dble_u8_to_u16(payload.at(6), payload.at(5)));
+                    int16_t value = static_cast<int16_t>(dble_u8_to_u16(payload[6], payload[5]));
                     std::cout << "Humidity: " << value/100 << "." << std::setw(2) << std::setfill('0') << value%100 << "%\n";
                     usedBytes = 7;
                     return true;
@@ -169,7 +169,7 @@ bool CAppDemo::extractClusterReport( const std::vector<uint8_t >& payload, uint8
                 }
                 else
                 {
-                    uint8_t value = static_cast<uint8_t>(payload.at(5));
+                    uint8_t value = static_cast<uint8_t>(payload[5]);
                     std::cout << "Battery level: " << value/10 << "." << std::setw(1) << std::setfill('0') << value%10 << "V\n";
                     usedBytes = 6;
                     return true;
@@ -187,7 +187,7 @@ bool CAppDemo::extractClusterReport( const std::vector<uint8_t >& payload, uint8
     }
 }
 
-bool CAppDemo::extractMultiClusterReport( std::vector<uint8_t > payload )
+bool CAppDemo::extractMultiClusterReport( CByteSpan payload )
 {
     uint8_t usedBytes = 0;
     bool validBuffer = true;
@@ -197,7 +197,7 @@ bool CAppDemo::extractMultiClusterReport( std::vector<uint8_t > payload )
         validBuffer = extractClusterReport(payload, usedBytes);
         if (validBuffer)
         {
-            payload.erase(payload.begin(), payload.begin()+static_cast<int>(usedBytes));
+            payload = payload.subspan(usedBytes);
         }
     }
     return validBuffer;
@@ -251,7 +251,7 @@ void CAppDemo::handleRxGpFrame( CGpFrame &i_gpf )
     }
 }
 
-void CAppDemo::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_receive ) {
+void CAppDemo::handleEzspRxMessage( EEzspCmd i_cmd, const CFrameBuffer& i_msg_receive ) {
     //-- clogD << "CAppDemo::ezspHandler " << CEzspEnum::EEzspCmdToString(i_cmd) << std::endl;
 
     switch( i_cmd )
@@ -346,8 +346,7 @@ void CAppDemo::handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_r
         case EZSP_GET_KEY:
         {
             EEmberStatus l_status = static_cast<EEmberStatus>(i_msg_receive.at(0));
-            i_msg_receive.erase(i_msg_receive.begin());
-            CEmberKeyStruct l_rsp(i_msg_receive);
+            CEmberKeyStruct l_rsp(CByteSpan(i_msg_receive).subspan(1));
             clogI << "EZSP_GET_KEY status : " << CEzspEnum::EEmberStatusToString(l_status) << ", " << l_rsp.String() << std::endl;
         }
         break;
@@ -6,6 +6,7 @@
 
 #include <vector>
 
+#include "../domain/byte-span.h"
 #include "../domain/ezsp-dongle.h"
 #include "../domain/zigbee-tools/zigbee-networking.h"
 #include "../domain/zigbee-tools/zigbee-messaging.h"
@@ -48,7 +49,7 @@ public:
      * Callback
      */
     void handleDongleState( EDongleState i_state );
-    void handleEzspRxMessage( EEzspCmd i_cmd, std::vector<uint8_t> i_msg_receive );
+    void handleEzspRxMessage( EEzspCmd i_cmd, const CFrameBuffer& i_msg_receive );
     void handleRxGpFrame( CGpFrame &i_gpf );
     void handleRxGpdId( uint32_t &i_gpd_id );
 
@@ -58,8 +59,8 @@ private:
     void stackInit();
     void chRqstTimeout(void);
 
-    static bool extractClusterReport( const std::vector<uint8_t >& payload, uint8_t& usedBytes );
-    static bool extractMultiClusterReport( std::vector<uint8_t > payload );
+    static bool extractClusterReport( const CByteSpan& payload, uint8_t& usedBytes );
+    static bool extractMultiClusterReport( CByteSpan payload );
 
 
 
@@ -6,6 +6,44 @@
  * Used as a dependency inversion paradigm
  */
 
+/**
+ * @defgroup logger_level_filtering Filtering of log statements before their arguments are evaluated
+ *
+ * Logging statements using the macros below only evaluate their arguments if the corresponding logger is outputting, thus
+ * @code
+ * clogD << "Frame: " << gpf.String() << std::endl;
+ * @endcode
+ * does not build any string when the debug level is disabled.
+ *
+ * In addition, LOGGER_MAX_COMPILED_LEVEL can be defined to the most verbose level that should be compiled in. Statements of more verbose levels are then removed at compile time, for example:
+ * @code
+ * CXXFLAGS += -DLOGGER_MAX_COMPILED_LEVEL=LOG_LEVEL::INFO
+ * @endcode
+ * strips all debug and trace statements from the build
+ *
+ *  @{
+ */
+
+#ifndef LOGGER_MAX_COMPILED_LEVEL
+/**
+ * @brief The most verbose log level compiled in (all levels by default)
+ */
+#define LOGGER_MAX_COMPILED_LEVEL LOG_LEVEL::TRACE
+#endif
+
+/**
+ * @brief Is a given level compiled in, and is the logger stream of this level outputting?
+ */
+#define LOGGER_IS_OUTPUTTING(level, stream) ((level) <= (LOGGER_MAX_COMPILED_LEVEL) && ILogger::isOutputting(stream))
+
+/**
+ * @brief Prefix a stream expression so that it is only evaluated if the logger outputs
+ *
+ * The if/else form keeps the result a single statement, that can safely be used in an unbraced if/else
+ */
+#define LOGGER_STREAM_IF(level, stream) if (!LOGGER_IS_OUTPUTTING(level, stream)) { } else stream
+/** @} */
+
 /**
  * @defgroup printf_compat_logger_macros printf-style logging functions
  *
@@ -29,21 +67,21 @@
  */
 #define plog SINGLETON_LOGGER_CLASS_NAME::getInstance().debugLogger.log
 /**
- * @brief Error logger getter
+ * @brief Error logger
  */
-#define plogE SINGLETON_LOGGER_CLASS_NAME::getInstance().errorLogger.log
+#define plogE(...) do { if (LOGGER_IS_OUTPUTTING(LOG_LEVEL::ERROR, ILogger::loggerErrorStream)) SINGLETON_LOGGER_CLASS_NAME::getInstance().errorLogger.log(__VA_ARGS__); } while (0)
 /**
- * @brief Warning logger getter
+ * @brief Warning logger
  */
-#define plogW SINGLETON_LOGGER_CLASS_NAME::getInstance().warningLogger.log
+#define plogW(...) do { if (LOGGER_IS_OUTPUTTING(LOG_LEVEL::WARNING, ILogger::loggerWarningStream)) SINGLETON_LOGGER_CLASS_NAME::getInstance().warningLogger.log(__VA_ARGS__); } while (0)
 /**
- * @brief Info logger getter
+ * @brief Info logger
  */
-#define plogI SINGLETON_LOGGER_CLASS_NAME::getInstance().infoLogger.log
+#define plogI(...) do { if (LOGGER_IS_OUTPUTTING(LOG_LEVEL::INFO, ILogger::loggerInfoStream)) SINGLETON_LOGGER_CLASS_NAME::getInstance().infoLogger.log(__VA_ARGS__); } while (0)
 /**
- * @brief Debug logger getter
+ * @brief Debug logger
  */
-#define plogD SINGLETON_LOGGER_CLASS_NAME::getInstance().debugLogger.log
+#define plogD(...) do { if (LOGGER_IS_OUTPUTTING(LOG_LEVEL::DEBUG, ILogger::loggerDebugStream)) SINGLETON_LOGGER_CLASS_NAME::getInstance().debugLogger.log(__VA_ARGS__); } while (0)
 /** @} */
 
 /**
@@ -53,7 +91,7 @@
  *
  * clog is a default logger stream
  * clogE is the error logger stream
- * thus
+ * The stream expression is only evaluated if the logger outputs (see @ref logger_level_filtering), thus
  * @code
  * clogE << "Error!";
  * @endcode
@@ -68,23 +106,23 @@
 /**
  * @brief Generic logger getter (uses debug level)
  */
-#define clog ILogger::loggerDebugStream
+#define clog LOGGER_STREAM_IF(LOG_LEVEL::DEBUG, ILogger::loggerDebugStream)
 /**
  * @brief Error logger getter
  */
-#define clogE ILogger::loggerErrorStream
+#define clogE LOGGER_STREAM_IF(LOG_LEVEL::ERROR, ILogger::loggerErrorStream)
 /**
  * @brief Warning logger getter
  */
-#define clogW ILogger::loggerWarningStream
+#define clogW LOGGER_STREAM_IF(LOG_LEVEL::WARNING, ILogger::loggerWarningStream)
 /**
  * @brief Info logger getter
  */
-#define clogI ILogger::loggerInfoStream
+#define clogI LOGGER_STREAM_IF(LOG_LEVEL::INFO, ILogger::loggerInfoStream)
 /**
  * @brief Debug logger getter
  */
-#define clogD ILogger::loggerDebugStream
+#define clogD LOGGER_STREAM_IF(LOG_LEVEL::DEBUG, ILogger::loggerDebugStream)
 /** @} */
 
 
@@ -96,6 +134,8 @@
 
 #include <string>
 #include <cstdarg>
+#include <cstring>
+#include <mutex>
 #include <streambuf>
 #include <ostream>
 
@@ -115,15 +155,56 @@ typedef enum {
 	TRACE
 } LOG_LEVEL;
 
-/* FIXME: current implementation uses std::streambuf::overflow(), causing invokation of writes for each character, and thus forcing to re-implement line-split for Raritan's logger
- * we could use a better implementation like:
- * https://stackoverflow.com/questions/2638654/redirect-c-stdclog-to-syslog-on-unix
+/**
+ * Size of the line buffer of each ILoggerStream (including the terminating '\0'). Longer lines are split
  */
+#define ILOGGER_LINE_BUFFER_SIZE 512
+
+class ILoggerStream;
+
+/**
+ * @brief Abstract class to implement a sink receiving the lines of one or several ILoggerStream, and outputting them later on
+ *
+ * When attached to a stream (see ILoggerStream::setAsyncSink()), the sink receives complete lines instead of the stream's outputLine() method.
+ * It is then responsible for invoking output() for each line, typically from a background thread, so that logging does not slow down the caller.
+ */
+class ILoggerAsyncSink {
+public:
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~ILoggerAsyncSink() { }
+
+	/**
+	 * @brief Queue a line for later output
+	 *
+	 * @param origin The stream the line has been logged to
+	 * @param line The text of the line (without the trailing newline, '\0' terminated)
+	 * @param length The length of the line
+	 *
+	 * @note This method should not block. Lines that cannot be queued may be dropped
+	 */
+	virtual void push(ILoggerStream& origin, const char* line, size_t length) = 0;
+
+protected:
+	/**
+	 * @brief Output a line that has been queued to the concrete logger it has been logged to
+	 *
+	 * @param origin The stream the line has been logged to
+	 * @param line The text of the line (without the trailing newline, '\0' terminated)
+	 * @param length The length of the line
+	 */
+	static void output(ILoggerStream& origin, const char* line, size_t length);
+};
+
 /**
  * @brief Abstract class to implement and ostream-compatible message logger
  *
  * Specialized loggers should derive from this virtual class in order to provide a concrete implementation of a logging mechanism.
  *
+ * Characters written to the stream are buffered, and the concrete implementation receives one complete line at a time through outputLine().
+ * Strings are appended at once (xsputn()), and nothing is buffered while the logger is not outputting.
+ *
  * A concrete implementation that specializes the ILogger class should also derive logger implementations from ILoggerStream, then instanciate each of these loggers statically in their concrete implementation .cpp file:
  * @code
  * static MyErrorLogger myErrorLoggerInstance;
@@ -161,9 +242,27 @@ public:
 	ILoggerStream(const LOG_LEVEL setLogLevel, const bool isEnabled = true) :
 		logLevel(setLogLevel),
 		enabled(isEnabled),
-		muted(false) {
+		muted(false),
+		lineMutex(),
+		lineBuffer(),
+		lineLength(0),
+		asyncSink(nullptr) {
 	}
 
+	/**
+	 * @brief Copy constructor
+	 *
+	 * Copy construction is forbidden on this class, as it holds the line being built
+	 */
+	ILoggerStream(const ILoggerStream& other) = delete;
+
+	/**
+	 * @brief Assignment operator
+	 *
+	 * Assignment is forbidden on this class, as it holds the line being built
+	 */
+	ILoggerStream& operator=(const ILoggerStream& other) = delete;
+
 	/**
 	 * @brief Destructor
 	 */
@@ -210,26 +309,115 @@ public:
 	 */
 	virtual void log(const char *format, ...) = 0;
 
+	/**
+	 * @brief Hand over complete lines to an asynchronous sink rather than outputting them directly
+	 *
+	 * @param sink The sink to use, or nullptr to output lines synchronously again (the sink must outlive this stream, or be detached before its destruction)
+	 */
+	void setAsyncSink(ILoggerAsyncSink* sink) {
+		std::lock_guard<std::mutex> lock(this->lineMutex);
+		this->asyncSink = sink;
+	}
+
 protected:
+	friend class ILoggerAsyncSink;
+
 	/**
-	 * @brief Receive one character of an output stream
+	 * @brief Output one complete line
 	 *
 	 * This method is purely virtual and should be overridden by inheriting classes defining a concrete implementation
 	 *
-	 * @note This is the method allowing to implement an ostream out of this class
+	 * @param line The text of the line, without the trailing newline. line[length] is always '\0'
+	 * @param length The length of the line
+	 */
+	virtual void outputLine(const char* line, size_t length) = 0;
+
+	/**
+	 * @brief Receive one character of an output stream
+	 *
+	 * @note This is the method allowing to implement an ostream out of this class. It is invoked for characters written one by one (eg numbers)
 	 *
 	 * @param c The new character
 	 *
 	 * @return The character that has actually been printed out to the log
 	 */
-	virtual int overflow(int c) = 0;
+	virtual int overflow(int c) {
+		if (c != traits_type::eof()) {
+			char ch = traits_type::to_char_type(c);
+			this->xsputn(&ch, 1);
+		}
+		return traits_type::not_eof(c);
+	}
+
+	/**
+	 * @brief Receive a sequence of characters of an output stream
+	 *
+	 * Characters are appended to the line buffer, and each complete line is output at once
+	 *
+	 * @param s The characters
+	 * @param n The number of characters
+	 *
+	 * @return The number of characters consumed (always @p n)
+	 */
+	virtual std::streamsize xsputn(const char* s, std::streamsize n) {
+		if (!this->isOutputting() || n <= 0) {
+			return n;
+		}
+		std::lock_guard<std::mutex> lock(this->lineMutex);	/* Loggers are shared between threads */
+		const char* end = s + n;
+		while (s < end) {
+			const char* eol = static_cast<const char*>(memchr(s, '\n', static_cast<size_t>(end - s)));
+			const char* chunkEnd = (eol != nullptr) ? eol : end;
+			while (s < chunkEnd) {
+				if (this->lineLength == ILOGGER_LINE_BUFFER_SIZE - 1) {
+					this->emitLine();	/* Line too long, split it */
+				}
+				size_t copied = static_cast<size_t>(chunkEnd - s);
+				if (copied > ILOGGER_LINE_BUFFER_SIZE - 1 - this->lineLength) {
+					copied = ILOGGER_LINE_BUFFER_SIZE - 1 - this->lineLength;
+				}
+				memcpy(this->lineBuffer + this->lineLength, s, copied);
+				this->lineLength += copied;
+				s += copied;
+			}
+			if (eol != nullptr) {
+				this->emitLine();
+				s = eol + 1;
+			}
+		}
+		return n;
+	}
+
+private:
+	/**
+	 * @brief Output the line buffer and empty it. lineMutex must be held
+	 */
+	void emitLine() {
+		this->lineBuffer[this->lineLength] = '\0';
+		if (this->asyncSink != nullptr) {
+			this->asyncSink->push(*this, this->lineBuffer, this->lineLength);
+		}
+		else {
+			this->outputLine(this->lineBuffer, this->lineLength);
+		}
+		this->lineLength = 0;
+	}
 
 protected:
 	LOG_LEVEL logLevel;	/*!< The log level handled by this instance of the logger, set at construction, then must not be modified anymore */
 	bool enabled;	/*!< Is this logger currently enabled. */
 	bool muted;	/*!< Is this logger muted */
+private:
+	std::mutex lineMutex;	/*!< Protects the line buffer below */
+	char lineBuffer[ILOGGER_LINE_BUFFER_SIZE];	/*!< The line currently being built */
+	size_t lineLength;	/*!< The number of characters in lineBuffer */
+	ILoggerAsyncSink* asyncSink;	/*!< The sink complete lines are handed over to, or nullptr to output them directly */
 };
 
+inline void ILoggerAsyncSink::output(ILoggerStream& origin, const char* line, size_t length) {
+	origin.outputLine(line, length);
+}
+
 /**
  * @brief Class to output log messages
  *
@@ -309,6 +497,31 @@ public:
 		this->traceLogger.setMaxEnabledLogLevel(logLevel);
 	}
 
+	/**
+	 * @brief Is a logger stream currently outputting?
+	 *
+	 * @param stream One of the global logger streams (eg loggerDebugStream)
+	 *
+	 * @return true if the ILoggerStream behind @p stream is enabled and not muted
+	 */
+	static bool isOutputting(const std::ostream& stream) {
+		const ILoggerStream* logger = static_cast<const ILoggerStream*>(stream.rdbuf());
+		return (logger != nullptr && logger->isOutputting());
+	}
+
+	/**
+	 * @brief Hand over the lines of all enclosed loggers to an asynchronous sink
+	 *
+	 * @param sink The sink to use, or nullptr to output lines synchronously again
+	 */
+	virtual void setAsyncSink(ILoggerAsyncSink* sink) {
+		this->errorLogger.setAsyncSink(sink);
+		this->warningLogger.setAsyncSink(sink);
+		this->infoLogger.setAsyncSink(sink);
+		this->debugLogger.setAsyncSink(sink);
+		this->traceLogger.setAsyncSink(sink);
+	}
+
 	/**
 	 * @brief Generic message logger method
 	 *
@@ -25,13 +25,10 @@ void ConsoleStderrLogger::log(const char *format, ...) {
 	}
 }
 
-int ConsoleStderrLogger::overflow(int c) {
-	if (c != EOF && this->enabled && !this->muted) {
-		if (putchar(c) == EOF) {
-			return EOF;
-		}
+void ConsoleStderrLogger::outputLine(const char* line, size_t length) {
+	if (this->enabled && !this->muted) {
+		printf("%.*s\n", static_cast<int>(length), line);	/* A single call per line, so that lines are not mixed with other stdio output */
 	}
-	return c;
 }
 
 /**
@@ -69,13 +66,10 @@ void ConsoleStdoutLogger::log(const char *format, ...) {
 	}
 }
 
-int ConsoleStdoutLogger::overflow(int c) {
-	if (c != EOF && this->enabled && !this->muted) {
-		if (putchar(c) == EOF) {
-			return EOF;
-		}
+void ConsoleStdoutLogger::outputLine(const char* line, size_t length) {
+	if (this->enabled && !this->muted) {
+		printf("%.*s\n", static_cast<int>(length), line);	/* A single call per line, so that lines are not mixed with other stdio output */
 	}
-	return c;
 }
 
 /**
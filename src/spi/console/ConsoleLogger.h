@@ -64,13 +64,12 @@ public:
 
 protected:
 	/**
-	 * @brief Receive one character of an output stream
+	 * @brief Output one complete line
 	 *
-	 * @param c The new character
-	 *
-	 * @return The character that has actually been printed out to the log
+	 * @param line The text of the line, without the trailing newline
+	 * @param length The length of the line
 	 */
-	virtual int overflow(int c);
+	virtual void outputLine(const char* line, size_t length);
 };
 
 /**
@@ -125,13 +124,12 @@ public:
 
 protected:
 	/**
-	 * @brief Receive one character of an output stream
-	 *
-	 * @param c The new character
+	 * @brief Output one complete line
 	 *
-	 * @return The character that has actually been printed out to the log
+	 * @param line The text of the line, without the trailing newline
+	 * @param length The length of the line
 	 */
-	virtual int overflow(int c);
+	virtual void outputLine(const char* line, size_t length);
 };
 
 /**
@@ -0,0 +1,131 @@
+/**
+ * @file CppThreadsAsyncLoggerSink.cpp
+ *
+ * @brief Concrete implementation of ILoggerAsyncSink, queueing lines in a lock-free ring drained by a C++11 thread
+ */
+
+#include "CppThreadsAsyncLoggerSink.h"
+
+#include <chrono>
+
+CppThreadsAsyncLoggerSink::CppThreadsAsyncLoggerSink(size_t slots) :
+	m_mask(0),
+	m_slots(),
+	m_enqueue_pos(0),
+	m_dequeue_pos(0),
+	m_dropped(0),
+	m_idle(false),
+	m_stopping(false),
+	m_wakeup_mutex(),
+	m_wakeup(),
+	m_thread() {
+	size_t size = 2;
+	while (size < slots) {
+		size <<= 1;
+	}
+	m_mask = size - 1;
+	m_slots.reset(new SSlot[size]);
+	for (size_t i = 0; i < size; i++) {
+		m_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	m_thread = std::thread(&CppThreadsAsyncLoggerSink::run, this);
+}
+
+CppThreadsAsyncLoggerSink::~CppThreadsAsyncLoggerSink() {
+	{
+		std::lock_guard<std::mutex> lock(m_wakeup_mutex);
+		m_stopping = true;
+	}
+	m_wakeup.notify_one();
+	m_thread.join();
+}
+
+void CppThreadsAsyncLoggerSink::push(ILoggerStream& origin, const char* line, size_t length) {
+	size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+	SSlot* slot;
+
+	/* Claim a slot (bounded multi-producer queue, each slot carrying a sequence number telling whether it is free for position pos) */
+	while (true) {
+		slot = &m_slots[pos & m_mask];
+		size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		if (sequence == pos) {
+			if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (sequence < pos) {
+			/* The slot still holds the line written one revolution ago: the ring is full */
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		else {
+			pos = m_enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	if (length > ILOGGER_LINE_BUFFER_SIZE - 1) {
+		length = ILOGGER_LINE_BUFFER_SIZE - 1;
+	}
+	memcpy(slot->line, line, length);
+	slot->line[length] = '\0';
+	slot->length = length;
+	slot->origin = &origin;
+	slot->sequence.store(pos + 1, std::memory_order_release);
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);	/* Pairs with the fence in run(): either the thread sees our line, or we see it idle */
+	if (m_idle.load(std::memory_order_relaxed)) {
+		/* Only take the mutex when the thread may be waiting, so that busy loggers never contend on it */
+		std::lock_guard<std::mutex> lock(m_wakeup_mutex);
+		m_wakeup.notify_one();
+	}
+}
+
+void CppThreadsAsyncLoggerSink::flush() {
+	size_t target = m_enqueue_pos.load();
+
+	while (m_dequeue_pos.load() < target) {
+		{
+			std::lock_guard<std::mutex> lock(m_wakeup_mutex);
+			m_wakeup.notify_one();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+size_t CppThreadsAsyncLoggerSink::getDroppedLinesCount() const {
+	return m_dropped.load();
+}
+
+bool CppThreadsAsyncLoggerSink::outputNext() {
+	size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+	SSlot& slot = m_slots[pos & m_mask];
+
+	if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+		return false;	/* Empty, or the producer that claimed this slot is still copying its line */
+	}
+	ILoggerAsyncSink::output(*slot.origin, slot.line, slot.length);
+	slot.sequence.store(pos + m_mask + 1, std::memory_order_release);	/* Free for the next revolution */
+	m_dequeue_pos.store(pos + 1);
+	return true;
+}
+
+void CppThreadsAsyncLoggerSink::run() {
+	while (true) {
+		while (this->outputNext()) {
+		}
+		std::unique_lock<std::mutex> lock(m_wakeup_mutex);
+		m_idle = true;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		m_wakeup.wait(lock, [this]() {
+			size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+			return m_stopping || m_slots[pos & m_mask].sequence.load(std::memory_order_acquire) == pos + 1;
+		});
+		m_idle = false;
+		if (m_stopping) {
+			lock.unlock();
+			while (this->outputNext()) {
+			}
+			return;
+		}
+	}
+}
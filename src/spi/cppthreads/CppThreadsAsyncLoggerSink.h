@@ -0,0 +1,118 @@
+/**
+ * @file CppThreadsAsyncLoggerSink.h
+ *
+ * @brief Concrete implementation of ILoggerAsyncSink, queueing lines in a lock-free ring drained by a C++11 thread
+ */
+
+#pragma once
+
+#include "../ILogger.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * Default number of lines the ring can hold (must be a power of 2)
+ */
+#define ASYNC_LOGGER_SINK_DEFAULT_SLOTS 128
+
+/**
+ * @brief Asynchronous log sink, moving the actual output of log lines to a background thread
+ *
+ * Lines are copied into a bounded ring of fixed-size slots. Any number of threads may log concurrently: slots are claimed with a compare-and-swap, without taking any lock, and lines are output by the thread of the sink in the order their slots have been claimed.
+ * When the ring is full, new lines are dropped (and counted) rather than blocking the thread logging them.
+ *
+ * @code
+ * CppThreadsAsyncLoggerSink sink;
+ * ConsoleLogger::getInstance().setAsyncSink(&sink);
+ * ...
+ * ConsoleLogger::getInstance().setAsyncSink(nullptr);	// Before sink goes out of scope
+ * @endcode
+ */
+class CppThreadsAsyncLoggerSink : public ILoggerAsyncSink {
+public:
+	/**
+	 * @brief Constructor, starts the thread of the sink
+	 *
+	 * @param slots The number of lines the ring can hold (rounded up to a power of 2)
+	 */
+	CppThreadsAsyncLoggerSink(size_t slots = ASYNC_LOGGER_SINK_DEFAULT_SLOTS);
+
+	/**
+	 * @brief Copy constructor
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	CppThreadsAsyncLoggerSink(const CppThreadsAsyncLoggerSink& other) = delete;
+
+	/**
+	 * @brief Assignment operator
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	CppThreadsAsyncLoggerSink& operator=(const CppThreadsAsyncLoggerSink& other) = delete;
+
+	/**
+	 * @brief Destructor, outputs the lines still queued then stops the thread (streams must have been detached before)
+	 */
+	~CppThreadsAsyncLoggerSink();
+
+	/**
+	 * @brief Queue a line for output by the thread of the sink
+	 *
+	 * @param origin The stream the line has been logged to
+	 * @param line The text of the line (without the trailing newline)
+	 * @param length The length of the line
+	 */
+	void push(ILoggerStream& origin, const char* line, size_t length);
+
+	/**
+	 * @brief Wait until all the lines queued so far have been output
+	 */
+	void flush();
+
+	/**
+	 * @brief Get the number of lines dropped because the ring was full
+	 *
+	 * @return The number of lines dropped since the creation of this sink
+	 */
+	size_t getDroppedLinesCount() const;
+
+private:
+	/**
+	 * @brief A line queued in the ring
+	 */
+	struct SSlot {
+		SSlot() : sequence(0), origin(nullptr), length(0), line() { }
+		std::atomic<size_t> sequence;	/*!< Position in the ring this slot is ready to be written at (== position), or read at (== position + 1) */
+		ILoggerStream* origin;	/*!< The stream the line has been logged to */
+		size_t length;	/*!< The length of the line */
+		char line[ILOGGER_LINE_BUFFER_SIZE];	/*!< The text of the line, '\0' terminated */
+	};
+
+	bool outputNext();
+	void run();
+
+	size_t m_mask;	/*!< Number of slots minus one */
+	std::unique_ptr<SSlot[]> m_slots;	/*!< The ring */
+	std::atomic<size_t> m_enqueue_pos;	/*!< Position of the next slot to claim for writing */
+	std::atomic<size_t> m_dequeue_pos;	/*!< Position of the next slot to output (only modified by the thread of the sink) */
+	std::atomic<size_t> m_dropped;	/*!< Number of lines dropped */
+	std::atomic<bool> m_idle;	/*!< Is the thread waiting for lines */
+	std::atomic<bool> m_stopping;	/*!< Is the thread requested to terminate */
+	std::mutex m_wakeup_mutex;	/*!< Mutex associated with m_wakeup */
+	std::condition_variable m_wakeup;	/*!< Wakes up the thread when lines are queued */
+	std::thread m_thread;	/*!< The thread outputting the lines */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
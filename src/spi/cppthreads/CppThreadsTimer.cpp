@@ -12,6 +12,19 @@ CppThreadsTimer::CppThreadsTimer() :  waitingThread(), cv(), cv_m() { }
 
 CppThreadsTimer::~CppThreadsTimer() {
 	this->stop();
+	this->releaseWaitingThread();
+}
+
+void CppThreadsTimer::releaseWaitingThread() {
+	if (this->waitingThread.joinable()) {
+		if (this->waitingThread.get_id() == std::this_thread::get_id()) {
+			/* We are running inside the callback of this timer, the thread will terminate by itself after the callback */
+			this->waitingThread.detach();
+		}
+		else {
+			this->waitingThread.join();
+		}
+	}
 }
 
 bool CppThreadsTimer::start(uint16_t timeout, std::function<void (ITimer* triggeringTimer)> callBackFunction) {
@@ -29,11 +42,17 @@ bool CppThreadsTimer::start(uint16_t timeout, std::function<void (ITimer* trigge
 		callBackFunction(this);
 	}
 	else {
+		/* A previous thread may still be finishing (or we may be restarted from our own callback) */
+		this->releaseWaitingThread();
 		this->started = true;
 		this->waitingThread = std::thread([=]() {
 			std::unique_lock<std::mutex> lock(this->cv_m);
-			this->cv.wait_for(lock, std::chrono::milliseconds(timeout), [this]{return !this->started;});
-			callBackFunction(this);
+			if (!this->cv.wait_for(lock, std::chrono::milliseconds(timeout), [this]{return !this->started;})) {
+				/* Timeout reached (we have not been stopped), the callback is free to restart this timer */
+				this->started = false;
+				lock.unlock();
+				callBackFunction(this);
+			}
 		});
 	}
 
@@ -45,13 +64,12 @@ bool CppThreadsTimer::stop() {
 	if (! this->started) {
 		return false;
 	}
-	if (this->started) {
+	{
+		std::lock_guard<std::mutex> lock(this->cv_m);
 		this->started = false;
-		this->cv.notify_one();
-	}
-	if (this->waitingThread.joinable()) {
-		this->waitingThread.join();
 	}
+	this->cv.notify_one();
+	this->releaseWaitingThread();
 	this->duration = 0;
 	return true;
 }
@@ -50,6 +50,11 @@ public:
 	bool isRunning();
 
 private:
+	/**
+	 * @brief Wait for the termination of the waiting thread (or detach from it if we are running inside it)
+	 */
+	void releaseWaitingThread();
+
 	std::thread waitingThread;	/*!< The thread that will wait for the specified timeout and will then run the callback */
 	std::condition_variable cv;	/*!< A condition variable that allows to unlock the wait performed by waitingThread (this allows stopping that secondary thread) */
 	std::mutex cv_m;	/*!< A mutex to handle access to variable cv */
@@ -0,0 +1,241 @@
+/**
+ * @file CppThreadsTimerWheel.cpp
+ *
+ * @brief Concrete implementation of ITimer sharing a single C++11 thread between all timers, using a hashed timing wheel
+ */
+
+#include "CppThreadsTimerWheel.h"
+
+#include <vector>
+
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+
+CppThreadsWheelTimer::CppThreadsWheelTimer(CppThreadsTimerWheel& wheel) :
+	m_wheel(wheel),
+	m_prev(nullptr),
+	m_next(nullptr),
+	m_deadline(0),
+	m_rounds(0),
+	m_period(0),
+	m_callback() {
+}
+
+CppThreadsWheelTimer::~CppThreadsWheelTimer() {
+	m_wheel.releaseTimer(*this);
+}
+
+bool CppThreadsWheelTimer::start(uint16_t timeout, std::function<void (ITimer* triggeringTimer)> callBackFunction) {
+	return this->start(std::chrono::milliseconds(timeout), callBackFunction);
+}
+
+bool CppThreadsWheelTimer::start(std::chrono::milliseconds timeout, std::function<void (ITimer* triggeringTimer)> callBackFunction) {
+	if (!callBackFunction || timeout.count() < 0) {
+		return false;
+	}
+	if (timeout.count() == 0) {
+		if (this->started) {
+			return false;
+		}
+		this->duration = 0;
+		callBackFunction(this);
+		return true;
+	}
+	return m_wheel.startTimer(*this, static_cast<uint64_t>(timeout.count()), 0, callBackFunction);
+}
+
+bool CppThreadsWheelTimer::startPeriodic(std::chrono::milliseconds period, std::function<void (ITimer* triggeringTimer)> callBackFunction) {
+	if (!callBackFunction || period.count() <= 0) {
+		return false;
+	}
+	return m_wheel.startTimer(*this, static_cast<uint64_t>(period.count()), static_cast<uint64_t>(period.count()), callBackFunction);
+}
+
+bool CppThreadsWheelTimer::stop() {
+	return m_wheel.stopTimer(*this);
+}
+
+bool CppThreadsWheelTimer::isRunning() {
+	std::lock_guard<std::mutex> lock(m_wheel.m_mutex);
+	return this->started;
+}
+
+CppThreadsTimerWheel::CppThreadsTimerWheel() :
+	m_epoch(std::chrono::steady_clock::now()),
+	m_slots(),
+	m_processed(0),
+	m_active(0),
+	m_expiring(nullptr),
+	m_stopping(false),
+	m_mutex(),
+	m_wakeup(),
+	m_thread() {
+	/* Only start the thread once all attributes are initialized */
+	m_thread = std::thread(&CppThreadsTimerWheel::run, this);
+}
+
+CppThreadsTimerWheel::~CppThreadsTimerWheel() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_wakeup.notify_all();
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
+}
+
+std::unique_ptr<ITimer> CppThreadsTimerWheel::create() const {
+	return std::unique_ptr<ITimer>(new CppThreadsWheelTimer(const_cast<CppThreadsTimerWheel&>(*this)));
+}
+
+uint64_t CppThreadsTimerWheel::nowTick() const {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_epoch).count());
+}
+
+void CppThreadsTimerWheel::link(CppThreadsWheelTimer& timer) {
+	CppThreadsWheelTimer*& head = m_slots[timer.m_deadline & TIMER_WHEEL_MASK];
+
+	/* Number of visits of this slot before the deadline, the first one being at least one tick after m_processed */
+	timer.m_rounds = (timer.m_deadline - m_processed - 1) / TIMER_WHEEL_SLOTS;
+	timer.m_prev = nullptr;
+	timer.m_next = head;
+	if (head) {
+		head->m_prev = &timer;
+	}
+	head = &timer;
+	m_active++;
+}
+
+void CppThreadsTimerWheel::unlink(CppThreadsWheelTimer& timer) {
+	if (timer.m_prev) {
+		timer.m_prev->m_next = timer.m_next;
+	}
+	else {
+		m_slots[timer.m_deadline & TIMER_WHEEL_MASK] = timer.m_next;
+	}
+	if (timer.m_next) {
+		timer.m_next->m_prev = timer.m_prev;
+	}
+	timer.m_prev = nullptr;
+	timer.m_next = nullptr;
+	m_active--;
+}
+
+bool CppThreadsTimerWheel::schedule(CppThreadsWheelTimer& timer, uint64_t deadline) {
+	if (0 == m_active) {
+		/* The thread has been idle, move the wheel to the present time */
+		m_processed = nowTick();
+	}
+	/* A deadline that has already been reached is processed at the next tick */
+	timer.m_deadline = (deadline > m_processed) ? deadline : (m_processed + 1);
+	this->link(timer);
+	return true;
+}
+
+bool CppThreadsTimerWheel::startTimer(CppThreadsWheelTimer& timer, uint64_t timeout, uint64_t period, std::function<void (ITimer* triggeringTimer)> callBackFunction) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (timer.started) {
+			return false;
+		}
+		timer.m_callback = callBackFunction;
+		timer.m_period = period;
+		timer.duration = static_cast<uint16_t>((timeout > UINT16_MAX) ? UINT16_MAX : timeout);
+		timer.started = true;
+		this->schedule(timer, nowTick() + timeout);
+	}
+	/* The thread may be sleeping until a later slot */
+	m_wakeup.notify_all();
+	return true;
+}
+
+bool CppThreadsTimerWheel::stopTimer(CppThreadsWheelTimer& timer) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!timer.started) {
+		return false;
+	}
+	/* A periodic timer being run is not in the wheel, it will not be rescheduled as it is not started anymore */
+	if (timer.m_prev || m_slots[timer.m_deadline & TIMER_WHEEL_MASK] == &timer) {
+		this->unlink(timer);
+	}
+	timer.started = false;
+	timer.duration = 0;
+	return true;
+}
+
+void CppThreadsTimerWheel::releaseTimer(CppThreadsWheelTimer& timer) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (timer.started && (timer.m_prev || m_slots[timer.m_deadline & TIMER_WHEEL_MASK] == &timer)) {
+		this->unlink(timer);
+	}
+	timer.started = false;
+	/* Do not free a timer whose callback is being run by the thread (unless we are that callback) */
+	if (std::this_thread::get_id() != m_thread.get_id()) {
+		m_wakeup.wait(lock, [this, &timer]() { return m_expiring != &timer; });
+	}
+}
+
+void CppThreadsTimerWheel::run() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	std::vector<CppThreadsWheelTimer*> expired;
+
+	while (!m_stopping) {
+		if (0 == m_active) {
+			m_wakeup.wait(lock);
+			continue;
+		}
+
+		/* Visit all slots up to now, collecting the timers that expire */
+		uint64_t now = nowTick();
+		while (m_processed < now) {
+			m_processed++;
+			CppThreadsWheelTimer* timer = m_slots[m_processed & TIMER_WHEEL_MASK];
+			while (timer) {
+				CppThreadsWheelTimer* next = timer->m_next;
+				if (0 == timer->m_rounds) {
+					this->unlink(*timer);
+					expired.push_back(timer);
+				}
+				else {
+					timer->m_rounds--;
+				}
+				timer = next;
+			}
+			/* Run callbacks in the order of the deadlines, before visiting later slots */
+			for (size_t i = 0; i < expired.size(); i++) {
+				CppThreadsWheelTimer* expiring = expired[i];
+				/* A callback run before may have stopped this timer (or even restarted it in another slot) */
+				if (!expiring->started || expiring->m_prev || m_slots[expiring->m_deadline & TIMER_WHEEL_MASK] == expiring) {
+					continue;
+				}
+				if (0 != expiring->m_period) {
+					this->schedule(*expiring, expiring->m_deadline + expiring->m_period);
+				}
+				else {
+					expiring->started = false;
+				}
+				m_expiring = expiring;
+				std::function<void (ITimer* triggeringTimer)> callback = expiring->m_callback;
+				lock.unlock();
+				callback(expiring);
+				lock.lock();
+				m_expiring = nullptr;
+				m_wakeup.notify_all();
+			}
+			expired.clear();
+		}
+
+		if (0 == m_active || m_stopping) {
+			continue;
+		}
+		/* Sleep until the next slot holding a timer (a timer started meanwhile wakes us up) */
+		uint64_t next = m_processed + 1;
+		while (!m_slots[next & TIMER_WHEEL_MASK] && next < m_processed + TIMER_WHEEL_SLOTS) {
+			next++;
+		}
+		m_wakeup.wait_until(lock, m_epoch + std::chrono::milliseconds(next));
+	}
+}
@@ -0,0 +1,193 @@
+/**
+ * @file CppThreadsTimerWheel.h
+ *
+ * @brief Concrete implementation of ITimer sharing a single C++11 thread between all timers, using a hashed timing wheel
+ */
+
+#pragma once
+
+#include "../ITimerFactory.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * Number of slots of the timing wheel (one slot per ms, must be a power of 2)
+ */
+#define TIMER_WHEEL_SLOTS 256
+
+class CppThreadsTimerWheel;
+
+/**
+ * @brief Timer driven by a CppThreadsTimerWheel
+ *
+ * Callbacks are invoked from the thread of the wheel, with a 1ms resolution. Besides the ITimer interface, timeouts longer than 65535ms and periodic timers are supported
+ */
+class CppThreadsWheelTimer : public ITimer {
+public:
+	/**
+	 * @brief Default constructor
+	 *
+	 * Construction without arguments is not allowed
+	 */
+	CppThreadsWheelTimer() = delete;
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param wheel The wheel driving this timer (it must outlive this timer)
+	 */
+	CppThreadsWheelTimer(CppThreadsTimerWheel& wheel);
+
+	/**
+	 * @brief Copy constructor
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	CppThreadsWheelTimer(const CppThreadsWheelTimer& other) = delete;
+
+	/**
+	 * @brief Assignment operator
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	CppThreadsWheelTimer& operator=(const CppThreadsWheelTimer& other) = delete;
+
+	/**
+	 * @brief Destructor
+	 *
+	 * If the callback of this timer is being run by the wheel thread, waits for its completion
+	 */
+	~CppThreadsWheelTimer();
+
+	/**
+	 * @brief Start a timer, run a callback after expiration of the configured time
+	 *
+	 * @param timeout The timeout (in ms)
+	 * @param callBackFunction The function to call at expiration of the timer (should be of type void f(ITimer*)) where argument will be a pointer to this timer object that invoked the callback
+	 *
+	 * @return false if the timer is already running
+	 */
+	bool start(uint16_t timeout, std::function<void (ITimer* triggeringTimer)> callBackFunction);
+
+	/**
+	 * @brief Start a timer, without the 65535ms limit of start(uint16_t, ...)
+	 *
+	 * @param timeout The timeout
+	 * @param callBackFunction The function to call at expiration of the timer
+	 *
+	 * @return false if the timer is already running
+	 */
+	bool start(std::chrono::milliseconds timeout, std::function<void (ITimer* triggeringTimer)> callBackFunction);
+
+	/**
+	 * @brief Start a periodic timer, the callback is invoked every period until stop() is invoked
+	 *
+	 * Expirations are scheduled from the theoretical time of the previous one, so there is no drift
+	 *
+	 * @param period The period (at least 1ms)
+	 * @param callBackFunction The function to call at each expiration of the timer
+	 *
+	 * @return false if the timer is already running
+	 */
+	bool startPeriodic(std::chrono::milliseconds period, std::function<void (ITimer* triggeringTimer)> callBackFunction);
+
+	/**
+	 * @brief Stop and reset the timer
+	 *
+	 * @return true if we actually could stop a running timer
+	 */
+	bool stop();
+
+	/**
+	 * @brief Is the timer currently running?
+	 *
+	 * @return true if the timer is running
+	 */
+	bool isRunning();
+
+private:
+	friend class CppThreadsTimerWheel;
+
+	CppThreadsTimerWheel& m_wheel;	/*!< The wheel driving this timer */
+	CppThreadsWheelTimer* m_prev;	/*!< Previous timer in the same slot of the wheel */
+	CppThreadsWheelTimer* m_next;	/*!< Next timer in the same slot of the wheel */
+	uint64_t m_deadline;	/*!< Tick (ms since the wheel has been created) at which the timer expires */
+	uint64_t m_rounds;	/*!< Number of times the slot will be visited before the deadline */
+	uint64_t m_period;	/*!< Period (in ms), 0 for a one-shot timer */
+	std::function<void (ITimer* triggeringTimer)> m_callback;	/*!< The function to call at expiration */
+};
+
+/**
+ * @brief Timer service running all its timers from a single thread, and factory of these timers
+ *
+ * Timers are stored in a hashed timing wheel: one slot per ms, a timer sitting in the slot of its deadline (modulo TIMER_WHEEL_SLOTS) along with the number of wheel revolutions left before it expires.
+ * Starting and stopping a timer is thus O(1) (insertion or removal in a doubly-linked list), and unlike CppThreadsTimer, no thread is created when a timer is started.
+ * The thread only wakes up for slots holding timers, and sleeps when no timer is running.
+ */
+class CppThreadsTimerWheel : public ITimerFactory {
+public:
+	/**
+	 * @brief Default constructor, starts the thread of the wheel
+	 */
+	CppThreadsTimerWheel();
+
+	/**
+	 * @brief Copy constructor
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	CppThreadsTimerWheel(const CppThreadsTimerWheel& other) = delete;
+
+	/**
+	 * @brief Assignment operator
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	CppThreadsTimerWheel& operator=(const CppThreadsTimerWheel& other) = delete;
+
+	/**
+	 * @brief Destructor, stops the thread of the wheel (all timers must have been destroyed before)
+	 */
+	~CppThreadsTimerWheel();
+
+	/**
+	 * @brief Create a new timer driven by this wheel
+	 *
+	 * @return The new timer created
+	 */
+	std::unique_ptr<ITimer> create() const;
+
+private:
+	friend class CppThreadsWheelTimer;
+
+	uint64_t nowTick() const;
+	bool schedule(CppThreadsWheelTimer& timer, uint64_t deadline);
+	void link(CppThreadsWheelTimer& timer);
+	void unlink(CppThreadsWheelTimer& timer);
+	bool startTimer(CppThreadsWheelTimer& timer, uint64_t timeout, uint64_t period, std::function<void (ITimer* triggeringTimer)> callBackFunction);
+	bool stopTimer(CppThreadsWheelTimer& timer);
+	void releaseTimer(CppThreadsWheelTimer& timer);
+	void run();
+
+	std::chrono::steady_clock::time_point m_epoch;	/*!< Time of tick 0 */
+	CppThreadsWheelTimer* m_slots[TIMER_WHEEL_SLOTS];	/*!< First timer of each slot */
+	uint64_t m_processed;	/*!< Last tick processed by the thread */
+	size_t m_active;	/*!< Number of timers in the wheel */
+	CppThreadsWheelTimer* m_expiring;	/*!< Timer whose callback is being run, if any */
+	bool m_stopping;	/*!< Is the thread requested to terminate */
+	mutable std::mutex m_mutex;	/*!< Protects all the above, and the wheel-related attributes of the timers */
+	std::condition_variable m_wakeup;	/*!< Wakes up the thread when a timer is started, or a waiter once a callback is over */
+	std::thread m_thread;	/*!< The thread running the callbacks */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
@@ -0,0 +1,129 @@
+/**
+ * @file LinuxEventLoop.cpp
+ *
+ * @brief Single-threaded main loop based on Linux epoll
+ */
+
+#include "LinuxEventLoop.h"
+#include "../GenericLogger.h"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+/**
+ * Maximum number of events processed per wait
+ */
+#define LINUX_EVENT_LOOP_MAX_EVENTS 16
+
+LinuxEventLoop::LinuxEventLoop() :
+	m_epoll_fd(epoll_create1(EPOLL_CLOEXEC)),
+	m_wakeup_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+	m_stopping(false),
+	m_handlers() {
+
+	if (m_epoll_fd < 0 || m_wakeup_fd < 0) {
+		clogE << "LinuxEventLoop: failed creating the epoll instance: " << std::strerror(errno) << "\n";
+		return;
+	}
+	this->add(m_wakeup_fd, EPOLLIN, [this](uint32_t events) {
+		uint64_t count;
+		if (::read(this->m_wakeup_fd, &count, sizeof(count)) < 0) {
+			/* Already drained, nothing to do */
+		}
+	});
+}
+
+LinuxEventLoop::~LinuxEventLoop() {
+	if (m_wakeup_fd >= 0) {
+		::close(m_wakeup_fd);
+	}
+	if (m_epoll_fd >= 0) {
+		::close(m_epoll_fd);
+	}
+}
+
+bool LinuxEventLoop::add(int fd, uint32_t events, FEventHandler handler) {
+	struct epoll_event ev;
+
+	if (fd < 0 || !handler || m_handlers.count(fd) != 0) {
+		return false;
+	}
+	std::memset(&ev, 0, sizeof(ev));
+	ev.events = events;
+	ev.data.fd = fd;
+	if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		clogE << "LinuxEventLoop: failed watching fd " << fd << ": " << std::strerror(errno) << "\n";
+		return false;
+	}
+	m_handlers[fd] = std::make_shared<FEventHandler>(handler);
+	return true;
+}
+
+bool LinuxEventLoop::modify(int fd, uint32_t events) {
+	struct epoll_event ev;
+
+	if (m_handlers.count(fd) == 0) {
+		return false;
+	}
+	std::memset(&ev, 0, sizeof(ev));
+	ev.events = events;
+	ev.data.fd = fd;
+	return (epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, fd, &ev) == 0);
+}
+
+bool LinuxEventLoop::remove(int fd) {
+	if (m_handlers.erase(fd) == 0) {
+		return false;
+	}
+	/* The fd may already have been closed by its owner, in which case the kernel already forgot about it */
+	epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+	return true;
+}
+
+void LinuxEventLoop::run() {
+	while (!m_stopping) {
+		if (this->runOnce(-1) < 0) {
+			break;
+		}
+	}
+	/* Ready to run again */
+	m_stopping = false;
+}
+
+int LinuxEventLoop::runOnce(int timeout) {
+	struct epoll_event events[LINUX_EVENT_LOOP_MAX_EVENTS];
+	int invoked = 0;
+
+	int count = epoll_wait(m_epoll_fd, events, LINUX_EVENT_LOOP_MAX_EVENTS, timeout);
+	if (count < 0) {
+		if (errno == EINTR) {
+			return 0;
+		}
+		clogE << "LinuxEventLoop: epoll_wait() failed: " << std::strerror(errno) << "\n";
+		return -1;
+	}
+
+	for (int i = 0; i < count; i++) {
+		/* A previous handler of this batch may have removed this fd */
+		std::map<int, std::shared_ptr<FEventHandler> >::const_iterator it = m_handlers.find(events[i].data.fd);
+		if (it == m_handlers.end()) {
+			continue;
+		}
+		std::shared_ptr<FEventHandler> handler = it->second;
+		(*handler)(events[i].events);
+		invoked++;
+	}
+	return invoked;
+}
+
+void LinuxEventLoop::stop() {
+	uint64_t one = 1;
+
+	m_stopping = true;
+	if (::write(m_wakeup_fd, &one, sizeof(one)) < 0) {
+		/* The counter is already non-zero, the loop will wake up anyway */
+	}
+}
@@ -0,0 +1,117 @@
+/**
+ * @file LinuxEventLoop.h
+ *
+ * @brief Single-threaded main loop based on Linux epoll
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief Main loop waiting for events on file descriptors (UARTs, timerfds...) using epoll
+ *
+ * All handlers are invoked from the thread running the loop, so the objects driven by a LinuxEventLoop (LinuxUartDriver, LinuxTimer and the dongle on top of them) need no locking,
+ * and any number of dongles can share the same loop (and thus the same thread).
+ * Apart from stop(), the methods of this class must only be invoked from the thread running the loop (or before it runs).
+ */
+class LinuxEventLoop {
+public:
+	/**
+	 * @brief Handler invoked when a file descriptor is ready
+	 *
+	 * @param events The epoll events that occurred (EPOLLIN, EPOLLOUT, EPOLLERR...)
+	 */
+	typedef std::function<void (uint32_t events)> FEventHandler;
+
+	/**
+	 * @brief Default constructor
+	 */
+	LinuxEventLoop();
+
+	/**
+	 * @brief Copy constructor
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	LinuxEventLoop(const LinuxEventLoop& other) = delete;
+
+	/**
+	 * @brief Assignment operator
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	LinuxEventLoop& operator=(const LinuxEventLoop& other) = delete;
+
+	/**
+	 * @brief Destructor
+	 */
+	~LinuxEventLoop();
+
+	/**
+	 * @brief Watch a file descriptor
+	 *
+	 * @param fd The file descriptor (it is not closed by the loop)
+	 * @param events The epoll events to wait for (eg: EPOLLIN)
+	 * @param handler The handler to invoke when one of the events occurs
+	 *
+	 * @return true on success
+	 */
+	bool add(int fd, uint32_t events, FEventHandler handler);
+
+	/**
+	 * @brief Change the events watched on a file descriptor
+	 *
+	 * @param fd The file descriptor, previously given to add()
+	 * @param events The epoll events to wait for
+	 *
+	 * @return true on success
+	 */
+	bool modify(int fd, uint32_t events);
+
+	/**
+	 * @brief Stop watching a file descriptor (this can be done from within a handler)
+	 *
+	 * @param fd The file descriptor, previously given to add()
+	 *
+	 * @return true if the file descriptor was watched
+	 */
+	bool remove(int fd);
+
+	/**
+	 * @brief Run the main loop, until stop() is invoked
+	 */
+	void run();
+
+	/**
+	 * @brief Wait for events once, and invoke the handlers of the file descriptors that are ready
+	 *
+	 * @param timeout The maximum time to wait (in ms), -1 to wait forever
+	 *
+	 * @return The number of handlers invoked, or -1 on error
+	 */
+	int runOnce(int timeout);
+
+	/**
+	 * @brief Make run() return (this can be invoked from any thread, or from a signal handler)
+	 */
+	void stop();
+
+private:
+	int m_epoll_fd;	/*!< The epoll instance */
+	int m_wakeup_fd;	/*!< An eventfd used to interrupt the wait from stop() */
+	volatile bool m_stopping;	/*!< Has stop() been invoked */
+	std::map<int, std::shared_ptr<FEventHandler> > m_handlers;	/*!< The handler of each watched file descriptor (shared so that it survives remove() while being invoked) */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
@@ -0,0 +1,96 @@
+/**
+ * @file LinuxTimer.cpp
+ *
+ * @brief Concrete implementation of ITimer using a Linux timerfd watched by a LinuxEventLoop
+ */
+
+#include "LinuxTimer.h"
+#include "../GenericLogger.h"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+LinuxTimer::LinuxTimer(LinuxEventLoop& eventLoop) :
+	m_eventLoop(eventLoop),
+	m_timer_fd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)),
+	m_callback() {
+
+	if (m_timer_fd < 0) {
+		clogE << "LinuxTimer: timerfd_create() failed: " << std::strerror(errno) << "\n";
+		return;
+	}
+	m_eventLoop.add(m_timer_fd, EPOLLIN, [this](uint32_t events) {
+		this->expired();
+	});
+}
+
+LinuxTimer::~LinuxTimer() {
+	this->stop();
+	if (m_timer_fd >= 0) {
+		m_eventLoop.remove(m_timer_fd);
+		::close(m_timer_fd);
+	}
+}
+
+bool LinuxTimer::start(uint16_t timeout, std::function<void (ITimer* triggeringTimer)> callBackFunction) {
+	struct itimerspec spec;
+
+	if (!callBackFunction) {
+		clogW << "Invalid callback function provided during start()\n";
+		return false;
+	}
+
+	if (started) {
+		this->stop();
+	}
+
+	duration = timeout;
+	if (duration == 0) {
+		callBackFunction(this);
+		return true;
+	}
+
+	std::memset(&spec, 0, sizeof(spec));
+	spec.it_value.tv_sec = timeout / 1000;
+	spec.it_value.tv_nsec = static_cast<long>(timeout % 1000) * 1000000L;
+	if (m_timer_fd < 0 || timerfd_settime(m_timer_fd, 0, &spec, nullptr) < 0) {
+		clogE << "LinuxTimer: timerfd_settime() failed: " << std::strerror(errno) << "\n";
+		return false;
+	}
+	m_callback = callBackFunction;
+	started = true;
+	return true;
+}
+
+bool LinuxTimer::stop() {
+	struct itimerspec spec;
+
+	if (!started) {
+		return false;
+	}
+	std::memset(&spec, 0, sizeof(spec));
+	timerfd_settime(m_timer_fd, 0, &spec, nullptr);
+	started = false;
+	duration = 0;
+	return true;
+}
+
+bool LinuxTimer::isRunning() {
+	return started;
+}
+
+void LinuxTimer::expired() {
+	uint64_t expirations;
+
+	/* Reading resets the readiness of the timerfd, a failure means the timer has been stopped or re-armed in the meantime */
+	if (::read(m_timer_fd, &expirations, sizeof(expirations)) < 0 || !started) {
+		return;
+	}
+	started = false;
+	/* The callback is free to restart this timer (or even to destroy it), so work on a copy */
+	std::function<void (ITimer* triggeringTimer)> callback = m_callback;
+	callback(this);
+}
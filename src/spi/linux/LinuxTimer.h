@@ -0,0 +1,91 @@
+/**
+ * @file LinuxTimer.h
+ *
+ * @brief Concrete implementation of ITimer using a Linux timerfd watched by a LinuxEventLoop
+ */
+
+#pragma once
+
+#include "../ITimer.h"
+#include "LinuxEventLoop.h"
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief Concrete implementation of ITimer using a Linux timerfd
+ *
+ * The callback is invoked from the thread running the event loop, no thread is created
+ */
+class LinuxTimer : public ITimer {
+public:
+	/**
+	 * @brief Default constructor
+	 *
+	 * Construction without arguments is not allowed
+	 */
+	LinuxTimer() = delete;
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param eventLoop The event loop that will watch this timer
+	 */
+	LinuxTimer(LinuxEventLoop& eventLoop);
+
+	/**
+	 * @brief Copy constructor
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	LinuxTimer(const LinuxTimer& other) = delete;
+
+	/**
+	 * @brief Assignment operator
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	LinuxTimer& operator=(const LinuxTimer& other) = delete;
+
+	/**
+	 * @brief Destructor
+	 */
+	~LinuxTimer();
+
+	/**
+	 * @brief Start a timer, run a callback after expiration of the configured time
+	 *
+	 * If the timer is already running, it is restarted
+	 *
+	 * @param timeout The timeout (in ms)
+	 * @param callBackFunction The function to call at expiration of the timer (should be of type void f(ITimer*)) where argument will be a pointer to this timer object that invoked the callback
+	 */
+	bool start(uint16_t timeout, std::function<void (ITimer* triggeringTimer)> callBackFunction);
+
+	/**
+	 * @brief Stop and reset the timer
+	 *
+	 * @return true if we actually could stop a running timer
+	 */
+	bool stop();
+
+	/**
+	 * @brief Is the timer currently running?
+	 *
+	 * @return true if the timer is running
+	 */
+	bool isRunning();
+
+private:
+	void expired();
+
+	LinuxEventLoop& m_eventLoop;	/*!< The event loop watching m_timer_fd */
+	int m_timer_fd;	/*!< The timerfd, created at construction */
+	std::function<void (ITimer* triggeringTimer)> m_callback;	/*!< The function to call at expiration */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
@@ -0,0 +1,20 @@
+/**
+ * @file LinuxTimerFactory.cpp
+ *
+ * @brief Concrete implementation of a ITimer factory returning LinuxTimer objects
+ */
+
+#include "LinuxTimerFactory.h"
+#include "LinuxTimer.h"
+
+LinuxTimerFactory::LinuxTimerFactory(LinuxEventLoop& eventLoop) : m_eventLoop(eventLoop) {
+
+}
+
+LinuxTimerFactory::~LinuxTimerFactory() {
+
+}
+
+std::unique_ptr<ITimer> LinuxTimerFactory::create() const {
+	return std::unique_ptr<ITimer>(new LinuxTimer(m_eventLoop));
+}
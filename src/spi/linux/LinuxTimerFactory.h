@@ -0,0 +1,46 @@
+/**
+ * @file LinuxTimerFactory.h
+ *
+ * @brief Concrete implementation of a ITimer factory returning LinuxTimer objects
+ */
+
+#pragma once
+
+#include "../ITimerFactory.h"
+#include "LinuxEventLoop.h"
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief Factory class to generate LinuxTimer objects
+ */
+class LinuxTimerFactory : public ITimerFactory {
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * @param eventLoop The event loop that will run the timers
+	 */
+	LinuxTimerFactory(LinuxEventLoop& eventLoop);
+
+	/**
+	 * @brief Destructor
+	 */
+	~LinuxTimerFactory();
+
+	/**
+	 * @brief Create a new timer
+	 *
+	 * @return The new timer created
+	 */
+	std::unique_ptr<ITimer> create() const;
+private:
+	LinuxEventLoop& m_eventLoop;	/*!< The event loop */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
@@ -0,0 +1,186 @@
+/**
+ * @file LinuxUartDriver.cpp
+ *
+ * @brief Concrete implementation of a UART driver using termios, watched by a LinuxEventLoop
+ */
+
+#include "LinuxUartDriver.h"
+#include "../GenericLogger.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+/**
+ * Maximum time (in ms) write() waits for room in the output buffer of the serial port
+ */
+#define LINUX_UART_WRITE_TIMEOUT 1000
+
+/**
+ * Size of the buffer used to read incoming bytes
+ */
+#define LINUX_UART_READ_SIZE 4096
+
+namespace {
+
+/**
+ * @brief Convert a baudrate into its termios constant
+ *
+ * @return The termios constant, or B0 if the baudrate is not supported
+ */
+speed_t toTermiosSpeed(unsigned int baudRate) {
+	switch (baudRate) {
+		case 9600: return B9600;
+		case 19200: return B19200;
+		case 38400: return B38400;
+		case 57600: return B57600;
+		case 115200: return B115200;
+		case 230400: return B230400;
+		case 460800: return B460800;
+		case 921600: return B921600;
+		default: return B0;
+	}
+}
+
+} // namespace
+
+LinuxUartDriver::LinuxUartDriver(LinuxEventLoop& eventLoop, GenericAsyncDataInputObservable* uartIncomingDataHandler) :
+	m_eventLoop(eventLoop),
+	m_serial_fd(-1),
+	m_data_input_observable(uartIncomingDataHandler) {
+}
+
+LinuxUartDriver::~LinuxUartDriver() {
+	this->close();
+}
+
+void LinuxUartDriver::setIncomingDataHandler(GenericAsyncDataInputObservable* uartIncomingDataHandler) {
+	m_data_input_observable = uartIncomingDataHandler;
+}
+
+int LinuxUartDriver::open(const std::string& serialPortName, unsigned int baudRate) {
+	struct termios tio;
+	speed_t speed = toTermiosSpeed(baudRate);
+
+	if (speed == B0) {
+		clogE << "Unsupported baudrate " << baudRate << "\n";
+		return EINVAL;
+	}
+	this->close();
+
+	int fd = ::open(serialPortName.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0) {
+		int err = errno;
+		clogE << "open() failed on port \"" << serialPortName << "\" with error " << err << ": " << std::strerror(err) << "\n";
+		return err;
+	}
+
+	if (tcgetattr(fd, &tio) < 0) {
+		int err = errno;
+		clogE << "tcgetattr() failed on port \"" << serialPortName << "\": " << std::strerror(err) << "\n";
+		::close(fd);
+		return err;
+	}
+	cfmakeraw(&tio);
+	tio.c_cflag |= (CLOCAL | CREAD);
+	tio.c_cflag &= ~static_cast<tcflag_t>(CSTOPB | CRTSCTS);
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+	if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+		int err = errno;
+		clogE << "tcsetattr() failed on port \"" << serialPortName << "\": " << std::strerror(err) << "\n";
+		::close(fd);
+		return err;
+	}
+	tcflush(fd, TCIOFLUSH);
+
+	auto cbin = [this](uint32_t events) {
+		if (!this->readAvailable()) {
+			/* Device unplugged (or other end of a pty closed), stop watching it or epoll would keep waking us up */
+			clogE << "Serial port hung up, closing it\n";
+			this->close();
+		}
+	};
+	if (!m_eventLoop.add(fd, EPOLLIN, cbin)) {
+		::close(fd);
+		return EINVAL;
+	}
+	m_serial_fd = fd;
+	return 0;
+}
+
+int LinuxUartDriver::write(size_t& writtenCnt, const void* buf, size_t cnt) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(buf);
+
+	writtenCnt = 0;
+	if (m_serial_fd < 0) {
+		return EBADF;
+	}
+	while (writtenCnt < cnt) {
+		ssize_t result = ::write(m_serial_fd, bytes + writtenCnt, cnt - writtenCnt);
+		if (result >= 0) {
+			writtenCnt += static_cast<size_t>(result);
+			continue;
+		}
+		if (errno == EINTR) {
+			continue;
+		}
+		if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			int err = errno;
+			clogW << "Failed writing " << cnt << " bytes: " << std::strerror(err) << "\n";
+			return err;
+		}
+		/* Output buffer full, wait for the UART to drain it */
+		struct pollfd pfd;
+		pfd.fd = m_serial_fd;
+		pfd.events = POLLOUT;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, LINUX_UART_WRITE_TIMEOUT) <= 0) {
+			clogW << "Timeout writing " << cnt << " bytes (" << writtenCnt << " written)\n";
+			return ETIMEDOUT;
+		}
+	}
+	return 0;
+}
+
+void LinuxUartDriver::close() {
+	if (m_serial_fd >= 0) {
+		m_eventLoop.remove(m_serial_fd);
+		::close(m_serial_fd);
+		m_serial_fd = -1;
+	}
+}
+
+bool LinuxUartDriver::readAvailable() {
+	unsigned char readData[LINUX_UART_READ_SIZE];
+
+	/* Drain everything available, so that observers get as many bytes as possible at once */
+	while (m_serial_fd >= 0) {
+		ssize_t rdcnt = ::read(m_serial_fd, readData, sizeof(readData));
+		if (rdcnt > 0) {
+			if (m_data_input_observable) {
+				m_data_input_observable->notifyObservers(readData, static_cast<size_t>(rdcnt));
+			}
+			if (static_cast<size_t>(rdcnt) < sizeof(readData)) {
+				break;
+			}
+		}
+		else if (rdcnt < 0 && errno == EINTR) {
+			continue;
+		}
+		else if (rdcnt < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}
+		else {
+			if (rdcnt < 0) {
+				clogE << "read() failed: " << std::strerror(errno) << "\n";
+			}
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file LinuxUartDriver.h
+ *
+ * @brief Concrete implementation of a UART driver using termios, watched by a LinuxEventLoop
+ */
+
+#pragma once
+
+#include "../IUartDriver.h"
+#include "LinuxEventLoop.h"
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * @brief Class to interact with a UART from a LinuxEventLoop
+ *
+ * The serial port is non-blocking, incoming bytes are read (and notified) from the thread running the event loop, no thread is created
+ */
+class LinuxUartDriver : public IUartDriver {
+public:
+	/**
+	 * @brief Default constructor
+	 *
+	 * Construction without arguments is not allowed
+	 */
+	LinuxUartDriver() = delete;
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param eventLoop The event loop that will watch the serial port
+	 * @param uartIncomingDataHandler An observable instance that will notify its observer when one or more new bytes have been read, if =nullptr, no notification will be done
+	 */
+	LinuxUartDriver(LinuxEventLoop& eventLoop, GenericAsyncDataInputObservable* uartIncomingDataHandler = nullptr);
+
+	/**
+	 * @brief Copy constructor
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	LinuxUartDriver(const LinuxUartDriver& other) = delete;
+
+	/**
+	 * @brief Assignment operator
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	LinuxUartDriver& operator=(const LinuxUartDriver& other) = delete;
+
+	/**
+	 * @brief Destructor
+	 */
+	~LinuxUartDriver();
+
+	/**
+	 * @brief Set the incoming data handler (a derived class of GenericAsyncDataInputObservable) that will notify observers when new bytes are available on the UART
+	 *
+	 * @param uartIncomingDataHandler A pointer to the new handler (the eventual previous handler that might have been set at construction will be dropped)
+	 */
+	void setIncomingDataHandler(GenericAsyncDataInputObservable* uartIncomingDataHandler);
+
+	/**
+	 * @brief Opens the serial port
+	 *
+	 * The port is configured in raw mode, 8 data bits, no parity, 1 stop bit
+	 *
+	 * @param serialPortName The name of the serial port to open (eg: "/dev/ttyUSB0")
+	 * @param baudRate The baudrate to enforce on the serial port
+	 *
+	 * @return 0 on success, errno on failure
+	 */
+	int open(const std::string& serialPortName, unsigned int baudRate = 57600);
+
+	/**
+	 * @brief Write a byte sequence to the serial port
+	 *
+	 * If the output buffer of the port is full, this waits (at most LINUX_UART_WRITE_TIMEOUT ms) for room, so that whole frames are written
+	 *
+	 * @param[out] writtenCnt How many bytes were actually written
+	 * @param[in] buf data buffer to write
+	 * @param[in] cnt byte count of data to write
+	 *
+	 * @return 0 on success, errno on failure
+	 */
+	int write(size_t& writtenCnt, const void* buf, size_t cnt);
+
+	/**
+	 * @brief Close the serial port
+	 */
+	void close();
+
+private:
+	/**
+	 * @brief Read and notify all the bytes available
+	 *
+	 * @return false if the port has been hung up or is in error
+	 */
+	bool readAvailable();
+
+	LinuxEventLoop& m_eventLoop;	/*!< The event loop watching m_serial_fd */
+	int m_serial_fd;	/*!< The serial port file descriptor, -1 if closed */
+	GenericAsyncDataInputObservable* m_data_input_observable;	/*!< The observable that will notify observers when new bytes are available on the UART */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
@@ -16,7 +16,7 @@ MockUartScheduledByteDelivery::MockUartScheduledByteDelivery(const std::vector<u
 delay(scheduleDelay),
 byteBuffer(scheduledBuffer) { }
 
-MockUartDriver::MockUartDriver(std::function<int (size_t& writtenCnt, const void* buf, size_t cnt, std::chrono::duration<double, std::milli> delta)> onWriteCallback) :
+MockUartDriver::MockUartDriver(std::function<int (size_t& writtenCnt, const void* buf, size_t cnt, std::chrono::duration<double, std::milli> delta)> onWriteCallback, VirtualClock* virtualClock) :
 	readBytesThread(),
 	scheduledReadQueueMutex(),
 	scheduledReadQueue(),
@@ -26,7 +26,9 @@ MockUartDriver::MockUartDriver(std::function<int (size_t& writtenCnt, const void
 	lastWrittenBytesTimestamp(std::chrono::time_point<std::chrono::high_resolution_clock>::min()),
 	scheduledReadBytesCount(0),
 	deliveredReadBytesCount(0),
-	writtenBytesCount(0) { }
+	writtenBytesCount(0),
+	virtualClock(virtualClock),
+	virtualDeliveryEvent(0) { }
 
 MockUartDriver::~MockUartDriver() {
 	this->destroyAllScheduledIncomingChunks();
@@ -47,7 +49,13 @@ int MockUartDriver::open(const std::string& serialPortName, unsigned int baudRat
 int MockUartDriver::write(size_t& writtenCnt, const void* buf, size_t cnt) {
 	
 	std::lock_guard<std::recursive_mutex> lock(writeMutex);	/* Make sure there is only one simultaneous executiong of method write() */
-	std::chrono::time_point<std::chrono::high_resolution_clock> now =  std::chrono::high_resolution_clock::now();
+	std::chrono::time_point<std::chrono::high_resolution_clock> now;
+	if (this->virtualClock != nullptr) {	/* Simulated time is mapped onto the epoch of the real clock, which is never equal to our min() "no previous timestamp" marker */
+		now = std::chrono::time_point<std::chrono::high_resolution_clock>(std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(this->virtualClock->now()));
+	}
+	else {
+		now = std::chrono::high_resolution_clock::now();
+	}
 	int result = 0;
 	if (this->onWriteCallback != nullptr) {
 		std::chrono::duration<double, std::milli> delta;
@@ -75,6 +83,12 @@ void MockUartDriver::scheduleIncomingChunk(const MockUartScheduledByteDelivery&
 		frontSchedule = this->scheduledReadQueue.empty();	/* Are the scheduledBytes the only ones in the queue? */
 		this->scheduledReadQueue.push(scheduledBytes);
 		this->scheduledReadBytesCount += scheduledBytes.byteBuffer.size();
+		if (this->virtualClock != nullptr) {
+			if (this->virtualDeliveryEvent == 0) {	/* No delivery in progress, otherwise the chunk will be chained after the previous ones */
+				this->scheduleVirtualDelivery();
+			}
+			return;
+		}
 	}	/* scheduledReadQueueMutex released here */
 	if (frontSchedule) {
 		if (this->readBytesThread.joinable())
@@ -109,6 +123,40 @@ void MockUartDriver::scheduleIncomingChunk(const MockUartScheduledByteDelivery&
 	}
 }
 
+void MockUartDriver::scheduleVirtualDelivery() {
+	if (this->scheduledReadQueue.empty()) {
+		this->virtualDeliveryEvent = 0;
+		return;
+	}
+	this->virtualDeliveryEvent = this->virtualClock->schedule(this->scheduledReadQueue.front().delay, [this]() {
+		this->deliverVirtualChunk();
+	});
+}
+
+void MockUartDriver::deliverVirtualChunk() {
+	struct MockUartScheduledByteDelivery nextChunk;
+	VirtualClock::EventId currentEvent;
+	{
+		std::lock_guard<std::mutex> lock(this->scheduledReadQueueMutex);
+		currentEvent = this->virtualDeliveryEvent;
+		if (this->scheduledReadQueue.empty()) {	/* Queue destroyed in the meantime */
+			this->virtualDeliveryEvent = 0;
+			return;
+		}
+		nextChunk = this->scheduledReadQueue.front();
+		this->scheduledReadQueue.pop();
+		this->scheduledReadBytesCount -= nextChunk.byteBuffer.size();
+		this->deliveredReadBytesCount += nextChunk.byteBuffer.size();
+	} /* scheduledReadQueueMutex released here, virtualDeliveryEvent is left set so that chunks scheduled by observers are chained below */
+	if (dataInputObservable != nullptr && !nextChunk.byteBuffer.empty()) {
+		this->dataInputObservable->notifyObservers(&(nextChunk.byteBuffer[0]), nextChunk.byteBuffer.size());	/* Notify observers */
+	}
+	std::lock_guard<std::mutex> lock(this->scheduledReadQueueMutex);
+	if (this->virtualDeliveryEvent == currentEvent) {	/* Unless an observer has destroyed the queue and restarted a new delivery */
+		this->scheduleVirtualDelivery();	/* The delay of the next chunk is relative to this delivery */
+	}
+}
+
 std::string MockUartDriver::scheduledIncomingChunksToString() {
 	std::stringstream result;
 	std::queue<struct MockUartScheduledByteDelivery> scheduledReadQueueCopy;
@@ -143,6 +191,10 @@ void MockUartDriver::destroyAllScheduledIncomingChunks() {
 			this->scheduledReadQueue = std::queue<struct MockUartScheduledByteDelivery>();	/* Replace the queue with a brand new (empty) one */
 			this->scheduledReadBytesCount = 0;	/* No more byte queued */
 		}
+		if (this->virtualDeliveryEvent != 0) {
+			this->virtualClock->cancel(this->virtualDeliveryEvent);
+			this->virtualDeliveryEvent = 0;
+		}
 	}	/* scheduledReadQueueMutex released here */
 	if (!queueIsEmpty) {	/* Kill the secondary thread */
 
@@ -8,6 +8,8 @@
 
 
 #include "../IUartDriver.h"
+#include "../virtual-clock/VirtualClock.h"
+#include <functional>
 #include <vector>
 #include <queue>
 #include <mutex>
@@ -43,8 +45,9 @@ public:
 	 *        size_t cnt: the number of bytes to write
 	 *        std::chrono::duration<double, std::milli> delta: the elapsed time since last bytes were written (in ms)
 	 *        This callback should return 0 on success, errno on failure
+	 * @param virtualClock An optional simulated clock. If provided, scheduled chunks are delivered by events on this clock (from the thread advancing it) instead of a sleeping thread, and write deltas are measured in simulated time
 	 */
-	MockUartDriver(std::function<int (size_t& writtenCnt, const void* buf, size_t cnt, std::chrono::duration<double, std::milli> delta)> onWriteCallback = nullptr);
+	MockUartDriver(std::function<int (size_t& writtenCnt, const void* buf, size_t cnt, std::chrono::duration<double, std::milli> delta)> onWriteCallback = nullptr, VirtualClock* virtualClock = nullptr);
 
 	/**
 	 * @brief Destructor
@@ -161,6 +164,18 @@ public:
 	void close();
 
 private:
+	/**
+	 * @brief Schedule the delivery of the chunk at the front of the queue on the virtual clock
+	 *
+	 * @note Grab scheduledReadQueueMutex before invoking this
+	 */
+	void scheduleVirtualDelivery();
+
+	/**
+	 * @brief Deliver the chunk at the front of the queue, then schedule the next one (invoked from an event of the virtual clock)
+	 */
+	void deliverVirtualChunk();
+
 	std::thread readBytesThread;	/*!< The thread that will generate emulated read bytes prepared in scheduledReadQueue */
 	std::mutex scheduledReadQueueMutex;	/*!< A mutex to handle access to scheduledReadQueue, scheduledReadBytesCount or deliveredReadBytesCount */
 	std::queue<struct MockUartScheduledByteDelivery> scheduledReadQueue;	/*!< The scheduled read bytes queue. Grab scheduledReadQueueMutex before accessing this */
@@ -173,4 +188,6 @@ private:
 	size_t scheduledReadBytesCount;	/*!< The current size of the scheduled read bytes queue. Grab scheduledReadQueueMutex before accessing this  */
 	size_t deliveredReadBytesCount;	/*!< The cumulative number of emulated read bytes delivered to the GenericAsyncDataInputObservable observer since the instanciation of this object. Grab scheduledReadQueueMutex before accessing this */
 	size_t writtenBytesCount;	/*!< The number of bytes written, as a total sum of the onWriteCallback function's successive writtenCnt returned values */
+	VirtualClock* virtualClock;	/*!< The simulated clock used to deliver scheduled chunks, or nullptr to use a sleeping thread */
+	VirtualClock::EventId virtualDeliveryEvent;	/*!< The event scheduled on virtualClock for the delivery of the front chunk (0 if none). Grab scheduledReadQueueMutex before accessing this */
 };
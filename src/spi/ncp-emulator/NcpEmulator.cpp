@@ -0,0 +1,838 @@
+/**
+ * @file NcpEmulator.cpp
+ *
+ * @brief Emulation of an EZSP NCP (ASH framing and a subset of the EZSP commands) behind the UART driver interface, for offline tests and load measurements
+ */
+
+#include "NcpEmulator.h"
+#include "../GenericLogger.h"
+#include "../../domain/crc-ccitt.h"
+#include "../../domain/ash-stuffing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <ios>
+
+#define NCP_ASH_FLAG_BYTE 0x7E
+#define NCP_ASH_ESCAPE_BYTE 0x7D
+#define NCP_ASH_XON_BYTE 0x11
+#define NCP_ASH_XOFF_BYTE 0x13
+#define NCP_ASH_SUBSTITUTE_BYTE 0x18
+#define NCP_ASH_CANCEL_BYTE 0x1A
+
+#define NCP_ASH_RST_CONTROL 0xC0
+#define NCP_ASH_RSTACK_CONTROL 0xC1
+#define NCP_ASH_ACK_CONTROL 0x80
+#define NCP_ASH_NAK_CONTROL 0xA0
+#define NCP_ASH_RETX_FLAG 0x08
+
+#define NCP_ASH_VERSION 0x02
+#define NCP_ASH_RESET_SOFTWARE 0x0B
+
+/**
+ * EZSP frame control of responses, and of asynchronous callbacks
+ */
+#define NCP_EZSP_FC_RESPONSE 0x80
+#define NCP_EZSP_FC_ASYNC_CALLBACK 0x90
+
+/**
+ * EzspStatus values
+ */
+#define NCP_EZSP_SUCCESS 0x00
+#define NCP_EZSP_ERROR_INVALID_FRAME_ID 0x31
+
+/**
+ * Status of GP table entries that are not in use
+ */
+#define NCP_GP_ENTRY_UNUSED 0xFF
+#define NCP_GP_ENTRY_ACTIVE 0x01
+
+/**
+ * Size of an EmberGpAddress
+ */
+#define NCP_GP_ADDRESS_SIZE 10
+
+namespace {
+
+/**
+ * @brief Apply the ASH pseudo-random sequence to a data field (this both randomises and restores it)
+ */
+void randomise(uint8_t* io_data, size_t i_len) {
+	uint8_t rand = 0x42;
+	for (size_t i = 0; i < i_len; i++) {
+		io_data[i] ^= rand;
+		rand = (rand & 0x01) ? static_cast<uint8_t>((rand >> 1) ^ 0xB8) : static_cast<uint8_t>(rand >> 1);
+	}
+}
+
+void appendU16(std::vector<uint8_t>& o_buf, uint16_t i_value) {
+	o_buf.push_back(static_cast<uint8_t>(i_value & 0xFF));
+	o_buf.push_back(static_cast<uint8_t>(i_value >> 8));
+}
+
+void appendU32(std::vector<uint8_t>& o_buf, uint32_t i_value) {
+	for (unsigned int i = 0; i < 4; i++) {
+		o_buf.push_back(static_cast<uint8_t>((i_value >> (8 * i)) & 0xFF));
+	}
+}
+
+/**
+ * @brief Append an ASH frame (CRC, stuffing and flag byte) to the bytes sent to the host
+ *
+ * @param o_bytes The bytes sent to the host
+ * @param i_raw The control byte followed by the (already randomised) data field
+ * @param i_corrupt Send a wrong CRC
+ */
+void appendFrame(std::vector<uint8_t>& o_bytes, const std::vector<uint8_t>& i_raw, bool i_corrupt) {
+	std::vector<uint8_t> raw(i_raw);
+	uint16_t crc = CCrcCcitt::compute(raw.data(), raw.size());
+	if (i_corrupt) {
+		crc ^= 0x0001;
+	}
+	raw.push_back(static_cast<uint8_t>(crc >> 8));
+	raw.push_back(static_cast<uint8_t>(crc & 0xFF));
+
+	size_t offset = o_bytes.size();
+	o_bytes.resize(offset + 2 * raw.size() + 1);
+	size_t len = CAshStuffing::stuff(raw.data(), raw.size(), o_bytes.data() + offset);
+	o_bytes[offset + len] = NCP_ASH_FLAG_BYTE;
+	o_bytes.resize(offset + len + 1);
+}
+
+} // namespace
+
+NcpEmulator::NcpEmulator(const SNcpEmulatorConfig& i_config, GenericAsyncDataInputObservable* uartIncomingDataHandler) :
+	m_config(i_config),
+	m_data_input_observable(uartIncomingDataHandler),
+	m_thread(),
+	m_mutex(),
+	m_wakeup(),
+	m_running(false),
+	m_rx_bytes(),
+	m_rx_frame(),
+	m_rx_escape(false),
+	m_tx_bytes(),
+	m_events(),
+	m_connected(false),
+	m_reject(false),
+	m_ack_pending(false),
+	m_ack_num(0),
+	m_frm_num(0),
+	m_unacked_frm_num(0),
+	m_tx_frames(),
+	m_tx_time(),
+	m_tx_pending(),
+	m_last_seq(0),
+	m_rng(i_config.seed),
+	m_handlers(),
+	m_config_values(),
+	m_network_up(i_config.networkUp),
+	m_pan_id(i_config.panId),
+	m_radio_channel(i_config.radioChannel),
+	m_sink_table(i_config.sinkTableSize),
+	m_proxy_table(i_config.proxyTableSize),
+	m_gpd_source_ids(),
+	m_gpd_next(0),
+	m_gpd_frame_counter(0),
+	m_gpd_command_id(0),
+	m_gpd_payload(),
+	m_gpd_period(0),
+	m_gpd_next_time(),
+	m_gpd_generation(0),
+	m_stats() {
+	if (m_config.txWindow < 1 || m_config.txWindow > 7) {
+		m_config.txWindow = 1;
+	}
+}
+
+NcpEmulator::~NcpEmulator() {
+	this->close();
+}
+
+void NcpEmulator::setIncomingDataHandler(GenericAsyncDataInputObservable* uartIncomingDataHandler) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_data_input_observable = uartIncomingDataHandler;
+	}
+	m_wakeup.notify_one();
+}
+
+int NcpEmulator::open(const std::string& serialPortName, unsigned int baudRate) {
+	this->close();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats = SNcpEmulatorStats();
+	m_rx_bytes.clear();
+	m_rx_frame.clear();
+	m_rx_escape = false;
+	m_tx_bytes.clear();
+	m_connected = false;
+	this->resetAsh();
+	m_running = true;
+	m_thread = std::thread(&NcpEmulator::run, this);
+	return 0;
+}
+
+int NcpEmulator::write(size_t& writtenCnt, const void* buf, size_t cnt) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(buf);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		writtenCnt = 0;
+		if (!m_running) {
+			return EBADF;
+		}
+		m_rx_bytes.insert(m_rx_bytes.end(), bytes, bytes + cnt);
+		m_stats.bytesIn += cnt;
+		writtenCnt = cnt;
+	}
+	m_wakeup.notify_one();
+	return 0;
+}
+
+void NcpEmulator::close() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+		m_events.clear();
+		m_gpd_period = std::chrono::nanoseconds(0);
+		m_gpd_generation++;
+	}
+	m_wakeup.notify_one();
+	if (m_thread.joinable()) {
+		if (m_thread.get_id() == std::this_thread::get_id()) {
+			/* We are invoked from an observer, the emulator thread will terminate by itself */
+			m_thread.detach();
+		}
+		else {
+			m_thread.join();
+		}
+	}
+}
+
+void NcpEmulator::setCommandHandler(EEzspCmd i_cmd, FNcpCommandHandler i_handler) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_handlers[static_cast<uint8_t>(i_cmd)] = i_handler;
+}
+
+void NcpEmulator::sendCallback(EEzspCmd i_cmd, const std::vector<uint8_t>& i_params) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		this->queueCallback(i_cmd, i_params);
+	}
+	m_wakeup.notify_one();
+}
+
+bool NcpEmulator::startGpTraffic(const std::vector<uint32_t>& i_source_ids, unsigned int i_rate, uint8_t i_command_id, const std::vector<uint8_t>& i_payload) {
+	if (i_source_ids.empty() || 0 == i_rate) {
+		return false;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_gpd_source_ids = i_source_ids;
+		m_gpd_next = 0;
+		m_gpd_command_id = i_command_id;
+		m_gpd_payload = i_payload;
+		m_gpd_period = std::chrono::nanoseconds(1000000000ULL / i_rate);
+		m_gpd_next_time = std::chrono::steady_clock::now();
+		unsigned int generation = ++m_gpd_generation;
+		this->schedule(m_gpd_next_time, [this, generation]() {
+			if (generation == m_gpd_generation) {
+				this->generateGpFrame();
+			}
+		});
+	}
+	m_wakeup.notify_one();
+	return true;
+}
+
+void NcpEmulator::stopGpTraffic() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_gpd_period = std::chrono::nanoseconds(0);
+	m_gpd_generation++;
+}
+
+SNcpEmulatorStats NcpEmulator::getStats() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+size_t NcpEmulator::getSinkTableEntryCount() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	size_t count = 0;
+	for (size_t i = 0; i < m_sink_table.size(); i++) {
+		if (!m_sink_table[i].empty()) {
+			count++;
+		}
+	}
+	return count;
+}
+
+void NcpEmulator::run() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (m_running) {
+		if (!m_rx_bytes.empty()) {
+			std::vector<uint8_t> bytes;
+			bytes.swap(m_rx_bytes);
+			this->receiveBytes(bytes);
+		}
+
+		/* Run the events that are due (an event may schedule another one that is already due, eg when GP traffic is late) */
+		TimePoint now = std::chrono::steady_clock::now();
+		while (m_running && !m_events.empty() && m_events.begin()->first <= now) {
+			std::function<void ()> event = m_events.begin()->second;
+			m_events.erase(m_events.begin());
+			event();
+		}
+
+		std::chrono::milliseconds ackTimeout(m_config.ackTimeout);
+		if (m_unacked_frm_num != m_frm_num && now >= m_tx_time + ackTimeout) {
+			this->retransmit();
+		}
+		this->pumpTx();
+		if (m_ack_pending) {
+			/* Nothing to piggyback the acknowledge on */
+			this->sendControl(static_cast<uint8_t>(NCP_ASH_ACK_CONTROL | m_ack_num));
+			m_stats.acksSent++;
+		}
+
+		/* Like a UART would, keep the bytes until someone reads them (the host writes RST before setting its handler) */
+		if (!m_tx_bytes.empty() && m_data_input_observable) {
+			std::vector<uint8_t> bytes;
+			bytes.swap(m_tx_bytes);
+			m_stats.bytesOut += bytes.size();
+			GenericAsyncDataInputObservable* observable = m_data_input_observable;
+			/* The host may write to us from its observer */
+			lock.unlock();
+			observable->notifyObservers(bytes.data(), bytes.size());
+			lock.lock();
+			continue;
+		}
+		if (!m_rx_bytes.empty() || !m_running) {
+			continue;
+		}
+
+		TimePoint deadline = TimePoint::max();
+		if (!m_events.empty()) {
+			deadline = m_events.begin()->first;
+		}
+		if (m_unacked_frm_num != m_frm_num && m_tx_time + ackTimeout < deadline) {
+			deadline = m_tx_time + ackTimeout;
+		}
+		if (deadline == TimePoint::max()) {
+			m_wakeup.wait(lock);
+		}
+		else {
+			m_wakeup.wait_until(lock, deadline);
+		}
+	}
+}
+
+void NcpEmulator::schedule(TimePoint i_when, std::function<void ()> i_event) {
+	m_events.insert(std::make_pair(i_when, i_event));
+}
+
+void NcpEmulator::receiveBytes(const std::vector<uint8_t>& i_bytes) {
+	for (size_t i = 0; i < i_bytes.size(); i++) {
+		uint8_t byte = i_bytes[i];
+		switch (byte) {
+			case NCP_ASH_FLAG_BYTE:
+				if (!m_rx_frame.empty()) {
+					this->receiveFrame();
+				}
+				m_rx_frame.clear();
+				m_rx_escape = false;
+				break;
+			case NCP_ASH_CANCEL_BYTE:
+			case NCP_ASH_SUBSTITUTE_BYTE:
+				m_rx_frame.clear();
+				m_rx_escape = false;
+				break;
+			case NCP_ASH_XON_BYTE:
+			case NCP_ASH_XOFF_BYTE:
+				break;
+			case NCP_ASH_ESCAPE_BYTE:
+				m_rx_escape = true;
+				break;
+			default:
+				m_rx_frame.push_back(m_rx_escape ? static_cast<uint8_t>(byte ^ 0x20) : byte);
+				m_rx_escape = false;
+				break;
+		}
+	}
+}
+
+void NcpEmulator::receiveFrame() {
+	if (m_rx_frame.size() < 3) {
+		return;
+	}
+	if (CCrcCcitt::compute(m_rx_frame.data(), m_rx_frame.size()) != 0) {
+		m_stats.crcErrors++;
+		if (m_connected && !m_reject) {
+			this->sendControl(static_cast<uint8_t>(NCP_ASH_NAK_CONTROL | m_ack_num));
+			m_stats.naksSent++;
+			m_reject = true;
+		}
+		return;
+	}
+
+	uint8_t control = m_rx_frame[0];
+	if (NCP_ASH_RST_CONTROL == control) {
+		m_stats.resets++;
+		this->resetAsh();
+		m_connected = true;
+		m_tx_bytes.push_back(NCP_ASH_CANCEL_BYTE);
+		appendFrame(m_tx_bytes, std::vector<uint8_t>({ NCP_ASH_RSTACK_CONTROL, NCP_ASH_VERSION, NCP_ASH_RESET_SOFTWARE }), false);
+		return;
+	}
+	if (!m_connected) {
+		return;
+	}
+
+	if ((control & 0x80) == 0) {
+		uint8_t frmNum = static_cast<uint8_t>((control >> 4) & 0x07);
+		this->releaseAckedFrames(control & 0x07);
+		if (frmNum == m_ack_num) {
+			m_ack_num = static_cast<uint8_t>((m_ack_num + 1) & 0x07);
+			m_reject = false;
+			m_ack_pending = true;
+			std::vector<uint8_t> ezsp(m_rx_frame.begin() + 1, m_rx_frame.end() - 2);
+			randomise(ezsp.data(), ezsp.size());
+			this->handleCommand(ezsp);
+		}
+		else if ((control & NCP_ASH_RETX_FLAG) && frmNum == ((m_ack_num - 1) & 0x07)) {
+			/* Our acknowledge got lost, acknowledge the frame again without processing it twice */
+			m_ack_pending = true;
+		}
+		else if (!m_reject) {
+			this->sendControl(static_cast<uint8_t>(NCP_ASH_NAK_CONTROL | m_ack_num));
+			m_stats.naksSent++;
+			m_reject = true;
+		}
+	}
+	else if ((control & 0xE0) == NCP_ASH_ACK_CONTROL) {
+		this->releaseAckedFrames(control & 0x07);
+	}
+	else if ((control & 0xE0) == NCP_ASH_NAK_CONTROL) {
+		m_stats.naksReceived++;
+		this->releaseAckedFrames(control & 0x07);
+		if (m_unacked_frm_num != m_frm_num) {
+			this->retransmit();
+		}
+	}
+}
+
+void NcpEmulator::resetAsh() {
+	m_reject = false;
+	m_ack_pending = false;
+	m_ack_num = 0;
+	m_frm_num = 0;
+	m_unacked_frm_num = 0;
+	for (unsigned int i = 0; i < 8; i++) {
+		m_tx_frames[i].clear();
+	}
+	m_tx_pending.clear();
+}
+
+void NcpEmulator::releaseAckedFrames(uint8_t i_ack_num) {
+	uint8_t outstanding = static_cast<uint8_t>((m_frm_num - m_unacked_frm_num) & 0x07);
+	uint8_t acked = static_cast<uint8_t>((i_ack_num - m_unacked_frm_num) & 0x07);
+
+	if (acked == 0 || acked > outstanding) {
+		return;
+	}
+	while (m_unacked_frm_num != i_ack_num) {
+		m_tx_frames[m_unacked_frm_num].clear();
+		m_unacked_frm_num = static_cast<uint8_t>((m_unacked_frm_num + 1) & 0x07);
+	}
+	/* The retransmission timer now applies to the next frame waiting for its acknowledge */
+	m_tx_time = std::chrono::steady_clock::now();
+}
+
+void NcpEmulator::sendControl(uint8_t i_control) {
+	appendFrame(m_tx_bytes, std::vector<uint8_t>({ i_control }), false);
+	if ((i_control & 0xE0) == NCP_ASH_ACK_CONTROL || (i_control & 0xE0) == NCP_ASH_NAK_CONTROL) {
+		m_ack_pending = false;
+	}
+}
+
+void NcpEmulator::sendDataFrame(uint8_t i_frm_num, bool i_retransmit) {
+	const std::vector<uint8_t>& ezsp = m_tx_frames[i_frm_num];
+	std::vector<uint8_t> raw;
+
+	raw.reserve(1 + ezsp.size());
+	/* The acknowledge of the frames received is piggybacked */
+	raw.push_back(static_cast<uint8_t>((i_frm_num << 4) | (i_retransmit ? NCP_ASH_RETX_FLAG : 0) | m_ack_num));
+	raw.insert(raw.end(), ezsp.begin(), ezsp.end());
+	randomise(raw.data() + 1, ezsp.size());
+	m_ack_pending = false;
+
+	bool corrupt = (m_config.corruptPercent > 0) && ((m_rng() % 100) < m_config.corruptPercent);
+	if (corrupt) {
+		m_stats.corrupted++;
+	}
+	appendFrame(m_tx_bytes, raw, corrupt);
+}
+
+void NcpEmulator::pumpTx() {
+	while (m_connected && !m_tx_pending.empty() && ((m_frm_num - m_unacked_frm_num) & 0x07) < m_config.txWindow) {
+		if (m_frm_num == m_unacked_frm_num) {
+			m_tx_time = std::chrono::steady_clock::now();
+		}
+		m_tx_frames[m_frm_num] = m_tx_pending.front();
+		m_tx_pending.pop_front();
+		this->sendDataFrame(m_frm_num, false);
+		m_stats.dataFramesSent++;
+		m_frm_num = static_cast<uint8_t>((m_frm_num + 1) & 0x07);
+	}
+}
+
+void NcpEmulator::retransmit() {
+	for (uint8_t frm = m_unacked_frm_num; frm != m_frm_num; frm = static_cast<uint8_t>((frm + 1) & 0x07)) {
+		this->sendDataFrame(frm, true);
+		m_stats.retransmissions++;
+	}
+	m_tx_time = std::chrono::steady_clock::now();
+}
+
+void NcpEmulator::queueFrame(const std::vector<uint8_t>& i_ezsp, bool i_callback) {
+	if (!m_connected || (i_callback && m_tx_pending.size() >= NCP_EMULATOR_MAX_PENDING)) {
+		if (i_callback) {
+			m_stats.callbacksDropped++;
+		}
+		return;
+	}
+	m_tx_pending.push_back(i_ezsp);
+	if (i_callback) {
+		m_stats.callbacks++;
+	}
+}
+
+void NcpEmulator::queueCallback(EEzspCmd i_cmd, const std::vector<uint8_t>& i_params) {
+	std::vector<uint8_t> frame({ m_last_seq, NCP_EZSP_FC_ASYNC_CALLBACK, 0xFF, 0x00, static_cast<uint8_t>(i_cmd) });
+	frame.insert(frame.end(), i_params.begin(), i_params.end());
+	this->queueFrame(frame, true);
+}
+
+void NcpEmulator::handleCommand(const std::vector<uint8_t>& i_ezsp) {
+	if (i_ezsp.size() < 3) {
+		return;
+	}
+	/* All commands use the extended header, except EZSP_VERSION (legacy header, so that any NCP can answer it) */
+	bool extended = (i_ezsp.size() >= 5) && (0xFF == i_ezsp[2]);
+	size_t headerLen = extended ? 5 : 3;
+	EEzspCmd cmd = static_cast<EEzspCmd>(i_ezsp[headerLen - 1]);
+	std::vector<uint8_t> params(i_ezsp.begin() + static_cast<std::ptrdiff_t>(headerLen), i_ezsp.end());
+
+	m_stats.commands++;
+	m_last_seq = i_ezsp[0];
+
+	std::vector<std::vector<uint8_t>> callbacks;
+	std::vector<uint8_t> rspParams;
+	bool handled = false;
+	std::map<uint8_t, FNcpCommandHandler>::const_iterator it = m_handlers.find(static_cast<uint8_t>(cmd));
+	if (it != m_handlers.end()) {
+		if (it->second) {
+			rspParams = it->second(cmd, params);
+			handled = true;
+		}
+	}
+	else {
+		rspParams = this->builtinCommand(cmd, params, callbacks, handled);
+	}
+
+	std::vector<uint8_t> response({ m_last_seq, NCP_EZSP_FC_RESPONSE });
+	if (extended) {
+		response.push_back(0xFF);
+		response.push_back(0x00);
+	}
+	if (handled) {
+		response.push_back(static_cast<uint8_t>(cmd));
+		response.insert(response.end(), rspParams.begin(), rspParams.end());
+	}
+	else {
+		clogW << "NcpEmulator: unsupported command 0x" << std::hex << static_cast<unsigned int>(cmd) << std::dec << "\n";
+		response.push_back(static_cast<uint8_t>(EZSP_INVALID_COMMAND));
+		response.push_back(NCP_EZSP_ERROR_INVALID_FRAME_ID);
+	}
+
+	/* Callbacks triggered by the command follow its response */
+	std::function<void ()> respond = [this, response, callbacks]() {
+		this->queueFrame(response, false);
+		for (size_t i = 0; i < callbacks.size(); i++) {
+			this->queueFrame(callbacks[i], true);
+		}
+	};
+	if (m_config.responseDelay > 0) {
+		this->schedule(std::chrono::steady_clock::now() + std::chrono::milliseconds(m_config.responseDelay), respond);
+	}
+	else {
+		respond();
+	}
+}
+
+std::vector<uint8_t> NcpEmulator::builtinCommand(EEzspCmd i_cmd, const std::vector<uint8_t>& i_params, std::vector<std::vector<uint8_t>>& o_callbacks, bool& o_handled) {
+	std::vector<uint8_t> rsp;
+	uint8_t index = i_params.empty() ? 0xFF : i_params[0];
+	std::vector<uint8_t> gpAddr;
+	if (i_params.size() >= NCP_GP_ADDRESS_SIZE) {
+		gpAddr.assign(i_params.begin(), i_params.begin() + NCP_GP_ADDRESS_SIZE);
+	}
+	auto callback = [this, &o_callbacks](EEzspCmd i_cb_cmd, const std::vector<uint8_t>& i_cb_params) {
+		std::vector<uint8_t> frame({ m_last_seq, NCP_EZSP_FC_ASYNC_CALLBACK, 0xFF, 0x00, static_cast<uint8_t>(i_cb_cmd) });
+		frame.insert(frame.end(), i_cb_params.begin(), i_cb_params.end());
+		o_callbacks.push_back(frame);
+	};
+
+	o_handled = true;
+	switch (i_cmd) {
+		case EZSP_VERSION:
+			/* Whatever the version requested by the host, the NCP answers with its own */
+			rsp.push_back(m_config.protocolVersion);
+			rsp.push_back(m_config.stackType);
+			appendU16(rsp, m_config.stackVersion);
+			break;
+		case EZSP_SET_CONFIGURATION_VALUE:
+			if (i_params.size() >= 3) {
+				m_config_values[i_params[0]] = static_cast<uint16_t>(i_params[1] | (i_params[2] << 8));
+			}
+			rsp.push_back(NCP_EZSP_SUCCESS);
+			break;
+		case EZSP_GET_CONFIGURATION_VALUE:
+			rsp.push_back(NCP_EZSP_SUCCESS);
+			appendU16(rsp, m_config_values[index]);
+			break;
+		case EZSP_SET_POLICY:
+		case EZSP_ADD_ENDPOINT:
+		case EZSP_SET_INITIAL_SECURITY_STATE:
+		case EZSP_PERMIT_JOINING:
+			rsp.push_back(EMBER_SUCCESS);
+			break;
+		case EZSP_NETWORK_INIT:
+			rsp.push_back(m_network_up ? EMBER_SUCCESS : EMBER_NOT_JOINED);
+			if (m_network_up) {
+				callback(EZSP_STACK_STATUS_HANDLER, std::vector<uint8_t>({ EMBER_NETWORK_UP }));
+			}
+			break;
+		case EZSP_NETWORK_STATE:
+			rsp.push_back(m_network_up ? EMBER_JOINED_NETWORK : EMBER_NO_NETWORK);
+			break;
+		case EZSP_FORM_NETWORK:
+			/* EmberNetworkParameters: extended PAN ID (8 bytes), PAN ID, TX power, radio channel, ... */
+			if (i_params.size() >= 12) {
+				m_pan_id = static_cast<uint16_t>(i_params[8] | (i_params[9] << 8));
+				m_radio_channel = i_params[11];
+			}
+			m_network_up = true;
+			rsp.push_back(EMBER_SUCCESS);
+			callback(EZSP_STACK_STATUS_HANDLER, std::vector<uint8_t>({ EMBER_NETWORK_UP }));
+			break;
+		case EZSP_LEAVE_NETWORK:
+			rsp.push_back(m_network_up ? EMBER_SUCCESS : EMBER_INVALID_CALL);
+			if (m_network_up) {
+				m_network_up = false;
+				callback(EZSP_STACK_STATUS_HANDLER, std::vector<uint8_t>({ EMBER_NETWORK_DOWN }));
+			}
+			break;
+		case EZSP_GET_NETWORK_PARAMETERS:
+			rsp.push_back(m_network_up ? EMBER_SUCCESS : EMBER_NOT_JOINED);
+			rsp.push_back(EMBER_COORDINATOR);
+			/* The extended PAN ID is our EUI64 */
+			for (unsigned int i = 0; i < 8; i++) {
+				rsp.push_back(static_cast<uint8_t>((m_config.eui64 >> (8 * i)) & 0xFF));
+			}
+			appendU16(rsp, m_pan_id);
+			rsp.push_back(3);	/* TX power */
+			rsp.push_back(m_radio_channel);
+			rsp.push_back(EMBER_USE_MAC_ASSOCIATION);
+			appendU16(rsp, 0x0000);	/* Network manager */
+			rsp.push_back(0);	/* Network update ID */
+			appendU32(rsp, static_cast<uint32_t>(1UL << m_radio_channel));
+			break;
+		case EZSP_GET_EUI64:
+			for (unsigned int i = 0; i < 8; i++) {
+				rsp.push_back(static_cast<uint8_t>((m_config.eui64 >> (8 * i)) & 0xFF));
+			}
+			break;
+		case EZSP_D_GP_SEND:
+			/* action, useCca, address, command ID, payload length, payload, handle, ... */
+			rsp.push_back(EMBER_SUCCESS);
+			if (i_params.size() >= 14 && 14U + i_params[13] < i_params.size() && i_params[0]) {
+				callback(EZSP_D_GP_SENT_HANDLER, std::vector<uint8_t>({ EMBER_SUCCESS, i_params[14U + i_params[13]] }));
+			}
+			break;
+		case EZSP_GP_SINK_TABLE_INIT:
+			break;
+		case EZSP_GP_SINK_TABLE_CLEAR_ALL:
+			for (size_t i = 0; i < m_sink_table.size(); i++) {
+				m_sink_table[i].clear();
+			}
+			break;
+		case EZSP_GP_SINK_TABLE_LOOKUP:
+		case EZSP_GP_SINK_TABLE_FIND_OR_ALLOCATE_ENTRY: {
+			int found = gpAddr.empty() ? -1 : this->findSinkEntry(gpAddr);
+			if (found < 0 && !gpAddr.empty() && EZSP_GP_SINK_TABLE_FIND_OR_ALLOCATE_ENTRY == i_cmd) {
+				for (size_t i = 0; i < m_sink_table.size() && found < 0; i++) {
+					if (m_sink_table[i].empty()) {
+						m_sink_table[i].assign(NCP_EMULATOR_SINK_ENTRY_SIZE, 0);
+						m_sink_table[i][0] = NCP_GP_ENTRY_ACTIVE;
+						std::copy(gpAddr.begin(), gpAddr.end(), m_sink_table[i].begin() + 3);
+						found = static_cast<int>(i);
+					}
+				}
+			}
+			rsp.push_back((found < 0) ? 0xFF : static_cast<uint8_t>(found));
+			break;
+		}
+		case EZSP_GP_SINK_TABLE_GET_ENTRY:
+			if (index < m_sink_table.size()) {
+				rsp.push_back(EMBER_SUCCESS);
+				if (m_sink_table[index].empty()) {
+					rsp.push_back(NCP_GP_ENTRY_UNUSED);
+					rsp.resize(1 + NCP_EMULATOR_SINK_ENTRY_SIZE, 0);
+				}
+				else {
+					rsp.insert(rsp.end(), m_sink_table[index].begin(), m_sink_table[index].end());
+				}
+			}
+			else {
+				rsp.push_back(EMBER_ERR_FATAL);
+				rsp.resize(1 + NCP_EMULATOR_SINK_ENTRY_SIZE, 0);
+			}
+			break;
+		case EZSP_GP_SINK_TABLE_SET_ENTRY:
+			if (index < m_sink_table.size() && i_params.size() >= 1 + NCP_EMULATOR_SINK_ENTRY_SIZE) {
+				m_sink_table[index].assign(i_params.begin() + 1, i_params.begin() + 1 + NCP_EMULATOR_SINK_ENTRY_SIZE);
+				rsp.push_back(EMBER_SUCCESS);
+			}
+			else {
+				rsp.push_back(EMBER_ERR_FATAL);
+			}
+			break;
+		case EZSP_GP_SINK_TABLE_REMOVE_ENTRY:
+			if (index < m_sink_table.size()) {
+				m_sink_table[index].clear();
+			}
+			break;
+		case EZSP_GP_PROXY_TABLE_LOOKUP: {
+			int found = gpAddr.empty() ? -1 : this->findProxyEntry(gpAddr);
+			rsp.push_back((found < 0) ? 0xFF : static_cast<uint8_t>(found));
+			break;
+		}
+		case EZSP_GP_PROXY_TABLE_GET_ENTRY:
+			if (index < m_proxy_table.size()) {
+				rsp.push_back(EMBER_SUCCESS);
+				if (m_proxy_table[index].empty()) {
+					rsp.push_back(NCP_GP_ENTRY_UNUSED);
+					rsp.resize(1 + NCP_EMULATOR_PROXY_ENTRY_SIZE, 0);
+				}
+				else {
+					rsp.insert(rsp.end(), m_proxy_table[index].begin(), m_proxy_table[index].end());
+				}
+			}
+			else {
+				/* Ends the sweeps of the proxy table by the host */
+				rsp.push_back(EMBER_ERR_FATAL);
+			}
+			break;
+		case EZSP_GP_PROXY_TABLE_PROCESS_GP_PAIRING: {
+			/* options (4 bytes), address, communication mode, sink network address and group ID, alias, sink EUI64, key, frame counter */
+			bool added = false;
+			if (i_params.size() >= 49) {
+				uint32_t options = static_cast<uint32_t>(i_params[0] | (i_params[1] << 8) | (i_params[2] << 16) | (static_cast<uint32_t>(i_params[3]) << 24));
+				std::vector<uint8_t> addr(i_params.begin() + 4, i_params.begin() + 4 + NCP_GP_ADDRESS_SIZE);
+				int found = this->findProxyEntry(addr);
+				if (options & (1U << 4)) {
+					/* Remove GPD */
+					if (found >= 0) {
+						m_proxy_table[static_cast<size_t>(found)].clear();
+					}
+				}
+				else if (options & (1U << 3)) {
+					/* Add sink */
+					for (size_t i = 0; i < m_proxy_table.size() && found < 0; i++) {
+						if (m_proxy_table[i].empty()) {
+							found = static_cast<int>(i);
+						}
+					}
+					if (found >= 0) {
+						std::vector<uint8_t> entry;
+						entry.push_back(NCP_GP_ENTRY_ACTIVE);
+						entry.insert(entry.end(), i_params.begin(), i_params.begin() + 4);
+						entry.insert(entry.end(), addr.begin(), addr.end());
+						entry.push_back(i_params[19]);	/* Assigned alias */
+						entry.push_back(i_params[20]);
+						entry.push_back(static_cast<uint8_t>(((options >> 9) & 0x03) | (((options >> 11) & 0x07) << 2)));	/* Security options */
+						entry.insert(entry.end(), i_params.begin() + 45, i_params.begin() + 49);	/* Frame counter */
+						entry.insert(entry.end(), i_params.begin() + 29, i_params.begin() + 45);	/* Key */
+						entry.resize(NCP_EMULATOR_PROXY_ENTRY_SIZE - 2, 0xFF);	/* Sink list */
+						entry.push_back(0xFF);	/* Groupcast radius */
+						entry.push_back(0);	/* Search counter */
+						m_proxy_table[static_cast<size_t>(found)] = entry;
+						added = true;
+					}
+				}
+			}
+			rsp.push_back(added ? 1 : 0);
+			break;
+		}
+		default:
+			o_handled = false;
+			break;
+	}
+	return rsp;
+}
+
+void NcpEmulator::generateGpFrame() {
+	uint32_t sourceId = m_gpd_source_ids[m_gpd_next];
+	m_gpd_next = (m_gpd_next + 1) % m_gpd_source_ids.size();
+	m_gpd_frame_counter++;
+
+	std::vector<uint8_t> params;
+	params.reserve(28 + m_gpd_payload.size());
+	params.push_back(EMBER_SUCCESS);
+	params.push_back(0xC8);	/* Link quality */
+	params.push_back(static_cast<uint8_t>(m_gpd_frame_counter & 0xFF));	/* Sequence number */
+	params.push_back(0x00);	/* Application ID: source ID */
+	appendU32(params, sourceId);
+	appendU32(params, sourceId);
+	params.push_back(0x00);	/* Endpoint */
+	params.push_back(0x02);	/* Security level: frame counter and MIC */
+	params.push_back(0x04);	/* Key type: out of the box key */
+	params.push_back(0x00);	/* Auto-commissioning */
+	params.push_back(0x00);	/* RxAfterTx */
+	appendU32(params, m_gpd_frame_counter);
+	params.push_back(m_gpd_command_id);
+	appendU32(params, 0);	/* MIC */
+	params.push_back(0xFF);	/* Proxy table index */
+	params.push_back(static_cast<uint8_t>(m_gpd_payload.size()));
+	params.insert(params.end(), m_gpd_payload.begin(), m_gpd_payload.end());
+	this->queueCallback(EZSP_GPEP_INCOMING_MESSAGE_HANDLER, params);
+
+	m_gpd_next_time += m_gpd_period;
+	unsigned int generation = m_gpd_generation;
+	this->schedule(m_gpd_next_time, [this, generation]() {
+		if (generation == m_gpd_generation) {
+			this->generateGpFrame();
+		}
+	});
+}
+
+int NcpEmulator::findSinkEntry(const std::vector<uint8_t>& i_gp_addr) const {
+	for (size_t i = 0; i < m_sink_table.size(); i++) {
+		if (!m_sink_table[i].empty() && std::equal(i_gp_addr.begin(), i_gp_addr.end(), m_sink_table[i].begin() + 3)) {
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+int NcpEmulator::findProxyEntry(const std::vector<uint8_t>& i_gp_addr) const {
+	for (size_t i = 0; i < m_proxy_table.size(); i++) {
+		if (!m_proxy_table[i].empty() && std::equal(i_gp_addr.begin(), i_gp_addr.end(), m_proxy_table[i].begin() + 5)) {
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
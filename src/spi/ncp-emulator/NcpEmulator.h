@@ -0,0 +1,297 @@
+/**
+ * @file NcpEmulator.h
+ *
+ * @brief Emulation of an EZSP NCP (ASH framing and a subset of the EZSP commands) behind the UART driver interface, for offline tests and load measurements
+ */
+
+#pragma once
+
+#include "../IUartDriver.h"
+#include "../../domain/ezsp-protocol/ezsp-enum.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * Size (in bytes) of an EmberGpSinkTableEntry, as stored by the emulated NCP
+ */
+#define NCP_EMULATOR_SINK_ENTRY_SIZE 60
+
+/**
+ * Size (in bytes) of an EmberGpProxyTableEntry, as stored by the emulated NCP
+ */
+#define NCP_EMULATOR_PROXY_ENTRY_SIZE 62
+
+/**
+ * Maximum number of EZSP frames waiting for the ASH window to open, further callbacks generated by the emulator are dropped
+ */
+#define NCP_EMULATOR_MAX_PENDING 256
+
+/**
+ * @brief Handler of an EZSP command by the emulated NCP
+ *
+ * Invoked from the emulator thread, with the emulator locked: it must not call any method of the emulator
+ *
+ * @param i_cmd The EZSP command
+ * @param i_params The parameters of the command
+ *
+ * @return The parameters of the response
+ */
+typedef std::function<std::vector<uint8_t> (EEzspCmd i_cmd, const std::vector<uint8_t>& i_params)> FNcpCommandHandler;
+
+/**
+ * @brief Configuration of the emulated NCP
+ */
+struct SNcpEmulatorConfig {
+	SNcpEmulatorConfig() :
+		protocolVersion(7),
+		stackType(2),
+		stackVersion(0x6a70),
+		eui64(0x000d6f000ba1b2c3ULL),
+		txWindow(1),
+		ackTimeout(400),
+		responseDelay(0),
+		corruptPercent(0),
+		seed(1),
+		networkUp(false),
+		panId(0x1234),
+		radioChannel(11),
+		sinkTableSize(32),
+		proxyTableSize(32) { }
+
+	uint8_t protocolVersion;	/*!< EZSP protocol version answered to EZSP_VERSION */
+	uint8_t stackType;	/*!< Stack type answered to EZSP_VERSION */
+	uint16_t stackVersion;	/*!< Stack version answered to EZSP_VERSION */
+	uint64_t eui64;	/*!< EUI64 of the emulated NCP */
+	uint8_t txWindow;	/*!< Number of DATA frames the NCP sends before getting them acknowledged, between 1 and 7 */
+	uint16_t ackTimeout;	/*!< Time (in ms) after which the DATA frames not acknowledged by the host are retransmitted */
+	uint16_t responseDelay;	/*!< Processing time (in ms) of each command before its response is sent */
+	uint8_t corruptPercent;	/*!< Percentage of DATA frames sent with a wrong CRC (the host drops them, and the NCP has to retransmit them) */
+	unsigned int seed;	/*!< Seed of the pseudo-random generator deciding which frames are corrupted */
+	bool networkUp;	/*!< Is a network already formed at startup */
+	uint16_t panId;	/*!< PAN ID of the network */
+	uint8_t radioChannel;	/*!< Radio channel of the network */
+	uint8_t sinkTableSize;	/*!< Number of entries of the GP sink table */
+	uint8_t proxyTableSize;	/*!< Number of entries of the GP proxy table */
+};
+
+/**
+ * @brief Statistics on the traffic handled by an NcpEmulator
+ */
+typedef struct {
+	uint32_t commands;	/*!< Number of EZSP commands received (retransmissions excluded) */
+	uint32_t callbacks;	/*!< Number of EZSP callbacks queued for the host */
+	uint32_t callbacksDropped;	/*!< Number of callbacks dropped because the host did not acknowledge the previous frames fast enough */
+	uint32_t dataFramesSent;	/*!< Number of DATA frames sent (retransmissions excluded) */
+	uint32_t retransmissions;	/*!< Number of DATA frames retransmitted */
+	uint32_t corrupted;	/*!< Number of DATA frames sent with a wrong CRC on purpose */
+	uint32_t acksSent;	/*!< Number of ACK frames sent */
+	uint32_t naksSent;	/*!< Number of NAK frames sent */
+	uint32_t naksReceived;	/*!< Number of NAK frames received */
+	uint32_t crcErrors;	/*!< Number of frames received with a wrong CRC */
+	uint32_t resets;	/*!< Number of RST frames received */
+	uint64_t bytesIn;	/*!< Number of bytes written by the host */
+	uint64_t bytesOut;	/*!< Number of bytes sent to the host */
+} SNcpEmulatorStats;
+
+/**
+ * @brief Class emulating an NCP behind the UART driver interface
+ *
+ * Bytes written by the host are processed by an ASH state machine similar to the one of the NCP: RST/RSTACK, frames acknowledged (or rejected with a NAK)
+ * according to their frame number, randomisation, a window of DATA frames sent to the host and their retransmission on NAK or timeout.
+ *
+ * The following EZSP commands are answered: version, configuration values and policies, endpoints, network state, init, forming and leaving,
+ * network parameters, EUI64, permit joining, and the GP sink and proxy tables. Any command can be added or overridden with setCommandHandler(), others
+ * get an EZSP_INVALID_COMMAND frame.
+ *
+ * EZSP_GPEP_INCOMING_MESSAGE_HANDLER callbacks can be generated at a given rate with startGpTraffic(), in order to measure the throughput and latency of the host stack
+ * without a dongle.
+ *
+ * All processing takes place in a dedicated thread, from which the bytes for the host are notified, like a real UART driver would do.
+ */
+class NcpEmulator : public IUartDriver {
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * @param i_config The configuration of the emulated NCP
+	 * @param uartIncomingDataHandler An observable instance that will notify its observer when bytes are sent by the emulated NCP, if =nullptr, no notification will be done
+	 */
+	NcpEmulator(const SNcpEmulatorConfig& i_config = SNcpEmulatorConfig(), GenericAsyncDataInputObservable* uartIncomingDataHandler = nullptr);
+
+	/**
+	 * @brief Copy constructor
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	NcpEmulator(const NcpEmulator& other) = delete;
+
+	/**
+	 * @brief Assignment operator
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	NcpEmulator& operator=(const NcpEmulator& other) = delete;
+
+	/**
+	 * @brief Destructor
+	 */
+	~NcpEmulator();
+
+	/**
+	 * @brief Set the incoming data handler (a derived class of GenericAsyncDataInputObservable) that will notify observers when bytes are sent by the emulated NCP
+	 *
+	 * @param uartIncomingDataHandler A pointer to the new handler (the eventual previous handler that might have been set at construction will be dropped)
+	 */
+	void setIncomingDataHandler(GenericAsyncDataInputObservable* uartIncomingDataHandler);
+
+	/**
+	 * @brief Start the emulated NCP
+	 *
+	 * @param serialPortName Unused
+	 * @param baudRate Unused
+	 *
+	 * @return 0 on success
+	 */
+	int open(const std::string& serialPortName, unsigned int baudRate = 57600);
+
+	/**
+	 * @brief Write bytes to the emulated NCP
+	 *
+	 * This never blocks, bytes are processed by the emulator thread
+	 *
+	 * @param[out] writtenCnt How many bytes were actually written
+	 * @param[in] buf data buffer to write
+	 * @param[in] cnt byte count of data to write
+	 *
+	 * @return 0 on success, EBADF if the emulator is not open
+	 */
+	int write(size_t& writtenCnt, const void* buf, size_t cnt);
+
+	/**
+	 * @brief Stop the emulated NCP, its network and tables are kept until it is open again
+	 */
+	void close();
+
+	/**
+	 * @brief Handle an EZSP command with a custom handler, instead of the built-in one
+	 *
+	 * @param i_cmd The EZSP command
+	 * @param i_handler The handler, nullptr to answer i_cmd with EZSP_INVALID_COMMAND
+	 */
+	void setCommandHandler(EEzspCmd i_cmd, FNcpCommandHandler i_handler);
+
+	/**
+	 * @brief Send a callback to the host
+	 *
+	 * @param i_cmd The EZSP command of the callback
+	 * @param i_params The parameters of the callback
+	 */
+	void sendCallback(EEzspCmd i_cmd, const std::vector<uint8_t>& i_params);
+
+	/**
+	 * @brief Generate EZSP_GPEP_INCOMING_MESSAGE_HANDLER callbacks, as if green power frames were received from GPDs
+	 *
+	 * Frames are sent from each source ID in turn, secured (with an incrementing frame counter) and successfully authenticated by the NCP
+	 *
+	 * @param i_source_ids The source IDs of the GPDs
+	 * @param i_rate The number of frames per second (all GPDs together)
+	 * @param i_command_id The GPD command ID
+	 * @param i_payload The GPD command payload
+	 *
+	 * @return false if no source ID is given or the rate is 0
+	 */
+	bool startGpTraffic(const std::vector<uint32_t>& i_source_ids, unsigned int i_rate, uint8_t i_command_id = 0xA0, const std::vector<uint8_t>& i_payload = std::vector<uint8_t>({ 0x02, 0x04, 0x00, 0x00, 0x29, 0x34, 0x08 }));
+
+	/**
+	 * @brief Stop generating EZSP_GPEP_INCOMING_MESSAGE_HANDLER callbacks
+	 */
+	void stopGpTraffic();
+
+	/**
+	 * @brief Get statistics on the traffic handled since the emulator was opened
+	 */
+	SNcpEmulatorStats getStats() const;
+
+	/**
+	 * @brief Get the number of used entries of the GP sink table
+	 */
+	size_t getSinkTableEntryCount() const;
+
+private:
+	typedef std::chrono::steady_clock::time_point TimePoint;
+
+	void run();
+	void schedule(TimePoint i_when, std::function<void ()> i_event);
+	void receiveBytes(const std::vector<uint8_t>& i_bytes);
+	void receiveFrame();
+	void resetAsh();
+	void releaseAckedFrames(uint8_t i_ack_num);
+	void sendControl(uint8_t i_control);
+	void sendDataFrame(uint8_t i_frm_num, bool i_retransmit);
+	void pumpTx();
+	void retransmit();
+	void queueFrame(const std::vector<uint8_t>& i_ezsp, bool i_callback);
+	void handleCommand(const std::vector<uint8_t>& i_ezsp);
+	std::vector<uint8_t> builtinCommand(EEzspCmd i_cmd, const std::vector<uint8_t>& i_params, std::vector<std::vector<uint8_t>>& o_callbacks, bool& o_handled);
+	void queueCallback(EEzspCmd i_cmd, const std::vector<uint8_t>& i_params);
+	void generateGpFrame();
+	int findSinkEntry(const std::vector<uint8_t>& i_gp_addr) const;
+	int findProxyEntry(const std::vector<uint8_t>& i_gp_addr) const;
+
+	SNcpEmulatorConfig m_config;	/*!< The configuration of the emulated NCP */
+	GenericAsyncDataInputObservable* m_data_input_observable;	/*!< The observable that will notify observers when bytes are sent by the emulated NCP */
+	std::thread m_thread;	/*!< The emulator thread */
+	mutable std::mutex m_mutex;	/*!< Protects the attributes below */
+	std::condition_variable m_wakeup;	/*!< Wakes the emulator thread up on incoming bytes or new events */
+	bool m_running;	/*!< Is the emulator open */
+	std::vector<uint8_t> m_rx_bytes;	/*!< Bytes written by the host, not processed yet */
+	std::vector<uint8_t> m_rx_frame;	/*!< The frame being received (unstuffed) */
+	bool m_rx_escape;	/*!< Was the previous received byte an escape byte */
+	std::vector<uint8_t> m_tx_bytes;	/*!< Bytes to notify to the host */
+	std::multimap<TimePoint, std::function<void ()>> m_events;	/*!< Events to run, by due time */
+	bool m_connected;	/*!< Has ASH been reset by the host */
+	bool m_reject;	/*!< Has a NAK been sent, and no DATA frame been accepted since */
+	bool m_ack_pending;	/*!< Has a DATA frame been received and not acknowledged yet */
+	uint8_t m_ack_num;	/*!< Number of the next DATA frame expected from the host */
+	uint8_t m_frm_num;	/*!< Number of the next DATA frame sent to the host */
+	uint8_t m_unacked_frm_num;	/*!< Number of the oldest DATA frame not acknowledged by the host */
+	std::vector<uint8_t> m_tx_frames[8];	/*!< EZSP frames sent and not acknowledged yet, indexed by frame number */
+	TimePoint m_tx_time;	/*!< When the oldest DATA frame not acknowledged was (re)transmitted */
+	std::deque<std::vector<uint8_t>> m_tx_pending;	/*!< EZSP frames waiting for the window to open */
+	uint8_t m_last_seq;	/*!< Sequence number of the last command, reused by the callbacks */
+	std::minstd_rand m_rng;	/*!< Decides which frames are corrupted */
+	std::map<uint8_t, FNcpCommandHandler> m_handlers;	/*!< Custom command handlers */
+	std::map<uint16_t, uint16_t> m_config_values;	/*!< Configuration values set by the host */
+	bool m_network_up;	/*!< Is the network formed */
+	uint16_t m_pan_id;	/*!< PAN ID of the network */
+	uint8_t m_radio_channel;	/*!< Radio channel of the network */
+	std::vector<std::vector<uint8_t>> m_sink_table;	/*!< GP sink table entries, empty if unused */
+	std::vector<std::vector<uint8_t>> m_proxy_table;	/*!< GP proxy table entries, empty if unused */
+	std::vector<uint32_t> m_gpd_source_ids;	/*!< Source IDs of the generated GP frames */
+	size_t m_gpd_next;	/*!< Index of the next source ID to generate a GP frame from */
+	uint32_t m_gpd_frame_counter;	/*!< Security frame counter of the generated GP frames */
+	uint8_t m_gpd_command_id;	/*!< Command ID of the generated GP frames */
+	std::vector<uint8_t> m_gpd_payload;	/*!< Payload of the generated GP frames */
+	std::chrono::nanoseconds m_gpd_period;	/*!< Time between generated GP frames, 0 when stopped */
+	TimePoint m_gpd_next_time;	/*!< When the next GP frame is due */
+	unsigned int m_gpd_generation;	/*!< Incremented on each start/stop, to cancel the events of a previous traffic */
+	SNcpEmulatorStats m_stats;	/*!< Traffic statistics */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
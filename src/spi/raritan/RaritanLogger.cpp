@@ -9,27 +9,14 @@
 #include <cstdarg>
 
 RaritanGenericLogger::RaritanGenericLogger(const LOG_LEVEL setLogLevel) :
-		ILoggerStream(setLogLevel),
-		m_buffer()	/* TODO: pre-allocate the buffer to a default size to avoid reallocs on the fly */
-{ /* Set the parent classes' logger's level to what has been provided as constructor's argument */
+		ILoggerStream(setLogLevel) { /* Set the parent classes' logger's level to what has been provided as constructor's argument */
 }
 
 RaritanGenericLogger::~RaritanGenericLogger() {
 }
 
-int RaritanGenericLogger::overflow(int c) {
-	if (c != EOF) {
-		if (c == '\n') {
-			this->log(this->m_buffer.c_str());
-			this->m_buffer = "";
-		}
-		else {
-			if (c>0xff)
-				return EOF;
-			this->m_buffer += static_cast<char>(c & 0xff);
-		}
-	}
-	return c;
+void RaritanGenericLogger::outputLine(const char* line, size_t length) {
+	this->log(line);	/* Lines are already split and '\0' terminated by ILoggerStream */
 }
 
 /**
@@ -44,17 +44,12 @@ public:
 
 protected:
 	/**
-	 * @brief Receive one character of an output stream
+	 * @brief Output one complete line to the Raritan log
 	 *
-	 * @param c The new character
-	 *
-	 * @return The character that has actually been printed out to the log
+	 * @param line The text of the line, without the trailing newline
+	 * @param length The length of the line
 	 */
-	virtual int overflow(int c);
-
-protected:
-	/* Member variables (attributes) */
-	std::string m_buffer;	/*!< The currently built buffer (used when outputting to log using ostream's operator<< */
+	virtual void outputLine(const char* line, size_t length);
 };
 
 /**
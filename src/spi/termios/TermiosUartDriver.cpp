@@ -0,0 +1,358 @@
+/**
+ * @file TermiosUartDriver.cpp
+ *
+ * @brief Concrete implementation of a UART driver using POSIX termios and poll(), with its own I/O thread
+ */
+
+#include "TermiosUartDriver.h"
+#include "../GenericLogger.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+/**
+ * Maximum number of buffers gathered in a single writev() (the minimum IOV_MAX guaranteed by POSIX)
+ */
+#define TERMIOS_UART_MAX_IOV 16
+
+namespace {
+
+/**
+ * @brief Convert a baudrate into its termios constant
+ *
+ * @return The termios constant, or B0 if the baudrate is not supported
+ */
+speed_t toTermiosSpeed(unsigned int baudRate) {
+	switch (baudRate) {
+		case 9600: return B9600;
+		case 19200: return B19200;
+		case 38400: return B38400;
+		case 57600: return B57600;
+		case 115200: return B115200;
+		case 230400: return B230400;
+#ifdef B460800
+		case 460800: return B460800;
+#endif
+#ifdef B921600
+		case 921600: return B921600;
+#endif
+		default: return B0;
+	}
+}
+
+/**
+ * @brief Set O_NONBLOCK and FD_CLOEXEC on a file descriptor
+ */
+bool setNonBlocking(int fd) {
+	int flags = fcntl(fd, F_GETFL);
+	return (flags >= 0) && (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0) && (fcntl(fd, F_SETFD, FD_CLOEXEC) == 0);
+}
+
+} // namespace
+
+TermiosUartDriver::TermiosUartDriver(GenericAsyncDataInputObservable* uartIncomingDataHandler) :
+	m_serial_fd(-1),
+	m_wake_fds(),
+	m_rts_cts(false),
+	m_data_input_observable(uartIncomingDataHandler),
+	m_io_thread_alive(false),
+	m_io_thread(),
+	m_tx_mutex(),
+	m_tx_queue(),
+	m_tx_offset(0),
+	m_tx_pending(0),
+	m_wake_pending(false),
+	m_stats() {
+	m_wake_fds[0] = -1;
+	m_wake_fds[1] = -1;
+}
+
+TermiosUartDriver::~TermiosUartDriver() {
+	this->close();
+}
+
+void TermiosUartDriver::setIncomingDataHandler(GenericAsyncDataInputObservable* uartIncomingDataHandler) {
+	m_data_input_observable = uartIncomingDataHandler;
+}
+
+void TermiosUartDriver::setFlowControl(bool rtsCts) {
+	m_rts_cts = rtsCts;
+}
+
+int TermiosUartDriver::open(const std::string& serialPortName, unsigned int baudRate) {
+	struct termios tio;
+	speed_t speed = toTermiosSpeed(baudRate);
+
+	if (speed == B0) {
+		clogE << "Unsupported baudrate " << baudRate << "\n";
+		return EINVAL;
+	}
+#ifndef CRTSCTS
+	if (m_rts_cts) {
+		clogE << "RTS/CTS flow control is not supported on this platform\n";
+		return ENOTSUP;
+	}
+#endif
+	this->close();
+
+	int fd = ::open(serialPortName.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (fd < 0) {
+		int err = errno;
+		clogE << "open() failed on port \"" << serialPortName << "\" with error " << err << ": " << std::strerror(err) << "\n";
+		return err;
+	}
+
+	if (tcgetattr(fd, &tio) < 0) {
+		int err = errno;
+		clogE << "tcgetattr() failed on port \"" << serialPortName << "\": " << std::strerror(err) << "\n";
+		::close(fd);
+		return err;
+	}
+	cfmakeraw(&tio);
+	tio.c_cflag |= (CLOCAL | CREAD);
+	tio.c_cflag &= ~static_cast<tcflag_t>(CSTOPB);
+#ifdef CRTSCTS
+	if (m_rts_cts) {
+		tio.c_cflag |= CRTSCTS;
+	}
+	else {
+		tio.c_cflag &= ~static_cast<tcflag_t>(CRTSCTS);
+	}
+#endif
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+	if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+		int err = errno;
+		clogE << "tcsetattr() failed on port \"" << serialPortName << "\": " << std::strerror(err) << "\n";
+		::close(fd);
+		return err;
+	}
+	tcflush(fd, TCIOFLUSH);
+
+	if (pipe(m_wake_fds) < 0 || !setNonBlocking(fd) || !setNonBlocking(m_wake_fds[0]) || !setNonBlocking(m_wake_fds[1])) {
+		int err = errno;
+		clogE << "Failed setting up the I/O thread: " << std::strerror(err) << "\n";
+		::close(fd);
+		this->close();
+		return err;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_tx_mutex);
+		m_serial_fd = fd;
+		m_stats = STermiosUartStats();
+	}
+	m_io_thread_alive = true;
+	m_io_thread = std::thread(&TermiosUartDriver::run, this);
+	return 0;
+}
+
+int TermiosUartDriver::write(size_t& writtenCnt, const void* buf, size_t cnt) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(buf);
+	std::lock_guard<std::mutex> lock(m_tx_mutex);
+
+	writtenCnt = 0;
+	if (m_serial_fd < 0) {
+		return EBADF;
+	}
+	if (m_tx_pending + cnt > TERMIOS_UART_MAX_PENDING) {
+		clogW << "Output queue full, dropping " << cnt << " bytes\n";
+		return ENOBUFS;
+	}
+	if (cnt == 0) {
+		return 0;
+	}
+	m_tx_queue.push_back(std::vector<uint8_t>(bytes, bytes + cnt));
+	m_tx_pending += cnt;
+	m_stats.frames++;
+	if (m_tx_pending > m_stats.maxPending) {
+		m_stats.maxPending = m_tx_pending;
+	}
+	/* Everything written until the I/O thread runs will be gathered in a single writev() */
+	if (!m_wake_pending) {
+		m_wake_pending = true;
+		this->wakeUp();
+	}
+	writtenCnt = cnt;
+	return 0;
+}
+
+void TermiosUartDriver::close() {
+	if (m_io_thread.joinable()) {
+		m_io_thread_alive = false;
+		this->wakeUp();
+		if (m_io_thread.get_id() == std::this_thread::get_id()) {
+			/* We are invoked from an observer, the I/O thread will terminate by itself */
+			m_io_thread.detach();
+		}
+		else {
+			m_io_thread.join();
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_tx_mutex);
+		if (m_serial_fd >= 0) {
+			::close(m_serial_fd);
+			m_serial_fd = -1;
+		}
+		m_tx_queue.clear();
+		m_tx_offset = 0;
+		m_tx_pending = 0;
+		m_wake_pending = false;
+	}
+	for (unsigned int i = 0; i < 2; i++) {
+		if (m_wake_fds[i] >= 0) {
+			::close(m_wake_fds[i]);
+			m_wake_fds[i] = -1;
+		}
+	}
+}
+
+STermiosUartStats TermiosUartDriver::getStats() const {
+	std::lock_guard<std::mutex> lock(m_tx_mutex);
+	return m_stats;
+}
+
+void TermiosUartDriver::wakeUp() {
+	const uint8_t wake = 0;
+	if (m_wake_fds[1] >= 0) {
+		/* If the pipe is full, the I/O thread has already been woken up */
+		ssize_t result = ::write(m_wake_fds[1], &wake, sizeof(wake));
+		(void)result;
+	}
+}
+
+void TermiosUartDriver::run() {
+	while (m_io_thread_alive) {
+		struct pollfd pfds[2];
+		bool pending;
+		{
+			std::lock_guard<std::mutex> lock(m_tx_mutex);
+			pending = (m_tx_pending > 0);
+		}
+		pfds[0].fd = m_serial_fd;
+		pfds[0].events = static_cast<short>(POLLIN | (pending ? POLLOUT : 0));
+		pfds[0].revents = 0;
+		pfds[1].fd = m_wake_fds[0];
+		pfds[1].events = POLLIN;
+		pfds[1].revents = 0;
+
+		if (poll(pfds, 2, -1) < 0) {
+			if (errno != EINTR) {
+				clogE << "poll() failed: " << std::strerror(errno) << "\n";
+				return;
+			}
+			continue;
+		}
+
+		if (pfds[1].revents & POLLIN) {
+			uint8_t drain[64];
+			while (::read(m_wake_fds[0], drain, sizeof(drain)) > 0) {
+			}
+			std::lock_guard<std::mutex> lock(m_tx_mutex);
+			m_wake_pending = false;
+		}
+		if (!m_io_thread_alive) {
+			break;
+		}
+		if (pfds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+			if (!this->readAvailable()) {
+				/* Device unplugged (or other end of a pty closed), poll() would keep waking us up */
+				clogE << "Serial port hung up, stopping I/O\n";
+				return;
+			}
+			if (!m_io_thread_alive) {
+				/* Closed by an observer */
+				break;
+			}
+		}
+		if (!this->writePending()) {
+			return;
+		}
+	}
+}
+
+bool TermiosUartDriver::readAvailable() {
+	unsigned char readData[TERMIOS_UART_READ_SIZE];
+
+	/* Drain everything available, so that observers get as many bytes as possible at once */
+	while (m_io_thread_alive) {
+		ssize_t rdcnt = ::read(m_serial_fd, readData, sizeof(readData));
+		if (rdcnt > 0) {
+			{
+				std::lock_guard<std::mutex> lock(m_tx_mutex);
+				m_stats.reads++;
+				m_stats.bytesRead += static_cast<uint64_t>(rdcnt);
+			}
+			if (m_data_input_observable) {
+				m_data_input_observable->notifyObservers(readData, static_cast<size_t>(rdcnt));
+			}
+			if (static_cast<size_t>(rdcnt) < sizeof(readData)) {
+				break;
+			}
+		}
+		else if (rdcnt < 0 && errno == EINTR) {
+			continue;
+		}
+		else if (rdcnt < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}
+		else {
+			if (rdcnt < 0) {
+				clogE << "read() failed: " << std::strerror(errno) << "\n";
+			}
+			return false;
+		}
+	}
+	return true;
+}
+
+bool TermiosUartDriver::writePending() {
+	std::lock_guard<std::mutex> lock(m_tx_mutex);
+
+	while (m_tx_pending > 0) {
+		struct iovec iov[TERMIOS_UART_MAX_IOV];
+		int iovcnt = 0;
+
+		for (std::deque<std::vector<uint8_t>>::iterator it = m_tx_queue.begin(); it != m_tx_queue.end() && iovcnt < TERMIOS_UART_MAX_IOV; ++it, ++iovcnt) {
+			size_t offset = (iovcnt == 0) ? m_tx_offset : 0;
+			iov[iovcnt].iov_base = it->data() + offset;
+			iov[iovcnt].iov_len = it->size() - offset;
+		}
+
+		ssize_t result = ::writev(m_serial_fd, iov, iovcnt);
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				/* Output buffer full (or CTS deasserted), poll() will tell us when there is room again */
+				return true;
+			}
+			clogE << "writev() failed: " << std::strerror(errno) << "\n";
+			return false;
+		}
+		m_stats.writes++;
+		m_stats.bytesWritten += static_cast<uint64_t>(result);
+
+		/* Release the buffers that have been fully written */
+		size_t written = static_cast<size_t>(result);
+		m_tx_pending -= written;
+		while (written > 0) {
+			size_t left = m_tx_queue.front().size() - m_tx_offset;
+			if (written < left) {
+				m_tx_offset += written;
+				break;
+			}
+			written -= left;
+			m_tx_offset = 0;
+			m_tx_queue.pop_front();
+		}
+	}
+	return true;
+}
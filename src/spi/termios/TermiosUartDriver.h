@@ -0,0 +1,152 @@
+/**
+ * @file TermiosUartDriver.h
+ *
+ * @brief Concrete implementation of a UART driver using POSIX termios and poll(), with its own I/O thread
+ */
+
+#pragma once
+
+#include "../IUartDriver.h"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef USE_RARITAN
+/**** Start of the official API; no includes below this point! ***************/
+#include <pp/official_api_start.h>
+#endif // USE_RARITAN
+
+/**
+ * Size of the buffer used to read incoming bytes (at most one notification of this size per read)
+ */
+#define TERMIOS_UART_READ_SIZE 4096
+
+/**
+ * Maximum number of bytes queued for writing, further writes fail with ENOBUFS
+ */
+#define TERMIOS_UART_MAX_PENDING 65536
+
+/**
+ * @brief Statistics on the I/O performed by a TermiosUartDriver
+ */
+typedef struct {
+	uint32_t reads;	/*!< Number of read() system calls that returned data */
+	uint64_t bytesRead;	/*!< Total number of bytes read */
+	uint32_t frames;	/*!< Number of buffers accepted by write() */
+	uint32_t writes;	/*!< Number of writev() system calls that wrote data */
+	uint64_t bytesWritten;	/*!< Total number of bytes written */
+	size_t maxPending;	/*!< Highest number of bytes that have been waiting to be written */
+} STermiosUartStats;
+
+/**
+ * @brief Class to interact with a UART using termios, without any third-party library
+ *
+ * The serial port is non-blocking and watched with poll() by a dedicated thread, that:
+ * - reads up to TERMIOS_UART_READ_SIZE bytes at once, and notifies them in a single call to the observers
+ * - writes the bytes queued by write(), all the buffers pending (eg an ACK frame followed by a DATA frame) being gathered in a single writev()
+ */
+class TermiosUartDriver : public IUartDriver {
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * @param uartIncomingDataHandler An observable instance that will notify its observer when one or more new bytes have been read, if =nullptr, no notification will be done
+	 */
+	TermiosUartDriver(GenericAsyncDataInputObservable* uartIncomingDataHandler = nullptr);
+
+	/**
+	 * @brief Copy constructor
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	TermiosUartDriver(const TermiosUartDriver& other) = delete;
+
+	/**
+	 * @brief Assignment operator
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	TermiosUartDriver& operator=(const TermiosUartDriver& other) = delete;
+
+	/**
+	 * @brief Destructor
+	 */
+	~TermiosUartDriver();
+
+	/**
+	 * @brief Set the incoming data handler (a derived class of GenericAsyncDataInputObservable) that will notify observers when new bytes are available on the UART
+	 *
+	 * @param uartIncomingDataHandler A pointer to the new handler (the eventual previous handler that might have been set at construction will be dropped)
+	 */
+	void setIncomingDataHandler(GenericAsyncDataInputObservable* uartIncomingDataHandler);
+
+	/**
+	 * @brief Enable or disable hardware (RTS/CTS) flow control, applied at the next open()
+	 *
+	 * Flow control is recommended at 460800 and 921600 bauds, where the NCP cannot keep up otherwise
+	 *
+	 * @param rtsCts true to enable RTS/CTS flow control (disabled by default)
+	 */
+	void setFlowControl(bool rtsCts);
+
+	/**
+	 * @brief Opens the serial port, and starts the I/O thread
+	 *
+	 * The port is configured in raw mode, 8 data bits, no parity, 1 stop bit
+	 *
+	 * @param serialPortName The name of the serial port to open (eg: "/dev/ttyUSB0")
+	 * @param baudRate The baudrate to enforce on the serial port
+	 *
+	 * @return 0 on success, errno on failure
+	 */
+	int open(const std::string& serialPortName, unsigned int baudRate = 57600);
+
+	/**
+	 * @brief Queue a byte sequence to be written to the serial port by the I/O thread
+	 *
+	 * This never blocks
+	 *
+	 * @param[out] writtenCnt How many bytes were actually queued (either cnt or 0)
+	 * @param[in] buf data buffer to write
+	 * @param[in] cnt byte count of data to write
+	 *
+	 * @return 0 on success, errno on failure (EBADF if the port is not open, ENOBUFS if TERMIOS_UART_MAX_PENDING bytes are already waiting)
+	 */
+	int write(size_t& writtenCnt, const void* buf, size_t cnt);
+
+	/**
+	 * @brief Close the serial port, bytes that have not been written yet are discarded
+	 */
+	void close();
+
+	/**
+	 * @brief Get statistics on the I/O performed since the port was opened
+	 */
+	STermiosUartStats getStats() const;
+
+private:
+	void run();
+	bool readAvailable();
+	bool writePending();
+	void wakeUp();
+
+	int m_serial_fd;	/*!< The serial port file descriptor, -1 if closed */
+	int m_wake_fds[2];	/*!< Pipe used to wake the I/O thread up (when bytes are queued, or to stop it) */
+	bool m_rts_cts;	/*!< Is hardware flow control requested */
+	GenericAsyncDataInputObservable* m_data_input_observable;	/*!< The observable that will notify observers when new bytes are available on the UART */
+	volatile bool m_io_thread_alive;	/*!< A boolean, indicating whether the I/O thread should keep running */
+	std::thread m_io_thread;	/*!< The thread polling the serial port */
+	mutable std::mutex m_tx_mutex;	/*!< Protects the attributes below */
+	std::deque<std::vector<uint8_t>> m_tx_queue;	/*!< Buffers waiting to be written, in order */
+	size_t m_tx_offset;	/*!< Number of bytes of the first buffer of m_tx_queue already written */
+	size_t m_tx_pending;	/*!< Number of bytes waiting to be written */
+	bool m_wake_pending;	/*!< Has the I/O thread been woken up and not yet flushed m_tx_queue */
+	STermiosUartStats m_stats;	/*!< I/O statistics */
+};
+
+#ifdef USE_RARITAN
+#include <pp/official_api_end.h>
+#endif // USE_RARITAN
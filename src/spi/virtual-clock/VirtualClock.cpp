@@ -0,0 +1,93 @@
+/**
+ * @file VirtualClock.cpp
+ *
+ * @brief Discrete-event scheduler running on a simulated time base, for unit tests
+ */
+
+#include "VirtualClock.h"
+
+VirtualClock::VirtualClock() :
+	m_mutex(),
+	m_now(0),
+	m_last_id(0),
+	m_events(),
+	m_deadlines() {
+}
+
+std::chrono::milliseconds VirtualClock::now() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return std::chrono::milliseconds(m_now);
+}
+
+VirtualClock::EventId VirtualClock::schedule(std::chrono::milliseconds delay, std::function<void ()> event) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::chrono::milliseconds::rep deadline = m_now + (delay.count() > 0 ? delay.count() : 0);
+	EventId id = ++m_last_id;
+
+	m_events[EventKey(deadline, id)] = event;
+	m_deadlines[id] = deadline;
+	return id;
+}
+
+bool VirtualClock::cancel(EventId id) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::map<EventId, std::chrono::milliseconds::rep>::iterator it = m_deadlines.find(id);
+
+	if (it == m_deadlines.end()) {
+		return false;
+	}
+	m_events.erase(EventKey(it->second, id));
+	m_deadlines.erase(it);
+	return true;
+}
+
+void VirtualClock::advance(std::chrono::milliseconds duration) {
+	std::chrono::milliseconds::rep target;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		target = m_now + duration.count();
+	}
+	while (this->runFirstBefore(target)) {
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_now < target) {
+		m_now = target;
+	}
+}
+
+bool VirtualClock::runNext() {
+	std::chrono::milliseconds::rep limit;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_events.empty()) {
+			return false;
+		}
+		limit = m_events.begin()->first.first;
+	}
+	return this->runFirstBefore(limit);
+}
+
+size_t VirtualClock::getPendingEventsCount() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_events.size();
+}
+
+bool VirtualClock::runFirstBefore(std::chrono::milliseconds::rep limit) {
+	std::function<void ()> event;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_events.empty() || m_events.begin()->first.first > limit) {
+			return false;
+		}
+		std::map<EventKey, std::function<void ()>>::iterator first = m_events.begin();
+		m_now = first->first.first;
+		event.swap(first->second);
+		m_deadlines.erase(first->first.second);
+		m_events.erase(first);
+	}
+	/* The event is run without holding the mutex, so that it can schedule or cancel other events */
+	if (event) {
+		event();
+	}
+	return true;
+}
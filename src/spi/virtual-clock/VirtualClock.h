@@ -0,0 +1,114 @@
+/**
+ * @file VirtualClock.h
+ *
+ * @brief Discrete-event scheduler running on a simulated time base, for unit tests
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief Simulated clock, on which events are scheduled and run when the time is advanced explicitly
+ *
+ * Time does not flow by itself: it only moves forward when advance() or runNext() is invoked, by jumping from one scheduled event to the next one.
+ * Events are run in the order of their deadline (events sharing the same deadline are run in the order they have been scheduled), from the thread that advances the time.
+ * This allows scenarios spanning seconds of protocol time to run at CPU speed, and in a fully deterministic way.
+ *
+ * Events may be scheduled or cancelled from any thread, including from within a running event
+ */
+class VirtualClock {
+public:
+	/**
+	 * @brief Identifier of a scheduled event (0 is never used, and can thus represent "no event")
+	 */
+	typedef uint64_t EventId;
+
+	/**
+	 * @brief Default constructor, the time starts at 0
+	 */
+	VirtualClock();
+
+	/**
+	 * @brief Copy constructor
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	VirtualClock(const VirtualClock& other) = delete;
+
+	/**
+	 * @brief Assignment operator
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	VirtualClock& operator=(const VirtualClock& other) = delete;
+
+	/**
+	 * @brief Get the current simulated time
+	 *
+	 * @return The time elapsed since the creation of this clock
+	 */
+	std::chrono::milliseconds now() const;
+
+	/**
+	 * @brief Schedule an event
+	 *
+	 * @param delay The delay after which the event will be run, relative to the current simulated time
+	 * @param event The function to invoke when the deadline is reached
+	 *
+	 * @return The identifier of the event, to be used with cancel()
+	 */
+	EventId schedule(std::chrono::milliseconds delay, std::function<void ()> event);
+
+	/**
+	 * @brief Cancel a scheduled event
+	 *
+	 * @param id The identifier of the event, as returned by schedule()
+	 *
+	 * @return true if the event was still pending and has been cancelled
+	 */
+	bool cancel(EventId id);
+
+	/**
+	 * @brief Move the simulated time forward, running all events reaching their deadline on the way
+	 *
+	 * Events scheduled by the events being run are also run if their deadline falls within the advanced duration
+	 *
+	 * @param duration The duration to advance the time by
+	 *
+	 * @warning This method must not be invoked from within an event
+	 */
+	void advance(std::chrono::milliseconds duration);
+
+	/**
+	 * @brief Jump to the deadline of the next scheduled event and run it
+	 *
+	 * @return false if there was no event to run
+	 *
+	 * @warning This method must not be invoked from within an event
+	 */
+	bool runNext();
+
+	/**
+	 * @brief Get the number of events currently scheduled
+	 *
+	 * @return The number of events not run nor cancelled yet
+	 */
+	size_t getPendingEventsCount() const;
+
+private:
+	typedef std::pair<std::chrono::milliseconds::rep, EventId> EventKey;	/*!< Events are sorted by deadline, then by scheduling order */
+
+	bool runFirstBefore(std::chrono::milliseconds::rep limit);
+
+	mutable std::mutex m_mutex;	/*!< Protects all the attributes below */
+	std::chrono::milliseconds::rep m_now;	/*!< Current simulated time (in ms) */
+	EventId m_last_id;	/*!< Identifier of the last event scheduled */
+	std::map<EventKey, std::function<void ()>> m_events;	/*!< Scheduled events */
+	std::map<EventId, std::chrono::milliseconds::rep> m_deadlines;	/*!< Deadline of each scheduled event, to find it back when cancelling it */
+};
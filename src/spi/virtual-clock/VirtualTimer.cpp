@@ -0,0 +1,66 @@
+/**
+ * @file VirtualTimer.cpp
+ *
+ * @brief Concrete implementation of ITimer driven by a VirtualClock, for unit tests
+ */
+
+#include "VirtualTimer.h"
+
+VirtualTimer::VirtualTimer(VirtualClock& clock) :
+	m_clock(clock),
+	m_event(0) {
+}
+
+VirtualTimer::~VirtualTimer() {
+	this->stop();
+}
+
+bool VirtualTimer::start(uint16_t timeout, std::function<void (ITimer* triggeringTimer)> callBackFunction) {
+
+	if (this->started) {
+		return false;
+	}
+
+	if (!callBackFunction) {
+		return false;
+	}
+
+	this->duration = timeout;
+	if (timeout == 0) {
+		callBackFunction(this);
+	}
+	else {
+		this->started = true;
+		m_event = m_clock.schedule(std::chrono::milliseconds(timeout), [this, callBackFunction]() {
+			/* The callback is free to restart this timer */
+			this->started = false;
+			m_event = 0;
+			callBackFunction(this);
+		});
+	}
+	return true;
+}
+
+bool VirtualTimer::stop() {
+
+	if (!this->started) {
+		return false;
+	}
+	m_clock.cancel(m_event);
+	m_event = 0;
+	this->started = false;
+	this->duration = 0;
+	return true;
+}
+
+bool VirtualTimer::isRunning() {
+	return this->started;
+}
+
+VirtualTimerFactory::VirtualTimerFactory(VirtualClock& clock) :
+	m_clock(clock) {
+}
+
+std::unique_ptr<ITimer> VirtualTimerFactory::create() const {
+	return std::unique_ptr<ITimer>(new VirtualTimer(m_clock));
+}
@@ -0,0 +1,102 @@
+/**
+ * @file VirtualTimer.h
+ *
+ * @brief Concrete implementation of ITimer driven by a VirtualClock, for unit tests
+ */
+
+#pragma once
+
+#include "../ITimerFactory.h"
+#include "VirtualClock.h"
+
+/**
+ * @brief Timer expiring on the simulated time of a VirtualClock
+ *
+ * Callbacks are invoked from the thread advancing the clock, when the clock reaches the deadline of the timer
+ */
+class VirtualTimer : public ITimer {
+public:
+	/**
+	 * @brief Default constructor
+	 *
+	 * Construction without arguments is not allowed
+	 */
+	VirtualTimer() = delete;
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param clock The clock driving this timer (it must outlive this timer)
+	 */
+	VirtualTimer(VirtualClock& clock);
+
+	/**
+	 * @brief Copy constructor
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	VirtualTimer(const VirtualTimer& other) = delete;
+
+	/**
+	 * @brief Assignment operator
+	 *
+	 * Copy construction is forbidden on this class
+	 */
+	VirtualTimer& operator=(const VirtualTimer& other) = delete;
+
+	/**
+	 * @brief Destructor
+	 */
+	~VirtualTimer();
+
+	/**
+	 * @brief Start a timer, run a callback after expiration of the configured time
+	 *
+	 * @param timeout The timeout (in ms of simulated time)
+	 * @param callBackFunction The function to call at expiration of the timer (should be of type void f(ITimer*)) where argument will be a pointer to this timer object that invoked the callback
+	 *
+	 * @return false if the timer is already running
+	 */
+	bool start(uint16_t timeout, std::function<void (ITimer* triggeringTimer)> callBackFunction);
+
+	/**
+	 * @brief Stop and reset the timer
+	 *
+	 * @return true if we actually could stop a running timer
+	 */
+	bool stop();
+
+	/**
+	 * @brief Is the timer currently running?
+	 *
+	 * @return true if the timer is running
+	 */
+	bool isRunning();
+
+private:
+	VirtualClock& m_clock;	/*!< The clock driving this timer */
+	VirtualClock::EventId m_event;	/*!< The event scheduled on m_clock for the expiration of this timer (0 if none) */
+};
+
+/**
+ * @brief Factory class to generate VirtualTimer objects, all driven by the same VirtualClock
+ */
+class VirtualTimerFactory : public ITimerFactory {
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * @param clock The clock driving the timers created (it must outlive them)
+	 */
+	VirtualTimerFactory(VirtualClock& clock);
+
+	/**
+	 * @brief Create a new timer driven by our clock
+	 *
+	 * @return The new timer created
+	 */
+	std::unique_ptr<ITimer> create() const;
+
+private:
+	VirtualClock& m_clock;	/*!< The clock driving the timers created */
+};
@@ -0,0 +1,40 @@
+/**
+ * @file alloc_counter.cpp
+ *
+ * @brief Replacement of the global operator new counting heap allocations
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "alloc_counter.h"
+
+static std::atomic<size_t> heapAllocations(0);
+
+size_t getHeapAllocationCount() {
+	return heapAllocations.load();
+}
+
+#if HEAP_ALLOCATION_COUNTING
+void* operator new(std::size_t size) {
+	heapAllocations++;
+	void* p = std::malloc(size ? size : 1);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](std::size_t size) {
+	return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+#endif	// HEAP_ALLOCATION_COUNTING
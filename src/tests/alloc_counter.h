@@ -0,0 +1,25 @@
+/**
+ * @file alloc_counter.h
+ *
+ * @brief Count of the heap allocations made by the test runner, to check that hot paths do not allocate
+ */
+
+#pragma once
+
+#include <cstddef>	// For size_t
+
+/**
+ * @brief Is getHeapAllocationCount() actually counting allocations
+ *
+ * CppUTest replaces operator new with its own leak detector, so allocations are only counted when running without it.
+ */
+#ifndef USE_CPPUTEST
+#define HEAP_ALLOCATION_COUNTING 1
+#else
+#define HEAP_ALLOCATION_COUNTING 0
+#endif
+
+/**
+ * @brief Get the number of heap allocations (calls to operator new) made so far, by any thread
+ */
+size_t getHeapAllocationCount();
@@ -0,0 +1,550 @@
+#include "TestHarness.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include <thread>
+#include <chrono>
+
+#include "../domain/crc-ccitt.h"
+#include "../domain/ash.h"
+#include "../domain/ash-stuffing.h"
+#include "../spi/cppthreads/CppThreadsTimerFactory.h"
+
+/**
+ * @brief Decode a whole buffer, collecting all DATA frames decoded
+ */
+static std::vector< std::vector<uint8_t> > decodeAll(CAsh& ash, const std::vector<uint8_t>& input, size_t chunkSize) {
+	std::vector< std::vector<uint8_t> > result;
+	size_t offset = 0;
+	while (offset < input.size()) {
+		size_t chunkEnd = std::min(input.size(), offset + chunkSize);
+		while (offset < chunkEnd) {
+			size_t used = 0;
+			CByteSpan frame = ash.decode(input.data() + offset, chunkEnd - offset, used);
+			if (used == 0) {
+				FAILF("Decoder did not consume any byte");
+			}
+			offset += used;
+			if (!frame.empty()) {
+				result.push_back(frame.toVector());
+			}
+		}
+	}
+	return result;
+}
+
+TEST_GROUP(ash_tests) {
+};
+
+TEST(ash_tests, crc_ccitt_known_values) {
+	const uint8_t rst[] = { 0xc0 };
+	const uint8_t ack1[] = { 0x81 };
+	const uint8_t rstack[] = { 0xc1, 0x02, 0x0b };
+
+	if (CCrcCcitt::computeBitwise(rst, sizeof(rst)) != 0x38bc) {
+		FAILF("Wrong CRC for RST frame");
+	}
+	if (CCrcCcitt::computeByteTable(ack1, sizeof(ack1)) != 0x6059) {
+		FAILF("Wrong CRC for ACK frame");
+	}
+	if (CCrcCcitt::compute(rstack, sizeof(rstack)) != 0x0a52) {
+		FAILF("Wrong CRC for RSTACK frame");
+	}
+	/* A frame followed by its own CRC checks to 0 */
+	const uint8_t rstackWithCrc[] = { 0xc1, 0x02, 0x0b, 0x0a, 0x52 };
+	if (CCrcCcitt::compute(rstackWithCrc, sizeof(rstackWithCrc)) != 0) {
+		FAILF("CRC over a frame and its CRC should be 0");
+	}
+	NOTIFYPASS();
+}
+
+TEST(ash_tests, crc_ccitt_implementations_match) {
+	std::vector<uint8_t> buf;
+	uint32_t seed = 0x12345678;
+
+	for (unsigned int len = 0; len < 300; len++) {
+		seed = seed * 1103515245U + 12345U;
+		buf.push_back(static_cast<uint8_t>(seed >> 16));
+
+		uint16_t ref = CCrcCcitt::computeBitwise(buf.data(), buf.size());
+		if (CCrcCcitt::computeByteTable(buf.data(), buf.size()) != ref) {
+			FAILF("Byte table CRC mismatch for length %u", len);
+		}
+		if (CCrcCcitt::computeSliceBy8(buf.data(), buf.size()) != ref) {
+			FAILF("Slice-by-8 CRC mismatch for length %u", len);
+		}
+
+		/* Incremental computation, splitting the buffer into single bytes and ranges */
+		CCrcCcitt crc;
+		size_t half = buf.size() / 2;
+		for (size_t loop = 0; loop < half; loop++) {
+			crc.update(buf[loop]);
+		}
+		crc.update(buf.data() + half, buf.size() - half);
+		if (crc.value() != ref) {
+			FAILF("Incremental CRC mismatch for length %u", len);
+		}
+	}
+	NOTIFYPASS();
+}
+
+TEST(ash_tests, ash_streaming_decode) {
+	CppThreadsTimerFactory timerFactory;
+	CAsh ash(nullptr, timerFactory);
+
+	/* Line noise, cancel byte, EZSP version response, then a response with extended header */
+	const std::vector<uint8_t> input({ 0x55, 0x1a,
+	                                   0x01, 0x42, 0xa1, 0xa8, 0x53, 0x28, 0x45, 0xd7, 0xcf, 0x00, 0x7e,
+	                                   0x12, 0x43, 0xa1, 0x57, 0x54, 0x2a, 0x45, 0xd7, 0xe7, 0x42, 0x7e });
+	const std::vector<uint8_t> expected1({ 0x00, 0x80, 0x00, 0x07, 0x02, 0x50, 0x65, 0x96, 0x94 });
+	const std::vector<uint8_t> expected2({ 0x01, 0x80, 0x00, 0x50, 0x65, 0xbe, 0xd6 });
+
+	for (size_t chunkSize = 1; chunkSize <= input.size(); chunkSize++) {
+		std::vector< std::vector<uint8_t> > frames = decodeAll(ash, input, chunkSize);
+		if (frames.size() != 2) {
+			FAILF("Expected 2 frames with chunks of %zu bytes, got %zu", chunkSize, frames.size());
+		}
+		if (frames[0] != expected1 || frames[1] != expected2) {
+			FAILF("Wrong frame content with chunks of %zu bytes", chunkSize);
+		}
+	}
+
+	/* Legacy vector API */
+	std::vector<uint8_t> legacyInput(input);
+	if (ash.decode(legacyInput) != expected1 || legacyInput.size() != 11) {
+		FAILF("Legacy decode failed on first frame");
+	}
+	if (ash.decode(legacyInput) != expected2 || !legacyInput.empty()) {
+		FAILF("Legacy decode failed on second frame");
+	}
+	NOTIFYPASS();
+}
+
+TEST(ash_tests, ash_streaming_decode_errors) {
+	CppThreadsTimerFactory timerFactory;
+	CAsh ash(nullptr, timerFactory);
+
+	/* Byte stuffed control byte (0x11) */
+	std::vector< std::vector<uint8_t> > frames = decodeAll(ash, std::vector<uint8_t>({ 0x7d, 0x31, 0x43, 0x21, 0xa8, 0x53, 0x05, 0xf0, 0x7e }), 4);
+	if (frames.size() != 1 || frames[0] != std::vector<uint8_t>({ 0x01, 0x00, 0x00, 0x07, 0x2f, 0xe5 })) {
+		FAILF("Failed decoding byte stuffed frame");
+	}
+
+	/* Wrong CRC */
+	frames = decodeAll(ash, std::vector<uint8_t>({ 0x01, 0x42, 0xa1, 0xa8, 0x53, 0x28, 0x45, 0xd7, 0xcf, 0x01, 0x7e }), 64);
+	if (!frames.empty()) {
+		FAILF("Frame with wrong CRC should be dropped");
+	}
+
+	/* Substitute byte invalidates the current frame only */
+	frames = decodeAll(ash, std::vector<uint8_t>({ 0x01, 0x42, 0x18, 0xa1, 0xa8, 0x53, 0x28, 0x45, 0xd7, 0xcf, 0x00, 0x7e,
+	                                               0x01, 0x42, 0xa1, 0xa8, 0x53, 0x28, 0x45, 0xd7, 0xcf, 0x00, 0x7e }), 5);
+	if (frames.size() != 1) {
+		FAILF("Substitute byte should only drop the frame it appears in");
+	}
+
+	/* Overlong garbage is dropped without overflowing */
+	std::vector<uint8_t> garbage(4 * ASH_MAX_LENGTH, 0x55);
+	garbage.push_back(0x7e);
+	frames = decodeAll(ash, garbage, 100);
+	if (!frames.empty()) {
+		FAILF("Overlong frame should be dropped");
+	}
+	NOTIFYPASS();
+}
+
+/**
+ * @brief Build a frame without data field (ACK, NAK...) as it would be sent by the NCP
+ */
+static std::vector<uint8_t> ncpControlFrame(uint8_t control) {
+	std::vector<uint8_t> frame({ control });
+	uint16_t crc = CCrcCcitt::compute(frame.data(), frame.size());
+	frame.push_back(static_cast<uint8_t>(crc >> 8));
+	frame.push_back(static_cast<uint8_t>(crc & 0xFF));
+	frame.push_back(0x7e);
+	return frame;
+}
+
+static std::vector<uint8_t> ncpAckFrame(uint8_t ackNum) {
+	return ncpControlFrame(static_cast<uint8_t>(0x80 | ackNum));
+}
+
+/**
+ * @brief ASH callback recording frames retransmitted by CAsh
+ */
+class CAshTestCallback : public CAshCallback {
+public:
+	CAshTestCallback() : infos(), retransmitted() { }
+	void ashCbInfo(EAshInfo info) { infos.push_back(info); }
+	void ashCbRetransmit(const std::vector<uint8_t>& i_frame) { retransmitted.push_back(i_frame); }
+
+	std::vector<EAshInfo> infos;
+	std::vector< std::vector<uint8_t> > retransmitted;
+};
+
+/**
+ * @brief Get the (un-stuffed) control byte of an encoded frame
+ */
+static uint8_t controlByte(const std::vector<uint8_t>& frame) {
+	if (frame.size() >= 2 && frame[0] == 0x7d) {
+		return static_cast<uint8_t>(frame[1] ^ 0x20);
+	}
+	return frame.empty() ? 0xff : frame[0];
+}
+
+TEST(ash_tests, ash_tx_window) {
+	CppThreadsTimerFactory timerFactory;
+	CAsh ash(nullptr, timerFactory);
+
+	if (ash.getTxWindow() != 1) {
+		FAILF("Default window should be stop-and-wait");
+	}
+	ash.setTxWindow(0);
+	if (ash.getTxWindow() != 1) {
+		FAILF("Window should be clamped to 1");
+	}
+	ash.setTxWindow(12);
+	if (ash.getTxWindow() != ASH_MAX_TX_WINDOW) {
+		FAILF("Window should be clamped to %u", ASH_MAX_TX_WINDOW);
+	}
+
+	ash.setTxWindow(3);
+	for (uint8_t loop = 0; loop < 3; loop++) {
+		if (ash.isTxWindowFull()) {
+			FAILF("Window full after %u frames", loop);
+		}
+		std::vector<uint8_t> frame = ash.DataFrame(std::vector<uint8_t>({ 0x05 }));
+		/* Frame number is in bits 4-6 of the control byte (no byte stuffing expected here) */
+		if (((frame[0] >> 4) & 0x07) != loop) {
+			FAILF("Wrong frame number 0x%02x for frame %u", frame[0], loop);
+		}
+	}
+	if (!ash.isTxWindowFull() || ash.getOutstandingFrameCount() != 3) {
+		FAILF("Window should be full with 3 outstanding frames");
+	}
+
+	/* ACK for frames 0 and 1 */
+	decodeAll(ash, ncpAckFrame(2), 64);
+	if (ash.getOutstandingFrameCount() != 1 || ash.isTxWindowFull()) {
+		FAILF("Expected 1 outstanding frame after ACK, got %u", ash.getOutstandingFrameCount());
+	}
+
+	/* Stale ACK (for frames already acknowledged) does not change anything */
+	decodeAll(ash, ncpAckFrame(1), 64);
+	if (ash.getOutstandingFrameCount() != 1) {
+		FAILF("Stale ACK should be ignored");
+	}
+
+	/* ACK numbers piggybacked in DATA frames also release frames (EZSP version response, ackNum 3) */
+	if (decodeAll(ash, std::vector<uint8_t>({ 0x03, 0x42, 0xa1, 0xa8, 0x53, 0x28, 0x45, 0xd7, 0x40, 0xa6, 0x7e }), 64).size() != 1) {
+		FAILF("Failed decoding DATA frame");
+	}
+	if (ash.getOutstandingFrameCount() != 0) {
+		FAILF("DATA frame should acknowledge the last outstanding frame");
+	}
+	NOTIFYPASS();
+}
+
+TEST(ash_tests, ash_nak_rewind) {
+	CppThreadsTimerFactory timerFactory;
+	CAshTestCallback cb;
+	CAsh ash(&cb, timerFactory);
+
+	ash.setTxWindow(4);
+	for (uint8_t loop = 0; loop < 4; loop++) {
+		ash.DataFrame(std::vector<uint8_t>({ 0x05 }));
+	}
+
+	/* NAK for frame 1: frame 0 is acknowledged, frames 1 to 3 are sent again with the reTx flag */
+	decodeAll(ash, ncpControlFrame(0xa1), 64);
+	if (cb.retransmitted.size() != 3) {
+		FAILF("Expected 3 retransmitted frames, got %zu", cb.retransmitted.size());
+	}
+	for (uint8_t loop = 0; loop < 3; loop++) {
+		if (controlByte(cb.retransmitted[loop]) != (((loop + 1) << 4) | 0x08)) {
+			FAILF("Wrong control byte 0x%02x for retransmitted frame %u", controlByte(cb.retransmitted[loop]), loop);
+		}
+	}
+	if (ash.getOutstandingFrameCount() != 3) {
+		FAILF("Expected 3 outstanding frames after NAK, got %u", ash.getOutstandingFrameCount());
+	}
+
+	/* The next new frame keeps its own number */
+	std::vector<uint8_t> frame = ash.DataFrame(std::vector<uint8_t>({ 0x05 }));
+	if (((controlByte(frame) >> 4) & 0x07) != 4) {
+		FAILF("Wrong frame number after NAK: 0x%02x", controlByte(frame));
+	}
+	NOTIFYPASS();
+}
+
+TEST(ash_tests, ash_ack_timer) {
+	CppThreadsTimerFactory timerFactory;
+	CAshTestCallback cb;
+	CAsh ash(&cb, timerFactory);
+
+	ash.resetNCPFrame();
+	/* RSTACK */
+	decodeAll(ash, std::vector<uint8_t>({ 0xc1, 0x02, 0x0b, 0x0a, 0x52, 0x7e }), 64);
+	if (!ash.isConnected()) {
+		FAILF("RSTACK should connect ASH");
+	}
+	if (ash.getAckTimeout() != 1600) {
+		FAILF("Wrong initial ACK timeout %u", ash.getAckTimeout());
+	}
+
+	/* A quick ACK shortens the timeout */
+	ash.DataFrame(std::vector<uint8_t>({ 0x05 }));
+	decodeAll(ash, ncpAckFrame(1), 64);
+	uint16_t timeout = ash.getAckTimeout();
+	if (timeout >= 1600 || timeout < 400) {
+		FAILF("ACK timeout should decrease towards the measured round trip time, got %u", timeout);
+	}
+
+	/* No ACK: the frame is sent again with the reTx flag, and the timeout backs off */
+	ash.DataFrame(std::vector<uint8_t>({ 0x05 }));
+	std::this_thread::sleep_for(std::chrono::milliseconds(timeout + 200));
+	if (cb.retransmitted.size() != 1 || controlByte(cb.retransmitted[0]) != 0x18) {
+		FAILF("Expected frame 1 to be retransmitted after timeout");
+	}
+	if (ash.getAckTimeout() != 2 * timeout) {
+		FAILF("ACK timeout should double after a timeout, got %u", ash.getAckTimeout());
+	}
+	decodeAll(ash, ncpAckFrame(2), 64);
+	if (ash.getOutstandingFrameCount() != 0) {
+		FAILF("Retransmitted frame should be acknowledged");
+	}
+	NOTIFYPASS();
+}
+
+TEST(ash_tests, ash_ack_counters) {
+	CppThreadsTimerFactory timerFactory;
+	CAsh ash(nullptr, timerFactory);
+	/* EZSP version response from the NCP, frame number 0 */
+	const std::vector<uint8_t> ncpData({ 0x01, 0x42, 0xa1, 0xa8, 0x53, 0x28, 0x45, 0xd7, 0xcf, 0x00, 0x7e });
+
+	decodeAll(ash, ncpData, 64);
+	if (ash.getRxUnackedCount() != 1) {
+		FAILF("Expected 1 unacknowledged DATA frame");
+	}
+	/* Acknowledge piggybacked in our next DATA frame */
+	std::vector<uint8_t> frame = ash.DataFrame(std::vector<uint8_t>({ 0x05 }));
+	if ((frame[0] & 0x07) != 1 || ash.getRxUnackedCount() != 0 || ash.getAckSavedCount() != 1) {
+		FAILF("Acknowledge should be piggybacked in the DATA frame");
+	}
+
+	/* Two DATA frames acknowledged by a single ACK frame */
+	decodeAll(ash, ncpData, 64);
+	decodeAll(ash, ncpData, 64);
+	if (ash.getRxUnackedCount() != 2) {
+		FAILF("Expected 2 unacknowledged DATA frames");
+	}
+	ash.AckFrame();
+	if (ash.getRxUnackedCount() != 0 || ash.getAckSentCount() != 1 || ash.getAckSavedCount() != 2) {
+		FAILF("Wrong counters after coalesced ACK: sent %u, saved %u", ash.getAckSentCount(), ash.getAckSavedCount());
+	}
+	NOTIFYPASS();
+}
+
+/**
+ * @brief Reference multi-pass ASH DATA frame encoder (header insertion, randomisation, CRC and stuffing each performed on a separate vector)
+ */
+static std::vector<uint8_t> referenceDataFrame(uint8_t control, uint8_t seq, std::vector<uint8_t> data) {
+	if (data.at(0) != 0) {
+		data.insert(data.begin(), 0x00);
+		data.insert(data.begin(), 0xff);
+	}
+	data.insert(data.begin(), 0x00);
+	data.insert(data.begin(), seq);
+
+	std::vector<uint8_t> frame({ control });
+	uint8_t rand = 0x42;
+	for (uint8_t byte : data) {
+		frame.push_back(byte ^ rand);
+		rand = (rand & 0x01) ? static_cast<uint8_t>((rand >> 1) ^ 0xb8) : static_cast<uint8_t>(rand >> 1);
+	}
+	uint16_t crc = CCrcCcitt::computeBitwise(frame.data(), frame.size());
+	frame.push_back(static_cast<uint8_t>(crc >> 8));
+	frame.push_back(static_cast<uint8_t>(crc & 0xff));
+
+	std::vector<uint8_t> stuffed;
+	for (uint8_t byte : frame) {
+		if (byte == 0x7e || byte == 0x7d || byte == 0x11 || byte == 0x13 || byte == 0x18 || byte == 0x1a) {
+			stuffed.push_back(0x7d);
+			stuffed.push_back(byte ^ 0x20);
+		}
+		else {
+			stuffed.push_back(byte);
+		}
+	}
+	stuffed.push_back(0x7e);
+	return stuffed;
+}
+
+TEST(ash_tests, ash_encode_data_frame) {
+	CppThreadsTimerFactory timerFactory;
+	CAsh ash(nullptr, timerFactory);
+	uint32_t seed = 0xcafe;
+
+	ash.setTxWindow(ASH_MAX_TX_WINDOW);
+	for (unsigned int loop = 0; loop < 200; loop++) {
+		std::vector<uint8_t> data;
+		/* Version request (command 0x00) has no extended header */
+		data.push_back(static_cast<uint8_t>(loop % 3));
+		for (unsigned int len = loop % 120; len > 0; len--) {
+			seed = seed * 1103515245U + 12345U;
+			data.push_back(static_cast<uint8_t>(seed >> 16));
+		}
+		uint8_t control = static_cast<uint8_t>((loop & 0x07) << 4);
+		std::vector<uint8_t> expected = referenceDataFrame(control, static_cast<uint8_t>(loop), data);
+
+		uint8_t frame[ASH_MAX_FRAME_SIZE];
+		size_t frameLen = ash.DataFrame(data.data(), data.size(), frame, sizeof(frame));
+		if (std::vector<uint8_t>(frame, frame + frameLen) != expected) {
+			FAILF("Encoded frame %u differs from reference encoder", loop);
+		}
+		/* Same frame as if sent by the NCP: de-randomised EZSP frame without extended header, followed by the CRC */
+		CAsh rxAsh(nullptr, timerFactory);
+		std::vector< std::vector<uint8_t> > decoded = decodeAll(rxAsh, expected, 64);
+		std::vector<uint8_t> expectedEzsp({ static_cast<uint8_t>(loop), 0x00 });
+		expectedEzsp.insert(expectedEzsp.end(), data.begin(), data.end());
+		if (decoded.size() != 1 || decoded[0].size() != expectedEzsp.size() + 2 ||
+		    !std::equal(expectedEzsp.begin(), expectedEzsp.end(), decoded[0].begin())) {
+			FAILF("Failed decoding frame %u", loop);
+		}
+		/* Acknowledge it, to keep room in the window */
+		decodeAll(ash, ncpAckFrame(static_cast<uint8_t>((loop + 1) & 0x07)), 64);
+	}
+
+	/* Output buffer too small */
+	uint8_t small[8];
+	if (ash.DataFrame(std::vector<uint8_t>({ 0x05, 0x01, 0x02 }).data(), 3, small, sizeof(small)) != 0) {
+		FAILF("Encoding should fail when the output buffer is too small");
+	}
+	NOTIFYPASS();
+}
+
+/**
+ * @brief Timer that never fires, so that benchmarks do not measure thread creation
+ */
+class CNullTimer : public ITimer {
+public:
+	bool start(uint16_t timeout, std::function<void (ITimer* triggeringTimer)> callBackFunction) { started = true; duration = timeout; return true; }
+	bool stop() { bool wasStarted = started; started = false; return wasStarted; }
+	bool isRunning() { return started; }
+};
+
+class CNullTimerFactory : public ITimerFactory {
+public:
+	std::unique_ptr<ITimer> create() const { return std::unique_ptr<ITimer>(new CNullTimer()); }
+};
+
+TEST(ash_tests, ash_encode_benchmark) {
+	CNullTimerFactory timerFactory;
+	CAsh ash(nullptr, timerFactory);
+	const unsigned int iterations = 20000;
+	std::vector<uint8_t> data({ 0xc6, 0x00, 0x00, 0x01, 0x00, 0x1a, 0x00, 0x00, 0x00, 0x7e, 0x11, 0x13, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47 });
+	size_t checksum = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int loop = 0; loop < iterations; loop++) {
+		checksum += referenceDataFrame(static_cast<uint8_t>(loop & 0x70), static_cast<uint8_t>(loop), data).size();
+	}
+	auto multiPass = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	for (unsigned int loop = 0; loop < iterations; loop++) {
+		uint8_t frame[ASH_MAX_FRAME_SIZE];
+		checksum += ash.DataFrame(data.data(), data.size(), frame, sizeof(frame));
+	}
+	auto bufferPath = std::chrono::steady_clock::now() - start;
+
+	std::cout << "DATA frame encoding (" << data.size() << " bytes command): multi-pass vectors "
+	          << std::chrono::duration_cast<std::chrono::nanoseconds>(multiPass).count() / iterations << "ns, caller buffer "
+	          << std::chrono::duration_cast<std::chrono::nanoseconds>(bufferPath).count() / iterations << "ns per frame"
+	          << " (checksum " << checksum << ")" << std::endl;
+	NOTIFYPASS();
+}
+
+TEST(ash_tests, ash_stuffing_scanners) {
+	std::vector<uint8_t> buf(300);
+	const uint8_t reserved[] = { 0x7e, 0x7d, 0x11, 0x13, 0x18, 0x1a };
+	uint32_t seed = 0xbeef;
+
+	for (unsigned int value = 0; value < 256; value++) {
+		bool expected = std::find(reserved, reserved + sizeof(reserved), value) != reserved + sizeof(reserved);
+		if (CAshStuffing::isReserved(static_cast<uint8_t>(value)) != expected) {
+			FAILF("Wrong classification for byte 0x%02x", value);
+		}
+	}
+
+	for (unsigned int loop = 0; loop < 2000; loop++) {
+		size_t len = loop % buf.size();
+		for (size_t i = 0; i < len; i++) {
+			do {
+				seed = seed * 1103515245U + 12345U;
+				buf[i] = static_cast<uint8_t>(seed >> 16);
+			} while (CAshStuffing::isReserved(buf[i]));
+		}
+		/* Place a reserved byte (or none) at a random position */
+		seed = seed * 1103515245U + 12345U;
+		size_t pos = (len > 0) ? (seed >> 8) % (len + 1) : 0;
+		if (pos < len) {
+			buf[pos] = reserved[loop % sizeof(reserved)];
+		}
+		if (CAshStuffing::findReservedScalar(buf.data(), len) != pos) {
+			FAILF("Scalar scanner failed for length %zu, position %zu", len, pos);
+		}
+		if (CAshStuffing::hasSse2() && CAshStuffing::findReservedSse2(buf.data(), len) != pos) {
+			FAILF("SSE2 scanner failed for length %zu, position %zu", len, pos);
+		}
+		if (CAshStuffing::hasAvx2() && CAshStuffing::findReservedAvx2(buf.data(), len) != pos) {
+			FAILF("AVX2 scanner failed for length %zu, position %zu", len, pos);
+		}
+		if (CAshStuffing::findReserved(buf.data(), len) != pos) {
+			FAILF("Scanner failed for length %zu, position %zu", len, pos);
+		}
+	}
+
+	/* Stuffing */
+	const std::vector<uint8_t> raw({ 0x7e, 0x00, 0x7d, 0x11, 0x13, 0x18, 0x1a, 0x20, 0x7e });
+	const std::vector<uint8_t> expected({ 0x7d, 0x5e, 0x00, 0x7d, 0x5d, 0x7d, 0x31, 0x7d, 0x33, 0x7d, 0x38, 0x7d, 0x3a, 0x20, 0x7d, 0x5e });
+	uint8_t out[2 * 9];
+	size_t outLen = CAshStuffing::stuff(raw.data(), raw.size(), out);
+	if (std::vector<uint8_t>(out, out + outLen) != expected) {
+		FAILF("Wrong stuffing");
+	}
+
+	/* Throughput on a payload without reserved bytes */
+	std::vector<uint8_t> clean(128, 0x55);
+	std::vector<uint8_t> stuffed(2 * clean.size());
+	const unsigned int iterations = 100000;
+	size_t checksum = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int loop = 0; loop < iterations; loop++) {
+		clean[loop % clean.size()] = static_cast<uint8_t>(0x40 + (loop & 0x0f));
+		checksum += CAshStuffing::stuff(clean.data(), clean.size(), stuffed.data());
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "Stuffing a clean 128 bytes payload using " << CAshStuffing::getImplementationName() << " scanner: "
+	          << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / iterations << "ns"
+	          << " (checksum " << checksum << ")" << std::endl;
+	NOTIFYPASS();
+}
+
+#ifndef USE_CPPUTEST
+void unit_tests_ash() {
+	crc_ccitt_known_values();
+	crc_ccitt_implementations_match();
+	ash_streaming_decode();
+	ash_streaming_decode_errors();
+	ash_tx_window();
+	ash_nak_rewind();
+	ash_ack_timer();
+	ash_ack_counters();
+	ash_encode_data_frame();
+	ash_encode_benchmark();
+	ash_stuffing_scanners();
+}
+#endif	// USE_CPPUTEST
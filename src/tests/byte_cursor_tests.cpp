@@ -0,0 +1,122 @@
+#include "TestHarness.h"
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+
+#include "alloc_counter.h"
+#include "../domain/byte-cursor.h"
+#include "../domain/ezsp-protocol/struct/ember-network-parameters.h"
+#include "../domain/zbmessage/green-power-frame.h"
+
+TEST_GROUP(byte_cursor_tests) {
+};
+
+TEST(byte_cursor_tests, byte_reader) {
+	const std::vector<uint8_t> data({0x01, 0x34, 0x12, 0x78, 0x56, 0x34, 0x12, 0xaa, 0xbb, 0xcc});
+	CByteReader reader(data);
+
+	if (reader.readU8() != 0x01 || reader.readU16() != 0x1234 || reader.readU32() != 0x12345678) {
+		FAILF("Little endian values not read as expected");
+	}
+	CByteSpan bytes = reader.readBytes(2);
+	if (bytes.size() != 2 || bytes.data() != data.data() + 7 || reader.getPosition() != 9 || reader.getRemainingSize() != 1) {
+		FAILF("Byte strings should be read as views on the data being read");
+	}
+	if (!reader.isValid()) {
+		FAILF("Reader should be valid after in bounds reads");
+	}
+
+	/* Reading past the end */
+	if (reader.readU16() != 0 || reader.isValid() || reader.getRemainingSize() != 0) {
+		FAILF("Out of bounds reads should return 0 and mark the reader as overflowed");
+	}
+	if (reader.readU8() != 0 || !reader.readBytes(1).empty() || reader.isValid()) {
+		FAILF("Reader overflow should be sticky");
+	}
+
+	CByteReader empty((CByteSpan()));
+	if (empty.readU64() != 0 || empty.isValid()) {
+		FAILF("Reading from an empty span should overflow");
+	}
+	NOTIFYPASS();
+}
+
+TEST(byte_cursor_tests, byte_writer) {
+	uint8_t buf[8] = {0};
+	CByteWriter writer(buf, 7);
+
+	writer.writeU8(0x01);
+	writer.writeU16(0x1234);
+	writer.writeU32(0x12345678);
+	if (!writer.isValid() || writer.getSize() != 7 || writer.getWritten().toVector() != std::vector<uint8_t>({0x01, 0x34, 0x12, 0x78, 0x56, 0x34, 0x12})) {
+		FAILF("Little endian values not written as expected");
+	}
+	writer.writeU8(0xff);
+	if (writer.isValid() || writer.getSize() != 7 || buf[7] != 0) {
+		FAILF("Writes past the end of the buffer should be dropped");
+	}
+	NOTIFYPASS();
+}
+
+TEST(byte_cursor_tests, ember_structs_parsing) {
+	CEmberNetworkParameters params;
+	params.setPanId(0xabcd);
+	params.setRadioChannel(15);
+	params.setChannels(0x07fff800);
+	std::vector<uint8_t> rsp = params.getRaw();
+	rsp.insert(rsp.begin(), 0x00);	/* status */
+	CEmberNetworkParameters decoded(rsp, 1);
+	if (decoded.getPanId() != 0xabcd || decoded.getRadioChannel() != 15 || decoded.getChannels() != 0x07fff800) {
+		FAILF("Network parameters not decoded as expected: %s", decoded.String().c_str());
+	}
+
+	/* Truncated responses from the NCP are decoded with missing fields set to 0 */
+	CEmberNetworkParameters truncatedParams(CByteSpan(rsp).subspan(0, 4), 1);
+	if (truncatedParams.getChannels() != 0) {
+		FAILF("Missing fields should be decoded as 0");
+	}
+	NOTIFYPASS();
+}
+
+TEST(byte_cursor_tests, gp_frame_zero_allocation) {
+	std::vector<uint8_t> msg(28, 0x00);	/* EZSP_GPEP_INCOMING_MESSAGE_HANDLER payload */
+	msg[1] = 0xd0;	/* link */
+	msg[2] = 0x42;	/* sequence number */
+	msg[4] = 0x01;	/* source id 0x00500001 */
+	msg[6] = 0x50;
+	msg[13] = 0x02;	/* security */
+	msg[17] = 0x10;	/* frame counter */
+	msg[21] = 0xa0;	/* command */
+	msg[27] = 4;	/* payload length */
+	msg.insert(msg.end(), {0x01, 0x02, 0x03, 0x04});
+
+	size_t allocations = getHeapAllocationCount();
+	CGpFrame gpf(msg);
+	allocations = getHeapAllocationCount() - allocations;
+
+	if (gpf.getSourceId() != 0x00500001 || gpf.getSequenceNumber() != 0x42 || gpf.getLinkValue() != 0xd0 || gpf.getSecurityFrameCounter() != 0x10
+	    || gpf.getCommandId() != 0xa0 || gpf.getPayload().toVector() != std::vector<uint8_t>({0x01, 0x02, 0x03, 0x04})) {
+		FAILF("GP frame not decoded as expected: %s", gpf.String().c_str());
+	}
+	if (HEAP_ALLOCATION_COUNTING && allocations != 0) {
+		FAILF("Decoding a GP frame made %zu heap allocations", allocations);
+	}
+
+	/* Frames truncated anywhere are decoded without reading out of bounds */
+	for (size_t len = 0; len < msg.size(); len++) {
+		CGpFrame truncated(CByteSpan(msg).subspan(0, len));
+		if (truncated.getPayload().size() > len) {
+			FAILF("Truncated GP frame decoded with a %zu bytes payload", truncated.getPayload().size());
+		}
+	}
+	NOTIFYPASS();
+}
+
+#ifndef USE_CPPUTEST
+void unit_tests_byte_cursor() {
+	byte_reader();
+	byte_writer();
+	ember_structs_parsing();
+	gp_frame_zero_allocation();
+}
+#endif	// USE_CPPUTEST
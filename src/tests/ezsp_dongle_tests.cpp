@@ -0,0 +1,611 @@
+#include "TestHarness.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <map>
+#include <string>
+#include <stdint.h>
+
+#include "../domain/ezsp-dongle.h"
+#include "../domain/crc-ccitt.h"
+#include "../domain/ash-stuffing.h"
+#include "../domain/zbmessage/zdp-enum.h"
+#include "../domain/zbmessage/zigbee-message.h"
+#include "../domain/ezsp-protocol/ezsp-commands.h"
+#include "../spi/cppthreads/CppThreadsTimerFactory.h"
+#include "../spi/cppthreads/CppThreadsTimerWheel.h"
+#include "alloc_counter.h"
+
+/**
+ * @brief UART driver recording all frames written by the dongle
+ */
+class CCaptureUartDriver : public IUartDriver {
+public:
+	CCaptureUartDriver() : written() { }
+	void setIncomingDataHandler(GenericAsyncDataInputObservable* uartIncomingDataHandler) { }
+	int open(const std::string& serialPortName, unsigned int baudRate) { return 0; }
+	int write(size_t& writtenCnt, const void* buf, size_t cnt) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(buf);
+		written.push_back(std::vector<uint8_t>(bytes, bytes + cnt));
+		writtenCnt = cnt;
+		return 0;
+	}
+	void close() { }
+
+	std::vector< std::vector<uint8_t> > written;
+};
+
+/**
+ * @brief Build a DATA frame as it would be sent by the NCP
+ *
+ * @param frmNum The ASH frame number
+ * @param seq The EZSP sequence number
+ * @param fc The EZSP frame control byte
+ * @param cmd The EZSP command
+ * @param params The parameters of the EZSP frame
+ * @param ackNum The ASH acknowledgement number
+ */
+static std::vector<uint8_t> ncpDataFrame(uint8_t frmNum, uint8_t seq, uint8_t fc, EEzspCmd cmd, const std::vector<uint8_t>& params, uint8_t ackNum = 0) {
+	std::vector<uint8_t> raw({ static_cast<uint8_t>((frmNum << 4) | (ackNum & 0x07)), seq, fc, 0xff, 0x00, static_cast<uint8_t>(cmd) });
+	raw.insert(raw.end(), params.begin(), params.end());
+
+	uint8_t rand = 0x42;
+	for (size_t i = 1; i < raw.size(); i++) {
+		raw[i] ^= rand;
+		rand = (rand & 0x01) ? static_cast<uint8_t>((rand >> 1) ^ 0xb8) : static_cast<uint8_t>(rand >> 1);
+	}
+	uint16_t crc = CCrcCcitt::compute(raw.data(), raw.size());
+	raw.push_back(static_cast<uint8_t>(crc >> 8));
+	raw.push_back(static_cast<uint8_t>(crc & 0xff));
+
+	std::vector<uint8_t> frame(2 * raw.size() + 1);
+	size_t len = CAshStuffing::stuff(raw.data(), raw.size(), frame.data());
+	frame[len++] = 0x7e;
+	frame.resize(len);
+	return frame;
+}
+
+/**
+ * @brief UART driver dropping all frames written by the dongle, without allocating
+ */
+class CDiscardUartDriver : public IUartDriver {
+public:
+	CDiscardUartDriver() : writes(0) { }
+	void setIncomingDataHandler(GenericAsyncDataInputObservable* uartIncomingDataHandler) { }
+	int open(const std::string& serialPortName, unsigned int baudRate) { return 0; }
+	int write(size_t& writtenCnt, const void* buf, size_t cnt) {
+		writes++;
+		writtenCnt = cnt;
+		return 0;
+	}
+	void close() { }
+
+	unsigned int writes;
+};
+
+/**
+ * @brief Open a dongle, and bring ASH to the connected state
+ */
+static void connectDongle(CEzspDongle& dongle, IUartDriver& uart) {
+	const uint8_t rstack[] = { 0xc1, 0x02, 0x0b, 0x0a, 0x52, 0x7e };
+
+	if (!dongle.open(&uart)) {
+		FAILF("Failed opening dongle");
+	}
+	dongle.handleInputData(rstack, sizeof(rstack));
+}
+
+static void feed(CEzspDongle& dongle, const std::vector<uint8_t>& frame) {
+	dongle.handleInputData(frame.data(), frame.size());
+}
+
+/**
+ * @brief Record of the completions of commands
+ */
+struct SCompletion {
+	SCompletion() : status(EZSP_RSP_ABORTED), cmd(EZSP_VERSION), response(), count(0) { }
+	EEzspRspStatus status;
+	EEzspCmd cmd;
+	std::vector<uint8_t> response;
+	unsigned int count;
+
+	FEzspRspHandler handler() {
+		return [this](EEzspRspStatus i_status, EEzspCmd i_cmd, CByteSpan i_response) {
+			this->status = i_status;
+			this->cmd = i_cmd;
+			this->response = i_response.toVector();
+			this->count++;
+		};
+	}
+};
+
+TEST_GROUP(ezsp_dongle_tests) {
+};
+
+TEST(ezsp_dongle_tests, dongle_response_by_sequence_number) {
+	CppThreadsTimerFactory timerFactory;
+	CCaptureUartDriver uart;
+	CEzspDongle dongle(timerFactory);
+	SCompletion first;
+	SCompletion second;
+
+	connectDongle(dongle, uart);
+	dongle.setTxWindow(2);
+	dongle.sendCommand(EZSP_NETWORK_STATE, std::vector<uint8_t>(), first.handler());
+	dongle.sendCommand(EZSP_GET_EUI64, std::vector<uint8_t>(), second.handler());
+
+	/* A callback sharing the command id of the first command does not complete it */
+	feed(dongle, ncpDataFrame(0, 0, 0x90, EZSP_NETWORK_STATE, std::vector<uint8_t>({ 0x05 })));
+	if (first.count != 0) {
+		FAILF("A callback should not complete a pending command");
+	}
+
+	/* Responses are matched by sequence number, whatever their order */
+	feed(dongle, ncpDataFrame(1, 1, 0x80, EZSP_GET_EUI64, std::vector<uint8_t>({ 1, 2, 3, 4, 5, 6, 7, 8 })));
+	if (second.count != 1 || second.status != EZSP_RSP_SUCCESS || second.cmd != EZSP_GET_EUI64 ||
+	    second.response != std::vector<uint8_t>({ 1, 2, 3, 4, 5, 6, 7, 8 })) {
+		FAILF("Second command not completed with its response");
+	}
+	if (first.count != 0) {
+		FAILF("First command should still be pending");
+	}
+	feed(dongle, ncpDataFrame(2, 0, 0x80, EZSP_NETWORK_STATE, std::vector<uint8_t>({ 0x02 })));
+	if (first.count != 1 || first.status != EZSP_RSP_SUCCESS || first.response != std::vector<uint8_t>({ 0x02 })) {
+		FAILF("First command not completed with its response");
+	}
+	NOTIFYPASS();
+}
+
+TEST(ezsp_dongle_tests, dongle_response_timeout) {
+	CppThreadsTimerFactory timerFactory;
+	CCaptureUartDriver uart;
+	CEzspDongle dongle(timerFactory);
+	SCompletion completion;
+
+	connectDongle(dongle, uart);
+	dongle.sendCommand(EZSP_NETWORK_STATE, std::vector<uint8_t>(), completion.handler(), 50);
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	if (completion.count != 1 || completion.status != EZSP_RSP_TIMEOUT) {
+		FAILF("Command should have timed out");
+	}
+
+	/* A late response is ignored */
+	feed(dongle, ncpDataFrame(0, 0, 0x80, EZSP_NETWORK_STATE, std::vector<uint8_t>({ 0x02 })));
+	if (completion.count != 1) {
+		FAILF("Late response should not complete the command again");
+	}
+	NOTIFYPASS();
+}
+
+TEST(ezsp_dongle_tests, dongle_rx_dispatch_by_command) {
+	CppThreadsTimerFactory timerFactory;
+	CCaptureUartDriver uart;
+	CEzspDongle dongle(timerFactory);
+	unsigned int stateCount = 0;
+	unsigned int euiCount = 0;
+	std::vector<uint8_t> stateParams;
+
+	connectDongle(dongle, uart);
+	unsigned int stateSubscription = dongle.subscribe(EZSP_NETWORK_STATE, [&](EEzspCmd i_cmd, CByteSpan i_msg) {
+		stateCount++;
+		stateParams = i_msg.toVector();
+	});
+	dongle.subscribe(EZSP_GET_EUI64, [&](EEzspCmd i_cmd, CByteSpan i_msg) {
+		euiCount++;
+	});
+	if (stateSubscription == 0) {
+		FAILF("Subscription should have succeeded");
+	}
+
+	/* Only the subscribers of the received command are invoked, with the parameters only */
+	feed(dongle, ncpDataFrame(0, 0, 0x90, EZSP_NETWORK_STATE, std::vector<uint8_t>({ 0x05, 0x06 })));
+	if (stateCount != 1 || euiCount != 0 || stateParams != std::vector<uint8_t>({ 0x05, 0x06 })) {
+		FAILF("Unexpected dispatch: state=%u, eui=%u", stateCount, euiCount);
+	}
+
+	/* A handler can unsubscribe itself while being invoked */
+	unsigned int selfSubscription = 0;
+	unsigned int selfCount = 0;
+	selfSubscription = dongle.subscribe(EZSP_NETWORK_STATE, [&](EEzspCmd i_cmd, CByteSpan i_msg) {
+		selfCount++;
+		dongle.unsubscribe(selfSubscription);
+	});
+	feed(dongle, ncpDataFrame(1, 1, 0x90, EZSP_NETWORK_STATE, std::vector<uint8_t>({ 0x02 })));
+	feed(dongle, ncpDataFrame(2, 2, 0x90, EZSP_NETWORK_STATE, std::vector<uint8_t>({ 0x02 })));
+	if (selfCount != 1 || stateCount != 3) {
+		FAILF("Unexpected dispatch after self unsubscription: self=%u, state=%u", selfCount, stateCount);
+	}
+
+	if (!dongle.unsubscribe(stateSubscription) || dongle.unsubscribe(stateSubscription)) {
+		FAILF("A subscription can be stopped exactly once");
+	}
+	feed(dongle, ncpDataFrame(3, 3, 0x90, EZSP_NETWORK_STATE, std::vector<uint8_t>({ 0x02 })));
+	if (stateCount != 3) {
+		FAILF("Handler invoked after unsubscription");
+	}
+	NOTIFYPASS();
+}
+
+TEST(ezsp_dongle_tests, dongle_async_dispatch) {
+	CppThreadsTimerFactory timerFactory;
+	CCaptureUartDriver uart;
+	CEzspDongle dongle(timerFactory);
+	std::atomic<unsigned int> stateCount(0);
+	std::thread::id handlerThread;
+
+	connectDongle(dongle, uart);
+	dongle.subscribe(EZSP_NETWORK_STATE, [&](EEzspCmd i_cmd, CByteSpan i_msg) {
+		handlerThread = std::this_thread::get_id();
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		stateCount++;
+	});
+	if (!dongle.setAsyncDispatch(4)) {
+		FAILF("Async dispatch should have been enabled");
+	}
+
+	/* A slow subscriber does not delay the UART read thread, the frame is acknowledged right away */
+	size_t writtenBefore = uart.written.size();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	feed(dongle, ncpDataFrame(0, 0, 0x90, EZSP_NETWORK_STATE, std::vector<uint8_t>({ 0x02 })));
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	if (elapsed >= 150) {
+		FAILF("Reading a frame took %ld ms, it should not wait for the subscriber", static_cast<long>(elapsed));
+	}
+	if (uart.written.size() != writtenBefore + 1) {
+		FAILF("The frame should have been acknowledged");
+	}
+
+	/* Switching back to synchronous mode dispatches what was waiting */
+	dongle.setSyncDispatch();
+	if (stateCount != 1 || handlerThread == std::this_thread::get_id()) {
+		FAILF("Subscriber should have been invoked once, from the dispatch thread");
+	}
+	SEzspRxMetrics metrics = dongle.getRxDispatchMetrics();
+	if (metrics.queued != 1 || metrics.dispatched != 1 || metrics.dropped != 0 || metrics.depth != 0) {
+		FAILF("Unexpected metrics: queued=%u, dispatched=%u, dropped=%u", metrics.queued, metrics.dispatched, metrics.dropped);
+	}
+	NOTIFYPASS();
+}
+
+TEST(ezsp_dongle_tests, rx_executor_overflow_policies) {
+	std::atomic<bool> release(false);
+	std::vector<uint8_t> received;
+	CEzspRxExecutor executor([&](CByteSpan i_frame) {
+		while (!release) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		received.push_back(i_frame[0]);
+	});
+	const uint8_t frames[] = { 0, 1, 2, 3, 4, 5 };
+
+	/* Drop: the dispatch thread is stuck on the first frame, only 2 more fit in the queue */
+	executor.start(2, EZSP_RX_OVERFLOW_DROP);
+	executor.dispatch(CByteSpan(&frames[0], 1));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	for (size_t i = 1; i < sizeof(frames); i++) {
+		executor.dispatch(CByteSpan(&frames[i], 1));
+	}
+	release = true;
+	executor.stop();
+	if (received != std::vector<uint8_t>({ 0, 1, 2 })) {
+		FAILF("Unexpected frames dispatched with the drop policy");
+	}
+	SEzspRxMetrics metrics = executor.getMetrics();
+	if (metrics.dropped != 3 || metrics.queued != 3 || metrics.max_depth != 2) {
+		FAILF("Unexpected metrics: dropped=%u, queued=%u, max_depth=%zu", metrics.dropped, metrics.queued, metrics.max_depth);
+	}
+
+	/* Block: no frame is lost, the producer waits for room */
+	received.clear();
+	release = false;
+	executor.start(1, EZSP_RX_OVERFLOW_BLOCK);
+	std::thread releaser([&]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		release = true;
+	});
+	for (size_t i = 0; i < sizeof(frames); i++) {
+		executor.dispatch(CByteSpan(&frames[i], 1));
+	}
+	executor.stop();
+	releaser.join();
+	if (received != std::vector<uint8_t>({ 0, 1, 2, 3, 4, 5 })) {
+		FAILF("All frames should have been dispatched in order with the block policy");
+	}
+	metrics = executor.getMetrics();
+	if (metrics.blocked == 0 || metrics.dropped != 3 || metrics.max_latency < 10000) {
+		FAILF("Unexpected metrics: blocked=%u, dropped=%u, max_latency=%u", metrics.blocked, metrics.dropped, metrics.max_latency);
+	}
+	NOTIFYPASS();
+}
+
+static SMsg schedulerMsg(EEzspCmd cmd, EEzspCmdPriority priority) {
+	SMsg msg = { cmd, std::vector<uint8_t>(), FEzspRspHandler(), 0, std::chrono::steady_clock::time_point(), priority, std::chrono::steady_clock::time_point() };
+	return msg;
+}
+
+TEST(ezsp_dongle_tests, cmd_scheduler_priority_order) {
+	CEzspCmdScheduler scheduler;
+
+	scheduler.push(schedulerMsg(EZSP_SET_CONFIGURATION_VALUE, EZSP_PRIO_BULK));
+	scheduler.push(schedulerMsg(EZSP_NETWORK_STATE, EZSP_PRIO_INTERACTIVE));
+	scheduler.push(schedulerMsg(EZSP_SET_POLICY, EZSP_PRIO_BULK));
+	scheduler.push(schedulerMsg(EZSP_D_GP_SEND, EZSP_PRIO_REALTIME));
+	if (scheduler.size() != 4) {
+		FAILF("Expected 4 queued commands, got %zu", scheduler.size());
+	}
+
+	/* Most urgent class first, FIFO within a class */
+	const EEzspCmd expected[] = { EZSP_D_GP_SEND, EZSP_NETWORK_STATE, EZSP_SET_CONFIGURATION_VALUE, EZSP_SET_POLICY };
+	for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+		SMsg msg = scheduler.pop();
+		if (msg.i_cmd != expected[i]) {
+			FAILF("Command %zu: expected 0x%02x, got 0x%02x", i, static_cast<unsigned int>(expected[i]), static_cast<unsigned int>(msg.i_cmd));
+		}
+	}
+	if (!scheduler.empty()) {
+		FAILF("Scheduler should be empty");
+	}
+
+	SEzspCmdQueueMetrics bulk = scheduler.getMetrics(EZSP_PRIO_BULK);
+	if (bulk.depth != 0 || bulk.max_depth != 2 || bulk.queued != 2 || bulk.served != 2 || bulk.aged != 0) {
+		FAILF("Unexpected bulk metrics");
+	}
+	NOTIFYPASS();
+}
+
+TEST(ezsp_dongle_tests, cmd_scheduler_aging) {
+	CEzspCmdScheduler scheduler;
+
+	scheduler.setAging(EZSP_PRIO_BULK, 20);
+	scheduler.push(schedulerMsg(EZSP_GP_PROXY_TABLE_GET_ENTRY, EZSP_PRIO_BULK));
+	std::this_thread::sleep_for(std::chrono::milliseconds(40));
+	scheduler.push(schedulerMsg(EZSP_D_GP_SEND, EZSP_PRIO_REALTIME));
+
+	/* The bulk command waited too long, it goes before the realtime one */
+	if (scheduler.pop().i_cmd != EZSP_GP_PROXY_TABLE_GET_ENTRY) {
+		FAILF("Aged bulk command should have been served first");
+	}
+	if (scheduler.pop().i_cmd != EZSP_D_GP_SEND) {
+		FAILF("Realtime command should have been served second");
+	}
+
+	SEzspCmdQueueMetrics bulk = scheduler.getMetrics(EZSP_PRIO_BULK);
+	if (bulk.aged != 1 || bulk.max_wait < 20) {
+		FAILF("Unexpected bulk metrics: aged=%u, max_wait=%u", bulk.aged, bulk.max_wait);
+	}
+	NOTIFYPASS();
+}
+
+TEST(ezsp_dongle_tests, enum_to_string) {
+	if (CEzspEnum::EEzspCmdToString(EZSP_VERSION) != "EZSP_VERSION" || CEzspEnum::EEzspCmdToString(EZSP_GP_SINK_TABLE_INIT) != "EZSP_GP_SINK_TABLE_INIT"
+	    || CEzspEnum::EEmberStatusToString(EMBER_NETWORK_UP) != "EMBER_NETWORK_UP" || CEzspEnum::EEmberStatusToString(static_cast<EEmberStatus>(0xFE)) != "OUT_OF_RANGE : 254"
+	    || CEzspEnum::EmberNodeTypeToString(EMBER_ROUTER) != "EMBER_ROUTER" || CEzspEnum::EmberKeyTypeToString(static_cast<EmberKeyType>(0x1234)) != "OUT_OF_RANGE"
+	    || CAsh::EAshInfoToString(ASH_NACK) != "ASH_NACK" || CZdpEnum::ToString(ZDP_MGMT_BIND) != "ZDP_MGMT_BIND") {
+		FAILF("Unexpected enum names");
+	}
+
+	/* Reference: the previous implementation, building a map of all names at each call */
+	std::vector<std::pair<EEzspCmd, std::string>> cmdNames;
+	for (unsigned int value = 0; value < 256; value++) {
+		std::string name = CEzspEnum::EEzspCmdToString(static_cast<EEzspCmd>(value));
+		if (name != "OUT_OF_RANGE") {
+			cmdNames.push_back(std::make_pair(static_cast<EEzspCmd>(value), name));
+		}
+	}
+	auto mapToString = [&cmdNames](EEzspCmd in) -> std::string {
+		const std::map<EEzspCmd, std::string> names(cmdNames.begin(), cmdNames.end());
+		auto it = names.find(in);
+		return it == names.end() ? "OUT_OF_RANGE" : it->second;
+	};
+
+	const unsigned int iterations = 20000;
+	size_t total = 0;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < iterations / 100; i++) {
+		total += mapToString(static_cast<EEzspCmd>(i & 0xFF)).size();
+	}
+	double mapCost = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count()) / (iterations / 100);
+	begin = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < iterations; i++) {
+		total += CEzspEnum::EEzspCmdToString(static_cast<EEzspCmd>(i & 0xFF)).size();
+	}
+	double tableCost = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count()) / iterations;
+	std::cout << "EEzspCmdToString() for " << cmdNames.size() << " commands: " << mapCost << "ns building a map, " << tableCost << "ns with a lookup table (" << total << " chars)" << std::endl;
+	NOTIFYPASS();
+}
+
+/**
+ * @brief Build EZSP_SEND_UNICAST parameters the way CZigbeeMessaging::SendUnicast() used to, byte by byte
+ */
+static std::vector<uint8_t> sendUnicastPushBack(EmberNodeId nodeId, CAPSFrame aps, const std::vector<uint8_t>& msg) {
+	std::vector<uint8_t> payload;
+	payload.push_back(EMBER_OUTGOING_DIRECT);
+	payload.push_back(static_cast<uint8_t>(nodeId & 0xFF));
+	payload.push_back(static_cast<uint8_t>((nodeId >> 8) & 0xFF));
+	CFrameBuffer apsBytes = aps.GetEmberAPS();
+	payload.insert(payload.end(), apsBytes.begin(), apsBytes.end());
+	payload.push_back(0);
+	payload.push_back(static_cast<uint8_t>(msg.size()));
+	payload.insert(payload.end(), msg.begin(), msg.end());
+	return payload;
+}
+
+TEST(ezsp_dongle_tests, ezsp_codec) {
+	CAPSFrame aps;
+	aps.SetDefaultAPS(0x0104, 0x0006, 0x01);
+	aps.sequence = 0x42;
+	const std::vector<uint8_t> msg({0x01, 0x42, 0x02});
+
+	if (CEzspSendUnicast::requestPayload(EMBER_OUTGOING_DIRECT, 0x1234, aps, 0, CByteSpan(msg)) != sendUnicastPushBack(0x1234, aps, msg)) {
+		FAILF("Unexpected EZSP_SEND_UNICAST encoding");
+	}
+	CEmberGpAddressStruct gpAddr(0x00500001U);
+	std::vector<uint8_t> gpSend({0x01, 0x00});
+	std::vector<uint8_t> gpAddrBytes = gpAddr.getRaw();
+	gpSend.insert(gpSend.end(), gpAddrBytes.begin(), gpAddrBytes.end());
+	gpSend.insert(gpSend.end(), {0xF3, 0x02, 0xAA, 0xBB, 0x07, 0x88, 0x13});
+	if (CEzspDGpSend::requestPayload(true, false, gpAddr, 0xF3, CByteSpan(std::vector<uint8_t>({0xAA, 0xBB})), 7, 5000) != gpSend) {
+		FAILF("Unexpected EZSP_D_GP_SEND encoding");
+	}
+	CEzspAddEndpoint<1,2>::CRequestBuffer endpoint;
+	const uint8_t expectedEndpoint[] = {242, 0x0E, 0xA1, 0x64, 0x00, 0x00, 0x01, 0x02, 0x21, 0x00, 0x21, 0x00, 0x00, 0x00};
+	if (sizeof(endpoint) != sizeof(expectedEndpoint)
+	    || CEzspAddEndpoint<1,2>::encodeRequest(endpoint, 242, 0xA10E, 0x0064, 0, 1, 2, std::array<uint16_t,1>{{0x0021}}, std::array<uint16_t,2>{{0x0021, 0x0000}}) != sizeof(expectedEndpoint)
+	    || !std::equal(endpoint.begin(), endpoint.end(), expectedEndpoint)) {
+		FAILF("Unexpected EZSP_ADD_ENDPOINT encoding");
+	}
+
+	/* Decoding, out of bounds data being rejected instead of throwing */
+	EEmberStatus status = EMBER_ERR_FATAL;
+	uint8_t handle = 0;
+	if (!CEzspDGpSentHandler::decodeResponse(std::vector<uint8_t>({0x00, 0x07}), status, handle) || status != EMBER_SUCCESS || handle != 7) {
+		FAILF("Unexpected EZSP_D_GP_SENT_HANDLER decoding");
+	}
+	if (CEzspDGpSentHandler::decodeResponse(std::vector<uint8_t>({0x00}), status, handle)) {
+		FAILF("Truncated responses should not be decoded");
+	}
+	std::vector<uint8_t> unicast = sendUnicastPushBack(0x1234, aps, msg);
+	uint8_t type = 0;
+	uint16_t nodeId = 0;
+	CAPSFrame decodedAps;
+	uint8_t tag = 0xFF;
+	CByteSpan content;
+	CByteSpan span(unicast);
+	typedef CEzspParameters<CEzspU8Field<>, CEzspU16Field, CEzspApsFrameField, CEzspU8Field<>, CEzspVarBytesField<EZSP_SEND_UNICAST_MAX_MESSAGE_LENGTH> > CSendUnicastRequest;
+	if (!CSendUnicastRequest::decode(span, type, nodeId, decodedAps, tag, content) || !span.empty() || nodeId != 0x1234 || tag != 0
+	    || decodedAps.GetEmberAPS() != aps.GetEmberAPS() || content.toVector() != msg) {
+		FAILF("Unexpected EZSP_SEND_UNICAST decoding");
+	}
+	unicast.pop_back();
+	span = CByteSpan(unicast);
+	if (CSendUnicastRequest::decode(span, type, nodeId, decodedAps, tag, content)) {
+		FAILF("A message shorter than its length should not be decoded");
+	}
+
+	/* Messages longer than what fits in an ASH frame are truncated */
+	std::vector<uint8_t> longMsg(200, 0x55);
+	if (CEzspSendUnicast::requestPayload(EMBER_OUTGOING_DIRECT, 0x1234, aps, 0, CByteSpan(longMsg)).size() != CEzspSendUnicast::CRequestBuffer().size()
+	    || CEzspSendUnicast::CRequestBuffer().size() > EZSP_MAX_PARAMETERS_LENGTH) {
+		FAILF("Unexpected EZSP_SEND_UNICAST maximum size");
+	}
+
+	const unsigned int iterations = 100000;
+	size_t total = 0;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < iterations; i++) {
+		total += sendUnicastPushBack(static_cast<EmberNodeId>(i), aps, msg).size();
+	}
+	double pushBackCost = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count()) / iterations;
+	begin = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < iterations; i++) {
+		total += CEzspSendUnicast::requestPayload(EMBER_OUTGOING_DIRECT, static_cast<EmberNodeId>(i), aps, 0, CByteSpan(msg)).size();
+	}
+	double codecCost = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count()) / iterations;
+	std::cout << "Encoding EZSP_SEND_UNICAST: " << pushBackCost << "ns with push_back, " << codecCost << "ns with the codec (" << total << " bytes)" << std::endl;
+	NOTIFYPASS();
+}
+
+/**
+ * @brief Observer counting the messages received
+ */
+class CCountingObserver : public CEzspDongleObserver {
+public:
+	CCountingObserver() : count(0), bytes(0) { }
+	void handleDongleState(EDongleState i_state) { }
+	void handleEzspRxMessage(EEzspCmd i_cmd, const CFrameBuffer& i_msg_receive) {
+		count++;
+		bytes += i_msg_receive.size();
+	}
+
+	unsigned int count;
+	size_t bytes;
+};
+
+TEST(ezsp_dongle_tests, dongle_steady_state_allocations) {
+	CppThreadsTimerWheel timerFactory;
+	CDiscardUartDriver uart;
+	CEzspDongle dongle(timerFactory);
+	CCountingObserver observer;
+	SCompletion completion;
+	unsigned int subscriberCount = 0;
+
+	connectDongle(dongle, uart);
+	dongle.registerObserver(&observer);
+	dongle.subscribe(EZSP_SEND_UNICAST, [&subscriberCount](EEzspCmd i_cmd, CByteSpan i_msg) {
+		subscriberCount++;
+	});
+
+	CZigBeeMsg zbMsg;
+	zbMsg.SetZdo(0x0005, std::vector<uint8_t>({0x34, 0x12}), 0x01);
+	const FEzspRspHandler handler = [&completion](EEzspRspStatus i_status, EEzspCmd i_cmd, CByteSpan i_response) {
+		completion.status = i_status;
+		completion.count++;
+	};
+
+	/* The NCP responses, built beforehand: frame numbers cycle every 8 frames and sequence numbers every 256 commands */
+	const unsigned int cycle = 256;
+	std::vector< std::vector<uint8_t> > responses;
+	for (unsigned int i = 0; i < cycle; i++) {
+		responses.push_back(ncpDataFrame(static_cast<uint8_t>(i & 0x07), static_cast<uint8_t>(i), 0x80, EZSP_SEND_UNICAST, std::vector<uint8_t>({ 0x00, 0x01 }), static_cast<uint8_t>(i + 1)));
+	}
+
+	/* One command sent, then its response received, the first cycle warming up the queues */
+	const unsigned int iterations = 16 * cycle;
+	size_t txAllocations = 0;
+	size_t rxAllocations = 0;
+	std::chrono::nanoseconds txTime(0);
+	std::chrono::nanoseconds rxTime(0);
+	for (unsigned int i = 0; i < cycle + iterations; i++) {
+		size_t allocations = getHeapAllocationCount();
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		dongle.sendCommand(CEzspSendUnicast::ID, CEzspSendUnicast::requestPayload(EMBER_OUTGOING_DIRECT, 0x1234, zbMsg.GetAps(), 0, CByteSpan(zbMsg.Get())), handler);
+		std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+		allocations = getHeapAllocationCount() - allocations;
+		if (i >= cycle) {
+			txAllocations += allocations;
+			txTime += std::chrono::duration_cast<std::chrono::nanoseconds>(middle - begin);
+		}
+
+		allocations = getHeapAllocationCount();
+		middle = std::chrono::steady_clock::now();
+		feed(dongle, responses[i % cycle]);
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		allocations = getHeapAllocationCount() - allocations;
+		if (i >= cycle) {
+			rxAllocations += allocations;
+			rxTime += std::chrono::duration_cast<std::chrono::nanoseconds>(end - middle);
+		}
+	}
+
+	if (completion.count != cycle + iterations || completion.status != EZSP_RSP_SUCCESS || subscriberCount != cycle + iterations || observer.count != cycle + iterations) {
+		FAILF("Unexpected dispatch: %u completions, %u subscriber calls, %u observer calls", completion.count, subscriberCount, observer.count);
+	}
+	/* Each command and each response (acknowledged right away) is written once */
+	if (uart.writes < 2 * (cycle + iterations)) {
+		FAILF("Only %u frames written", uart.writes);
+	}
+	if (HEAP_ALLOCATION_COUNTING && (txAllocations != 0 || rxAllocations != 0)) {
+		FAILF("Steady state made %zu heap allocations sending commands and %zu receiving responses", txAllocations, rxAllocations);
+	}
+	std::cout << "Steady state EZSP_SEND_UNICAST: TX " << txTime.count() / iterations << "ns, " << txAllocations << " allocations; RX "
+	          << rxTime.count() / iterations << "ns, " << rxAllocations << " allocations" << std::endl;
+	dongle.unregisterObserver(&observer);
+	NOTIFYPASS();
+}
+
+#ifndef USE_CPPUTEST
+void unit_tests_ezsp_dongle() {
+	dongle_response_by_sequence_number();
+	dongle_response_timeout();
+	dongle_rx_dispatch_by_command();
+	dongle_async_dispatch();
+	rx_executor_overflow_policies();
+	cmd_scheduler_priority_order();
+	cmd_scheduler_aging();
+	enum_to_string();
+	ezsp_codec();
+	dongle_steady_state_allocations();
+}
+#endif	// USE_CPPUTEST
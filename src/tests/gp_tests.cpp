@@ -4,7 +4,7 @@
 #include <stdint.h>
 
 #include "../spi/mock-uart/MockUartDriver.h"
-#include "../spi/cppthreads/CppThreadsTimerFactory.h"
+#include "../spi/virtual-clock/VirtualTimer.h"
 #include "../spi/IAsyncDataInputObserver.h"
 
 #include "../spi/GenericLogger.h"
@@ -131,7 +131,7 @@ public:
 TEST_GROUP(gp_tests) {
 };
 
-#define UT_WAIT_MS(tms) std::this_thread::sleep_for(std::chrono::milliseconds(tms))
+#define UT_WAIT_MS(tms) virtualClock.advance(std::chrono::milliseconds(tms))	/* Simulated time, the scenario runs at CPU speed */
 #define UT_FAILF_UNLESS_STAGE(tstage) do {\
 	if (serialProcessor.stage != tstage) \
 		FAILF("Failed to transition to stage %d", tstage); \
@@ -141,7 +141,8 @@ TEST_GROUP(gp_tests) {
 
 
 TEST(gp_tests, gp_recv_sensor_measurement) {
-	CppThreadsTimerFactory timerFactory;
+	VirtualClock virtualClock;
+	VirtualTimerFactory timerFactory(virtualClock);
 	GenericAsyncDataInputObservable uartIncomingDataHandler;
 	ConsoleLogger::getInstance().setLogLevel(LOG_LEVEL::DEBUG);	/* Only display logs for debug level info and higher (up to error) */
 	std::vector< std::vector<uint8_t> > stageExpectedTransitions;
@@ -149,7 +150,7 @@ TEST(gp_tests, gp_recv_sensor_measurement) {
 	auto wcb = [&serialProcessor](size_t& writtenCnt, const void* buf, size_t cnt, std::chrono::duration<double, std::milli> delta) -> int {
 		return serialProcessor.onWriteCallback(writtenCnt, buf, cnt, delta);
 	};
-	MockUartDriver uartDriver(wcb);
+	MockUartDriver uartDriver(wcb, &virtualClock);
 	if (uartDriver.open("/dev/ttyUSB0", 57600) != 0) {
 		FAILF("Failed opening mock serial port");
 	}
@@ -1277,7 +1278,7 @@ TEST(gp_tests, gp_recv_sensor_measurement) {
 	UT_WAIT_MS(100);
 	UT_FAILF_UNLESS_STAGE(361);
 
-	std::this_thread::sleep_for(std::chrono::milliseconds(1000));	/* Give 1s for final timeout (allows all written bytes to be sent by libezsp) */
+	UT_WAIT_MS(1000);	/* Give 1s for final timeout (allows all written bytes to be sent by libezsp) */
 
 	uartDriver.destroyAllScheduledIncomingChunks(); /* Destroy all uartDriver currently running thread just in case */
 
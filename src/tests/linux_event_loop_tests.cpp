@@ -0,0 +1,166 @@
+#include "TestHarness.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <stdint.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../domain/ezsp-dongle.h"
+#include "../spi/linux/LinuxEventLoop.h"
+#include "../spi/linux/LinuxTimerFactory.h"
+#include "../spi/linux/LinuxUartDriver.h"
+#include "pty_pair.h"
+
+/**
+ * @brief Observer collecting the bytes read from the UART
+ */
+class CCollector : public IAsyncDataInputObserver {
+public:
+	CCollector() : received(), threadId() { }
+	void handleInputData(const unsigned char* dataIn, const size_t dataLen) {
+		received.insert(received.end(), dataIn, dataIn + dataLen);
+		threadId = std::this_thread::get_id();
+	}
+
+	std::vector<uint8_t> received;
+	std::thread::id threadId;
+};
+
+/**
+ * @brief Observer recording the dongle state changes
+ */
+class CDongleStateObserver : public CEzspDongleObserver {
+public:
+	CDongleStateObserver() : ready(false) { }
+	void handleDongleState(EDongleState i_state) { ready = (DONGLE_READY == i_state); }
+	void handleEzspRxMessage(EEzspCmd i_cmd, const CFrameBuffer& i_msg_receive) { }
+
+	bool ready;
+};
+
+/**
+ * @brief Run the event loop until a condition is met, or 1s has elapsed
+ */
+template <typename TCondition>
+static bool runUntil(LinuxEventLoop& loop, TCondition condition) {
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+	while (!condition() && std::chrono::steady_clock::now() < deadline) {
+		loop.runOnce(10);
+	}
+	return condition();
+}
+
+TEST_GROUP(linux_event_loop_tests) {
+};
+
+TEST(linux_event_loop_tests, linux_timers_on_loop_thread) {
+	LinuxEventLoop loop;
+	LinuxTimerFactory factory(loop);
+	std::unique_ptr<ITimer> slow(factory.create());
+	std::unique_ptr<ITimer> fast(factory.create());
+	std::vector<int> fired;
+	std::thread::id callbackThread;
+
+	slow->start(40, [&](ITimer* triggeringTimer) { fired.push_back(40); callbackThread = std::this_thread::get_id(); });
+	fast->start(10, [&](ITimer* triggeringTimer) { fired.push_back(10); });
+	if (!slow->isRunning() || !fast->isRunning()) {
+		FAILF("Timers should be running");
+	}
+	if (!runUntil(loop, [&]() { return fired.size() == 2; })) {
+		FAILF("Timers did not expire");
+	}
+	if (fired != std::vector<int>({ 10, 40 }) || callbackThread != std::this_thread::get_id() || slow->isRunning()) {
+		FAILF("Timers should expire in order, from the loop thread");
+	}
+
+	/* A stopped timer does not fire, a timer can restart itself from its callback, and the loop can be stopped from a callback */
+	unsigned int ticks = 0;
+	std::function<void (ITimer*)> tick = [&](ITimer* triggeringTimer) {
+		if (++ticks < 3) {
+			triggeringTimer->start(5, tick);
+		}
+		else {
+			loop.stop();
+		}
+	};
+	slow->start(20, [&](ITimer* triggeringTimer) { FAILF("Stopped timer should not fire"); });
+	slow->stop();
+	fast->start(5, tick);
+	loop.run();
+	if (ticks != 3) {
+		FAILF("Expected 3 ticks, got %u", ticks);
+	}
+	NOTIFYPASS();
+}
+
+TEST(linux_event_loop_tests, linux_uart_over_pty) {
+	LinuxEventLoop loop;
+	GenericAsyncDataInputObservable observable;
+	CCollector collector;
+	CPtyPair pty;
+	LinuxUartDriver uart(loop);
+
+	observable.registerObserver(&collector);
+	uart.setIncomingDataHandler(&observable);
+	if (uart.open(pty.slaveName, 115200) != 0) {
+		FAILF("Failed opening %s", pty.slaveName.c_str());
+	}
+
+	/* Incoming bytes are notified from the loop thread */
+	std::vector<uint8_t> incoming(1000);
+	for (size_t i = 0; i < incoming.size(); i++) {
+		incoming[i] = static_cast<uint8_t>(i);
+	}
+	pty.writeMaster(incoming);
+	if (!runUntil(loop, [&]() { return collector.received.size() == incoming.size(); }) || collector.received != incoming) {
+		FAILF("Expected %zu bytes, got %zu", incoming.size(), collector.received.size());
+	}
+	if (collector.threadId != std::this_thread::get_id()) {
+		FAILF("Bytes should be notified from the loop thread");
+	}
+
+	/* Outgoing bytes */
+	const std::vector<uint8_t> outgoing({ 0x1a, 0xc0, 0x38, 0xbc, 0x7e });
+	size_t written = 0;
+	if (uart.write(written, outgoing.data(), outgoing.size()) != 0 || written != outgoing.size()) {
+		FAILF("Write failed");
+	}
+	if (pty.readMaster(outgoing.size()) != outgoing) {
+		FAILF("Unexpected bytes written");
+	}
+	NOTIFYPASS();
+}
+
+TEST(linux_event_loop_tests, linux_loop_drives_dongle) {
+	LinuxEventLoop loop;
+	LinuxTimerFactory factory(loop);
+	CPtyPair pty;
+	LinuxUartDriver uart(loop);
+	CDongleStateObserver observer;
+	CEzspDongle dongle(factory, &observer);
+
+	if (uart.open(pty.slaveName, 57600) != 0 || !dongle.open(&uart)) {
+		FAILF("Failed opening dongle");
+	}
+	/* The dongle resets the NCP, answer with RSTACK */
+	const std::vector<uint8_t> rst({ 0x1a, 0xc0, 0x38, 0xbc, 0x7e });
+	if (pty.readMaster(rst.size()) != rst) {
+		FAILF("Expected a RST frame");
+	}
+	pty.writeMaster(std::vector<uint8_t>({ 0xc1, 0x02, 0x0b, 0x0a, 0x52, 0x7e }));
+	if (!runUntil(loop, [&]() { return observer.ready; })) {
+		FAILF("Dongle not ready");
+	}
+	NOTIFYPASS();
+}
+
+#ifndef USE_CPPUTEST
+void unit_tests_linux_event_loop() {
+	linux_timers_on_loop_thread();
+	linux_uart_over_pty();
+	linux_loop_drives_dongle();
+}
+#endif	// USE_CPPUTEST
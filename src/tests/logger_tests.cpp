@@ -0,0 +1,283 @@
+#include "TestHarness.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <stdint.h>
+
+#include "../spi/GenericLogger.h"
+#include "../spi/cppthreads/CppThreadsAsyncLoggerSink.h"
+#include "../domain/zbmessage/green-power-frame.h"
+#include "../domain/ezsp-protocol/ezsp-enum.h"
+
+/**
+ * @brief Logger stream collecting the lines it outputs
+ */
+class CLineCollectorLogger : public ILoggerStream {
+public:
+	CLineCollectorLogger() : ILoggerStream(LOG_LEVEL::DEBUG), m(), lines(), outputThreads() { }
+	void log(const char *format, ...) { }
+
+	std::mutex m;
+	std::vector<std::string> lines;
+	std::vector<std::thread::id> outputThreads;
+
+protected:
+	void outputLine(const char* line, size_t length) {
+		std::lock_guard<std::mutex> lock(m);
+		if (line[length] != '\0') {
+			lines.push_back("<not terminated>");
+		}
+		lines.push_back(std::string(line, length));
+		outputThreads.push_back(std::this_thread::get_id());
+	}
+};
+
+/**
+ * @brief Logger stream implemented the way ILoggerStream used to require it: one overflow() call per character, lines being re-split by the logger
+ */
+class CPerCharacterLogger : public std::streambuf {
+public:
+	CPerCharacterLogger() : buffer(), lines(0) { }
+
+	std::string buffer;
+	size_t lines;
+
+protected:
+	int overflow(int c) {
+		if (c == '\n') {
+			lines++;
+			buffer = "";
+		}
+		else {
+			buffer += static_cast<char>(c);
+		}
+		return c;
+	}
+};
+
+/**
+ * @brief Logger stream counting the lines it outputs
+ */
+class CLineCounterLogger : public ILoggerStream {
+public:
+	CLineCounterLogger() : ILoggerStream(LOG_LEVEL::DEBUG), lines(0) { }
+	void log(const char *format, ...) { }
+
+	size_t lines;
+
+protected:
+	void outputLine(const char* line, size_t length) {
+		lines++;
+	}
+};
+
+TEST_GROUP(logger_tests) {
+};
+
+TEST(logger_tests, logger_stream_lines) {
+	CLineCollectorLogger logger;
+	std::ostream os(&logger);
+
+	os << "Frame " << 42 << " from 0x" << std::hex << 0x1234 << "\nsecond";
+	if (logger.lines.size() != 1) {
+		FAILF("Only complete lines should be output");
+	}
+	os << " line" << std::endl;
+	os << std::string(ILOGGER_LINE_BUFFER_SIZE + 10, 'x') << "\n";
+	if (logger.lines != std::vector<std::string>({"Frame 42 from 0x1234", "second line", std::string(ILOGGER_LINE_BUFFER_SIZE - 1, 'x'), std::string(11, 'x')})) {
+		FAILF("Unexpected lines output");
+	}
+
+	logger.setMaxEnabledLogLevel(LOG_LEVEL::INFO);
+	os << "Not output\n";
+	logger.setMaxEnabledLogLevel(LOG_LEVEL::DEBUG);
+	logger.mute();
+	os << "Not output either\n";
+	logger.unmute();
+	os << "\n";
+	if (logger.lines.size() != 5 || !logger.lines.back().empty()) {
+		FAILF("Lines should not be output (nor buffered) while the logger is disabled or muted");
+	}
+	NOTIFYPASS();
+}
+
+TEST(logger_tests, logger_async_sink) {
+	CLineCollectorLogger first;
+	CLineCollectorLogger second;
+	const unsigned int threads = 4;
+	const unsigned int linesPerThread = 500;
+	size_t dropped;
+	{
+		CppThreadsAsyncLoggerSink sink(4096);
+		first.setAsyncSink(&sink);
+		second.setAsyncSink(&sink);
+
+		std::vector<std::thread> producers;
+		for (unsigned int t = 0; t < threads; t++) {
+			producers.push_back(std::thread([t, &first, &second]() {
+				std::ostream os((t % 2 == 0) ? static_cast<std::streambuf*>(&first) : static_cast<std::streambuf*>(&second));
+				for (unsigned int i = 0; i < linesPerThread; i++) {
+					os << (t * 10000 + i) << "\n";
+				}
+			}));
+		}
+		for (size_t t = 0; t < producers.size(); t++) {
+			producers[t].join();
+		}
+		sink.flush();
+		dropped = sink.getDroppedLinesCount();
+		first.setAsyncSink(nullptr);
+		second.setAsyncSink(nullptr);
+	}
+
+	if (first.lines.size() + second.lines.size() + dropped != threads * linesPerThread || dropped != 0) {
+		FAILF("Expected %u lines, got %zu (%zu dropped)", threads * linesPerThread, first.lines.size() + second.lines.size(), dropped);
+	}
+	/* Lines logged by each thread are output in order, from the thread of the sink */
+	std::vector<unsigned long> last(threads, 0);
+	for (unsigned int s = 0; s < 2; s++) {
+		CLineCollectorLogger& logger = (s == 0) ? first : second;
+		for (size_t i = 0; i < logger.lines.size(); i++) {
+			unsigned long value = std::stoul(logger.lines[i]);
+			unsigned long t = value / 10000;
+			if (t >= threads || (value % 10000 != 0 && value <= last[t]) || logger.outputThreads[i] == std::this_thread::get_id()) {
+				FAILF("Unexpected line \"%s\"", logger.lines[i].c_str());
+			}
+			last[t] = value;
+		}
+	}
+
+	CppThreadsAsyncLoggerSink tiny(2);
+	CLineCounterLogger counter;
+	counter.setAsyncSink(&tiny);
+	std::ostream os(&counter);
+	for (unsigned int i = 0; i < 10000; i++) {
+		os << "Burst\n";
+	}
+	tiny.flush();
+	counter.setAsyncSink(nullptr);
+	if (counter.lines + tiny.getDroppedLinesCount() != 10000) {
+		FAILF("Lines should either be output or counted as dropped");
+	}
+	NOTIFYPASS();
+}
+
+/**
+ * @brief Measure the time taken to log a typical frame dump line
+ *
+ * @return The average time per line (in ns)
+ */
+static double benchLogging(std::streambuf& logger, unsigned int iterations) {
+	std::ostream os(&logger);
+	const std::string frame("41 ea b1 57 54 ef 6a 66 36 94 4d 25 fb 54 95 49 cd 4f 94 a9 ec ce 66 e4 7b c5 63 29 45 fa 80 85");
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	for (unsigned int i = 0; i < iterations; i++) {
+		os << "ASH received DATA frame: " << frame << "\n";
+	}
+	return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count()) / iterations;
+}
+
+TEST(logger_tests, logger_benchmark) {
+	const unsigned int iterations = 20000;
+	CPerCharacterLogger perCharacter;
+	CLineCounterLogger buffered;
+	CLineCounterLogger disabled;
+	disabled.setMaxEnabledLogLevel(LOG_LEVEL::INFO);
+
+	double perCharacterCost = benchLogging(perCharacter, iterations);
+	double bufferedCost = benchLogging(buffered, iterations);
+	double disabledCost = benchLogging(disabled, iterations);
+	std::cout << "Logging a frame dump line: per character " << perCharacterCost << "ns, buffered " << bufferedCost << "ns, disabled " << disabledCost << "ns" << std::endl;
+	if (perCharacter.lines != iterations || buffered.lines != iterations || disabled.lines != 0) {
+		FAILF("Unexpected number of lines output");
+	}
+	NOTIFYPASS();
+}
+
+/**
+ * @brief Count how many times a log statement argument has been evaluated
+ */
+static unsigned int evaluations = 0;
+static const char* countEvaluation() {
+	evaluations++;
+	return "";
+}
+
+TEST(logger_tests, logger_disabled_statements) {
+	ConsoleLogger::getInstance().setLogLevel(LOG_LEVEL::INFO);
+	clogD << "Not evaluated" << countEvaluation() << std::endl;
+	if (evaluations == 0)
+		clog << countEvaluation();
+	else
+		FAILF("Arguments of a disabled log statement should not be evaluated");
+	plogD("Not evaluated %s", countEvaluation());
+	clogI << countEvaluation();
+	if (evaluations != 1 || LOGGER_IS_OUTPUTTING(LOG_LEVEL::DEBUG, ILogger::loggerDebugStream) || !LOGGER_IS_OUTPUTTING(LOG_LEVEL::INFO, ILogger::loggerInfoStream)) {
+		FAILF("Only enabled log statements should be evaluated");
+	}
+	ConsoleLogger::getInstance().setLogLevel(LOG_LEVEL::TRACE);
+	NOTIFYPASS();
+}
+
+/**
+ * @brief Measure the time taken to decode a GP frame and log it at debug level, the way CGpSink does when receiving it
+ *
+ * @param filtered Use the clogD macro (true), or write to the debug stream unconditionally, as clogD used to do (false)
+ *
+ * @return The average time per frame (in ns)
+ */
+static double benchGpFrameLogging(bool filtered, unsigned int iterations) {
+	std::vector<uint8_t> msg(28, 0x00);	/* EZSP_GPEP_INCOMING_MESSAGE_HANDLER payload */
+	msg[1] = 0xd0;	/* link */
+	msg[2] = 0x42;	/* sequence number */
+	msg[4] = 0x01;	/* source id 0x00500001 */
+	msg[6] = 0x50;
+	msg[13] = 0x02;	/* security */
+	msg[21] = 0xa0;	/* command */
+	msg[27] = 4;	/* payload length */
+	msg.insert(msg.end(), {0x01, 0x02, 0x03, 0x04});
+	EEmberStatus status = static_cast<EEmberStatus>(msg.at(0));
+	uint32_t sourceIds = 0;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	for (unsigned int i = 0; i < iterations; i++) {
+		CGpFrame gpf(msg);
+		sourceIds += gpf.getSourceId();
+		if (filtered) {
+			clogD << "EZSP_GPEP_INCOMING_MESSAGE_HANDLER status : " << CEzspEnum::EEmberStatusToString(status) << ", link : " << unsigned(msg.at(1)) << ", sequence number : " << unsigned(msg.at(2)) << ", gp address : " << gpf << std::endl;
+		}
+		else {
+			ILogger::loggerDebugStream << "EZSP_GPEP_INCOMING_MESSAGE_HANDLER status : " << CEzspEnum::EEmberStatusToString(status) << ", link : " << unsigned(msg.at(1)) << ", sequence number : " << unsigned(msg.at(2)) << ", gp address : " << gpf << std::endl;
+		}
+	}
+	if (sourceIds != 0x00500001U * iterations) {
+		return -1;
+	}
+	return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count()) / iterations;
+}
+
+TEST(logger_tests, logger_gp_frame_benchmark) {
+	ConsoleLogger::getInstance().setLogLevel(LOG_LEVEL::INFO);
+	double unfilteredCost = benchGpFrameLogging(false, 5000);
+	double filteredCost = benchGpFrameLogging(true, 5000);
+	ConsoleLogger::getInstance().setLogLevel(LOG_LEVEL::TRACE);
+	std::cout << "Decoding a GP frame with debug logs disabled: " << unfilteredCost << "ns when formatting log arguments, " << filteredCost << "ns when skipping them" << std::endl;
+	if (unfilteredCost < 0 || filteredCost < 0) {
+		FAILF("GP frame not decoded as expected");
+	}
+	NOTIFYPASS();
+}
+
+#ifndef USE_CPPUTEST
+void unit_tests_logger() {
+	logger_stream_lines();
+	logger_async_sink();
+	logger_benchmark();
+	logger_disabled_statements();
+	logger_gp_frame_benchmark();
+}
+#endif	// USE_CPPUTEST
@@ -0,0 +1,385 @@
+#include "TestHarness.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <stdint.h>
+
+#include "../domain/ezsp-dongle.h"
+#include "../domain/zigbee-tools/zigbee-messaging.h"
+#include "../domain/zigbee-tools/green-power-sink.h"
+#include "../domain/green-power-observer.h"
+#include "../domain/ezsp-protocol/struct/ember-gp-address-struct.h"
+#include "../spi/cppthreads/CppThreadsTimerFactory.h"
+#include "../spi/ncp-emulator/NcpEmulator.h"
+
+/**
+ * @brief Dongle observer waiting for the dongle to be ready, and counting the callbacks received
+ */
+class CEmulatedDongleObserver : public CEzspDongleObserver {
+public:
+	CEmulatedDongleObserver() : ready(false), stackStatus(0), stackStatusCount(0) { }
+	void handleDongleState( EDongleState i_state ) {
+		if (DONGLE_READY == i_state) {
+			ready = true;
+		}
+	}
+	void handleEzspRxMessage( EEzspCmd i_cmd, const CFrameBuffer& i_msg_receive ) {
+		if (EZSP_STACK_STATUS_HANDLER == i_cmd && !i_msg_receive.empty()) {
+			stackStatus = i_msg_receive[0];
+			stackStatusCount++;
+		}
+	}
+
+	std::atomic<bool> ready;
+	std::atomic<uint8_t> stackStatus;
+	std::atomic<unsigned int> stackStatusCount;
+};
+
+/**
+ * @brief GP observer counting the green power frames received
+ */
+class CGpFrameCounter : public CGpObserver {
+public:
+	CGpFrameCounter() : frames(0), lastSourceId(0) { }
+	void handleRxGpFrame( CGpFrame &i_gpf ) {
+		lastSourceId = i_gpf.getSourceId();
+		frames++;
+	}
+	void handleRxGpdId( uint32_t &i_gpd_id ) { }
+
+	std::atomic<unsigned int> frames;
+	std::atomic<uint32_t> lastSourceId;
+};
+
+/**
+ * @brief Dongle observer counting the responses and callbacks received, per command
+ */
+class CCommandCounter : public CEzspDongleObserver {
+public:
+	CCommandCounter() : counts() {
+		for (size_t i = 0; i < 256; i++) {
+			counts[i] = 0;
+		}
+	}
+	void handleDongleState( EDongleState i_state ) { }
+	void handleEzspRxMessage( EEzspCmd i_cmd, const CFrameBuffer& i_msg_receive ) {
+		counts[static_cast<unsigned int>(i_cmd) & 0xFF]++;
+	}
+	unsigned int count(EEzspCmd i_cmd) const {
+		return counts[static_cast<unsigned int>(i_cmd) & 0xFF];
+	}
+
+	std::atomic<unsigned int> counts[256];
+};
+
+/**
+ * @brief Wait for a condition to become true, at most timeoutMs
+ */
+template <typename Predicate>
+static bool waitFor(Predicate condition, unsigned int timeoutMs) {
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+	while (!condition()) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+/**
+ * @brief Send a command to the emulated NCP, and wait for its response
+ *
+ * @return The parameters of the response, empty on failure
+ */
+static std::vector<uint8_t> request(CEzspDongle& dongle, EEzspCmd cmd, const std::vector<uint8_t>& params, EEzspCmd* rspCmd = nullptr) {
+	std::mutex m;
+	std::condition_variable done;
+	bool completed = false;
+	std::vector<uint8_t> response;
+
+	dongle.sendCommand(cmd, params, [&](EEzspRspStatus i_status, EEzspCmd i_cmd, CByteSpan i_response) {
+		std::lock_guard<std::mutex> lock(m);
+		if (EZSP_RSP_SUCCESS == i_status) {
+			response = i_response.toVector();
+			if (rspCmd) {
+				*rspCmd = i_cmd;
+			}
+		}
+		completed = true;
+		done.notify_all();
+	}, 2000);
+
+	std::unique_lock<std::mutex> lock(m);
+	done.wait(lock, [&completed]() { return completed; });
+	return response;
+}
+
+/**
+ * @brief Open a dongle on the emulated NCP, and wait until ASH is connected
+ */
+static void connectEmulatedDongle(CEzspDongle& dongle, NcpEmulator& ncp, CEmulatedDongleObserver& observer) {
+	if (ncp.open("emulator") != 0 || !dongle.open(&ncp)) {
+		FAILF("Failed opening dongle on the emulated NCP");
+	}
+	if (!waitFor([&observer]() { return observer.ready.load(); }, 2000)) {
+		FAILF("Dongle not ready");
+	}
+}
+
+TEST_GROUP(ncp_emulator_tests) {
+};
+
+TEST(ncp_emulator_tests, ncp_emulator_network_and_tables) {
+	CppThreadsTimerFactory timerFactory;
+	CEmulatedDongleObserver observer;
+	NcpEmulator ncp;
+	CEzspDongle dongle(timerFactory, &observer);
+
+	connectEmulatedDongle(dongle, ncp, observer);
+
+	if (request(dongle, EZSP_VERSION, std::vector<uint8_t>({ 6 })) != std::vector<uint8_t>({ 7, 2, 0x70, 0x6a })) {
+		FAILF("Unexpected version response");
+	}
+	if (request(dongle, EZSP_NETWORK_INIT, std::vector<uint8_t>()) != std::vector<uint8_t>({ EMBER_NOT_JOINED }) ||
+	    request(dongle, EZSP_NETWORK_STATE, std::vector<uint8_t>()) != std::vector<uint8_t>({ EMBER_NO_NETWORK })) {
+		FAILF("No network should exist");
+	}
+
+	/* Forming a network: extended PAN ID, PAN ID 0xabcd, TX power, channel 15, ... */
+	std::vector<uint8_t> nwkParams({ 1, 2, 3, 4, 5, 6, 7, 8, 0xcd, 0xab, 3, 15, 0, 0, 0, 0, 0, 0x80, 0, 0 });
+	if (request(dongle, EZSP_FORM_NETWORK, nwkParams) != std::vector<uint8_t>({ EMBER_SUCCESS })) {
+		FAILF("Failed forming the network");
+	}
+	if (!waitFor([&observer]() { return observer.stackStatusCount > 0; }, 1000) || observer.stackStatus != EMBER_NETWORK_UP) {
+		FAILF("Expected a stack status callback with the network up");
+	}
+	std::vector<uint8_t> nwk = request(dongle, EZSP_GET_NETWORK_PARAMETERS, std::vector<uint8_t>());
+	if (nwk.size() != 22 || nwk[0] != EMBER_SUCCESS || nwk[10] != 0xcd || nwk[11] != 0xab || nwk[13] != 15) {
+		FAILF("Unexpected network parameters");
+	}
+
+	/* Unsupported commands are rejected */
+	EEzspCmd rspCmd = EZSP_VERSION;
+	request(dongle, EZSP_GET_CHILD_DATA, std::vector<uint8_t>({ 0 }), &rspCmd);
+	if (rspCmd != EZSP_INVALID_COMMAND) {
+		FAILF("Expected EZSP_INVALID_COMMAND, got 0x%02x", static_cast<unsigned int>(rspCmd));
+	}
+
+	/* GP sink table */
+	std::vector<uint8_t> gpAddr = CEmberGpAddressStruct(0x12345678).getRaw();
+	if (request(dongle, EZSP_GP_SINK_TABLE_LOOKUP, gpAddr) != std::vector<uint8_t>({ 0xff }) ||
+	    request(dongle, EZSP_GP_SINK_TABLE_FIND_OR_ALLOCATE_ENTRY, gpAddr) != std::vector<uint8_t>({ 0 }) ||
+	    request(dongle, EZSP_GP_SINK_TABLE_LOOKUP, gpAddr) != std::vector<uint8_t>({ 0 })) {
+		FAILF("Failed allocating a sink table entry");
+	}
+	std::vector<uint8_t> entry = request(dongle, EZSP_GP_SINK_TABLE_GET_ENTRY, std::vector<uint8_t>({ 0 }));
+	if (entry.size() != 1 + NCP_EMULATOR_SINK_ENTRY_SIZE || entry[0] != EMBER_SUCCESS || !std::equal(gpAddr.begin(), gpAddr.end(), entry.begin() + 4)) {
+		FAILF("Unexpected sink table entry");
+	}
+	request(dongle, EZSP_GP_SINK_TABLE_REMOVE_ENTRY, std::vector<uint8_t>({ 0 }));
+	if (request(dongle, EZSP_GP_SINK_TABLE_LOOKUP, gpAddr) != std::vector<uint8_t>({ 0xff }) || ncp.getSinkTableEntryCount() != 0) {
+		FAILF("Sink table entry not removed");
+	}
+
+	/* Leaving */
+	if (request(dongle, EZSP_LEAVE_NETWORK, std::vector<uint8_t>()) != std::vector<uint8_t>({ EMBER_SUCCESS }) ||
+	    request(dongle, EZSP_NETWORK_STATE, std::vector<uint8_t>()) != std::vector<uint8_t>({ EMBER_NO_NETWORK })) {
+		FAILF("Failed leaving the network");
+	}
+	ncp.close();
+	NOTIFYPASS();
+}
+
+TEST(ncp_emulator_tests, ncp_emulator_ash_recovery) {
+	CppThreadsTimerFactory timerFactory;
+	CEmulatedDongleObserver observer;
+	SNcpEmulatorConfig config;
+	config.corruptPercent = 25;
+	config.ackTimeout = 30;
+	NcpEmulator ncp(config);
+	CEzspDongle dongle(timerFactory, &observer);
+
+	connectEmulatedDongle(dongle, ncp, observer);
+
+	/* One frame out of four is dropped by the host, the NCP retransmits it */
+	for (unsigned int i = 0; i < 40; i++) {
+		if (request(dongle, EZSP_NETWORK_STATE, std::vector<uint8_t>()) != std::vector<uint8_t>({ EMBER_NO_NETWORK })) {
+			FAILF("Command %u failed", i);
+		}
+	}
+	SNcpEmulatorStats stats = ncp.getStats();
+	if (stats.corrupted == 0 || stats.retransmissions < stats.corrupted) {
+		FAILF("Expected retransmissions: %u frames corrupted, %u retransmitted", stats.corrupted, stats.retransmissions);
+	}
+
+	/* A frame with a wrong CRC is rejected by the NCP */
+	const uint8_t garbage[] = { 0x25, 0x42, 0x21, 0xa8, 0x00, 0x00, 0x7e };
+	size_t written = 0;
+	ncp.write(written, garbage, sizeof(garbage));
+	if (!waitFor([&ncp]() { return ncp.getStats().naksSent > 0; }, 1000)) {
+		FAILF("Expected a NAK");
+	}
+	if (request(dongle, EZSP_NETWORK_STATE, std::vector<uint8_t>()) != std::vector<uint8_t>({ EMBER_NO_NETWORK })) {
+		FAILF("Command failed after a NAK");
+	}
+	ncp.close();
+	NOTIFYPASS();
+}
+
+TEST(ncp_emulator_tests, ncp_emulator_throughput_benchmark) {
+	CppThreadsTimerFactory timerFactory;
+	CEmulatedDongleObserver observer;
+	SNcpEmulatorConfig config;
+	config.txWindow = 4;
+	config.networkUp = true;
+	NcpEmulator ncp(config);
+	CEzspDongle dongle(timerFactory, &observer);
+	CZigbeeMessaging messaging(dongle, timerFactory);
+	CGpSink sink(dongle, messaging);
+	CGpFrameCounter counter;
+
+	sink.registerObserver(&counter);
+	connectEmulatedDongle(dongle, ncp, observer);
+	dongle.setTxWindow(4);
+
+	/* Round trip of a single command */
+	const unsigned int roundTrips = 200;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < roundTrips; i++) {
+		request(dongle, EZSP_NETWORK_STATE, std::vector<uint8_t>());
+	}
+	std::cout << "Emulated NCP: command round trip " << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count() / roundTrips << "us" << std::endl;
+
+	/* Command throughput, 4 in flight */
+	const unsigned int commands = 2000;
+	std::atomic<unsigned int> completed(0);
+	std::atomic<long long> latencyUs(0);
+	begin = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < commands; i++) {
+		std::chrono::steady_clock::time_point sent = std::chrono::steady_clock::now();
+		dongle.sendCommand(EZSP_NETWORK_STATE, std::vector<uint8_t>(), [&completed, &latencyUs, sent](EEzspRspStatus i_status, EEzspCmd i_cmd, CByteSpan i_response) {
+			if (EZSP_RSP_SUCCESS == i_status) {
+				latencyUs += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sent).count();
+				completed++;
+			}
+		}, 0, EZSP_PRIO_BULK);
+	}
+	if (!waitFor([&completed]() { return completed == commands; }, 10000)) {
+		FAILF("Only %u commands out of %u completed", completed.load(), commands);
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	std::cout << "Emulated NCP: " << static_cast<unsigned int>(commands / elapsed) << " commands/s, average latency from queuing " << latencyUs / commands << "us" << std::endl;
+
+	/* GP frames from 10 GPDs at 1000 frames/s */
+	std::vector<uint32_t> sourceIds;
+	for (uint32_t i = 0; i < 10; i++) {
+		sourceIds.push_back(0x01510000 + i);
+	}
+	begin = std::chrono::steady_clock::now();
+	if (!ncp.startGpTraffic(sourceIds, 1000)) {
+		FAILF("Failed starting GP traffic");
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	ncp.stopGpTraffic();
+	SNcpEmulatorStats stats = ncp.getStats();
+	if (!waitFor([&counter, &stats]() { return counter.frames == stats.callbacks; }, 2000)) {
+		FAILF("%u GP frames generated, %u received", stats.callbacks, counter.frames.load());
+	}
+	elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	std::cout << "Emulated NCP: " << static_cast<unsigned int>(counter.frames / elapsed) << " GP frames/s received, " << stats.callbacksDropped << " dropped" << std::endl;
+	if (stats.callbacks < 300 || counter.lastSourceId < 0x01510000 || counter.lastSourceId > 0x01510009) {
+		FAILF("Unexpected GP traffic: %u frames", stats.callbacks);
+	}
+	ncp.close();
+	NOTIFYPASS();
+}
+
+TEST(ncp_emulator_tests, gp_sink_table_mirror) {
+	CppThreadsTimerFactory timerFactory;
+	CEmulatedDongleObserver observer;
+	CCommandCounter commands;
+	SNcpEmulatorConfig config;
+	config.networkUp = true;
+	config.sinkTableSize = 8;
+	NcpEmulator ncp(config);
+	CEzspDongle dongle(timerFactory, &observer);
+	CZigbeeMessaging messaging(dongle, timerFactory);
+	CGpSink sink(dongle, messaging);
+
+	dongle.registerObserver(&commands);
+	connectEmulatedDongle(dongle, ncp, observer);
+
+	/* An entry already in the table of the NCP, at index 2 */
+	CEmberGpSinkTableEntryStruct existing;
+	existing.setEntryActive(true);
+	existing.setGpdAddress(CEmberGpAddressStruct(0x01510001));
+	std::vector<uint8_t> setEntry({ 2 });
+	std::vector<uint8_t> raw = existing.getRaw();
+	setEntry.insert(setEntry.end(), raw.begin(), raw.end());
+	if (request(dongle, EZSP_GP_SINK_TABLE_SET_ENTRY, setEntry) != std::vector<uint8_t>({ EMBER_SUCCESS })) {
+		FAILF("Failed writing a sink table entry");
+	}
+
+	/* The table is read once at init, the registration waits for it, then takes one command per GPD on the sink table */
+	sink.init();
+	sink.registerGpds(std::vector<CGpDevice>({ CGpDevice(0x01510002, EmberKeyData(16, 0x5a)), CGpDevice(0x01510001, EmberKeyData(16, 0xa5)) }));
+	if (!waitFor([&commands]() { return commands.count(EZSP_GP_PROXY_TABLE_PROCESS_GP_PAIRING) == 2; }, 2000)) {
+		FAILF("GPDs not registered");
+	}
+	request(dongle, EZSP_NETWORK_STATE, std::vector<uint8_t>());	/* Wait for the pending responses to be handled */
+	if (commands.count(EZSP_GP_SINK_TABLE_GET_ENTRY) != config.sinkTableSize + 1U || commands.count(EZSP_GP_SINK_TABLE_SET_ENTRY) != 1 + 2) {
+		FAILF("Unexpected sink table accesses: %u reads, %u writes", commands.count(EZSP_GP_SINK_TABLE_GET_ENTRY), commands.count(EZSP_GP_SINK_TABLE_SET_ENTRY));
+	}
+	const CGpSinkTable& table = sink.getSinkTable();
+	if (!table.isLoaded() || table.getSize() != config.sinkTableSize || table.getActiveEntryCount() != 2 || ncp.getSinkTableEntryCount() != 2) {
+		FAILF("Unexpected sink table mirror: %zu entries out of %zu", table.getActiveEntryCount(), table.getSize());
+	}
+	/* A registered GPD keeps its entry, a new one gets the first free entry */
+	if (table.getEntryIndexForSourceId(0x01510001) != 2 || table.getEntryIndexForSourceId(0x01510002) != 0 || table.getEntry(0).getGpdKey() != EmberKeyData(16, 0x5a)) {
+		FAILF("Unexpected sink table entries");
+	}
+
+	/* Removal, answered locally for GPDs not in the sink table */
+	sink.removeGpds(std::vector<uint32_t>({ 0x01510003, 0x01510001 }));
+	if (!waitFor([&commands]() { return commands.count(EZSP_GP_PROXY_TABLE_LOOKUP) == 2; }, 2000)) {
+		FAILF("GPDs not removed");
+	}
+	request(dongle, EZSP_NETWORK_STATE, std::vector<uint8_t>());
+	if (commands.count(EZSP_GP_SINK_TABLE_REMOVE_ENTRY) != 1 || table.getEntryIndexForSourceId(0x01510001) != GP_SINK_INVALID_ENTRY
+	    || table.getActiveEntryCount() != 1 || ncp.getSinkTableEntryCount() != 1) {
+		FAILF("Sink table entry not removed");
+	}
+
+	/* No lookup of the sink table of the NCP */
+	if (commands.count(EZSP_GP_SINK_TABLE_LOOKUP) != 0 || commands.count(EZSP_GP_SINK_TABLE_FIND_OR_ALLOCATE_ENTRY) != 0) {
+		FAILF("The sink table of the NCP should not be looked up");
+	}
+
+	if (!sink.gpClearAllTables()) {
+		FAILF("Failed clearing GP tables");
+	}
+	if (!waitFor([&commands]() { return commands.count(EZSP_GP_SINK_TABLE_CLEAR_ALL) == 1; }, 2000)) {
+		FAILF("Sink table not cleared");
+	}
+	request(dongle, EZSP_NETWORK_STATE, std::vector<uint8_t>());
+	if (!table.isLoaded() || table.getActiveEntryCount() != 0 || table.getFreeEntryIndex() != 0) {
+		FAILF("Sink table mirror not cleared");
+	}
+	ncp.close();
+	NOTIFYPASS();
+}
+
+#ifndef USE_CPPUTEST
+void unit_tests_ncp_emulator() {
+	ncp_emulator_network_and_tables();
+	ncp_emulator_ash_recovery();
+	ncp_emulator_throughput_benchmark();
+	gp_sink_table_mirror();
+}
+#endif	// USE_CPPUTEST
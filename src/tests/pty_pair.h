@@ -0,0 +1,67 @@
+/**
+ * @file pty_pair.h
+ *
+ * @brief Pseudo-terminal helper for the tests of serial port drivers
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <stdint.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "TestHarness.h"
+
+/**
+ * @brief Pseudo-terminal pair, the slave side being used as a serial port and the master side playing the role of the NCP
+ */
+class CPtyPair {
+public:
+	CPtyPair() : master(posix_openpt(O_RDWR | O_NOCTTY)), slaveName() {
+		if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0 || ptsname(master) == nullptr) {
+			FAILF("Failed opening a pseudo-terminal");
+		}
+		slaveName = ptsname(master);
+	}
+	~CPtyPair() {
+		::close(master);
+	}
+	CPtyPair(const CPtyPair&) = delete;
+	CPtyPair& operator=(const CPtyPair&) = delete;
+
+	/**
+	 * @brief Read what the driver wrote on the slave side, waiting at most 1s for expectedLen bytes
+	 */
+	std::vector<uint8_t> readMaster(size_t expectedLen) {
+		std::vector<uint8_t> result;
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+		int flags = fcntl(master, F_GETFL);
+		fcntl(master, F_SETFL, flags | O_NONBLOCK);
+		while (result.size() < expectedLen && std::chrono::steady_clock::now() < deadline) {
+			uint8_t buf[256];
+			ssize_t len = ::read(master, buf, sizeof(buf));
+			if (len > 0) {
+				result.insert(result.end(), buf, buf + len);
+			}
+			else {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+		fcntl(master, F_SETFL, flags);
+		return result;
+	}
+
+	void writeMaster(const std::vector<uint8_t>& data) {
+		if (::write(master, data.data(), data.size()) != static_cast<ssize_t>(data.size())) {
+			FAILF("Failed writing to the pseudo-terminal");
+		}
+	}
+
+	int master;
+	std::string slaveName;
+};
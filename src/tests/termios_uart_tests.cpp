@@ -0,0 +1,150 @@
+#include "TestHarness.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <stdint.h>
+#include <termios.h>
+
+#include "../spi/termios/TermiosUartDriver.h"
+#include "pty_pair.h"
+
+/**
+ * @brief Observer collecting the bytes read from the UART, from the I/O thread of the driver
+ */
+class CChunkCollector : public IAsyncDataInputObserver {
+public:
+	CChunkCollector() : m(), received(), chunks(0), maxChunk(0) { }
+	void handleInputData(const unsigned char* dataIn, const size_t dataLen) {
+		std::lock_guard<std::mutex> lock(m);
+		received.insert(received.end(), dataIn, dataIn + dataLen);
+		chunks++;
+		if (dataLen > maxChunk) {
+			maxChunk = dataLen;
+		}
+	}
+	size_t size() {
+		std::lock_guard<std::mutex> lock(m);
+		return received.size();
+	}
+
+	std::mutex m;
+	std::vector<uint8_t> received;
+	size_t chunks;
+	size_t maxChunk;
+};
+
+TEST_GROUP(termios_uart_tests) {
+};
+
+TEST(termios_uart_tests, termios_uart_bulk_read) {
+	GenericAsyncDataInputObservable observable;
+	CChunkCollector collector;
+	CPtyPair pty;
+	TermiosUartDriver uart(&observable);
+
+	observable.registerObserver(&collector);
+	if (uart.open(pty.slaveName, 115200) != 0) {
+		FAILF("Failed opening %s", pty.slaveName.c_str());
+	}
+
+	std::vector<uint8_t> incoming(10000);
+	for (size_t i = 0; i < incoming.size(); i++) {
+		incoming[i] = static_cast<uint8_t>(i * 7);
+	}
+	pty.writeMaster(incoming);
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+	while (collector.size() < incoming.size() && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	std::lock_guard<std::mutex> lock(collector.m);
+	if (collector.received != incoming) {
+		FAILF("Expected %zu bytes, got %zu", incoming.size(), collector.received.size());
+	}
+	/* Bytes are notified in bulk, never more than one read buffer at once */
+	if (collector.maxChunk > TERMIOS_UART_READ_SIZE || collector.chunks > incoming.size() / 16) {
+		FAILF("Bytes notified in %zu chunks (largest %zu bytes)", collector.chunks, collector.maxChunk);
+	}
+	STermiosUartStats stats = uart.getStats();
+	if (stats.bytesRead != incoming.size() || stats.reads != collector.chunks) {
+		FAILF("Unexpected read statistics: %u reads, %llu bytes", stats.reads, static_cast<unsigned long long>(stats.bytesRead));
+	}
+	NOTIFYPASS();
+}
+
+TEST(termios_uart_tests, termios_uart_write_coalescing) {
+	CPtyPair pty;
+	TermiosUartDriver uart;
+	size_t written = 0;
+
+	if (uart.open(pty.slaveName, 115200) != 0) {
+		FAILF("Failed opening %s", pty.slaveName.c_str());
+	}
+
+	/* Fill the pseudo-terminal until it pushes back, so that the following frames have to wait in the output queue */
+	std::vector<uint8_t> expected;
+	std::vector<uint8_t> bulk(4096, 0x55);
+	while (uart.getStats().bytesWritten == expected.size() && expected.size() < TERMIOS_UART_MAX_PENDING / 2) {
+		if (uart.write(written, bulk.data(), bulk.size()) != 0 || written != bulk.size()) {
+			FAILF("Failed queuing bulk data");
+		}
+		expected.insert(expected.end(), bulk.begin(), bulk.end());
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	/* A burst of small frames (eg an ACK followed by DATA frames) */
+	const unsigned int burst = 20;
+	for (unsigned int i = 0; i < burst; i++) {
+		const uint8_t frame[] = { 0x80, static_cast<uint8_t>(0x60 + i), 0x59, 0x7e };
+		if (uart.write(written, frame, sizeof(frame)) != 0 || written != sizeof(frame)) {
+			FAILF("Failed queuing frame %u", i);
+		}
+		expected.insert(expected.end(), frame, frame + sizeof(frame));
+	}
+
+	if (pty.readMaster(expected.size()) != expected) {
+		FAILF("Bytes written out of order or lost");
+	}
+	STermiosUartStats stats = uart.getStats();
+	if (stats.bytesWritten != expected.size() || stats.writes >= stats.frames) {
+		FAILF("Expected frames to be coalesced: %u frames, %u writes", stats.frames, stats.writes);
+	}
+	NOTIFYPASS();
+}
+
+TEST(termios_uart_tests, termios_uart_flow_control) {
+	CPtyPair pty;
+	TermiosUartDriver uart;
+	size_t written = 0;
+	uint8_t byte = 0x7e;
+
+	if (uart.write(written, &byte, 1) != EBADF) {
+		FAILF("Writing to a closed port should fail");
+	}
+	if (uart.open(pty.slaveName, 12345) == 0) {
+		FAILF("Unsupported baudrate should be rejected");
+	}
+	uart.setFlowControl(true);
+	if (uart.open(pty.slaveName, 921600) != 0) {
+		FAILF("Failed opening %s at 921600 bauds with RTS/CTS", pty.slaveName.c_str());
+	}
+	struct termios tio;
+	if (tcgetattr(pty.master, &tio) != 0 || cfgetospeed(&tio) != B921600 || (tio.c_cflag & CRTSCTS) == 0) {
+		FAILF("Serial port not configured as expected");
+	}
+	uart.close();
+	if (uart.write(written, &byte, 1) != EBADF) {
+		FAILF("Writing to a closed port should fail");
+	}
+	NOTIFYPASS();
+}
+
+#ifndef USE_CPPUTEST
+void unit_tests_termios_uart() {
+	termios_uart_bulk_read();
+	termios_uart_write_coalescing();
+	termios_uart_flow_control();
+}
+#endif	// USE_CPPUTEST
@@ -13,6 +13,14 @@
 #ifndef USE_CPPUTEST
 void unit_tests_gp();	// Declaration of gp unit test procedure (see gp_tests.cpp)
 void unit_tests_mock_serial();	// Declaration of mock serial self tests (see mock_serial_self_tests.cpp)
+void unit_tests_ash();	// Declaration of ASH framing unit test procedure (see ash_tests.cpp)
+void unit_tests_ezsp_dongle();	// Declaration of EZSP dongle unit test procedure (see ezsp_dongle_tests.cpp)
+void unit_tests_linux_event_loop();	// Declaration of Linux event loop unit test procedure (see linux_event_loop_tests.cpp)
+void unit_tests_timers();	// Declaration of timer unit test procedure (see timer_tests.cpp)
+void unit_tests_logger();	// Declaration of logger unit test procedure (see logger_tests.cpp)
+void unit_tests_termios_uart();	// Declaration of termios UART driver unit test procedure (see termios_uart_tests.cpp)
+void unit_tests_ncp_emulator();	// Declaration of NCP emulator unit test procedure (see ncp_emulator_tests.cpp)
+void unit_tests_byte_cursor();	// Declaration of byte cursor unit test procedure (see byte_cursor_tests.cpp)
 #endif
 
 int main(int argc, char* argv[]) {
@@ -20,6 +28,22 @@ int main(int argc, char* argv[]) {
 #ifndef USE_CPPUTEST
 	printf("*** Self test on mock serial ***\n");
 	unit_tests_mock_serial();
+	printf("*** Testing ASH framing ***\n");
+	unit_tests_ash();
+	printf("*** Testing byte cursors ***\n");
+	unit_tests_byte_cursor();
+	printf("*** Testing EZSP dongle ***\n");
+	unit_tests_ezsp_dongle();
+	printf("*** Testing Linux event loop ***\n");
+	unit_tests_linux_event_loop();
+	printf("*** Testing timers ***\n");
+	unit_tests_timers();
+	printf("*** Testing loggers ***\n");
+	unit_tests_logger();
+	printf("*** Testing termios UART driver ***\n");
+	unit_tests_termios_uart();
+	printf("*** Testing against an emulated NCP ***\n");
+	unit_tests_ncp_emulator();
 	printf("*** Testing GP frames processing ***\n");
 	unit_tests_gp();
 	printf("\n*** All unit tests passed successfully ***\n");
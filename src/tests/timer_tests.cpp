@@ -0,0 +1,252 @@
+#include "TestHarness.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <stdint.h>
+
+#include "../spi/cppthreads/CppThreadsTimer.h"
+#include "../spi/cppthreads/CppThreadsTimerWheel.h"
+#include "../spi/virtual-clock/VirtualTimer.h"
+#include "../spi/mock-uart/MockUartDriver.h"
+
+/**
+ * @brief Wait for a condition to become true, at most timeoutMs
+ */
+template <typename Predicate>
+static bool waitFor(Predicate condition, unsigned int timeoutMs) {
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+	while (!condition()) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+TEST_GROUP(timer_tests) {
+};
+
+TEST(timer_tests, timer_wheel_expiry_order) {
+	CppThreadsTimerWheel wheel;
+	std::unique_ptr<ITimer> late = wheel.create();
+	std::unique_ptr<ITimer> early = wheel.create();
+	std::unique_ptr<ITimer> stopped = wheel.create();
+	std::unique_ptr<ITimer> immediate = wheel.create();
+	std::mutex order_m;
+	std::vector<int> order;
+	auto record = [&order, &order_m](int id) {
+		std::lock_guard<std::mutex> lock(order_m);
+		order.push_back(id);
+	};
+
+	/* 300ms does not fit in one revolution of the wheel */
+	if (!late->start(300, [&record](ITimer*) { record(2); })) {
+		FAILF("Failed starting timer");
+	}
+	if (late->start(10, [&record](ITimer*) { record(9); })) {
+		FAILF("A running timer should not be restartable");
+	}
+	early->start(20, [&record](ITimer*) { record(1); });
+	stopped->start(30, [&record](ITimer*) { record(3); });
+	immediate->start(0, [&record](ITimer*) { record(0); });
+	if (!stopped->isRunning() || !stopped->stop() || stopped->stop() || stopped->isRunning()) {
+		FAILF("Unexpected stop() behaviour");
+	}
+
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	if (!waitFor([&late]() { return !late->isRunning(); }, 2000)) {
+		FAILF("Timer did not expire");
+	}
+	long elapsed = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count());
+	if (elapsed < 295) {
+		FAILF("Timer expired too early (after %ldms)", elapsed);
+	}
+
+	std::lock_guard<std::mutex> lock(order_m);
+	if (order != std::vector<int>({0, 1, 2})) {
+		FAILF("Unexpected expiry order");
+	}
+	NOTIFYPASS();
+}
+
+TEST(timer_tests, timer_wheel_periodic_and_restart) {
+	CppThreadsTimerWheel wheel;
+	CppThreadsWheelTimer periodic(wheel);
+	CppThreadsWheelTimer oneShot(wheel);
+	std::atomic<unsigned int> ticks(0);
+	std::atomic<unsigned int> restarts(0);
+
+	if (!periodic.startPeriodic(std::chrono::milliseconds(5), [&ticks](ITimer*) { ticks++; })) {
+		FAILF("Failed starting periodic timer");
+	}
+
+	/* A one-shot timer restarting itself from its callback */
+	std::function<void (ITimer*)> restart = [&restarts, &restart](ITimer* timer) {
+		if (++restarts < 3) {
+			timer->start(5, restart);
+		}
+	};
+	oneShot.start(5, restart);
+
+	if (!waitFor([&ticks, &restarts]() { return ticks >= 5 && restarts >= 3; }, 2000)) {
+		FAILF("Periodic timer ticked %u times, one-shot timer restarted %u times", ticks.load(), restarts.load());
+	}
+	if (!periodic.isRunning() || oneShot.isRunning()) {
+		FAILF("Periodic timer should still be running, not the one-shot one");
+	}
+	periodic.stop();
+	unsigned int ticksAtStop = ticks;
+	std::this_thread::sleep_for(std::chrono::milliseconds(30));
+	if (ticks != ticksAtStop) {
+		FAILF("Periodic timer ticked after being stopped");
+	}
+	NOTIFYPASS();
+}
+
+TEST(timer_tests, timer_wheel_long_duration) {
+	CppThreadsTimerWheel wheel;
+	CppThreadsWheelTimer timer(wheel);
+	std::atomic<bool> fired(false);
+
+	/* Longer than what fits in the uint16_t of ITimer::start() */
+	if (!timer.start(std::chrono::milliseconds(100000), [&fired](ITimer*) { fired = true; })) {
+		FAILF("Failed starting long timer");
+	}
+	if (timer.duration != UINT16_MAX) {
+		FAILF("Duration should saturate, got %u", timer.duration);
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(600));
+	if (fired || !timer.isRunning()) {
+		FAILF("Long timer expired early");
+	}
+	/* Destroying a running timer must unregister it from the wheel */
+	NOTIFYPASS();
+}
+
+/**
+ * @brief Measure the average cost (in ns) of starting then stopping a timer
+ */
+static double benchStartStop(ITimer& timer, unsigned int iterations) {
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < iterations; i++) {
+		timer.start(10000, [](ITimer*) { });
+		timer.stop();
+	}
+	return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count()) / iterations;
+}
+
+TEST(timer_tests, timer_start_stop_benchmark) {
+	CppThreadsTimer threadTimer;
+	CppThreadsTimerWheel wheel;
+	CppThreadsWheelTimer wheelTimer(wheel);
+
+	double threadCost = benchStartStop(threadTimer, 200);
+	double wheelCost = benchStartStop(wheelTimer, 20000);
+	std::cout << "start()+stop(): thread per timer " << threadCost << "ns, timer wheel " << wheelCost << "ns" << std::endl;
+	if (threadTimer.isRunning() || wheelTimer.isRunning()) {
+		FAILF("Timers should be stopped");
+	}
+	NOTIFYPASS();
+}
+
+TEST(timer_tests, virtual_clock_timers) {
+	VirtualClock clock;
+	VirtualTimerFactory factory(clock);
+	std::unique_ptr<ITimer> late = factory.create();
+	std::unique_ptr<ITimer> early = factory.create();
+	std::unique_ptr<ITimer> stopped = factory.create();
+	std::unique_ptr<ITimer> periodic = factory.create();
+	std::vector<long> expiries;	/* Simulated time at which each timer expired, tagged with the timer id in the thousands */
+	unsigned int ticks = 0;
+	std::function<void (ITimer*)> tick = [&](ITimer* timer) {
+		expiries.push_back(4000 + static_cast<long>(clock.now().count()));
+		if (++ticks < 3) {
+			timer->start(1000, tick);	/* Restart from our own callback */
+		}
+	};
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	late->start(60000, [&](ITimer*) { expiries.push_back(1000 + static_cast<long>(clock.now().count())); });
+	early->start(500, [&](ITimer*) { expiries.push_back(2000 + static_cast<long>(clock.now().count())); });
+	stopped->start(700, [&](ITimer*) { expiries.push_back(3000 + static_cast<long>(clock.now().count())); });
+	periodic->start(1000, tick);
+	if (late->start(10, [](ITimer*) { }) || !stopped->stop() || stopped->isRunning()) {
+		FAILF("Unexpected start()/stop() behaviour");
+	}
+
+	clock.advance(std::chrono::milliseconds(2999));
+	if (expiries != std::vector<long>({2500, 5000, 6000}) || !periodic->isRunning()) {
+		FAILF("Unexpected expiries after 2999ms of simulated time");
+	}
+	while (clock.runNext()) {
+	}
+	if (clock.now() != std::chrono::milliseconds(60000) || expiries != std::vector<long>({2500, 5000, 6000, 7000, 61000}) || late->isRunning() || periodic->isRunning()) {
+		FAILF("Unexpected expiries when running all events");
+	}
+	long elapsed = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count());
+	if (elapsed > 100) {
+		FAILF("One minute of simulated time took %ldms", elapsed);
+	}
+	NOTIFYPASS();
+}
+
+TEST(timer_tests, virtual_clock_mock_uart) {
+	VirtualClock clock;
+	GenericAsyncDataInputObservable observable;
+	std::vector<long> writeDeltas;
+	MockUartDriver uart([&writeDeltas](size_t& writtenCnt, const void* buf, size_t cnt, std::chrono::duration<double, std::milli> delta) -> int {
+		writeDeltas.push_back(delta == std::chrono::duration<double, std::milli>::max() ? -1 : static_cast<long>(delta.count()));
+		writtenCnt = cnt;
+		return 0;
+	}, &clock);
+	std::vector<long> readTimes;
+	class CReadTimeRecorder : public IAsyncDataInputObserver {
+	public:
+		CReadTimeRecorder(VirtualClock& clock, std::vector<long>& times) : m_clock(clock), m_times(times) { }
+		void handleInputData(const unsigned char* dataIn, const size_t dataLen) {
+			m_times.push_back(static_cast<long>(m_clock.now().count()));
+		}
+	private:
+		VirtualClock& m_clock;
+		std::vector<long>& m_times;
+	} recorder(clock, readTimes);
+	const uint8_t byte = 0x7e;
+	size_t written;
+
+	observable.registerObserver(&recorder);
+	uart.setIncomingDataHandler(&observable);
+	uart.scheduleIncomingChunk(MockUartScheduledByteDelivery(std::vector<unsigned char>({0x1a}), std::chrono::milliseconds(2000)));
+	uart.scheduleIncomingChunk(MockUartScheduledByteDelivery(std::vector<unsigned char>({0xc1, 0x02}), std::chrono::milliseconds(5000)));	/* Relative to the previous chunk */
+	uart.scheduleIncomingChunk(MockUartScheduledByteDelivery(std::vector<unsigned char>({0x7e}), std::chrono::milliseconds(100000)));
+	uart.write(written, &byte, 1);
+	clock.advance(std::chrono::milliseconds(7000));
+	uart.write(written, &byte, 1);
+
+	if (readTimes != std::vector<long>({2000, 7000}) || uart.getDeliveredIncomingBytesCount() != 3 || uart.getScheduledIncomingChunksCount() != 1) {
+		FAILF("Chunks not delivered at the expected simulated time");
+	}
+	if (writeDeltas != std::vector<long>({-1, 7000})) {
+		FAILF("Write deltas should be measured in simulated time");
+	}
+	uart.destroyAllScheduledIncomingChunks();
+	if (clock.getPendingEventsCount() != 0 || uart.getScheduledIncomingBytesCount() != 0) {
+		FAILF("Pending delivery should have been cancelled");
+	}
+	NOTIFYPASS();
+}
+
+#ifndef USE_CPPUTEST
+void unit_tests_timers() {
+	timer_wheel_expiry_order();
+	timer_wheel_periodic_and_restart();
+	timer_wheel_long_duration();
+	timer_start_stop_benchmark();
+	virtual_clock_timers();
+	virtual_clock_mock_uart();
+}
+#endif	// USE_CPPUTEST